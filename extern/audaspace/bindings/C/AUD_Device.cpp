@@ -18,8 +18,10 @@
 #include "devices/I3DDevice.h"
 #include "devices/IDeviceFactory.h"
 #include "devices/ReadDevice.h"
+#include "devices/SoftwareDevice.h"
 #include "Exception.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace aud;
@@ -248,6 +250,26 @@ AUD_API void AUD_Device_setVolume(AUD_Device* device, float value)
 	dev->setVolume(value);
 }
 
+AUD_API int AUD_Device_setMixingThreads(AUD_Device* device, int count)
+{
+	auto dev = std::dynamic_pointer_cast<SoftwareDevice>(device ? *device : DeviceManager::getDevice());
+	if(!dev)
+		return false;
+
+	dev->setMixingThreads(std::max(count, 0));
+	return true;
+}
+
+AUD_API int AUD_Device_setVirtualizationVolume(AUD_Device* device, float volume)
+{
+	auto dev = std::dynamic_pointer_cast<SoftwareDevice>(device ? *device : DeviceManager::getDevice());
+	if(!dev)
+		return false;
+
+	dev->setVirtualizationVolume(volume);
+	return true;
+}
+
 AUD_API int AUD_Device_read(AUD_Device* device, unsigned char* buffer, int length)
 {
 	assert(device);
@@ -192,6 +192,22 @@ extern AUD_API float AUD_Device_getVolume(AUD_Device* device);
  */
 extern AUD_API void AUD_Device_setVolume(AUD_Device* device, float value);
 
+/**
+ * Sets the number of threads mixing the sounds of a software mixing device.
+ * \param device The device to set the mixing threads from.
+ * \param count The number of threads, 0 or 1 to mix on the playback thread only.
+ * \return Whether the device mixes its sounds in software.
+ */
+extern AUD_API int AUD_Device_setMixingThreads(AUD_Device* device, int count);
+
+/**
+ * Sets the volume under which the sounds of a software mixing device are not read.
+ * \param device The device to set the virtualization volume from.
+ * \param volume The volume, 0 for silent sounds only, negative to always read sounds.
+ * \return Whether the device mixes its sounds in software.
+ */
+extern AUD_API int AUD_Device_setVirtualizationVolume(AUD_Device* device, float volume);
+
 /**
  * Reads the next samples into the supplied buffer.
  * \param device The readable device.
@@ -30,7 +30,9 @@
 #include "util/Buffer.h"
 
 #include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 AUD_NAMESPACE_BEGIN
 
@@ -38,6 +40,7 @@ class Mixer;
 class PitchReader;
 class ResampleReader;
 class ChannelMapperReader;
+class ThreadPool;
 
 /**
  * The software device is a generic device with software mixing.
@@ -96,6 +99,9 @@ protected:
 		/// The loop count of the source.
 		int m_loopcount;
 
+		/// Samples played while the source was inaudible, not yet skipped in the reader.
+		int m_virtual_samples;
+
 		/// Location in 3D Space.
 		Vector3 m_location;
 
@@ -154,6 +160,20 @@ protected:
 		 */
 		bool pause(bool keep);
 
+		/**
+		 * Advances the position of an inaudible source without reading it.
+		 * The reader is only seeked when the end of the source is reached or
+		 * when the source becomes audible again.
+		 * \param length The number of samples played.
+		 * \return Whether the end of the source is reached.
+		 */
+		bool virtualize(int length);
+
+		/**
+		 * Applies the samples skipped while the source was inaudible to the reader.
+		 */
+		void devirtualize();
+
 	public:
 		/**
 		 * Creates a new software handle.
@@ -293,6 +313,41 @@ private:
 	 */
 	std::list<std::shared_ptr<SoftwareHandle> > m_pausedSounds;
 
+	/// State of a mixing thread.
+	struct MixingTask
+	{
+		/// The mixer the sounds of the task are superposed into.
+		std::shared_ptr<Mixer> mixer;
+
+		/// The reading buffer of the task.
+		Buffer buffer;
+	};
+
+	/**
+	 * The thread pool mixing the sounds in parallel, null when mixing on the calling thread only.
+	 */
+	std::shared_ptr<ThreadPool> m_mixing_pool;
+
+	/**
+	 * The states of the mixing threads besides the calling thread.
+	 */
+	std::vector<std::shared_ptr<MixingTask> > m_mixing_tasks;
+
+	/**
+	 * The sounds mixed during the current mix call.
+	 */
+	std::vector<std::shared_ptr<SoftwareHandle> > m_mixing_sounds;
+
+	/**
+	 * Whether each of the mixed sounds reached its end during the current mix call.
+	 */
+	std::vector<unsigned char> m_mixing_ended;
+
+	/**
+	 * Volume under which a sound is inaudible and is not read, negative to always read sounds.
+	 */
+	float m_virtualization_volume;
+
 	/**
 	 * Whether there is currently playback.
 	 */
@@ -336,6 +391,18 @@ private:
 	SoftwareDevice(const SoftwareDevice&) = delete;
 	SoftwareDevice& operator=(const SoftwareDevice&) = delete;
 
+	/**
+	 * Reads a range of the mixed sounds and superposes them.
+	 * \param begin The index of the first sound in m_mixing_sounds.
+	 * \param end The index after the last sound in m_mixing_sounds.
+	 * \param mixer The mixer to superpose the sounds into.
+	 * \param buffer The reading buffer.
+	 * \param length The length in samples to be mixed.
+	 * \note The sounds ending are only marked in m_mixing_ended, so that
+	 *       ranges can be mixed from several threads at once.
+	 */
+	void mixSounds(int begin, int end, Mixer& mixer, Buffer& buffer, int length);
+
 public:
 
 	/**
@@ -351,6 +418,34 @@ public:
 	 */
 	void setQuality(ResampleQuality quality);
 
+	/**
+	 * Sets the number of threads mixing the sounds.
+	 * The sounds are only split between threads when enough of them are playing.
+	 * \param count The number of threads including the playback thread,
+	 *        0 or 1 to mix on the playback thread only.
+	 */
+	void setMixingThreads(unsigned int count);
+
+	/**
+	 * Retrieves the number of threads mixing the sounds.
+	 * \return The number of threads including the playback thread.
+	 */
+	unsigned int getMixingThreads() const;
+
+	/**
+	 * Sets the volume under which sounds are virtual.
+	 * Virtual sounds are not read nor mixed, only their position advances.
+	 * \param volume The volume, by default 0 for silent sounds only,
+	 *        negative to disable virtualization.
+	 */
+	void setVirtualizationVolume(float volume);
+
+	/**
+	 * Retrieves the volume under which sounds are virtual.
+	 * \return The virtualization volume.
+	 */
+	float getVirtualizationVolume() const;
+
 	virtual DeviceSpecs getSpecs() const;
 	virtual std::shared_ptr<IHandle> play(std::shared_ptr<IReader> reader, bool keep = false);
 	virtual std::shared_ptr<IHandle> play(std::shared_ptr<ISound> sound, bool keep = false);
@@ -112,6 +112,12 @@ public:
 	 */
 	void mix(sample_t* buffer, int start, int length, float volume_to, float volume_from);
 
+	/**
+	 * Superposes the mixing buffer of another mixer.
+	 * \param mixer The mixer to add, with the same specification and length.
+	 */
+	void add(const Mixer& mixer);
+
 	/**
 	 * Writes the mixing buffer into an output buffer.
 	 * \param buffer The target buffer for superposing.
@@ -20,12 +20,14 @@
 #include "respec/JOSResampleReader.h"
 #include "respec/LinearResampleReader.h"
 #include "respec/Mixer.h"
+#include "util/ThreadPool.h"
 #include "Exception.h"
 #include "ISound.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <mutex>
@@ -42,6 +44,9 @@ enum RenderFlags
 
 #define PITCH_MAX 10
 
+// minimum number of sounds mixed by a thread, below the overhead of a task outweighs its work
+#define MIXING_SOUNDS_MIN 16
+
 /******************************************************************************/
 /********************** SoftwareHandle Handle Code ************************/
 /******************************************************************************/
@@ -77,8 +82,47 @@ bool SoftwareDevice::SoftwareHandle::pause(bool keep)
 	return false;
 }
 
+bool SoftwareDevice::SoftwareHandle::virtualize(int length)
+{
+	m_virtual_samples += length;
+
+	int sound_length = m_reader->getLength();
+
+	// sources of unknown length never end
+	if(sound_length < 0)
+		return false;
+
+	int position = m_reader->getPosition() + m_virtual_samples;
+
+	if(position < sound_length)
+		return false;
+
+	// in case of looping
+	while(position >= sound_length && m_loopcount && sound_length > 0)
+	{
+		position -= sound_length;
+
+		if(m_loopcount > 0)
+			m_loopcount--;
+	}
+
+	m_virtual_samples = 0;
+	m_reader->seek(std::min(position, sound_length));
+
+	return position >= sound_length && !m_loopcount;
+}
+
+void SoftwareDevice::SoftwareHandle::devirtualize()
+{
+	if(m_virtual_samples)
+	{
+		m_reader->seek(m_reader->getPosition() + m_virtual_samples);
+		m_virtual_samples = 0;
+	}
+}
+
 SoftwareDevice::SoftwareHandle::SoftwareHandle(SoftwareDevice* device, std::shared_ptr<IReader> reader, std::shared_ptr<PitchReader> pitch, std::shared_ptr<ResampleReader> resampler, std::shared_ptr<ChannelMapperReader> mapper, bool keep) :
-	m_reader(reader), m_pitch(pitch), m_resampler(resampler), m_mapper(mapper), m_first_reading(true), m_keep(keep), m_user_pitch(1.0f), m_user_volume(1.0f), m_user_pan(0.0f), m_volume(0.0f), m_old_volume(0.0f), m_loopcount(0),
+	m_reader(reader), m_pitch(pitch), m_resampler(resampler), m_mapper(mapper), m_first_reading(true), m_keep(keep), m_user_pitch(1.0f), m_user_volume(1.0f), m_user_pan(0.0f), m_volume(0.0f), m_old_volume(0.0f), m_loopcount(0), m_virtual_samples(0),
 	m_relative(true), m_volume_max(1.0f), m_volume_min(0), m_distance_max(std::numeric_limits<float>::max()),
 	m_distance_reference(1.0f), m_attenuation(1.0f), m_cone_angle_outer(M_PI), m_cone_angle_inner(M_PI), m_cone_volume_outer(0),
 	m_flags(RENDER_CONE), m_stop(nullptr), m_stop_data(nullptr), m_status(STATUS_PLAYING), m_device(device)
@@ -373,6 +417,7 @@ bool SoftwareDevice::SoftwareHandle::seek(double position)
 		return false;
 
 	m_pitch->setPitch(m_user_pitch);
+	m_virtual_samples = 0;
 	m_reader->seek((int)(position * m_reader->getSpecs().rate));
 
 	if(m_status == STATUS_STOPPED)
@@ -391,7 +436,7 @@ double SoftwareDevice::SoftwareHandle::getPosition()
 	if(!m_status)
 		return 0.0f;
 
-	double position = m_reader->getPosition() / (double)m_device->m_specs.rate;
+	double position = (m_reader->getPosition() + m_virtual_samples) / (double)m_device->m_specs.rate;
 
 	return position;
 }
@@ -719,6 +764,7 @@ void SoftwareDevice::create()
 	m_distance_model = DISTANCE_MODEL_INVERSE_CLAMPED;
 	m_flags = 0;
 	m_quality = ResampleQuality::FASTEST;
+	m_virtualization_volume = 0.0f;
 }
 
 void SoftwareDevice::destroy()
@@ -727,82 +773,144 @@ void SoftwareDevice::destroy()
 		playing(m_playback = false);
 
 	stopAll();
+
+	m_mixing_pool.reset();
+	m_mixing_tasks.clear();
 }
 
-void SoftwareDevice::mix(data_t* buffer, int length)
+void SoftwareDevice::mixSounds(int begin, int end, Mixer& mixer, Buffer& buffer, int length)
 {
-	m_buffer.assureSize(length * AUD_SAMPLE_SIZE(m_specs));
+	buffer.assureSize(length * AUD_SAMPLE_SIZE(m_specs));
 
-	std::lock_guard<ILockable> lock(*this);
+	int len;
+	int pos;
+	bool eos;
+	sample_t* buf = buffer.getBuffer();
 
+	for(int i = begin; i < end; i++)
 	{
-		std::shared_ptr<SoftwareDevice::SoftwareHandle> sound;
-		int len;
-		int pos;
-		bool eos;
-		std::list<std::shared_ptr<SoftwareDevice::SoftwareHandle> > stopSounds;
-		std::list<std::shared_ptr<SoftwareDevice::SoftwareHandle> > pauseSounds;
-		sample_t* buf = m_buffer.getBuffer();
+		SoftwareHandle* sound = m_mixing_sounds[i].get();
 
-		m_mixer->clear(length);
+		// get the buffer from the source
+		pos = 0;
+		len = length;
+		eos = false;
+
+		// update 3D Info
+		sound->update();
+
+		// inaudible sounds only advance
+		if(sound->m_volume <= m_virtualization_volume && sound->m_old_volume <= m_virtualization_volume)
+		{
+			m_mixing_ended[i] = sound->virtualize(length);
+			continue;
+		}
 
-		// for all sounds
-		for(auto& sound : m_playingSounds)
+		try
 		{
-			// get the buffer from the source
-			pos = 0;
-			len = length;
-			eos = false;
+			sound->devirtualize();
 
-			// update 3D Info
-			sound->update();
+			sound->m_reader->read(len, eos, buf);
 
-			try
+			// in case of looping
+			while(pos + len < length && sound->m_loopcount && eos)
 			{
+				mixer.mix(buf, pos, len, sound->m_volume, sound->m_old_volume);
+
+				sound->m_old_volume = sound->m_volume;
+
+				pos += len;
+
+				if(sound->m_loopcount > 0)
+					sound->m_loopcount--;
+
+				sound->m_reader->seek(0);
+
+				len = length - pos;
 				sound->m_reader->read(len, eos, buf);
 
-				// in case of looping
-				while(pos + len < length && sound->m_loopcount && eos)
-				{
-					m_mixer->mix(buf, pos, len, sound->m_volume, sound->m_old_volume);
+				// prevent endless loop
+				if(!len)
+					break;
+			}
+		}
+		catch(Exception& e)
+		{
+			len = 0;
+			std::cerr << "Caught exception while reading sound data during playback with software mixing: " << e.getMessage() << std::endl;
+		}
 
-					sound->m_old_volume = sound->m_volume;
+		mixer.mix(buf, pos, len, sound->m_volume, sound->m_old_volume);
 
-					pos += len;
+		// in case the end of the sound is reached
+		m_mixing_ended[i] = eos && !sound->m_loopcount;
+	}
+}
 
-					if(sound->m_loopcount > 0)
-						sound->m_loopcount--;
+void SoftwareDevice::mix(data_t* buffer, int length)
+{
+	std::lock_guard<ILockable> lock(*this);
 
-					sound->m_reader->seek(0);
+	{
+		std::list<std::shared_ptr<SoftwareDevice::SoftwareHandle> > stopSounds;
+		std::list<std::shared_ptr<SoftwareDevice::SoftwareHandle> > pauseSounds;
+
+		m_mixer->clear(length);
 
-					len = length - pos;
-					sound->m_reader->read(len, eos, buf);
+		m_mixing_sounds.assign(m_playingSounds.begin(), m_playingSounds.end());
+		m_mixing_ended.assign(m_mixing_sounds.size(), false);
 
-					// prevent endless loop
-					if(!len)
-						break;
-				}
-			}
-			catch(Exception& e)
+		int count = m_mixing_sounds.size();
+		int tasks = std::min(int(m_mixing_tasks.size()) + 1, count / MIXING_SOUNDS_MIN);
+
+		if(tasks > 1)
+		{
+			// the sounds are split in ranges mixed by the threads into their own mixer
+			std::vector<std::future<void> > futures;
+			int begin = count / tasks;
+
+			for(int i = 1; i < tasks; i++)
 			{
-				len = 0;
-				std::cerr << "Caught exception while reading sound data during playback with software mixing: " << e.getMessage() << std::endl;
+				int end = count * (i + 1) / tasks;
+				MixingTask* task = m_mixing_tasks[i - 1].get();
+
+				futures.push_back(m_mixing_pool->enqueue([this, task, begin, end, length]()
+				{
+					task->mixer->clear(length);
+					mixSounds(begin, end, *task->mixer, task->buffer, length);
+				}));
+
+				begin = end;
 			}
 
-			m_mixer->mix(buf, pos, len, sound->m_volume, sound->m_old_volume);
+			mixSounds(0, count / tasks, *m_mixer, m_buffer, length);
 
-			// in case the end of the sound is reached
-			if(eos && !sound->m_loopcount)
+			for(int i = 1; i < tasks; i++)
 			{
-				if(sound->m_stop)
-					sound->m_stop(sound->m_stop_data);
-
-				if(sound->m_keep)
-					pauseSounds.push_back(sound);
-				else
-					stopSounds.push_back(sound);
+				futures[i - 1].get();
+				m_mixer->add(*m_mixing_tasks[i - 1]->mixer);
 			}
 		}
+		else
+			mixSounds(0, count, *m_mixer, m_buffer, length);
+
+		for(int i = 0; i < count; i++)
+		{
+			if(!m_mixing_ended[i])
+				continue;
+
+			std::shared_ptr<SoftwareDevice::SoftwareHandle>& sound = m_mixing_sounds[i];
+
+			if(sound->m_stop)
+				sound->m_stop(sound->m_stop_data);
+
+			if(sound->m_keep)
+				pauseSounds.push_back(sound);
+			else
+				stopSounds.push_back(sound);
+		}
+
+		m_mixing_sounds.clear();
 
 		// superpose
 		m_mixer->read(buffer, m_volume);
@@ -830,11 +938,51 @@ void SoftwareDevice::setQuality(ResampleQuality quality)
 	m_quality = quality;
 }
 
+void SoftwareDevice::setMixingThreads(unsigned int count)
+{
+	std::lock_guard<ILockable> lock(*this);
+
+	m_mixing_pool.reset();
+	m_mixing_tasks.clear();
+
+	if(count <= 1)
+		return;
+
+	m_mixing_pool = std::make_shared<ThreadPool>(count - 1);
+
+	for(unsigned int i = 1; i < count; i++)
+	{
+		std::shared_ptr<MixingTask> task = std::make_shared<MixingTask>();
+		task->mixer = std::shared_ptr<Mixer>(new Mixer(m_specs));
+		m_mixing_tasks.push_back(task);
+	}
+}
+
+unsigned int SoftwareDevice::getMixingThreads() const
+{
+	return m_mixing_tasks.size() + 1;
+}
+
+void SoftwareDevice::setVirtualizationVolume(float volume)
+{
+	std::lock_guard<ILockable> lock(*this);
+
+	m_virtualization_volume = volume;
+}
+
+float SoftwareDevice::getVirtualizationVolume() const
+{
+	return m_virtualization_volume;
+}
+
 void SoftwareDevice::setSpecs(Specs specs)
 {
 	m_specs.specs = specs;
 	m_mixer->setSpecs(specs);
 
+	for(auto& task : m_mixing_tasks)
+		task->mixer->setSpecs(specs);
+
 	for(auto& sound : m_playingSounds)
 	{
 		sound->setSpecs(specs);
@@ -851,6 +999,9 @@ void SoftwareDevice::setSpecs(DeviceSpecs specs)
 	m_specs = specs;
 	m_mixer->setSpecs(specs);
 
+	for(auto& task : m_mixing_tasks)
+		task->mixer->setSpecs(specs);
+
 	for(auto& sound : m_playingSounds)
 	{
 		sound->setSpecs(specs.specs);
@@ -19,6 +19,11 @@
 #include <cmath>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define AUD_RESAMPLE_SSE
+#endif
+
 AUD_NAMESPACE_BEGIN
 
 LinearResampleReader::LinearResampleReader(std::shared_ptr<IReader> reader, SampleRate rate) :
@@ -144,9 +149,39 @@ void LinearResampleReader::read(int& length, bool& eos, sample_t* buffer)
 	if(length == 0)
 		return;
 
+	int start = 0;
+
+#ifdef AUD_RESAMPLE_SSE
+	// mono sources, as used for 3D sounds, interpolate four samples at once
+	if(m_channels == CHANNELS_MONO)
+	{
+		const __m128 vfactor = _mm_set1_ps(factor);
+		const __m128 vcache_pos = _mm_set1_ps(m_cache_pos);
+		const __m128 voffset = _mm_set_ps(4.0f, 3.0f, 2.0f, 1.0f);
+		alignas(16) int index[4];
+		alignas(16) float rest[4];
+
+		for(; start + 4 <= length; start += 4)
+		{
+			// the positions are always positive, truncation is the floor
+			__m128 vpos = _mm_add_ps(_mm_div_ps(_mm_add_ps(_mm_set1_ps(float(start)), voffset), vfactor), vcache_pos);
+			__m128i vindex = _mm_cvttps_epi32(vpos);
+			__m128 vrest = _mm_sub_ps(vpos, _mm_cvtepi32_ps(vindex));
+
+			_mm_store_si128(reinterpret_cast<__m128i*>(index), vindex);
+			_mm_store_ps(rest, vrest);
+
+			__m128 vlow = _mm_set_ps(buf[index[3]], buf[index[2]], buf[index[1]], buf[index[0]]);
+			__m128 vhigh = _mm_set_ps(buf[index[3] + (rest[3] > 0)], buf[index[2] + (rest[2] > 0)], buf[index[1] + (rest[1] > 0)], buf[index[0] + (rest[0] > 0)]);
+
+			_mm_storeu_ps(buffer + start, _mm_add_ps(vlow, _mm_mul_ps(vrest, _mm_sub_ps(vhigh, vlow))));
+		}
+	}
+#endif
+
 	for(int channel = 0; channel < m_channels; channel++)
 	{
-		for(int i = 0; i < length; i++)
+		for(int i = start; i < length; i++)
 		{
 			spos = (i + 1) / factor + m_cache_pos;
 
@@ -157,6 +192,8 @@ void LinearResampleReader::read(int& length, bool& eos, sample_t* buffer)
 		}
 	}
 
+	spos = length / factor + m_cache_pos;
+
 	if(std::floor(spos) == spos)
 	{
 		std::memcpy(m_cache.getBuffer() + m_channels, buf + int(std::floor(spos)) * m_channels, samplesize);
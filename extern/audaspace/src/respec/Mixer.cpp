@@ -19,6 +19,11 @@
 #include <algorithm>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define AUD_MIXER_SSE
+#endif
+
 AUD_NAMESPACE_BEGIN
 
 Mixer::Mixer(DeviceSpecs specs)
@@ -81,38 +86,114 @@ void Mixer::clear(int length)
 
 void Mixer::mix(sample_t* buffer, int start, int length, float volume)
 {
-	sample_t* out = m_buffer.getBuffer();
+	sample_t* out = m_buffer.getBuffer() + start * m_specs.channels;
 
 	length = (std::min(m_length, length + start) - start) * m_specs.channels;
-	start *= m_specs.channels;
 
-	for(int i = 0; i < length; i++)
-		out[i + start] += buffer[i] * volume;
+	int i = 0;
+
+#ifdef AUD_MIXER_SSE
+	const __m128 vvolume = _mm_set1_ps(volume);
+
+	for(; i + 4 <= length; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(buffer + i), vvolume)));
+#endif
+
+	for(; i < length; i++)
+		out[i] += buffer[i] * volume;
 }
 
 void Mixer::mix(sample_t* buffer, int start, int length, float volume_to, float volume_from)
 {
-	sample_t* out = m_buffer.getBuffer();
+	if(volume_to == volume_from)
+	{
+		mix(buffer, start, length, volume_to);
+		return;
+	}
+
+	sample_t* out = m_buffer.getBuffer() + start * m_specs.channels;
+	const int channels = m_specs.channels;
 
 	length = (std::min(m_length, length + start) - start);
 
-	for(int i = 0; i < length; i++)
+	int i = 0;
+
+#ifdef AUD_MIXER_SSE
+	// the volume ramp is computed for several frames at once for the common channel counts
+	const __m128 vlength = _mm_set1_ps(float(length));
+	const __m128 vone = _mm_set1_ps(1.0f);
+	const __m128 vfrom = _mm_set1_ps(volume_from);
+	const __m128 vto = _mm_set1_ps(volume_to);
+
+	if(channels == CHANNELS_MONO)
+	{
+		for(; i + 4 <= length; i += 4)
+		{
+			__m128 t = _mm_div_ps(_mm_add_ps(_mm_set1_ps(float(i)), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)), vlength);
+			__m128 volume = _mm_add_ps(_mm_mul_ps(vfrom, _mm_sub_ps(vone, t)), _mm_mul_ps(vto, t));
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(buffer + i), volume)));
+		}
+	}
+	else if(channels == CHANNELS_STEREO)
+	{
+		for(; i + 2 <= length; i += 2)
+		{
+			__m128 t = _mm_div_ps(_mm_add_ps(_mm_set1_ps(float(i)), _mm_set_ps(1.0f, 1.0f, 0.0f, 0.0f)), vlength);
+			__m128 volume = _mm_add_ps(_mm_mul_ps(vfrom, _mm_sub_ps(vone, t)), _mm_mul_ps(vto, t));
+			_mm_storeu_ps(out + i * 2, _mm_add_ps(_mm_loadu_ps(out + i * 2), _mm_mul_ps(_mm_loadu_ps(buffer + i * 2), volume)));
+		}
+	}
+#endif
+
+	for(; i < length; i++)
 	{
 		float volume = volume_from * (1.0f - i / float(length)) + volume_to * (i / float(length));
 
-		for(int c = 0; c < m_specs.channels; c++)
-			out[(i + start) * m_specs.channels + c] += buffer[i * m_specs.channels + c] * volume;
+		for(int c = 0; c < channels; c++)
+			out[i * channels + c] += buffer[i * channels + c] * volume;
 	}
 }
 
+void Mixer::add(const Mixer& mixer)
+{
+	sample_t* out = m_buffer.getBuffer();
+	const sample_t* in = mixer.m_buffer.getBuffer();
+
+	const int length = std::min(m_length, mixer.m_length) * m_specs.channels;
+
+	int i = 0;
+
+#ifdef AUD_MIXER_SSE
+	for(; i + 4 <= length; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(in + i)));
+#endif
+
+	for(; i < length; i++)
+		out[i] += in[i];
+}
+
 void Mixer::read(data_t* buffer, float volume)
 {
 	sample_t* out = m_buffer.getBuffer();
 
-	for(int i = 0; i < m_length * m_specs.channels; i++)
-		out[i] *= volume;
+	const int length = m_length * m_specs.channels;
+
+	if(volume != 1.0f)
+	{
+		int i = 0;
+
+#ifdef AUD_MIXER_SSE
+		const __m128 vvolume = _mm_set1_ps(volume);
+
+		for(; i + 4 <= length; i += 4)
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(out + i), vvolume));
+#endif
+
+		for(; i < length; i++)
+			out[i] *= volume;
+	}
 
-	m_convert(buffer, (data_t*) out, m_length * m_specs.channels);
+	m_convert(buffer, (data_t*) out, length);
 }
 
 AUD_NAMESPACE_END
@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 #include "DNA_ID.h"
 
 /* Dependency Graph */
@@ -38,6 +40,7 @@ struct Depsgraph;
 /* ------------------------------------------------ */
 
 struct Main;
+struct Object;
 struct Scene;
 struct ViewLayer;
 
@@ -200,6 +203,24 @@ void DEG_evaluate_on_refresh(
     Depsgraph *graph,
     DepsgraphEvaluateSyncWriteback sync_writeback = DEG_EVALUATE_SYNC_WRITEBACK_NO);
 
+/**
+ * Check whether the evaluated transform of the object is only used by the object itself, so its
+ * world matrix can be written directly without scheduling the evaluation of other nodes.
+ * The result only changes when the relations are rebuilt, see #DEG_get_relations_update_count.
+ */
+bool DEG_object_transform_is_isolated(const Depsgraph *graph, const Object *object);
+
+/**
+ * Transform-only update entry point used by the game engine.
+ * Copy the world matrix of the original objects to their evaluated copies and update the derived
+ * data (inverse matrix, negative scale flag, transform update count) as the transform evaluation
+ * would do, without tagging nor evaluating the graph. The draw data of the objects are tagged
+ * for a transform update, so the draw engines refresh them like after a regular evaluation.
+ *
+ * \note The objects must be isolated, see #DEG_object_transform_is_isolated.
+ */
+void DEG_evaluate_transforms(Depsgraph *graph, blender::Span<Object *> objects);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -236,6 +257,9 @@ void DEG_make_inactive(Depsgraph *depsgraph);
 
 /* Returns the number of times the graph has been evaluated. */
 uint64_t DEG_get_update_count(const Depsgraph *depsgraph);
+/* Returns the number of times the relations of the graph have been tagged for update or rebuilt,
+ * results derived from the relations stay valid while it is unchanged. */
+uint64_t DEG_get_relations_update_count(const Depsgraph *depsgraph);
 
 /**
  * Disable the visibility optimization making it so IDs which affect hidden objects or disabled
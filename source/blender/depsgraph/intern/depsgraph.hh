@@ -176,6 +176,9 @@ struct Depsgraph {
   /* The number of times this graph has been evaluated. */
   uint64_t update_count;
 
+  /* The number of times the relations of this graph have been tagged for update or rebuilt. */
+  uint64_t relations_update_count;
+
   /**
    * Stores functions that can be called after depsgraph evaluation to writeback some changes to
    * original data. Also see `DEG_depsgraph_writeback_sync.hh`.
@@ -11,13 +11,19 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_matrix.h"
+#include "BLI_set.hh"
 #include "BLI_utildefines.h"
 
+#include "BKE_object.hh"
+#include "BKE_object_types.hh"
 #include "BKE_scene.hh"
 
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "DRW_engine.hh"
+
 #include "DEG_depsgraph.hh"
 #include "DEG_depsgraph_query.hh"
 #include "DEG_depsgraph_writeback_sync.hh"
@@ -26,10 +32,13 @@
 #include "intern/eval/deg_eval_flush.h"
 
 #include "intern/node/deg_node.hh"
+#include "intern/node/deg_node_component.hh"
+#include "intern/node/deg_node_id.hh"
 #include "intern/node/deg_node_operation.hh"
 #include "intern/node/deg_node_time.hh"
 
 #include "intern/depsgraph.hh"
+#include "intern/depsgraph_relation.hh"
 #include "intern/depsgraph_tag.hh"
 
 namespace deg = blender::deg;
@@ -92,3 +101,76 @@ void DEG_evaluate_on_framechange(Depsgraph *graph,
   deg_graph->ctime = BKE_scene_frame_to_ctime(scene, frame);
   deg_flush_updates_and_refresh(deg_graph, sync_writeback);
 }
+
+bool DEG_object_transform_is_isolated(const Depsgraph *graph, const Object *object)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  if (deg_graph->need_update_relations) {
+    return false;
+  }
+  const deg::IDNode *id_node = deg_graph->find_id_node(&object->id);
+  if (id_node == nullptr) {
+    return false;
+  }
+  const deg::ComponentNode *transform_comp = id_node->find_component(deg::NodeType::TRANSFORM);
+  if (transform_comp == nullptr) {
+    return false;
+  }
+
+  /* Walk all the operations depending on the transform, they must belong to the same object and
+   * either be part of the transform evaluation or do nothing (instancing, dimensions...). */
+  blender::Vector<const deg::OperationNode *> stack(transform_comp->operations.begin(),
+                                                    transform_comp->operations.end());
+  blender::Set<const deg::OperationNode *> visited(stack);
+  while (!stack.is_empty()) {
+    const deg::OperationNode *op_node = stack.pop_last();
+    for (const deg::Relation *rel : op_node->outlinks) {
+      if (rel->to->get_class() != deg::NodeClass::OPERATION) {
+        return false;
+      }
+      const deg::OperationNode *to_node = static_cast<const deg::OperationNode *>(rel->to);
+      const deg::ComponentNode *to_comp = to_node->owner;
+      if (to_comp->owner != id_node) {
+        return false;
+      }
+      if (!ELEM(to_comp->type, deg::NodeType::TRANSFORM, deg::NodeType::SYNCHRONIZATION) &&
+          !to_node->is_noop())
+      {
+        return false;
+      }
+      if (visited.add(to_node)) {
+        stack.append(to_node);
+      }
+    }
+  }
+  return true;
+}
+
+void DEG_evaluate_transforms(Depsgraph *graph, blender::Span<Object *> objects)
+{
+  if (objects.is_empty()) {
+    return;
+  }
+
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  /* Count as an update so the draw engines detect the transform change of the objects. */
+  deg_graph->update_count++;
+
+  for (Object *object : objects) {
+    Object *object_eval = DEG_get_evaluated_object(graph, object);
+    if (object_eval == object) {
+      continue;
+    }
+    copy_m4_m4(object_eval->runtime->object_to_world.ptr(), object->object_to_world().ptr());
+    BKE_object_eval_transform_final(graph, object_eval);
+
+    /* Tag the engine data as the update flush does, engines like EEVEE rely on it to refresh
+     * the lights and the shadows casted by the object. */
+    DrawDataList *draw_data_list = DRW_drawdatalist_from_id(&object_eval->id);
+    if (draw_data_list != nullptr) {
+      LISTBASE_FOREACH (DrawData *, draw_data, draw_data_list) {
+        draw_data->recalc |= ID_RECALC_TRANSFORM;
+      }
+    }
+  }
+}
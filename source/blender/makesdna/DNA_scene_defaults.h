@@ -219,6 +219,7 @@
     .cfm = 0.0f, \
     .obstacleSimulation = OBSTSIMULATION_NONE, \
     .levelHeight = 2.0f, \
+    .batchCellSize = 32.0f, \
     .exitkey = 218, \
     .flag = GAME_USE_UNDO, \
     .lodflag = SCE_LOD_USE_HYST, \
@@ -925,10 +925,8 @@ typedef struct GameData {
   /* physics (it was in world)*/
   float gravity; /*Gravitation constant for the game world*/
 
-  /*
-   * Radius of the activity bubble, in Manhattan length. Objects
-   * outside the box are activity-culled. */
-  float _pad11;
+  /* Size of the grid cells grouping the static batched objects, 0 for a single cell. */
+  float batchCellSize;
 
   /*
    * bit 3: (gameengine): Activity culling is enabled.
@@ -1017,6 +1015,7 @@ enum {
 #define GAME_PYTHON_CONSOLE (1 << 22)
 #define GAME_USE_INTERACTIVE_DYNAPAINT (1 << 23)
 #define GAME_USE_INTERACTIVE_RIGIDBODY (1 << 24)
+#define GAME_USE_STATIC_BATCHING (1 << 25)
 /* Note: GameData.flag is now an int (max 32 flags). A short could only take 16 flags */
 
 /* GameData.playerflag */
@@ -6595,6 +6595,24 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Use Interactive Rigidbody Sim", "Blender Rigidbody sim at bge runtime (experimental)");
 
+  /* static batching */
+  prop = RNA_def_property(srna, "use_static_batching", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_USE_STATIC_BATCHING);
+  RNA_def_property_ui_text(
+      prop,
+      "Static Batching",
+      "Merge the static meshes without logic sharing the same materials into one object per "
+      "grid cell at game start");
+
+  prop = RNA_def_property(srna, "static_batching_cell_size", PROP_FLOAT, PROP_DISTANCE);
+  RNA_def_property_float_sdna(prop, NULL, "batchCellSize");
+  RNA_def_property_range(prop, 0.0f, FLT_MAX);
+  RNA_def_property_ui_range(prop, 0.0f, 1000.0f, 10, 1);
+  RNA_def_property_ui_text(prop,
+                           "Cell Size",
+                           "Size of the grid cells grouping the batched objects, 0 to merge the "
+                           "objects of the whole scene");
+
   /* obstacle simulation */
   prop = RNA_def_property(srna, "obstacle_simulation", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_sdna(prop, NULL, "obstacleSimulation");
@@ -47,6 +47,7 @@
 
 static Main *bpy_import_main = nullptr;
 static ListBase bpy_import_main_list;
+static bpy_text_compile_fn bpy_text_compile_func = nullptr;
 
 /* 'builtins' is most likely PyEval_GetBuiltins() */
 
@@ -88,6 +89,11 @@ void bpy_import_main_set(struct Main *maggie)
   bpy_import_main = maggie;
 }
 
+void bpy_text_compile_func_set(bpy_text_compile_fn func)
+{
+  bpy_text_compile_func = func;
+}
+
 void bpy_import_main_extra_add(struct Main *maggie)
 {
   BLI_addhead(&bpy_import_main_list, maggie);
@@ -120,7 +126,12 @@ bool bpy_text_compile(Text *text)
 
   size_t buf_len_dummy;
   buf = txt_to_buf(text, &buf_len_dummy);
-  text->compiled = Py_CompileStringObject(buf, fn_dummy_py, Py_file_input, nullptr, -1);
+  if (bpy_text_compile_func) {
+    text->compiled = bpy_text_compile_func(buf, fn_dummy);
+  }
+  else {
+    text->compiled = Py_CompileStringObject(buf, fn_dummy_py, Py_file_input, nullptr, -1);
+  }
   MEM_freeN(buf);
 
   Py_DECREF(fn_dummy_py);
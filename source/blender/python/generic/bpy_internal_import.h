@@ -48,6 +48,10 @@ PyObject *bpy_text_reimport(PyObject *module, int *found);
 
 void bpy_text_filename_get(char *fn, size_t fn_len, struct Text *text);
 
+/* The game engine compiles the text blocks through its bytecode cache, nullptr to reset. */
+typedef PyObject *(*bpy_text_compile_fn)(const char *buf, const char *filepath);
+void bpy_text_compile_func_set(bpy_text_compile_fn func);
+
 /* The game engine has its own Main struct, if this is set search this rather than G.main */
 struct Main *bpy_import_main_get(void);
 void bpy_import_main_set(struct Main *maggie);
@@ -0,0 +1,111 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file gameengine/Common/CM_Memory.cpp
+ *  \ingroup common
+ */
+
+#include "CM_Memory.h"
+
+#include <atomic>
+
+#include "MEM_guardedalloc.h"
+
+namespace {
+
+struct Counters {
+  std::atomic<size_t> current;
+  std::atomic<size_t> peak;
+  std::atomic<unsigned int> allocs;
+  std::atomic<unsigned int> frees;
+  /// Counts of the last complete frame.
+  std::atomic<unsigned int> frameAllocs;
+  std::atomic<unsigned int> frameFrees;
+};
+
+Counters counters[CM_MEMORY_NUM_CATEGORIES];
+
+const char *categoryNames[CM_MEMORY_NUM_CATEGORIES] = {
+    "Converter", "Rasterizer", "Physics", "Expressions", "Ketsji", "VideoTexture"};
+
+}  // namespace
+
+void CM_MemoryAlloc(CM_MemoryCategory category, size_t size)
+{
+  Counters &counter = counters[category];
+  const size_t current = counter.current.fetch_add(size, std::memory_order_relaxed) + size;
+  counter.allocs.fetch_add(1, std::memory_order_relaxed);
+
+  size_t peak = counter.peak.load(std::memory_order_relaxed);
+  while (current > peak &&
+         !counter.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+  }
+}
+
+void CM_MemoryFree(CM_MemoryCategory category, size_t size)
+{
+  Counters &counter = counters[category];
+  counter.current.fetch_sub(size, std::memory_order_relaxed);
+  counter.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void *CM_MemoryClassAlloc(CM_MemoryCategory category,
+                          size_t size,
+                          size_t alignment,
+                          const char *id)
+{
+  CM_MemoryAlloc(category, size);
+  return MEM_mallocN_aligned(size, alignment, id);
+}
+
+void CM_MemoryClassFree(CM_MemoryCategory category, void *ptr, size_t size)
+{
+  CM_MemoryFree(category, size);
+  MEM_freeN(ptr);
+}
+
+void CM_MemoryNextFrame()
+{
+  for (Counters &counter : counters) {
+    counter.frameAllocs.store(counter.allocs.exchange(0, std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+    counter.frameFrees.store(counter.frees.exchange(0, std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+  }
+}
+
+CM_MemoryStatistics CM_MemoryGetStatistics(CM_MemoryCategory category)
+{
+  const Counters &counter = counters[category];
+  CM_MemoryStatistics statistics;
+  statistics.current = counter.current.load(std::memory_order_relaxed);
+  statistics.peak = counter.peak.load(std::memory_order_relaxed);
+  statistics.frameAllocs = counter.frameAllocs.load(std::memory_order_relaxed);
+  statistics.frameFrees = counter.frameFrees.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+const char *CM_MemoryGetCategoryName(CM_MemoryCategory category)
+{
+  return categoryNames[category];
+}
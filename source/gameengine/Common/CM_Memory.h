@@ -0,0 +1,104 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file CM_Memory.h
+ *  \ingroup common
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/// Game engine module an allocation is accounted to.
+enum CM_MemoryCategory {
+  CM_MEMORY_CONVERTER = 0,
+  CM_MEMORY_RASTERIZER,
+  CM_MEMORY_PHYSICS,
+  CM_MEMORY_EXPRESSIONS,
+  CM_MEMORY_KETSJI,
+  CM_MEMORY_VIDEOTEXTURE,
+  CM_MEMORY_NUM_CATEGORIES
+};
+
+struct CM_MemoryStatistics {
+  /// Bytes currently allocated.
+  size_t current;
+  /// Maximum of the allocated bytes since the engine start.
+  size_t peak;
+  /// Number of allocations and frees during the last frame.
+  unsigned int frameAllocs;
+  unsigned int frameFrees;
+};
+
+/// Account an allocation of size bytes.
+void CM_MemoryAlloc(CM_MemoryCategory category, size_t size);
+/// Account a free of an allocation of size bytes.
+void CM_MemoryFree(CM_MemoryCategory category, size_t size);
+
+/// Allocate memory accounted to a category, used by CM_MEMORY_CLASS_ALLOC_FUNCS.
+void *CM_MemoryClassAlloc(CM_MemoryCategory category,
+                          size_t size,
+                          size_t alignment,
+                          const char *id);
+void CM_MemoryClassFree(CM_MemoryCategory category, void *ptr, size_t size);
+
+/// Store the allocation counts of the frame and start counting for a new frame.
+void CM_MemoryNextFrame();
+/// Statistics of a category, the allocation counts are those of the last frame.
+CM_MemoryStatistics CM_MemoryGetStatistics(CM_MemoryCategory category);
+const char *CM_MemoryGetCategoryName(CM_MemoryCategory category);
+
+/** Class allocation operators accounting the instances to a category.
+ * The size received by the sized delete is the size of the dynamic type for classes with
+ * a virtual destructor, derived classes can use the macro again to change the category.
+ */
+#define CM_MEMORY_CLASS_ALLOC_FUNCS(category, _id) \
+ public: \
+  void *operator new(size_t num_bytes) \
+  { \
+    return CM_MemoryClassAlloc(category, num_bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, _id); \
+  } \
+  void *operator new(size_t num_bytes, std::align_val_t alignment) \
+  { \
+    return CM_MemoryClassAlloc(category, num_bytes, size_t(alignment), _id); \
+  } \
+  void operator delete(void *mem, size_t num_bytes) \
+  { \
+    if (mem) { \
+      CM_MemoryClassFree(category, mem, num_bytes); \
+    } \
+  } \
+  void operator delete(void *mem, size_t num_bytes, std::align_val_t /*alignment*/) \
+  { \
+    if (mem) { \
+      CM_MemoryClassFree(category, mem, num_bytes); \
+    } \
+  } \
+  void *operator new(size_t /*num_bytes*/, void *ptr) \
+  { \
+    return ptr; \
+  } \
+  void operator delete(void * /*mem*/, void * /*ptr*/) \
+  { \
+  }
@@ -0,0 +1,69 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file CM_Serialize.h
+ *  \ingroup common
+ *  \brief Helpers writing and reading plain values in binary buffers.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+template<class T> inline void CM_WriteData(std::string &buffer, T value)
+{
+  buffer.append((const char *)&value, sizeof(T));
+}
+
+/// Write a string prefixed by its size, the size must fit in an unsigned short.
+inline void CM_WriteString(std::string &buffer, const std::string &str)
+{
+  CM_WriteData<unsigned short>(buffer, str.size());
+  buffer.append(str);
+}
+
+/** Read a value and advance the data pointer.
+ * \return False if the value exceeds the end of the buffer.
+ */
+template<class T> inline bool CM_ReadData(const char *&data, const char *end, T &value)
+{
+  if (data + sizeof(T) > end) {
+    return false;
+  }
+  memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return true;
+}
+
+/// Read a string written by CM_WriteString.
+inline bool CM_ReadString(const char *&data, const char *end, std::string &str)
+{
+  unsigned short size;
+  if (!CM_ReadData(data, end, size) || data + size > end) {
+    return false;
+  }
+  str.assign(data, size);
+  data += size;
+  return true;
+}
@@ -26,6 +26,13 @@
 
 #include "CM_Utils.h"
 
+#include <atomic>
+#include <cstdlib>
+
+#include "BLI_system.h"
+
+#include BLI_SYSTEM_PID_H
+
 /* Remove the 3 first chars as the object
  * has a prefix now after commit d6cefef98
  */
@@ -47,3 +54,9 @@ std::string CM_RemovePrefix(const std::string &propname)
   }
   return temporal;
 }
+
+std::string CM_UniqueTemporaryPath(const std::string &path)
+{
+  static std::atomic<unsigned int> counter(0);
+  return path + "." + std::to_string(abs(getpid())) + "." + std::to_string(counter++) + ".tmp";
+}
@@ -29,3 +29,8 @@
 #include <string>
 
 std::string CM_RemovePrefix(const std::string &propname);
+
+/** Return a temporary file path next to path, unique between threads and processes, used to
+ * write a file before renaming it over path.
+ */
+std::string CM_UniqueTemporaryPath(const std::string &path);
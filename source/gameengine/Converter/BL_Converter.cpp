@@ -35,6 +35,8 @@
 
 #include "BL_Converter.h"
 
+#include <limits>
+
 #include "BKE_context.hh"
 #include "BKE_idtype.hh"
 #include "BKE_lib_id.hh"
@@ -43,10 +45,13 @@
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_time.h"
 #include "BLO_readfile.hh"
 #include "DNA_material_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_scene_types.h"
+#include "MEM_guardedalloc.h"
 
 #include "BL_DataConversion.h"
 #include "BL_SceneConverter.h"
@@ -100,8 +105,15 @@ void BL_Converter::SceneSlot::Merge(const BL_SceneConverter *converter)
   }
 }
 
+BL_Converter::LibrarySlot::LibrarySlot() : m_freeing(false)
+{
+}
+
 BL_Converter::BL_Converter(Main *maggie, KX_KetsjiEngine *engine)
-    : m_maggie(maggie), m_ketsjiEngine(engine), m_alwaysUseExpandFraming(false)
+    : m_mergeTimeBudget(0.0),
+      m_maggie(maggie),
+      m_ketsjiEngine(engine),
+      m_alwaysUseExpandFraming(false)
 {
   BKE_main_id_tag_all(maggie, LIB_TAG_DOIT, false);  // avoid re-tagging later on
   m_threadinfo.m_pool = BLI_task_pool_create(nullptr, TASK_PRIORITY_LOW);
@@ -113,6 +125,7 @@ BL_Converter::~BL_Converter()
   while (m_DynamicMaggie.size() != 0) {
     FreeBlendFile(m_DynamicMaggie[0]);
   }
+  UpdateFreeingLibraries(std::numeric_limits<unsigned int>::max());
 
   m_DynamicMaggie.clear();
 
@@ -246,6 +259,10 @@ void BL_Converter::RemoveScene(KX_Scene *scene)
   scene->Release();
 
   m_sceneSlots.erase(scene);
+
+  for (std::pair<Main *const, LibrarySlot> &pair : m_librarySlots) {
+    pair.second.m_scenes.erase(scene);
+  }
 }
 
 void BL_Converter::SetAlwaysUseExpandFraming(bool to_what)
@@ -260,6 +277,14 @@ void BL_Converter::RegisterInterpolatorList(KX_Scene *scene,
   SceneSlot &sceneSlot = m_sceneSlots[scene];
   sceneSlot.m_interpolators.emplace_back(interpolator);
   sceneSlot.m_actionToInterp[for_act] = interpolator;
+
+  // Interpolators of library actions are freed with the library.
+  if (!m_idToLibrary.empty() && BLI_thread_is_main()) {
+    std::map<ID *, Main *>::const_iterator it = m_idToLibrary.find((ID *)for_act);
+    if (it != m_idToLibrary.end()) {
+      m_librarySlots[it->second].m_scenes[scene].m_interpolators.insert(interpolator);
+    }
+  }
 }
 
 BL_InterpolatorList *BL_Converter::FindInterpolatorList(KX_Scene *scene, bAction *for_act)
@@ -292,32 +317,75 @@ Main *BL_Converter::GetMainDynamicPath(const std::string &path) const
   return nullptr;
 }
 
-void BL_Converter::MergeAsyncLoads()
+KX_LibLoadStatus *BL_Converter::GetLibLoadStatus(const std::string &path) const
 {
-  std::vector<KX_Scene *> *merge_scenes;
+  Main *maggie = GetMainDynamicPath(path);
+  if (!maggie) {
+    return nullptr;
+  }
+
+  std::map<std::string, KX_LibLoadStatus *>::const_iterator it = m_status_map.find(
+      maggie->filepath);
+  return (it != m_status_map.end()) ? it->second : nullptr;
+}
 
-  std::vector<KX_LibLoadStatus *>::iterator mit;
-  std::vector<KX_Scene *>::iterator sit;
+void BL_Converter::MergeAsyncLoads()
+{
+  MergeScenes(m_mergeTimeBudget);
+}
 
+void BL_Converter::MergeScenes(double budget)
+{
   m_threadinfo.m_mutex.Lock();
+  m_mergingStatus.insert(m_mergingStatus.end(), m_mergequeue.begin(), m_mergequeue.end());
+  m_mergequeue.clear();
+  m_threadinfo.m_mutex.Unlock();
+
+  const double starttime = BLI_time_now_seconds();
+  bool merged = false;
+
+  while (!m_mergingStatus.empty()) {
+    KX_LibLoadStatus *status = m_mergingStatus.front();
+    std::vector<KX_Scene *> *merge_scenes = (std::vector<KX_Scene *> *)status->GetData();
 
-  for (mit = m_mergequeue.begin(); mit != m_mergequeue.end(); ++mit) {
-    merge_scenes = (std::vector<KX_Scene *> *)(*mit)->GetData();
+    if (!merge_scenes->empty()) {
+      // Merge at least one scene per frame to always progress.
+      if (merged && budget > 0.0 && (BLI_time_now_seconds() - starttime) >= budget) {
+        return;
+      }
+
+      KX_Scene *scene = merge_scenes->front();
+      merge_scenes->erase(merge_scenes->begin());
+
+      const double mergestart = BLI_time_now_seconds();
+      const size_t memstart = MEM_get_memory_in_use();
 
-    for (sit = merge_scenes->begin(); sit != merge_scenes->end(); ++sit) {
-      (*mit)->GetMergeScene()->MergeScene(*sit);
-      delete (*sit);
+      status->GetMergeScene()->MergeScene(scene);
+      delete scene;
+
+      status->AddMergeTime(BLI_time_now_seconds() - mergestart);
+      status->AddMemoryUsage((long long)MEM_get_memory_in_use() - (long long)memstart);
+      status->AddProgress((1.0f - status->GetProgress()) / (merge_scenes->size() + 1));
+      merged = true;
+      continue;
     }
 
     delete merge_scenes;
-    (*mit)->SetData(nullptr);
+    status->SetData(nullptr);
+    m_mergingStatus.erase(m_mergingStatus.begin());
 
-    (*mit)->Finish();
+    status->Finish();
   }
+}
 
-  m_mergequeue.clear();
+void BL_Converter::SetMergeTimeBudget(double budget)
+{
+  m_mergeTimeBudget = budget;
+}
 
-  m_threadinfo.m_mutex.Unlock();
+double BL_Converter::GetMergeTimeBudget() const
+{
+  return m_mergeTimeBudget;
 }
 
 void BL_Converter::FinalizeAsyncLoads()
@@ -325,7 +393,7 @@ void BL_Converter::FinalizeAsyncLoads()
   // Finish all loading libraries.
   BLI_task_pool_work_and_wait(m_threadinfo.m_pool);
   // Merge all libraries data in the current scene, to avoid memory leak of unmerged scenes.
-  MergeAsyncLoads();
+  MergeScenes(0.0);
 }
 
 void BL_Converter::AddScenesToMergeQueue(KX_LibLoadStatus *status)
@@ -341,7 +409,10 @@ static void async_convert(TaskPool *pool, void *ptr, int /*threadid*/)
   KX_LibLoadStatus *status = (KX_LibLoadStatus *)ptr;
   std::vector<Scene *> *scenes = (std::vector<Scene *> *)status->GetData();
   std::vector<KX_Scene *> *merge_scenes =
-      new std::vector<KX_Scene *>();  // Deleted in MergeAsyncLoads
+      new std::vector<KX_Scene *>();  // Deleted in MergeScenes
+
+  // Approximate, the allocations of the other threads are counted too.
+  const size_t memstart = MEM_get_memory_in_use();
 
   for (unsigned int i = 0; i < scenes->size(); ++i) {
     new_scene = status->GetEngine()->CreateScene((*scenes)[i], true);
@@ -355,6 +426,7 @@ static void async_convert(TaskPool *pool, void *ptr, int /*threadid*/)
   }
 
   delete scenes;
+  status->AddMemoryUsage((long long)MEM_get_memory_in_use() - (long long)memstart);
   status->SetData(merge_scenes);
 
   status->GetConverter()->AddScenesToMergeQueue(status);
@@ -436,6 +508,8 @@ KX_LibLoadStatus *BL_Converter::LinkBlendFile(BlendHandle *bpy_openlib,
     return nullptr;
   }
 
+  const size_t memstart = MEM_get_memory_in_use();
+
   main_newlib = BKE_main_new();
   BKE_reports_init(&reports, RPT_STORE);
 
@@ -488,6 +562,7 @@ KX_LibLoadStatus *BL_Converter::LinkBlendFile(BlendHandle *bpy_openlib,
                   // materials/shaders
       scene_merge->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
     }
+    RegisterLibraryData(main_newlib, scene_merge, sceneConverter);
     m_sceneSlots[scene_merge].Merge(sceneConverter);
     scene_merge->SetBlenderSceneConverter(sceneConverter);
   }
@@ -499,7 +574,7 @@ KX_LibLoadStatus *BL_Converter::LinkBlendFile(BlendHandle *bpy_openlib,
       if (options & LIB_LOAD_VERBOSE) {
         CM_Debug("action name: " << action->name + 2);
       }
-      scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
+      RegisterLibraryAction(main_newlib, scene_merge, action);
     }
   }
   else if (idcode == ID_SCE) {
@@ -549,11 +624,14 @@ KX_LibLoadStatus *BL_Converter::LinkBlendFile(BlendHandle *bpy_openlib,
         if (options & LIB_LOAD_VERBOSE) {
           CM_Debug("action name: " << action->name + 2);
         }
-        scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
+        RegisterLibraryAction(main_newlib, scene_merge, action);
       }
     }
   }
 
+  // Memory of the linked datablocks and of the synchronous conversion.
+  status->AddMemoryUsage((long long)MEM_get_memory_in_use() - (long long)memstart);
+
   if (!(options & LIB_LOAD_ASYNC)) {
     status->Finish();
   }
@@ -597,7 +675,7 @@ bool BL_Converter::FreeBlendFile(Main *maggie)
     }
   }
 
-  // free all tagged objects
+  // free all tagged scenes
   EXP_ListValue<KX_Scene> *scenes = m_ketsjiEngine->CurrentScenes();
   int numScenes = scenes->GetCount();
 
@@ -609,111 +687,168 @@ bool BL_Converter::FreeBlendFile(Main *maggie)
       sce_idx--;
       numScenes--;
     }
-    else {
-      // in case the mesh might be refered to later
-      std::map<std::string, void *> &mapStringToMeshes = scene->GetLogicManager()->GetMeshMap();
-      for (std::map<std::string, void *>::iterator it = mapStringToMeshes.begin(),
-                                                   end = mapStringToMeshes.end();
-           it != end;) {
-        RAS_MeshObject *meshobj = (RAS_MeshObject *)it->second;
-        if (meshobj && IS_TAGGED(meshobj->GetOrigMesh())) {
-          it = mapStringToMeshes.erase(it);
-        }
-        else {
-          ++it;
-        }
+  }
+
+  /* Only the data indexed for this library are visited, the objects of the other
+   * libraries and of the main file are never scanned. */
+  LibrarySlot &slot = m_librarySlots[maggie];
+  slot.m_freeing = true;
+
+  for (std::pair<KX_Scene *const, LibrarySlot::SceneData> &pair : slot.m_scenes) {
+    KX_Scene *scene = pair.first;
+    LibrarySlot::SceneData &data = pair.second;
+
+    // in case the mesh might be refered to later
+    std::map<std::string, void *> &mapStringToMeshes = scene->GetLogicManager()->GetMeshMap();
+    for (const std::pair<std::string, void *> &mesh : data.m_meshNames) {
+      std::map<std::string, void *>::iterator it = mapStringToMeshes.find(mesh.first);
+      if (it != mapStringToMeshes.end() && it->second == mesh.second) {
+        mapStringToMeshes.erase(it);
       }
+    }
 
-      // Now unregister actions.
-      std::map<std::string, void *> &mapStringToActions = scene->GetLogicManager()->GetActionMap();
-      for (std::map<std::string, void *>::iterator it = mapStringToActions.begin(),
-                                                   end = mapStringToActions.end();
-           it != end;) {
-        ID *action = (ID *)it->second;
-        if (IS_TAGGED(action)) {
-          it = mapStringToActions.erase(it);
-        }
-        else {
-          ++it;
-        }
+    // Now unregister actions.
+    std::map<std::string, void *> &mapStringToActions = scene->GetLogicManager()->GetActionMap();
+    for (const std::pair<std::string, void *> &action : data.m_actionNames) {
+      std::map<std::string, void *>::iterator it = mapStringToActions.find(action.first);
+      if (it != mapStringToActions.end() && it->second == action.second) {
+        mapStringToActions.erase(it);
       }
+    }
+
+    // The objects using the library data must stop now, the data are freed with the library.
+    for (KX_GameObject *gameobj : data.m_users) {
+      FreeLibraryUser(gameobj);
+    }
+    data.m_users.clear();
 
-      // removed tagged objects and meshes
-      EXP_ListValue<KX_GameObject> *obj_lists[] = {
-          scene->GetObjectList(), scene->GetInactiveList(), nullptr};
+    // The objects of the library are removed progressively, meanwhile they stay inactive.
+    for (KX_GameObject *gameobj : data.m_objects) {
+      SuspendLibraryObject(gameobj);
+    }
+  }
+
+#ifdef WITH_PYTHON
+  /* make sure this maggie is removed from the import list if it's there
+   * (this operation is safe if it isn't in the list) */
+  removeImportMain(maggie);
+#endif
 
-      for (int ob_ls_idx = 0; obj_lists[ob_ls_idx]; ob_ls_idx++) {
-        EXP_ListValue<KX_GameObject> *obs = obj_lists[ob_ls_idx];
+  delete m_status_map[maggie->filepath];
+  m_status_map.erase(maggie->filepath);
 
-        for (int ob_idx = 0; ob_idx < obs->GetCount(); ob_idx++) {
-          KX_GameObject *gameobj = obs->GetValue(ob_idx);
-          if (IS_TAGGED(gameobj->GetBlenderObject())) {
-            int size_before = obs->GetCount();
+  // Free small libraries immediately.
+  m_freeingLibraries.push_back(maggie);
+  UpdateFreeingLibraries(FREE_LIBRARY_BUDGET);
 
-            /* Eventually calls RemoveNodeDestructObject
-             * frees m_map_gameobject_to_blender from UnregisterGameObject */
-            scene->RemoveObject(gameobj);
+  return true;
+}
 
-            if (size_before != obs->GetCount()) {
-              ob_idx--;
-            }
-            else {
-              CM_Error("could not remove \"" << gameobj->GetName() << "\"");
-            }
-          }
-          else {
-            gameobj->RemoveTaggedActions();
-            // free the mesh, we could be referecing a linked one!
-            int mesh_index = gameobj->GetMeshCount();
-            while (mesh_index--) {
-              RAS_MeshObject *mesh = gameobj->GetMesh(mesh_index);
-              if (IS_TAGGED(mesh->GetOrigMesh())) {
-                gameobj->RemoveMeshes(); /* XXX - slack, should only remove meshes that are library
-                                            items but mostly objects only have 1 mesh */
-                break;
-              }
-              else {
-                // also free the mesh if it's using a tagged material
-                int mat_index = mesh->NumMaterials();
-                while (mat_index--) {
-                  if (IS_TAGGED(mesh->GetMeshMaterial(mat_index)
-                                    ->GetBucket()
-                                    ->GetPolyMaterial()
-                                    ->GetBlenderMaterial())) {
-                    gameobj->RemoveMeshes();  // XXX - slack, same as above
-                    break;
-                  }
-                }
-              }
-            }
-
-            // make sure action actuators are not referencing tagged actions
-            for (unsigned int act_idx = 0; act_idx < gameobj->GetActuators().size(); act_idx++) {
-              if (gameobj->GetActuators()[act_idx]->IsType(SCA_IActuator::KX_ACT_ACTION)) {
-                SCA_ActionActuator *act = (SCA_ActionActuator *)gameobj->GetActuators()[act_idx];
-                if (IS_TAGGED(act->GetAction())) {
-                  act->SetAction(nullptr);
-                }
-              }
-            }
-          }
+void BL_Converter::UpdateFreeingLibraries(unsigned int budget)
+{
+  for (std::vector<Main *>::iterator it = m_freeingLibraries.begin();
+       it != m_freeingLibraries.end();)
+  {
+    Main *maggie = *it;
+    LibrarySlot &slot = m_librarySlots[maggie];
+    if (!FreeLibraryObjects(slot, budget)) {
+      // Continue in the next frame.
+      return;
+    }
+
+    FreeLibraryData(maggie, slot);
+    m_librarySlots.erase(maggie);
+
+    BKE_main_free(maggie);
+    it = m_freeingLibraries.erase(it);
+  }
+}
+
+void BL_Converter::SuspendLibraryObject(KX_GameObject *gameobj)
+{
+  gameobj->SuspendLogicAndActions(false);
+  gameobj->SuspendPhysics(false, false);
+  gameobj->SetVisible(false, false);
+}
+
+void BL_Converter::FreeLibraryUser(KX_GameObject *gameobj)
+{
+  gameobj->RemoveTaggedActions();
+  // free the mesh, we could be referecing a linked one!
+  int mesh_index = gameobj->GetMeshCount();
+  while (mesh_index--) {
+    RAS_MeshObject *mesh = gameobj->GetMesh(mesh_index);
+    if (IS_TAGGED(mesh->GetOrigMesh())) {
+      gameobj->RemoveMeshes(); /* XXX - slack, should only remove meshes that are library
+                                  items but mostly objects only have 1 mesh */
+      break;
+    }
+    else {
+      // also free the mesh if it's using a tagged material
+      int mat_index = mesh->NumMaterials();
+      while (mat_index--) {
+        if (IS_TAGGED(
+                mesh->GetMeshMaterial(mat_index)->GetBucket()->GetPolyMaterial()->GetBlenderMaterial()))
+        {
+          gameobj->RemoveMeshes();  // XXX - slack, same as above
+          break;
         }
       }
     }
   }
 
-  for (std::map<KX_Scene *, SceneSlot>::iterator sit = m_sceneSlots.begin(),
-                                                 send = m_sceneSlots.end();
-       sit != send;
-       ++sit) {
-    KX_Scene *scene = sit->first;
+  // make sure action actuators are not referencing tagged actions
+  for (SCA_IActuator *actuator : gameobj->GetActuators()) {
+    if (actuator->IsType(SCA_IActuator::KX_ACT_ACTION)) {
+      SCA_ActionActuator *act = (SCA_ActionActuator *)actuator;
+      if (IS_TAGGED(act->GetAction())) {
+        act->SetAction(nullptr);
+      }
+    }
+  }
+}
+
+bool BL_Converter::FreeLibraryObjects(LibrarySlot &slot, unsigned int &budget)
+{
+  for (std::pair<KX_Scene *const, LibrarySlot::SceneData> &pair : slot.m_scenes) {
+    KX_Scene *scene = pair.first;
+    std::set<KX_GameObject *> &objects = pair.second.m_objects;
+
+    while (!objects.empty()) {
+      if (budget == 0) {
+        return false;
+      }
+      --budget;
+
+      KX_GameObject *gameobj = *objects.begin();
+      /* Eventually calls RemoveNodeDestructObject and UnregisterLibraryObject
+       * for the object and its children. */
+      scene->RemoveObject(gameobj);
+      // WARNING: 'gameobj' maybe be freed now, only compare, don't access.
+      objects.erase(gameobj);
+    }
+  }
+
+  return true;
+}
+
+void BL_Converter::FreeLibraryData(Main *maggie, LibrarySlot &slot)
+{
+  for (std::pair<KX_Scene *const, LibrarySlot::SceneData> &pair : slot.m_scenes) {
+    KX_Scene *scene = pair.first;
+    const LibrarySlot::SceneData &data = pair.second;
+
+    std::map<KX_Scene *, SceneSlot>::iterator sit = m_sceneSlots.find(scene);
+    if (sit == m_sceneSlots.end()) {
+      continue;
+    }
     SceneSlot &sceneSlot = sit->second;
 
     for (UniquePtrList<KX_BlenderMaterial>::iterator it = sceneSlot.m_materials.begin();
-         it != sceneSlot.m_materials.end();) {
+         it != sceneSlot.m_materials.end();)
+    {
       KX_BlenderMaterial *mat = (*it).get();
-      Material *bmat = mat->GetBlenderMaterial();
-      if (IS_TAGGED(bmat)) {
+      if (data.m_materials.count(mat)) {
         scene->GetBucketManager()->RemoveMaterial(mat);
         it = sceneSlot.m_materials.erase(it);
       }
@@ -723,11 +858,11 @@ bool BL_Converter::FreeBlendFile(Main *maggie)
     }
 
     for (UniquePtrList<BL_InterpolatorList>::iterator it = sceneSlot.m_interpolators.begin();
-         it != sceneSlot.m_interpolators.end();) {
+         it != sceneSlot.m_interpolators.end();)
+    {
       BL_InterpolatorList *interp = (*it).get();
-      bAction *action = interp->GetAction();
-      if (IS_TAGGED(action)) {
-        sceneSlot.m_actionToInterp.erase(action);
+      if (data.m_interpolators.count(interp)) {
+        sceneSlot.m_actionToInterp.erase(interp->GetAction());
         it = sceneSlot.m_interpolators.erase(it);
       }
       else {
@@ -736,9 +871,9 @@ bool BL_Converter::FreeBlendFile(Main *maggie)
     }
 
     for (UniquePtrList<RAS_MeshObject>::iterator it = sceneSlot.m_meshobjects.begin();
-         it != sceneSlot.m_meshobjects.end();) {
-      RAS_MeshObject *mesh = (*it).get();
-      if (IS_TAGGED(mesh->GetOrigMesh())) {
+         it != sceneSlot.m_meshobjects.end();)
+    {
+      if (data.m_meshobjects.count((*it).get())) {
         it = sceneSlot.m_meshobjects.erase(it);
       }
       else {
@@ -747,18 +882,154 @@ bool BL_Converter::FreeBlendFile(Main *maggie)
     }
   }
 
-#ifdef WITH_PYTHON
-  /* make sure this maggie is removed from the import list if it's there
-   * (this operation is safe if it isn't in the list) */
-  removeImportMain(maggie);
-#endif
+  for (std::map<ID *, Main *>::iterator it = m_idToLibrary.begin(); it != m_idToLibrary.end();) {
+    if (it->second == maggie) {
+      it = m_idToLibrary.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
 
-  delete m_status_map[maggie->filepath];
-  m_status_map.erase(maggie->filepath);
+Main *BL_Converter::GetLibraryForScene(KX_Scene *scene) const
+{
+  Scene *blenderScene = scene->GetBlenderScene();
+  for (Main *maggie : m_DynamicMaggie) {
+    if (BLI_findindex(&maggie->scenes, blenderScene) != -1) {
+      return maggie;
+    }
+  }
 
-  BKE_main_free(maggie);
+  return nullptr;
+}
 
-  return true;
+void BL_Converter::RegisterLibraryObjects(KX_Scene *to, KX_Scene *from)
+{
+  Main *maggie = GetLibraryForScene(from);
+  if (!maggie) {
+    return;
+  }
+
+  LibrarySlot::SceneData &data = m_librarySlots[maggie].m_scenes[to];
+  for (KX_GameObject *gameobj : *from->GetObjectList()) {
+    data.m_objects.insert(gameobj);
+  }
+  for (KX_GameObject *gameobj : *from->GetInactiveList()) {
+    data.m_objects.insert(gameobj);
+  }
+
+  // Actions registered by the conversion of the actuators.
+  for (const std::pair<const std::string, void *> &action :
+       from->GetLogicManager()->GetActionMap()) {
+    data.m_actionNames.emplace_back(action.first, action.second);
+    m_idToLibrary[(ID *)action.second] = maggie;
+  }
+}
+
+void BL_Converter::RegisterLibraryData(Main *maggie, KX_Scene *scene, const SceneSlot &sceneSlot)
+{
+  LibrarySlot::SceneData &data = m_librarySlots[maggie].m_scenes[scene];
+  for (const std::unique_ptr<KX_BlenderMaterial> &mat : sceneSlot.m_materials) {
+    data.m_materials.insert(mat.get());
+  }
+  for (const std::unique_ptr<RAS_MeshObject> &meshobj : sceneSlot.m_meshobjects) {
+    data.m_meshobjects.insert(meshobj.get());
+    data.m_meshNames.emplace_back(meshobj->GetName(), meshobj.get());
+    m_idToLibrary[(ID *)meshobj->GetOrigMesh()] = maggie;
+  }
+  for (const std::unique_ptr<BL_InterpolatorList> &interp : sceneSlot.m_interpolators) {
+    data.m_interpolators.insert(interp.get());
+  }
+}
+
+void BL_Converter::RegisterLibraryData(Main *maggie,
+                                       KX_Scene *scene,
+                                       const BL_SceneConverter *converter)
+{
+  LibrarySlot::SceneData &data = m_librarySlots[maggie].m_scenes[scene];
+  for (KX_BlenderMaterial *mat : converter->m_materials) {
+    data.m_materials.insert(mat);
+  }
+  for (RAS_MeshObject *meshobj : converter->m_meshobjects) {
+    data.m_meshobjects.insert(meshobj);
+    data.m_meshNames.emplace_back(meshobj->GetName(), meshobj);
+    m_idToLibrary[(ID *)meshobj->GetOrigMesh()] = maggie;
+  }
+}
+
+void BL_Converter::RegisterLibraryAction(Main *maggie, KX_Scene *scene, ID *action)
+{
+  scene->GetLogicManager()->RegisterActionName(action->name + 2, action);
+
+  m_librarySlots[maggie].m_scenes[scene].m_actionNames.emplace_back(action->name + 2, action);
+  m_idToLibrary[action] = maggie;
+}
+
+void BL_Converter::RegisterLibraryReplica(KX_Scene *scene,
+                                          KX_GameObject *original,
+                                          KX_GameObject *replica)
+{
+  // Scenes converted asynchronously are indexed when merged.
+  if (m_librarySlots.empty() || !BLI_thread_is_main()) {
+    return;
+  }
+
+  for (std::pair<Main *const, LibrarySlot> &pair : m_librarySlots) {
+    LibrarySlot &slot = pair.second;
+    std::map<KX_Scene *, LibrarySlot::SceneData>::iterator it = slot.m_scenes.find(scene);
+    if (it == slot.m_scenes.end()) {
+      continue;
+    }
+
+    LibrarySlot::SceneData &data = it->second;
+    if (data.m_objects.count(original)) {
+      data.m_objects.insert(replica);
+      if (slot.m_freeing) {
+        SuspendLibraryObject(replica);
+      }
+    }
+    else if (data.m_users.count(original)) {
+      data.m_users.insert(replica);
+    }
+  }
+}
+
+void BL_Converter::RegisterLibraryUser(KX_Scene *scene, KX_GameObject *gameobj, ID *id)
+{
+  if (m_idToLibrary.empty() || !BLI_thread_is_main()) {
+    return;
+  }
+
+  std::map<ID *, Main *>::const_iterator it = m_idToLibrary.find(id);
+  if (it == m_idToLibrary.end()) {
+    return;
+  }
+
+  LibrarySlot &slot = m_librarySlots[it->second];
+  if (slot.m_freeing) {
+    return;
+  }
+
+  LibrarySlot::SceneData &data = slot.m_scenes[scene];
+  if (!data.m_objects.count(gameobj)) {
+    data.m_users.insert(gameobj);
+  }
+}
+
+void BL_Converter::UnregisterLibraryObject(KX_Scene *scene, KX_GameObject *gameobj)
+{
+  if (m_librarySlots.empty() || !BLI_thread_is_main()) {
+    return;
+  }
+
+  for (std::pair<Main *const, LibrarySlot> &pair : m_librarySlots) {
+    std::map<KX_Scene *, LibrarySlot::SceneData>::iterator it = pair.second.m_scenes.find(scene);
+    if (it != pair.second.m_scenes.end()) {
+      it->second.m_objects.erase(gameobj);
+      it->second.m_users.erase(gameobj);
+    }
+  }
 }
 
 bool BL_Converter::FreeBlendFile(const std::string &path)
@@ -770,6 +1041,11 @@ void BL_Converter::MergeScene(KX_Scene *to, KX_Scene *from)
 {
   SceneSlot &sceneSlotFrom = m_sceneSlots[from];
 
+  Main *maggie = GetLibraryForScene(from);
+  if (maggie) {
+    RegisterLibraryData(maggie, to, sceneSlotFrom);
+  }
+
   for (std::unique_ptr<KX_BlenderMaterial> &mat : sceneSlotFrom.m_materials) {
     mat->ReplaceScene(to);
   }
@@ -863,6 +1139,9 @@ RAS_MeshObject *BL_Converter::ConvertMeshSpecial(KX_Scene *kx_scene,
       (Mesh *)me, nullptr, kx_scene, m_ketsjiEngine->GetRasterizer(), sceneConverter, false, true);
   kx_scene->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
 
+  if (maggie != m_maggie) {
+    RegisterLibraryData(maggie, kx_scene, sceneConverter);
+  }
   m_sceneSlots[kx_scene].Merge(sceneConverter);
   kx_scene->SetBlenderSceneConverter(sceneConverter);
 
@@ -32,6 +32,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <vector>
 
 #include "BL_ScalarInterpolator.h"
@@ -45,9 +46,11 @@ class BL_SceneConverter;
 class KX_KetsjiEngine;
 class KX_LibLoadStatus;
 class KX_BlenderMaterial;
+class KX_GameObject;
 class BL_InterpolatorList;
 class RAS_MeshObject;
 class RAS_Rasterizer;
+struct ID;
 struct Main;
 struct BlendHandle;
 struct Scene;
@@ -76,6 +79,39 @@ class BL_Converter {
 
   std::map<KX_Scene *, SceneSlot> m_sceneSlots;
 
+  /** Data converted from a dynamically loaded library, indexed at conversion time
+   * to free the library without scanning the objects of all the scenes.
+   */
+  class LibrarySlot {
+   public:
+    /// Data of the library merged in a scene.
+    class SceneData {
+     public:
+      /// Objects converted from the library and their replicas.
+      std::set<KX_GameObject *> m_objects;
+      /// Objects outside of the library using its meshes or actions.
+      std::set<KX_GameObject *> m_users;
+      std::set<KX_BlenderMaterial *> m_materials;
+      std::set<RAS_MeshObject *> m_meshobjects;
+      std::set<BL_InterpolatorList *> m_interpolators;
+      /// Meshes and actions registered by name in the logic manager of the scene.
+      std::vector<std::pair<std::string, void *>> m_meshNames;
+      std::vector<std::pair<std::string, void *>> m_actionNames;
+    };
+
+    std::map<KX_Scene *, SceneData> m_scenes;
+    /// The library was freed, its objects are being removed over several frames.
+    bool m_freeing;
+
+    LibrarySlot();
+  };
+
+  std::map<Main *, LibrarySlot> m_librarySlots;
+  /// Library of the datablocks used by the engine data (objects, meshes and actions).
+  std::map<ID *, Main *> m_idToLibrary;
+  /// Libraries being freed, in order of freeing.
+  std::vector<Main *> m_freeingLibraries;
+
   struct ThreadInfo {
     TaskPool *m_pool;
     CM_ThreadMutex m_mutex;
@@ -84,6 +120,10 @@ class BL_Converter {
   // Saved KX_LibLoadStatus objects
   std::map<std::string, KX_LibLoadStatus *> m_status_map;
   std::vector<KX_LibLoadStatus *> m_mergequeue;
+  /// Converted libraries being merged, only accessed by the main thread.
+  std::vector<KX_LibLoadStatus *> m_mergingStatus;
+  /// Maximum time in seconds spent merging converted scenes per frame, 0 for unlimited.
+  double m_mergeTimeBudget;
 
   Main *m_maggie;
   std::vector<Main *> m_DynamicMaggie;
@@ -91,6 +131,23 @@ class BL_Converter {
   KX_KetsjiEngine *m_ketsjiEngine;
   bool m_alwaysUseExpandFraming;
 
+  /// Index the meshes, materials and interpolators converted from a library.
+  void RegisterLibraryData(Main *maggie, KX_Scene *scene, const SceneSlot &sceneSlot);
+  void RegisterLibraryData(Main *maggie, KX_Scene *scene, const BL_SceneConverter *converter);
+  /// Register an action of a library by name in a scene.
+  void RegisterLibraryAction(Main *maggie, KX_Scene *scene, ID *action);
+  /// Make a library object inactive until it is removed.
+  void SuspendLibraryObject(KX_GameObject *gameobj);
+  /// Remove the references of an object to the data of the library being freed.
+  void FreeLibraryUser(KX_GameObject *gameobj);
+  /// Remove the objects of a library, return false if the budget was exhausted before the end.
+  bool FreeLibraryObjects(LibrarySlot &slot, unsigned int &budget);
+  void FreeLibraryData(Main *maggie, LibrarySlot &slot);
+  /** Merge the converted scenes of the asynchronous loads.
+   * \param budget The time in seconds after which no other scene is merged, 0 for unlimited.
+   */
+  void MergeScenes(double budget);
+
  public:
   BL_Converter(Main *maggie, KX_KetsjiEngine *engine);
   virtual ~BL_Converter();
@@ -119,6 +176,10 @@ class BL_Converter {
   Main *CreateMainDynamic(const std::string &path);
   Main *GetMainDynamicPath(const std::string &path) const;
   const std::vector<Main *> &GetMainDynamic() const;
+  /** Return the status of the last load of a library, nullptr if the library is not loaded.
+   * The status is deleted when the library is freed, it must not be kept across frames.
+   */
+  KX_LibLoadStatus *GetLibLoadStatus(const std::string &path) const;
 
   KX_LibLoadStatus *LinkBlendFileMemory(void *data,
                                         int length,
@@ -138,6 +199,22 @@ class BL_Converter {
 
   bool FreeBlendFile(Main *maggie);
   bool FreeBlendFile(const std::string &path);
+  /** Remove the objects of the freed libraries and free the libraries once done.
+   * \param budget The maximum number of objects to remove, spreading large libraries over
+   * several frames.
+   */
+  void UpdateFreeingLibraries(unsigned int budget);
+
+  /// Find the dynamic library containing the Blender scene of a scene, nullptr for the main file.
+  Main *GetLibraryForScene(KX_Scene *scene) const;
+  /// Index the objects of a library scene merged into another scene.
+  void RegisterLibraryObjects(KX_Scene *to, KX_Scene *from);
+  /// Index the replica of a library object, or of an object using library data.
+  void RegisterLibraryReplica(KX_Scene *scene, KX_GameObject *original, KX_GameObject *replica);
+  /// Index an object outside of a library using a datablock of this library.
+  void RegisterLibraryUser(KX_Scene *scene, KX_GameObject *gameobj, ID *id);
+  /// Remove an object from the library indices, called when the object is removed.
+  void UnregisterLibraryObject(KX_Scene *scene, KX_GameObject *gameobj);
 
   RAS_MeshObject *ConvertMeshSpecial(KX_Scene *kx_scene, Main *maggie, const std::string &name);
 
@@ -145,10 +222,15 @@ class BL_Converter {
 
   void MergeAsyncLoads();
   void FinalizeAsyncLoads();
+  void SetMergeTimeBudget(double budget);
+  double GetMergeTimeBudget() const;
   void AddScenesToMergeQueue(KX_LibLoadStatus *status);
 
   void PrintStats();
 
+  /// Number of objects of freed libraries removed per frame.
+  static const unsigned int FREE_LIBRARY_BUDGET = 256;
+
   // LibLoad Options.
   enum {
     LIB_LOAD_LOAD_ACTIONS = 1,
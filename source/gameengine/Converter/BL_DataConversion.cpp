@@ -84,6 +84,7 @@
 #include "BL_ConvertControllers.h"
 #include "BL_ConvertProperties.h"
 #include "BL_ConvertSensors.h"
+#include "BL_StaticBatching.h"
 #include "KX_BlenderMaterial.h"
 #include "KX_BoneParentNodeRelationship.h"
 #include "KX_Camera.h"
@@ -1362,6 +1363,15 @@ void BL_ConvertBlenderObjects(struct Main *maggie,
   /* Ensure objects base flags are up to date each time we call BL_ConvertObjects */
   BKE_scene_base_flag_to_objects(blenderscene, BKE_view_layer_default_view(blenderscene));
 
+  /* Merge the static objects before their conversion, the merged objects are not converted. */
+  std::set<Object *> batchedObjects;
+  std::vector<BL_StaticBatch> staticBatches;
+  if (!single_object && !libloading && (blenderscene->gm.flag & GAME_USE_STATIC_BATCHING)) {
+    staticBatches = BL_BatchStaticObjects(
+        kxscene, blenderscene->gm.batchCellSize, batchedObjects);
+    BKE_scene_base_flag_to_objects(blenderscene, BKE_view_layer_default_view(blenderscene));
+  }
+
   std::vector<Object *> lod_objects = lod_level_object_list(
       BKE_view_layer_default_view(blenderscene));
 
@@ -1382,7 +1392,9 @@ void BL_ConvertBlenderObjects(struct Main *maggie,
       continue;
     }
 
-    if (blenderobject == kxscene->GetGameDefaultCamera()) {
+    if (blenderobject == kxscene->GetGameDefaultCamera() ||
+        batchedObjects.find(blenderobject) != batchedObjects.end())
+    {
       continue;
     }
 
@@ -1437,6 +1449,13 @@ void BL_ConvertBlenderObjects(struct Main *maggie,
     }
   }
 
+  for (const BL_StaticBatch &batch : staticBatches) {
+    KX_GameObject *gameobj = converter->FindGameObject(batch.m_object);
+    if (gameobj) {
+      gameobj->SetBatchedObjects(batch.m_objects);
+    }
+  }
+
   if (!grouplist.empty()) {  // always empty during single object conversion
     // now convert the group referenced by dupli group object
     // keep track of all groups already converted
@@ -34,6 +34,7 @@
 #include <map>
 #include <vector>
 
+#include "CM_Memory.h"
 #include "CM_Message.h"
 
 class SCA_IActuator;
@@ -83,4 +84,6 @@ class BL_SceneConverter {
 
   void RegisterGameController(SCA_IController *cont, bController *for_controller);
   SCA_IController *FindGameController(bController *for_controller);
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_CONVERTER, "BL_SceneConverter")
 };
@@ -0,0 +1,298 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file gameengine/Converter/BL_StaticBatching.cpp
+ *  \ingroup bgeconv
+ */
+
+#include "BL_StaticBatching.h"
+
+#include <cmath>
+#include <map>
+#include <tuple>
+
+#include "BKE_collection.hh"
+#include "BKE_context.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_instances.hh"
+#include "BKE_key.hh"
+#include "BKE_layer.hh"
+#include "BKE_main.hh"
+#include "BKE_material.h"
+#include "BKE_mesh.hh"
+#include "BKE_object.hh"
+#include "BKE_scene.hh"
+#include "BLI_listbase.h"
+#include "BLI_math_matrix.hh"
+#include "BLI_math_vector.h"
+#include "DEG_depsgraph_build.hh"
+#include "DEG_depsgraph_query.hh"
+#include "DNA_collection_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "GEO_realize_instances.hh"
+#include "MEM_guardedalloc.h"
+
+#include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
+#include "KX_Scene.h"
+
+using namespace blender;
+
+/// Settings which must be identical for objects merged together.
+struct BL_BatchKey {
+  int m_cell[3];
+  std::vector<Material *> m_materials;
+  int m_gameflag;
+  int m_gameflag2;
+  unsigned short m_colGroup;
+  unsigned short m_colMask;
+  float m_friction;
+  float m_rollingFriction;
+  float m_restitution;
+  float m_margin;
+
+  bool operator<(const BL_BatchKey &other) const
+  {
+    return std::tie(m_cell[0],
+                    m_cell[1],
+                    m_cell[2],
+                    m_materials,
+                    m_gameflag,
+                    m_gameflag2,
+                    m_colGroup,
+                    m_colMask,
+                    m_friction,
+                    m_rollingFriction,
+                    m_restitution,
+                    m_margin) < std::tie(other.m_cell[0],
+                                         other.m_cell[1],
+                                         other.m_cell[2],
+                                         other.m_materials,
+                                         other.m_gameflag,
+                                         other.m_gameflag2,
+                                         other.m_colGroup,
+                                         other.m_colMask,
+                                         other.m_friction,
+                                         other.m_rollingFriction,
+                                         other.m_restitution,
+                                         other.m_margin);
+  }
+};
+
+static bool BL_CanBatchObject(Object *ob, const std::set<Object *> &parents)
+{
+  if (ob->type != OB_MESH || ob->parent || parents.find(ob) != parents.end() ||
+      ob->instance_collection || ob->adt || ob->rigidbody_object || BKE_key_from_object(ob))
+  {
+    return false;
+  }
+
+  if ((ob->base_flag & (BASE_ENABLED_AND_MAYBE_VISIBLE_IN_VIEWPORT |
+                        BASE_ENABLED_AND_VISIBLE_IN_DEFAULT_VIEWPORT)) == 0)
+  {
+    return false;
+  }
+
+  // Objects with logic, properties or components can be accessed individually.
+  if (!BLI_listbase_is_empty(&ob->prop) || !BLI_listbase_is_empty(&ob->sensors) ||
+      !BLI_listbase_is_empty(&ob->controllers) || !BLI_listbase_is_empty(&ob->actuators) ||
+      !BLI_listbase_is_empty(&ob->components) || ob->custom_object ||
+      !BLI_listbase_is_empty(&ob->constraints) || !BLI_listbase_is_empty(&ob->lodlevels))
+  {
+    return false;
+  }
+
+  const int excludedFlags = OB_DYNAMIC | OB_RIGID_BODY | OB_SOFT_BODY | OB_OCCLUDER | OB_SENSOR |
+                            OB_NAVMESH | OB_HASOBSTACLE | OB_CHARACTER | OB_CHILD |
+                            OB_RECORD_ANIMATION | OB_OVERLAY_COLLECTION;
+  if (ob->gameflag & excludedFlags) {
+    return false;
+  }
+
+  // The merged object collides with its triangle mesh.
+  if ((ob->gameflag & OB_COLLISION) && (ob->gameflag & OB_BOUNDS) &&
+      ob->collision_boundtype != OB_BOUND_TRIANGLE_MESH)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+static void BL_CopyGameSettings(const Object *from, Object *to)
+{
+  to->gameflag = from->gameflag;
+  to->gameflag2 = from->gameflag2;
+  to->body_type = from->body_type;
+  to->col_group = from->col_group;
+  to->col_mask = from->col_mask;
+  to->collision_boundtype = from->collision_boundtype;
+  to->margin = from->margin;
+  to->friction = from->friction;
+  to->rolling_friction = from->rolling_friction;
+  to->reflect = from->reflect;
+  to->activityCulling = from->activityCulling;
+  to->state = from->state;
+  to->init_state = from->init_state;
+}
+
+std::vector<BL_StaticBatch> BL_BatchStaticObjects(KX_Scene *kxscene,
+                                                  float cellSize,
+                                                  std::set<Object *> &batchedObjects)
+{
+  bContext *C = KX_GetActiveEngine()->GetContext();
+  Main *bmain = CTX_data_main(C);
+  Depsgraph *depsgraph = CTX_data_depsgraph_on_load(C);
+  Scene *scene = kxscene->GetBlenderScene();
+  ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+
+  // Parent objects keep the transform of their children.
+  std::set<Object *> parents;
+  LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+    if (ob->parent) {
+      parents.insert(ob->parent);
+    }
+  }
+
+  std::map<BL_BatchKey, std::vector<Object *>> groups;
+  BKE_view_layer_synced_ensure(scene, view_layer);
+  LISTBASE_FOREACH (Base *, base, BKE_view_layer_object_bases_get(view_layer)) {
+    Object *ob = base->object;
+    if (!BL_CanBatchObject(ob, parents) ||
+        !BKE_object_get_evaluated_mesh(DEG_get_evaluated_object(depsgraph, ob)))
+    {
+      continue;
+    }
+
+    const float3 &position = ob->object_to_world().location();
+    BL_BatchKey key;
+    for (unsigned short i = 0; i < 3; ++i) {
+      key.m_cell[i] = (cellSize > 0.0f) ? int(std::floor(position[i] / cellSize)) : 0;
+    }
+    for (short i = 0; i < ob->totcol; ++i) {
+      key.m_materials.push_back(BKE_object_material_get(ob, i + 1));
+    }
+    key.m_gameflag = ob->gameflag;
+    key.m_gameflag2 = ob->gameflag2;
+    key.m_colGroup = ob->col_group;
+    key.m_colMask = ob->col_mask;
+    key.m_friction = ob->friction;
+    key.m_rollingFriction = ob->rolling_friction;
+    key.m_restitution = ob->reflect;
+    key.m_margin = ob->margin;
+
+    groups[key].push_back(ob);
+  }
+
+  std::vector<BL_StaticBatch> batches;
+  for (const auto &[key, objects] : groups) {
+    // Nothing to gain from merging a single object.
+    if (objects.size() < 2) {
+      continue;
+    }
+
+    // The merged object is placed at the center of the merged objects.
+    float3 center(0.0f);
+    for (Object *ob : objects) {
+      center += ob->object_to_world().location();
+    }
+    center /= float(objects.size());
+    const float4x4 batchInverse = math::from_location<float4x4>(-center);
+
+    BL_StaticBatch batch;
+    bke::Instances *instances = new bke::Instances();
+    unsigned int numPolygons = 0;
+    for (Object *ob : objects) {
+      const Mesh *meshEval = BKE_object_get_evaluated_mesh(
+          DEG_get_evaluated_object(depsgraph, ob));
+
+      // Use the object materials in all meshes to keep the material indices consistent.
+      Mesh *mesh = BKE_mesh_copy_for_eval(*meshEval);
+      MEM_SAFE_FREE(mesh->mat);
+      mesh->totcol = key.m_materials.size();
+      mesh->mat = MEM_cnew_array<Material *>(mesh->totcol, __func__);
+      std::copy(key.m_materials.begin(), key.m_materials.end(), mesh->mat);
+
+      const int handle = instances->add_reference(
+          bke::InstanceReference(bke::GeometrySet::from_mesh(mesh)));
+      instances->add_instance(handle, batchInverse * ob->object_to_world());
+
+      batch.m_objects.emplace_back(numPolygons, ob->id.name + 2);
+      // The converted mesh contains a polygon per triangle or quad of a face.
+      const OffsetIndices faces = meshEval->faces();
+      for (const int i : faces.index_range()) {
+        const int size = faces[i].size();
+        numPolygons += (size == 4) ? 1 : size - 2;
+      }
+    }
+
+    geometry::RealizeInstancesOptions options;
+    options.keep_original_ids = true;
+    options.realize_instance_attributes = false;
+    bke::GeometrySet geometry = geometry::realize_instances(
+        bke::GeometrySet::from_instances(instances), options);
+    Mesh *result = geometry.get_component_for_write<bke::MeshComponent>().release();
+    if (!result) {
+      continue;
+    }
+
+    std::vector<Material *> materials(result->mat, result->mat + result->totcol);
+
+    Mesh *batchMesh = BKE_mesh_add(bmain, "StaticBatch");
+    Object *batchObject = BKE_object_add_only_object(bmain, OB_MESH, "StaticBatch");
+    batchObject->data = batchMesh;
+    // Frees the result mesh.
+    BKE_mesh_nomain_to_mesh(result, batchMesh, batchObject);
+    if (!materials.empty()) {
+      Material **matar = materials.data();
+      BKE_object_material_array_assign(bmain, batchObject, &matar, materials.size(), false);
+    }
+
+    copy_v3_v3(batchObject->loc, center);
+    BL_CopyGameSettings(objects.front(), batchObject);
+    BKE_collection_object_add(bmain, scene->master_collection, batchObject);
+    kxscene->AddStaticBatchObject(batchObject);
+
+    // Hide the merged objects the same way as objects of the inactive layers.
+    for (Object *ob : objects) {
+      kxscene->BackupRestrictFlag(ob, ob->visibility_flag);
+      ob->visibility_flag |= OB_HIDE_VIEWPORT;
+      batchedObjects.insert(ob);
+    }
+
+    batch.m_object = batchObject;
+    batches.push_back(batch);
+  }
+
+  if (!batches.empty()) {
+    // Evaluate the merged objects before their conversion.
+    BKE_main_collection_sync_remap(bmain);
+    DEG_relations_tag_update(bmain);
+    BKE_view_layer_synced_ensure(scene, view_layer);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  return batches;
+}
@@ -0,0 +1,55 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file BL_StaticBatching.h
+ *  \ingroup bgeconv
+ */
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class KX_Scene;
+struct Object;
+
+/// Object created by merging static objects.
+struct BL_StaticBatch {
+  struct Object *m_object;
+  /// Index of the first converted polygon and name of each merged object.
+  std::vector<std::pair<unsigned int, std::string>> m_objects;
+};
+
+/** Merge the static mesh objects of the active layers without logic, sharing the same materials,
+ * physics settings and grid cell, into one new Blender object per group.
+ * The merged objects are hidden and must not be converted. The new objects are converted as any
+ * other object and are deleted with the scene.
+ * \param cellSize The size of the grid cells, 0 to use a single cell.
+ * \param batchedObjects Set filled with the merged objects.
+ * \return The new objects.
+ */
+std::vector<BL_StaticBatch> BL_BatchStaticObjects(KX_Scene *kxscene,
+                                                  float cellSize,
+                                                  std::set<Object *> &batchedObjects);
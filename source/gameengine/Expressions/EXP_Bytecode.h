@@ -0,0 +1,156 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_Bytecode.h
+ *  \ingroup expressions
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+
+#include "EXP_IntValue.h"
+
+class EXP_Expression;
+
+/** Unboxed value stored in a bytecode register.
+ * Only the types the interpreter can handle without allocation are represented,
+ * strings are referenced and never copied.
+ */
+struct EXP_BytecodeValue {
+  VALUE_DATA_TYPE m_type;
+  union {
+    bool m_bool;
+    cInt m_int;
+    float m_float;
+    const std::string *m_string;
+  };
+
+  /// Same as EXP_Value::GetNumber() for the boxed equivalent.
+  double GetNumber() const;
+
+  /** Unbox an expression value.
+   * \return False if the value type is not supported by the interpreter.
+   */
+  static bool FromValue(EXP_Value *value, EXP_BytecodeValue &result);
+};
+
+/** Source of an identifier value resolved once at compile time, replacing
+ * the lookup by name done by EXP_IdentifierExpr for each evaluation.
+ */
+class EXP_BytecodeSlot {
+ public:
+  virtual ~EXP_BytecodeSlot() = default;
+
+  /** Read the current value of the identifier.
+   * \return False if the value can't be produced, the caller must then fallback on
+   * the expression tree evaluation.
+   */
+  virtual bool Load(EXP_BytecodeValue &value) = 0;
+};
+
+/// Slot reading a property of a value, the property is looked up again only when the owner properties changed.
+class EXP_PropertySlot : public EXP_BytecodeSlot {
+ private:
+  EXP_Value *m_owner;
+  std::string m_name;
+  EXP_Value *m_property;
+  unsigned int m_revision;
+
+ public:
+  EXP_PropertySlot(EXP_Value *owner, const std::string &name);
+  virtual ~EXP_PropertySlot() = default;
+
+  virtual bool Load(EXP_BytecodeValue &value);
+};
+
+/** Register based program compiled from an expression tree.
+ *
+ * The program is evaluated without any allocation and produces exactly the same result
+ * as EXP_Expression::Calculate(). Every case producing an error value or a value not
+ * representable in registers (e.g string concatenation) makes Execute() fail, in this case
+ * the caller must evaluate the original expression tree to obtain the error.
+ */
+class EXP_BytecodeProgram {
+ public:
+  enum Opcode : unsigned char {
+    /// dst = constants[a]
+    OP_LOAD_CONST,
+    /// dst = slots[a]
+    OP_LOAD_SLOT,
+    /// dst = op dst
+    OP_UNARY,
+    /// dst = dst op a
+    OP_BINARY,
+    /// if (!dst) goto a
+    OP_JUMP_IF_FALSE,
+    /// goto a
+    OP_JUMP
+  };
+
+  struct Instruction {
+    Opcode m_opcode;
+    VALUE_OPERATOR m_operator;
+    unsigned short m_dst;
+    unsigned short m_arg;
+  };
+
+  /// Maximum number of registers used by a program, deeper expressions are not compiled.
+  static const unsigned short MAX_REGISTERS = 32;
+
+ private:
+  std::vector<Instruction> m_instructions;
+  std::vector<EXP_BytecodeValue> m_constants;
+  std::vector<std::unique_ptr<EXP_BytecodeSlot>> m_slots;
+  /// Storage of the string constants, a deque to keep the pointers valid.
+  std::deque<std::string> m_strings;
+
+  /// Compile expr to write its result in register dst, return false if expr is not supported.
+  bool CompileNode(EXP_Expression *expr, unsigned short dst);
+  /// Try to evaluate expr at compile time, return false if expr isn't constant.
+  bool FoldConstant(EXP_Expression *expr, EXP_BytecodeValue &result);
+  bool AddConstant(EXP_Value *value, EXP_BytecodeValue &result);
+  void Emit(Opcode opcode, VALUE_OPERATOR op, unsigned short dst, unsigned short arg);
+
+ public:
+  EXP_BytecodeProgram() = default;
+  ~EXP_BytecodeProgram() = default;
+
+  /** Compile an expression tree.
+   * \return nullptr if the expression contains constructs not supported by the interpreter.
+   */
+  static std::unique_ptr<EXP_BytecodeProgram> Compile(EXP_Expression *expr);
+
+  /** Evaluate the program.
+   * \return False if the evaluation must be done by the expression tree.
+   */
+  bool Execute(EXP_BytecodeValue &result);
+
+  /// Apply an unary operator with the semantic of EXP_Operator1Expr.
+  static bool ApplyUnary(VALUE_OPERATOR op, const EXP_BytecodeValue &val, EXP_BytecodeValue &result);
+  /// Apply a binary operator with the semantic of EXP_Value::Calc.
+  static bool ApplyBinary(VALUE_OPERATOR op,
+                          const EXP_BytecodeValue &lhs,
+                          const EXP_BytecodeValue &rhs,
+                          EXP_BytecodeValue &result);
+};
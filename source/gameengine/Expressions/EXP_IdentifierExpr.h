@@ -44,4 +44,7 @@ class EXP_IdentifierExpr : public EXP_Expression {
 
   virtual EXP_Value *Calculate();
   virtual unsigned char GetExpressionID();
+
+  const std::string &GetIdentifier() const;
+  EXP_Value *GetContext() const;
 };
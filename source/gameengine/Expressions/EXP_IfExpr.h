@@ -33,4 +33,8 @@ class EXP_IfExpr : public EXP_Expression {
 
   virtual unsigned char GetExpressionID();
   virtual EXP_Value *Calculate();
+
+  EXP_Expression *GetGuard() const;
+  EXP_Expression *GetTrueExpr() const;
+  EXP_Expression *GetFalseExpr() const;
 };
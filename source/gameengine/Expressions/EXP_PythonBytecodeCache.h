@@ -0,0 +1,48 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file EXP_PythonBytecodeCache.h
+ *  \ingroup expressions
+ *  \brief Cache of the code objects compiled from the game scripts.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "EXP_Python.h"
+
+/** Set the directory where the compiled scripts are stored between sessions.
+ * \param path The cache directory, created if missing, empty to only cache during the session.
+ */
+void EXP_SetPythonBytecodeCacheDirectory(const std::string &path);
+
+/** Compile a script or return the code object already compiled for the same text and filename.
+ * The code objects are shared during the session and stored in the cache directory, keyed by
+ * the hash of the text and the filename and the python version.
+ * \return A new reference to the code object or nullptr with a python error set.
+ */
+PyObject *EXP_CompilePythonScript(const std::string &text, const std::string &filename);
+
+/// Release the code objects compiled during the session, python must still be initialized.
+void EXP_ClearPythonBytecodeCache();
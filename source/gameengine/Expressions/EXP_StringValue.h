@@ -31,6 +31,8 @@ class EXP_StringValue : public EXP_PropValue {
   /// EXP_Value implementation
   virtual bool IsEqual(const std::string &other);
   virtual std::string GetText();
+  /// Return the string without copy.
+  const std::string &GetString() const;
   virtual double GetNumber();
   virtual int GetValueType();
 
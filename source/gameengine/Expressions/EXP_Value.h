@@ -26,8 +26,11 @@
 #include <string>  // std::string class.
 #include <vector>
 
+#include "CM_Memory.h"
 #include "CM_RefCount.h"
 
+class EXP_BytecodeSlot;
+
 #ifndef GEN_NO_TRACE
 #  undef trace
 #  define trace(exp) ((void)nullptr)
@@ -142,6 +145,12 @@ class EXP_Value : public EXP_PyObjectPlus, public CM_RefCount<EXP_Value> {
   virtual int GetPropertyCount();
 
   virtual EXP_Value *FindIdentifier(const std::string &identifiername);
+  /** Return a slot reading the identifier value without any lookup by name, used by
+   * the expression bytecode. Return nullptr if the identifier can't be resolved statically.
+   */
+  virtual EXP_BytecodeSlot *FindIdentifierSlot(const std::string &identifiername);
+  /// Return a counter incremented each time a property is added, replaced or removed.
+  unsigned int GetPropertiesRevision() const;
 
   virtual std::string GetText();
   virtual double GetNumber();
@@ -169,6 +178,9 @@ class EXP_Value : public EXP_PyObjectPlus, public CM_RefCount<EXP_Value> {
  private:
   /// Properties for user/game etc.
   std::map<std::string, EXP_Value *> m_properties;
+  unsigned int m_propertiesRevision;
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_EXPRESSIONS, "EXP_Value")
 };
 
 /** EXP_PropValue is a EXP_Value derived class, that implements the identification (String name)
@@ -0,0 +1,726 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/intern/Bytecode.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_Bytecode.h"
+
+#include <cmath>
+
+#include "EXP_BoolValue.h"
+#include "EXP_ConstExpr.h"
+#include "EXP_FloatValue.h"
+#include "EXP_IdentifierExpr.h"
+#include "EXP_IfExpr.h"
+#include "EXP_Operator1Expr.h"
+#include "EXP_Operator2Expr.h"
+#include "EXP_StringValue.h"
+
+double EXP_BytecodeValue::GetNumber() const
+{
+  switch (m_type) {
+    case VALUE_INT_TYPE: {
+      return (double)m_int;
+    }
+    case VALUE_FLOAT_TYPE: {
+      return m_float;
+    }
+    case VALUE_BOOL_TYPE: {
+      return (double)m_bool;
+    }
+    case VALUE_STRING_TYPE: {
+      return -1.0;
+    }
+    default: {
+      return 0.0;
+    }
+  }
+}
+
+bool EXP_BytecodeValue::FromValue(EXP_Value *value, EXP_BytecodeValue &result)
+{
+  switch (value->GetValueType()) {
+    case VALUE_INT_TYPE: {
+      result.m_type = VALUE_INT_TYPE;
+      result.m_int = static_cast<EXP_IntValue *>(value)->GetInt();
+      return true;
+    }
+    case VALUE_FLOAT_TYPE: {
+      result.m_type = VALUE_FLOAT_TYPE;
+      result.m_float = static_cast<EXP_FloatValue *>(value)->GetFloat();
+      return true;
+    }
+    case VALUE_BOOL_TYPE: {
+      result.m_type = VALUE_BOOL_TYPE;
+      result.m_bool = static_cast<EXP_BoolValue *>(value)->GetBool();
+      return true;
+    }
+    case VALUE_STRING_TYPE: {
+      result.m_type = VALUE_STRING_TYPE;
+      result.m_string = &static_cast<EXP_StringValue *>(value)->GetString();
+      return true;
+    }
+    case VALUE_EMPTY_TYPE: {
+      result.m_type = VALUE_EMPTY_TYPE;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+EXP_PropertySlot::EXP_PropertySlot(EXP_Value *owner, const std::string &name)
+    : m_owner(owner), m_name(name), m_property(nullptr), m_revision(owner->GetPropertiesRevision())
+{
+  m_property = m_owner->GetProperty(m_name);
+}
+
+bool EXP_PropertySlot::Load(EXP_BytecodeValue &value)
+{
+  // Lookup the property by name only when it could have been replaced or removed.
+  const unsigned int revision = m_owner->GetPropertiesRevision();
+  if (revision != m_revision) {
+    m_property = m_owner->GetProperty(m_name);
+    m_revision = revision;
+  }
+
+  if (!m_property) {
+    return false;
+  }
+
+  return EXP_BytecodeValue::FromValue(m_property, value);
+}
+
+void EXP_BytecodeProgram::Emit(Opcode opcode,
+                               VALUE_OPERATOR op,
+                               unsigned short dst,
+                               unsigned short arg)
+{
+  m_instructions.push_back({opcode, op, dst, arg});
+}
+
+bool EXP_BytecodeProgram::AddConstant(EXP_Value *value, EXP_BytecodeValue &result)
+{
+  if (!EXP_BytecodeValue::FromValue(value, result)) {
+    return false;
+  }
+
+  // The program must not depend on the lifetime of the expression tree.
+  if (result.m_type == VALUE_STRING_TYPE) {
+    m_strings.push_back(*result.m_string);
+    result.m_string = &m_strings.back();
+  }
+
+  return true;
+}
+
+bool EXP_BytecodeProgram::FoldConstant(EXP_Expression *expr, EXP_BytecodeValue &result)
+{
+  switch (expr->GetExpressionID()) {
+    case EXP_Expression::CCONSTEXPRESSIONID: {
+      return AddConstant(static_cast<EXP_ConstExpr *>(expr)->GetValue(), result);
+    }
+    case EXP_Expression::COPERATOR1EXPRESSIONID: {
+      EXP_Operator1Expr *op1expr = static_cast<EXP_Operator1Expr *>(expr);
+      EXP_BytecodeValue val;
+      if (!FoldConstant(op1expr->GetOperand(), val)) {
+        return false;
+      }
+      return ApplyUnary(op1expr->GetOperator(), val, result);
+    }
+    case EXP_Expression::COPERATOR2EXPRESSIONID: {
+      EXP_Operator2Expr *op2expr = static_cast<EXP_Operator2Expr *>(expr);
+      EXP_BytecodeValue lhs;
+      EXP_BytecodeValue rhs;
+      if (!FoldConstant(op2expr->GetLhs(), lhs) || !FoldConstant(op2expr->GetRhs(), rhs)) {
+        return false;
+      }
+      return ApplyBinary(op2expr->GetOperator(), lhs, rhs, result);
+    }
+    case EXP_Expression::CIFEXPRESSIONID: {
+      // Only the selected branch is evaluated by EXP_IfExpr, the other can be anything.
+      EXP_IfExpr *ifexpr = static_cast<EXP_IfExpr *>(expr);
+      EXP_BytecodeValue guard;
+      if (!FoldConstant(ifexpr->GetGuard(), guard) || guard.m_type != VALUE_BOOL_TYPE) {
+        return false;
+      }
+      return FoldConstant(guard.m_bool ? ifexpr->GetTrueExpr() : ifexpr->GetFalseExpr(), result);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+bool EXP_BytecodeProgram::CompileNode(EXP_Expression *expr, unsigned short dst)
+{
+  if (dst >= MAX_REGISTERS) {
+    return false;
+  }
+
+  EXP_BytecodeValue constant;
+  if (FoldConstant(expr, constant)) {
+    m_constants.push_back(constant);
+    Emit(OP_LOAD_CONST, VALUE_NO_OPERATOR, dst, m_constants.size() - 1);
+    return true;
+  }
+
+  switch (expr->GetExpressionID()) {
+    case EXP_Expression::CIDENTIFIEREXPRESSIONID: {
+      EXP_IdentifierExpr *idexpr = static_cast<EXP_IdentifierExpr *>(expr);
+      EXP_Value *context = idexpr->GetContext();
+      if (!context) {
+        return false;
+      }
+
+      EXP_BytecodeSlot *slot = context->FindIdentifierSlot(idexpr->GetIdentifier());
+      if (!slot) {
+        return false;
+      }
+
+      m_slots.emplace_back(slot);
+      Emit(OP_LOAD_SLOT, VALUE_NO_OPERATOR, dst, m_slots.size() - 1);
+      return true;
+    }
+    case EXP_Expression::COPERATOR1EXPRESSIONID: {
+      EXP_Operator1Expr *op1expr = static_cast<EXP_Operator1Expr *>(expr);
+      if (!CompileNode(op1expr->GetOperand(), dst)) {
+        return false;
+      }
+
+      Emit(OP_UNARY, op1expr->GetOperator(), dst, 0);
+      return true;
+    }
+    case EXP_Expression::COPERATOR2EXPRESSIONID: {
+      EXP_Operator2Expr *op2expr = static_cast<EXP_Operator2Expr *>(expr);
+      // Both operands are always evaluated as in EXP_Operator2Expr, the errors must be reported.
+      if (!CompileNode(op2expr->GetLhs(), dst) || !CompileNode(op2expr->GetRhs(), dst + 1)) {
+        return false;
+      }
+
+      Emit(OP_BINARY, op2expr->GetOperator(), dst, dst + 1);
+      return true;
+    }
+    case EXP_Expression::CIFEXPRESSIONID: {
+      EXP_IfExpr *ifexpr = static_cast<EXP_IfExpr *>(expr);
+      if (!CompileNode(ifexpr->GetGuard(), dst)) {
+        return false;
+      }
+
+      const unsigned int jumpfalse = m_instructions.size();
+      Emit(OP_JUMP_IF_FALSE, VALUE_NO_OPERATOR, dst, 0);
+
+      if (!CompileNode(ifexpr->GetTrueExpr(), dst)) {
+        return false;
+      }
+
+      const unsigned int jumpend = m_instructions.size();
+      Emit(OP_JUMP, VALUE_NO_OPERATOR, dst, 0);
+      m_instructions[jumpfalse].m_arg = m_instructions.size();
+
+      if (!CompileNode(ifexpr->GetFalseExpr(), dst)) {
+        return false;
+      }
+
+      m_instructions[jumpend].m_arg = m_instructions.size();
+      return true;
+    }
+    default: {
+      // Constant not representable in registers (e.g error value).
+      return false;
+    }
+  }
+}
+
+std::unique_ptr<EXP_BytecodeProgram> EXP_BytecodeProgram::Compile(EXP_Expression *expr)
+{
+  std::unique_ptr<EXP_BytecodeProgram> program(new EXP_BytecodeProgram());
+  if (!program->CompileNode(expr, 0)) {
+    return nullptr;
+  }
+
+  return program;
+}
+
+bool EXP_BytecodeProgram::Execute(EXP_BytecodeValue &result)
+{
+  EXP_BytecodeValue registers[MAX_REGISTERS];
+
+  const unsigned int size = m_instructions.size();
+  unsigned int pc = 0;
+  while (pc < size) {
+    const Instruction &inst = m_instructions[pc++];
+    EXP_BytecodeValue &dst = registers[inst.m_dst];
+
+    switch (inst.m_opcode) {
+      case OP_LOAD_CONST: {
+        dst = m_constants[inst.m_arg];
+        break;
+      }
+      case OP_LOAD_SLOT: {
+        if (!m_slots[inst.m_arg]->Load(dst)) {
+          return false;
+        }
+        break;
+      }
+      case OP_UNARY: {
+        const EXP_BytecodeValue val = dst;
+        if (!ApplyUnary(inst.m_operator, val, dst)) {
+          return false;
+        }
+        break;
+      }
+      case OP_BINARY: {
+        const EXP_BytecodeValue lhs = dst;
+        if (!ApplyBinary(inst.m_operator, lhs, registers[inst.m_arg], dst)) {
+          return false;
+        }
+        break;
+      }
+      case OP_JUMP_IF_FALSE: {
+        // EXP_IfExpr compares the text of the guard value.
+        bool guard;
+        if (dst.m_type == VALUE_BOOL_TYPE) {
+          guard = dst.m_bool;
+        }
+        else if (dst.m_type == VALUE_STRING_TYPE && *dst.m_string == EXP_BoolValue::sTrueString) {
+          guard = true;
+        }
+        else if (dst.m_type == VALUE_STRING_TYPE && *dst.m_string == EXP_BoolValue::sFalseString) {
+          guard = false;
+        }
+        else {
+          return false;
+        }
+
+        if (!guard) {
+          pc = inst.m_arg;
+        }
+        break;
+      }
+      case OP_JUMP: {
+        pc = inst.m_arg;
+        break;
+      }
+    }
+  }
+
+  result = registers[0];
+  return true;
+}
+
+bool EXP_BytecodeProgram::ApplyUnary(VALUE_OPERATOR op,
+                                     const EXP_BytecodeValue &val,
+                                     EXP_BytecodeValue &result)
+{
+  /* EXP_Operator1Expr calls val->CalcFinal(VALUE_EMPTY_TYPE, op, empty),
+   * only the operators supported by the CalcFinal of each type are accepted. */
+  switch (val.m_type) {
+    case VALUE_INT_TYPE: {
+      switch (op) {
+        case VALUE_POS_OPERATOR: {
+          result.m_type = VALUE_INT_TYPE;
+          result.m_int = val.m_int;
+          return true;
+        }
+        case VALUE_NEG_OPERATOR: {
+          result.m_type = VALUE_INT_TYPE;
+          result.m_int = -val.m_int;
+          return true;
+        }
+        case VALUE_NOT_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (val.m_int == 0);
+          return true;
+        }
+        default: {
+          return false;
+        }
+      }
+    }
+    case VALUE_FLOAT_TYPE: {
+      switch (op) {
+        case VALUE_POS_OPERATOR: {
+          result.m_type = VALUE_FLOAT_TYPE;
+          result.m_float = val.m_float;
+          return true;
+        }
+        case VALUE_NEG_OPERATOR: {
+          result.m_type = VALUE_FLOAT_TYPE;
+          result.m_float = -val.m_float;
+          return true;
+        }
+        case VALUE_NOT_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (val.m_float == 0);
+          return true;
+        }
+        default: {
+          return false;
+        }
+      }
+    }
+    case VALUE_BOOL_TYPE: {
+      if (op == VALUE_NOT_OPERATOR) {
+        result.m_type = VALUE_BOOL_TYPE;
+        result.m_bool = !val.m_bool;
+        return true;
+      }
+      return false;
+    }
+    case VALUE_EMPTY_TYPE: {
+      // EXP_EmptyValue::CalcFinal returns the empty operand.
+      result.m_type = VALUE_EMPTY_TYPE;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+bool EXP_BytecodeProgram::ApplyBinary(VALUE_OPERATOR op,
+                                      const EXP_BytecodeValue &lhs,
+                                      const EXP_BytecodeValue &rhs,
+                                      EXP_BytecodeValue &result)
+{
+  /* lhs->Calc(op, rhs) intercepts some operators and then
+   * calls rhs->CalcFinal(lhs type, op, lhs). */
+  switch (lhs.m_type) {
+    case VALUE_INT_TYPE:
+    case VALUE_FLOAT_TYPE: {
+      if (op == VALUE_AND_OPERATOR || op == VALUE_OR_OPERATOR) {
+        return false;
+      }
+      break;
+    }
+    case VALUE_BOOL_TYPE:
+    case VALUE_STRING_TYPE: {
+      break;
+    }
+    default: {
+      // EXP_EmptyValue::Calc expects the right operand to handle an empty value.
+      return false;
+    }
+  }
+
+  switch (rhs.m_type) {
+    case VALUE_INT_TYPE: {
+      const cInt r = rhs.m_int;
+      if (lhs.m_type == VALUE_INT_TYPE) {
+        const cInt l = lhs.m_int;
+        switch (op) {
+          case VALUE_MOD_OPERATOR: {
+            if (r == 0) {
+              return false;
+            }
+            result.m_type = VALUE_INT_TYPE;
+            result.m_int = l % r;
+            return true;
+          }
+          case VALUE_ADD_OPERATOR: {
+            result.m_type = VALUE_INT_TYPE;
+            result.m_int = l + r;
+            return true;
+          }
+          case VALUE_SUB_OPERATOR: {
+            result.m_type = VALUE_INT_TYPE;
+            result.m_int = l - r;
+            return true;
+          }
+          case VALUE_MUL_OPERATOR: {
+            result.m_type = VALUE_INT_TYPE;
+            result.m_int = l * r;
+            return true;
+          }
+          case VALUE_DIV_OPERATOR: {
+            if (r == 0) {
+              return false;
+            }
+            result.m_type = VALUE_INT_TYPE;
+            result.m_int = l / r;
+            return true;
+          }
+          case VALUE_EQL_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l == r);
+            return true;
+          }
+          case VALUE_NEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l != r);
+            return true;
+          }
+          case VALUE_GRE_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l > r);
+            return true;
+          }
+          case VALUE_LES_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l < r);
+            return true;
+          }
+          case VALUE_GEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l >= r);
+            return true;
+          }
+          case VALUE_LEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l <= r);
+            return true;
+          }
+          default: {
+            return false;
+          }
+        }
+      }
+      else if (lhs.m_type == VALUE_FLOAT_TYPE) {
+        const float l = lhs.m_float;
+        switch (op) {
+          case VALUE_MOD_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = std::fmod(l, r);
+            return true;
+          }
+          case VALUE_ADD_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = l + r;
+            return true;
+          }
+          case VALUE_SUB_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = l - r;
+            return true;
+          }
+          case VALUE_MUL_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = l * r;
+            return true;
+          }
+          case VALUE_DIV_OPERATOR: {
+            if (r == 0) {
+              return false;
+            }
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = l / r;
+            return true;
+          }
+          case VALUE_EQL_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l == r);
+            return true;
+          }
+          case VALUE_NEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l != r);
+            return true;
+          }
+          case VALUE_GRE_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l > r);
+            return true;
+          }
+          case VALUE_LES_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l < r);
+            return true;
+          }
+          case VALUE_GEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l >= r);
+            return true;
+          }
+          case VALUE_LEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = (l <= r);
+            return true;
+          }
+          default: {
+            return false;
+          }
+        }
+      }
+      // String concatenation or error.
+      return false;
+    }
+    case VALUE_FLOAT_TYPE: {
+      const float r = rhs.m_float;
+      if (lhs.m_type == VALUE_INT_TYPE || lhs.m_type == VALUE_FLOAT_TYPE) {
+        /* Keep the same conversions as EXP_FloatValue::CalcFinal, the integer
+         * is converted to float for the arithmetic and the comparisons. */
+        const bool isint = (lhs.m_type == VALUE_INT_TYPE);
+        const cInt li = lhs.m_int;
+        const float lf = lhs.m_float;
+        switch (op) {
+          case VALUE_MOD_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = isint ? std::fmod(li, r) : std::fmod(lf, r);
+            return true;
+          }
+          case VALUE_ADD_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = isint ? li + r : lf + r;
+            return true;
+          }
+          case VALUE_SUB_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = isint ? li - r : lf - r;
+            return true;
+          }
+          case VALUE_MUL_OPERATOR: {
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = isint ? li * r : lf * r;
+            return true;
+          }
+          case VALUE_DIV_OPERATOR: {
+            if (r == 0) {
+              return false;
+            }
+            result.m_type = VALUE_FLOAT_TYPE;
+            result.m_float = isint ? li / r : lf / r;
+            return true;
+          }
+          case VALUE_EQL_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = isint ? (li == r) : (lf == r);
+            return true;
+          }
+          case VALUE_NEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = isint ? (li != r) : (lf != r);
+            return true;
+          }
+          case VALUE_GRE_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = isint ? (li > r) : (lf > r);
+            return true;
+          }
+          case VALUE_LES_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = isint ? (li < r) : (lf < r);
+            return true;
+          }
+          case VALUE_GEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = isint ? (li >= r) : (lf >= r);
+            return true;
+          }
+          case VALUE_LEQ_OPERATOR: {
+            result.m_type = VALUE_BOOL_TYPE;
+            result.m_bool = isint ? (li <= r) : (lf <= r);
+            return true;
+          }
+          default: {
+            return false;
+          }
+        }
+      }
+      return false;
+    }
+    case VALUE_BOOL_TYPE: {
+      if (lhs.m_type != VALUE_BOOL_TYPE) {
+        return false;
+      }
+      switch (op) {
+        case VALUE_AND_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (lhs.m_bool && rhs.m_bool);
+          return true;
+        }
+        case VALUE_OR_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (lhs.m_bool || rhs.m_bool);
+          return true;
+        }
+        case VALUE_EQL_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (lhs.m_bool == rhs.m_bool);
+          return true;
+        }
+        case VALUE_NEQ_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (lhs.m_bool != rhs.m_bool);
+          return true;
+        }
+        default: {
+          return false;
+        }
+      }
+    }
+    case VALUE_STRING_TYPE: {
+      // Concatenation allocates a new string, let the expression tree do it.
+      if (lhs.m_type != VALUE_STRING_TYPE) {
+        return false;
+      }
+      const std::string &l = *lhs.m_string;
+      const std::string &r = *rhs.m_string;
+      switch (op) {
+        case VALUE_EQL_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (l == r);
+          return true;
+        }
+        case VALUE_NEQ_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (l != r);
+          return true;
+        }
+        case VALUE_GRE_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (l > r);
+          return true;
+        }
+        case VALUE_LES_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (l < r);
+          return true;
+        }
+        case VALUE_GEQ_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (l >= r);
+          return true;
+        }
+        case VALUE_LEQ_OPERATOR: {
+          result.m_type = VALUE_BOOL_TYPE;
+          result.m_bool = (l <= r);
+          return true;
+        }
+        default: {
+          return false;
+        }
+      }
+    }
+    case VALUE_EMPTY_TYPE: {
+      // EXP_EmptyValue::CalcFinal returns the left operand.
+      result = lhs;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
@@ -44,6 +44,11 @@ EXP_Value *EXP_ConstExpr::Calculate()
   return m_value->AddRef();
 }
 
+EXP_Value *EXP_ConstExpr::GetValue() const
+{
+  return m_value;
+}
+
 double EXP_ConstExpr::GetNumber()
 {
   return -1.0;
@@ -63,3 +63,13 @@ unsigned char EXP_IdentifierExpr::GetExpressionID()
 {
   return CIDENTIFIEREXPRESSIONID;
 }
+
+const std::string &EXP_IdentifierExpr::GetIdentifier() const
+{
+  return m_identifier;
+}
+
+EXP_Value *EXP_IdentifierExpr::GetContext() const
+{
+  return m_idContext;
+}
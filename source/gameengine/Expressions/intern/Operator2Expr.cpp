@@ -54,3 +54,18 @@ EXP_Value *EXP_Operator2Expr::Calculate()
 
   return calculate;
 }
+
+VALUE_OPERATOR EXP_Operator2Expr::GetOperator() const
+{
+  return m_op;
+}
+
+EXP_Expression *EXP_Operator2Expr::GetLhs() const
+{
+  return m_lhs;
+}
+
+EXP_Expression *EXP_Operator2Expr::GetRhs() const
+{
+  return m_rhs;
+}
@@ -0,0 +1,174 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file gameengine/Expressions/intern/PythonBytecodeCache.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_PythonBytecodeCache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include <marshal.h>
+
+#include "BLI_fileops.h"
+#include "BLI_hash_md5.hh"
+#include "BLI_path_util.h"
+#include "BLI_utildefines.h"
+#include "MEM_guardedalloc.h"
+
+#include "CM_Message.h"
+#include "CM_Utils.h"
+
+/// Suffix of the cache files, the compiled code is only valid for one python version.
+#define CACHE_FILE_SUFFIX \
+  ".cpython-" STRINGIFY(PY_MAJOR_VERSION) STRINGIFY(PY_MINOR_VERSION) ".pyc"
+
+static std::string cacheDirectory;
+/// Code objects compiled during the session by key.
+static std::unordered_map<std::string, PyObject *> cachedCodes;
+
+static std::string GetCacheKey(const std::string &text, const std::string &filename)
+{
+  const std::string data = filename + '\0' + text;
+  unsigned char digest[16];
+  BLI_hash_md5_buffer(data.data(), data.size(), digest);
+
+  char hexdigest[33];
+  BLI_hash_md5_to_hexdigest(digest, hexdigest);
+  return hexdigest;
+}
+
+static PyObject *ReadCacheFile(const std::string &path)
+{
+  size_t size;
+  char *data = (char *)BLI_file_read_binary_as_mem(path.c_str(), 0, &size);
+  if (!data) {
+    return nullptr;
+  }
+
+  PyObject *code = nullptr;
+  uint32_t magic;
+  if (size > sizeof(magic)) {
+    memcpy(&magic, data, sizeof(magic));
+    if (magic == (uint32_t)PyImport_GetMagicNumber()) {
+      code = PyMarshal_ReadObjectFromString(data + sizeof(magic), size - sizeof(magic));
+    }
+  }
+  MEM_freeN(data);
+
+  // Corrupted or outdated file, compile the script again.
+  if (!code || !PyCode_Check(code)) {
+    Py_XDECREF(code);
+    PyErr_Clear();
+    return nullptr;
+  }
+
+  return code;
+}
+
+static void WriteCacheFile(const std::string &path, PyObject *code)
+{
+  PyObject *data = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
+  if (!data) {
+    PyErr_Clear();
+    return;
+  }
+
+  // Write in a temporary file to never leave a partial cache file, its name is unique as
+  // several threads or game engine instances can write the same cache file.
+  const std::string tmppath = CM_UniqueTemporaryPath(path);
+  FILE *file = BLI_fopen(tmppath.c_str(), "wb");
+  if (file) {
+    const uint32_t magic = PyImport_GetMagicNumber();
+    const size_t size = PyBytes_GET_SIZE(data);
+    const bool written = fwrite(&magic, sizeof(magic), 1, file) == 1 &&
+                         fwrite(PyBytes_AS_STRING(data), 1, size, file) == size;
+    fclose(file);
+
+    if (!written || BLI_rename_overwrite(tmppath.c_str(), path.c_str()) != 0) {
+      CM_Warning("failed to write python bytecode cache file: " << path);
+      BLI_delete(tmppath.c_str(), false, false);
+    }
+  }
+
+  Py_DECREF(data);
+}
+
+void EXP_SetPythonBytecodeCacheDirectory(const std::string &path)
+{
+  cacheDirectory.clear();
+  if (path.empty()) {
+    return;
+  }
+
+  if (!BLI_is_dir(path.c_str()) && !BLI_dir_create_recursive(path.c_str())) {
+    CM_Warning("python bytecode cache directory can't be created: " << path);
+    return;
+  }
+
+  cacheDirectory = path;
+}
+
+PyObject *EXP_CompilePythonScript(const std::string &text, const std::string &filename)
+{
+  const std::string key = GetCacheKey(text, filename);
+
+  const auto it = cachedCodes.find(key);
+  if (it != cachedCodes.end()) {
+    Py_INCREF(it->second);
+    return it->second;
+  }
+
+  std::string path;
+  PyObject *code = nullptr;
+  if (!cacheDirectory.empty()) {
+    path = cacheDirectory + SEP_STR + key + CACHE_FILE_SUFFIX;
+    code = ReadCacheFile(path);
+  }
+
+  if (!code) {
+    code = Py_CompileString(text.c_str(), filename.c_str(), Py_file_input);
+    if (!code) {
+      return nullptr;
+    }
+
+    if (!path.empty()) {
+      WriteCacheFile(path, code);
+    }
+  }
+
+  cachedCodes.emplace(key, code);
+  Py_INCREF(code);
+  return code;
+}
+
+void EXP_ClearPythonBytecodeCache()
+{
+  for (const auto &pair : cachedCodes) {
+    Py_DECREF(pair.second);
+  }
+  cachedCodes.clear();
+}
@@ -108,6 +108,11 @@ std::string EXP_StringValue::GetText()
   return m_strString;
 }
 
+const std::string &EXP_StringValue::GetString() const
+{
+  return m_strString;
+}
+
 bool EXP_StringValue::IsEqual(const std::string &other)
 {
   return (m_strString == other);
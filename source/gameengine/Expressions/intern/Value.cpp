@@ -21,6 +21,7 @@
 #include "EXP_Value.h"
 
 #include "EXP_BoolValue.h"
+#include "EXP_Bytecode.h"
 #include "EXP_ErrorValue.h"
 #include "EXP_FloatValue.h"
 #include "EXP_IntValue.h"
@@ -71,7 +72,7 @@ PyMethodDef EXP_Value::Methods[] = {
 };
 #endif  // WITH_PYTHON
 
-EXP_Value::EXP_Value()
+EXP_Value::EXP_Value() : m_propertiesRevision(0)
 {
 }
 
@@ -162,6 +163,7 @@ void EXP_Value::SetProperty(const std::string &name, EXP_Value *ioProperty)
 
   // Add property at end of array.
   m_properties[name] = ioProperty->AddRef();
+  ++m_propertiesRevision;
 }
 
 /// Get pointer to a property with name <inName>, returns nullptr if there is no property named
@@ -207,6 +209,7 @@ bool EXP_Value::RemoveProperty(const std::string &inName)
   if (it != m_properties.end()) {
     (*it).second->Release();
     m_properties.erase(it);
+    ++m_propertiesRevision;
     return true;
   }
 
@@ -236,6 +239,7 @@ void EXP_Value::ClearProperties()
 
   // Delete property array.
   m_properties.clear();
+  ++m_propertiesRevision;
 }
 
 /// Get property number <inIndex>.
@@ -307,6 +311,21 @@ EXP_Value *EXP_Value::FindIdentifier(const std::string &identifiername)
   return result;
 }
 
+EXP_BytecodeSlot *EXP_Value::FindIdentifierSlot(const std::string &identifiername)
+{
+  // Sub contexts can be replaced at any time, let the expression tree resolve them.
+  if (identifiername.find('.') != std::string::npos) {
+    return nullptr;
+  }
+
+  return new EXP_PropertySlot(this, identifiername);
+}
+
+unsigned int EXP_Value::GetPropertiesRevision() const
+{
+  return m_propertiesRevision;
+}
+
 #ifdef WITH_PYTHON
 
 PyAttributeDef EXP_Value::Attributes[] = {
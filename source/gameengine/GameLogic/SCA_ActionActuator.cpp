@@ -35,7 +35,10 @@
 
 #include "BL_ActionManager.h"
 #include "BL_ArmatureObject.h"
+#include "BL_Converter.h"
 #include "EXP_FloatValue.h"
+#include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
 
 SCA_ActionActuator::SCA_ActionActuator(SCA_IObject *gameobj,
                                        const std::string &propname,
@@ -385,6 +388,12 @@ int SCA_ActionActuator::pyattr_set_action(EXP_PyObjectPlus *self_v,
     }
   }
 
+  if (action) {
+    KX_GameObject *gameobj = (KX_GameObject *)self->GetParent();
+    KX_GetActiveEngine()->GetConverter()->RegisterLibraryUser(
+        gameobj->GetScene(), gameobj, &action->id);
+  }
+
   self->SetAction(action);
   return PY_SET_ATTR_SUCCESS;
 }
@@ -35,10 +35,38 @@
 #include "SCA_ExpressionController.h"
 
 #include "CM_Message.h"
+#include "EXP_Bytecode.h"
 #include "EXP_InputParser.h"
 #include "SCA_ISensor.h"
 #include "SCA_LogicManager.h"
 
+/// Slot reading the state of a sensor linked to the controller.
+class SCA_SensorStateSlot : public EXP_BytecodeSlot {
+ private:
+  SCA_IController *m_controller;
+  SCA_ISensor *m_sensor;
+  unsigned int m_index;
+
+ public:
+  SCA_SensorStateSlot(SCA_IController *controller, SCA_ISensor *sensor, unsigned int index)
+      : m_controller(controller), m_sensor(sensor), m_index(index)
+  {
+  }
+
+  virtual bool Load(EXP_BytecodeValue &value)
+  {
+    // The sensor could have been unlinked, in this case the name must be resolved again.
+    const std::vector<SCA_ISensor *> &sensors = m_controller->GetLinkedSensors();
+    if (m_index >= sensors.size() || sensors[m_index] != m_sensor) {
+      return false;
+    }
+
+    value.m_type = VALUE_BOOL_TYPE;
+    value.m_bool = m_sensor->GetState();
+    return true;
+  }
+};
+
 /* ------------------------------------------------------------------------- */
 /* Native functions                                                          */
 /* ------------------------------------------------------------------------- */
@@ -49,6 +77,11 @@ SCA_ExpressionController::SCA_ExpressionController(SCA_IObject *gameobj,
 {
 }
 
+SCA_ExpressionController::SCA_ExpressionController(const SCA_ExpressionController &other)
+    : SCA_IController(other), m_exprText(other.m_exprText), m_exprCache(nullptr)
+{
+}
+
 SCA_ExpressionController::~SCA_ExpressionController()
 {
   if (m_exprCache)
@@ -70,6 +103,7 @@ EXP_Value *SCA_ExpressionController::GetReplica()
 // Use this function when you know that you won't use the sensor anymore
 void SCA_ExpressionController::Delete()
 {
+  m_program.reset();
   if (m_exprCache) {
     m_exprCache->Release();
     m_exprCache = nullptr;
@@ -85,8 +119,18 @@ void SCA_ExpressionController::Trigger(SCA_LogicManager *logicmgr)
     EXP_Parser parser;
     parser.SetContext(this->AddRef());
     m_exprCache = parser.ProcessText(m_exprText);
+    if (m_exprCache) {
+      m_program = EXP_BytecodeProgram::Compile(m_exprCache);
+    }
   }
-  if (m_exprCache) {
+
+  EXP_BytecodeValue result;
+  if (m_program && m_program->Execute(result)) {
+    const float num = (float)result.GetNumber();
+    expressionresult = !MT_fuzzyZero(num);
+  }
+  // Evaluate the expression tree when the program is not available or to report the errors.
+  else if (m_exprCache) {
     EXP_Value *value = m_exprCache->Calculate();
     if (value) {
       if (value->IsError()) {
@@ -135,3 +179,15 @@ EXP_Value *SCA_ExpressionController::FindIdentifier(const std::string &identifie
 
   return GetParent()->FindIdentifier(identifiername);
 }
+
+EXP_BytecodeSlot *SCA_ExpressionController::FindIdentifierSlot(const std::string &identifiername)
+{
+  for (unsigned int i = 0, size = m_linkedsensors.size(); i < size; ++i) {
+    SCA_ISensor *sensor = m_linkedsensors[i];
+    if (sensor->GetName() == identifiername) {
+      return new SCA_SensorStateSlot(this, sensor, i);
+    }
+  }
+
+  return GetParent()->FindIdentifierSlot(identifiername);
+}
@@ -34,22 +34,29 @@
 
 #pragma once
 
+#include <memory>
+
 #include "SCA_IController.h"
 
 class EXP_Expression;
+class EXP_BytecodeProgram;
 
 class SCA_ExpressionController : public SCA_IController {
   //	Py_Header
   std::string m_exprText;
   EXP_Expression *m_exprCache;
+  /// Compiled version of m_exprCache, nullptr if the expression can't be compiled.
+  std::unique_ptr<EXP_BytecodeProgram> m_program;
 
  public:
   SCA_ExpressionController(SCA_IObject *gameobj, const std::string &exprtext);
 
+  SCA_ExpressionController(const SCA_ExpressionController &other);
   virtual ~SCA_ExpressionController();
   virtual EXP_Value *GetReplica();
   virtual void Trigger(SCA_LogicManager *logicmgr);
   virtual EXP_Value *FindIdentifier(const std::string &identifiername);
+  virtual EXP_BytecodeSlot *FindIdentifierSlot(const std::string &identifiername);
   /**
    *  used to release the expression cache
    *  so that self references are removed before the controller itself is released
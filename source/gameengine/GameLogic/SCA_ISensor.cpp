@@ -411,6 +411,18 @@ PyObject *SCA_ISensor::pyattr_get_triggered(EXP_PyObjectPlus *self_v,
   if (SCA_PythonController::m_sCurrentController) {
     retval = SCA_PythonController::m_sCurrentController->IsTriggered(self);
   }
+  else {
+    // Look for the batched controllers being executed.
+    for (SCA_IController *controller : self->m_linkedcontrollers) {
+      if (controller->GetType() == &SCA_PythonController::Type) {
+        SCA_PythonController *pythonController = static_cast<SCA_PythonController *>(controller);
+        if (pythonController->IsBatchRunning() && pythonController->IsTriggered(self)) {
+          retval = true;
+          break;
+        }
+      }
+    }
+  }
   return PyBool_FromLong(retval);
 }
 
@@ -148,6 +148,10 @@ void SCA_LogicManager::BeginFrame(double curtime, double fixedtime)
       contr->ClrJustActivated();
     }
   }
+
+#ifdef WITH_PYTHON
+  SCA_PythonController::RunBatchedControllers();
+#endif
 }
 
 void SCA_LogicManager::UpdateFrame(double curtime)
@@ -35,6 +35,7 @@
 #include "SCA_PythonController.h"
 
 #ifdef WITH_PYTHON
+#  include "EXP_PythonBytecodeCache.h"
 #  include "compile.h"
 #  include "py_capi_utils.h"
 #endif  // WITH_PYTHON
@@ -43,6 +44,10 @@
 
 // initialize static member variables
 SCA_PythonController *SCA_PythonController::m_sCurrentController = nullptr;
+std::vector<SCA_PythonController *> SCA_PythonController::m_sBatchedControllers;
+
+/// Attribute of the module functions batched with bge.logic.batchedController().
+#define SCA_PYTHON_BATCHED_ATTRIBUTE "_bge_batched"
 
 SCA_PythonController::SCA_PythonController(SCA_IObject *gameobj, int mode)
     : SCA_IController(gameobj),
@@ -53,7 +58,9 @@ SCA_PythonController::SCA_PythonController(SCA_IObject *gameobj, int mode)
       m_function_argc(0),
       m_bModified(true),
       m_debug(false),
-      m_mode(mode)
+      m_mode(mode),
+      m_batched(false),
+      m_batchRunning(false)
 #ifdef WITH_PYTHON
       ,
       m_pythondictionary(nullptr)
@@ -143,7 +150,7 @@ SCA_IActuator *SCA_PythonController::LinkedActuatorFromPy(PyObject *value)
 {
   // for safety, todo: only allow for registered actuators (pointertable)
   // we don't want to crash gameengine/blender by python scripts
-  std::vector<SCA_IActuator *> lacts = m_sCurrentController->GetLinkedActuators();
+  std::vector<SCA_IActuator *> lacts = GetLinkedActuators();
   std::vector<SCA_IActuator *>::iterator it;
 
   if (PyUnicode_Check(value)) {
@@ -172,6 +179,74 @@ SCA_IActuator *SCA_PythonController::LinkedActuatorFromPy(PyObject *value)
 
 const char *SCA_PythonController::sPyGetCurrentController__doc__ = "getCurrentController()";
 
+PyObject *SCA_PythonController::sPyBatchedController(PyObject *self, PyObject *value)
+{
+  if (!PyCallable_Check(value)) {
+    PyErr_SetString(PyExc_TypeError,
+                    "bge.logic.batchedController(function): expected a callable function");
+    return nullptr;
+  }
+
+  if (PyObject_SetAttrString(value, SCA_PYTHON_BATCHED_ATTRIBUTE, Py_True) == -1) {
+    return nullptr;
+  }
+
+  Py_INCREF(value);
+  return value;
+}
+
+const char *SCA_PythonController::sPyBatchedController__doc__ = "batchedController(function)";
+
+void SCA_PythonController::RunBatchedControllers()
+{
+  if (m_sBatchedControllers.empty()) {
+    return;
+  }
+
+  std::vector<SCA_PythonController *> controllers;
+  controllers.swap(m_sBatchedControllers);
+
+  std::vector<SCA_PythonController *> batch;
+  for (unsigned int i = 0, size = controllers.size(); i < size; ++i) {
+    if (!controllers[i]) {
+      continue;
+    }
+
+    // Gather the controllers sharing the function of the first not yet executed controller.
+    PyObject *function = controllers[i]->m_function;
+    batch.clear();
+    for (unsigned int j = i; j < size; ++j) {
+      if (controllers[j] && controllers[j]->m_function == function) {
+        batch.push_back(controllers[j]);
+        controllers[j] = nullptr;
+      }
+    }
+
+    PyObject *list = PyList_New(batch.size());
+    for (unsigned int j = 0, len = batch.size(); j < len; ++j) {
+      PyList_SET_ITEM(list, j, batch[j]->GetProxy());
+      batch[j]->m_batchRunning = true;
+    }
+
+    PyObject *resultobj = PyObject_CallFunctionObjArgs(function, list, nullptr);
+    Py_DECREF(list);
+
+    if (resultobj) {
+      Py_DECREF(resultobj);
+    }
+    else {
+      batch.front()->ErrorPrint("Python script error");
+    }
+
+    for (SCA_PythonController *controller : batch) {
+      controller->m_batchRunning = false;
+      controller->m_triggeredSensors.clear();
+      // Release the reference taken when the controller was queued.
+      controller->Release();
+    }
+  }
+}
+
 PyTypeObject SCA_PythonController::Type = {
     PyVarObject_HEAD_INIT(nullptr, 0) "SCA_PythonController",
     sizeof(EXP_PyObjectPlus_Proxy),
@@ -251,8 +326,8 @@ bool SCA_PythonController::Compile()
     m_bytecode = nullptr;
   }
 
-  // recompile the scripttext into bytecode
-  m_bytecode = Py_CompileString(m_scriptText.c_str(), m_scriptName.c_str(), Py_file_input);
+  // recompile the scripttext into bytecode, shared with the controllers using the same script
+  m_bytecode = EXP_CompilePythonScript(m_scriptText, m_scriptName);
 
   if (m_bytecode) {
     return true;
@@ -331,6 +406,16 @@ bool SCA_PythonController::Import()
     m_function_argc = ((PyCodeObject *)PyFunction_GET_CODE(m_function))->co_argcount;
   }
 
+  m_batched = false;
+  PyObject *batched = PyObject_GetAttrString(m_function, SCA_PYTHON_BATCHED_ATTRIBUTE);
+  if (batched) {
+    m_batched = PyObject_IsTrue(batched) == 1;
+    Py_DECREF(batched);
+  }
+  else {
+    PyErr_Clear();
+  }
+
   if (m_function_argc > 1) {
     Py_DECREF(m_function);
     m_function = nullptr;
@@ -401,6 +486,15 @@ void SCA_PythonController::Trigger(SCA_LogicManager *logicmgr)
       if (!m_function)
         return;
 
+      if (m_batched && m_function_argc == 1) {
+        /* The function is called later with all the controllers sharing it, keep the triggered
+         * sensors until then. The reference ensures the controller is alive at this call. */
+        AddRef();
+        m_sBatchedControllers.push_back(this);
+        m_sCurrentController = nullptr;
+        return;
+      }
+
       PyObject *args = nullptr;
 
       if (m_function_argc == 1) {
@@ -436,7 +530,7 @@ void SCA_PythonController::Trigger(SCA_LogicManager *logicmgr)
 
 PyObject *SCA_PythonController::PyActivate(PyObject *value)
 {
-  if (m_sCurrentController != this) {
+  if (m_sCurrentController != this && !m_batchRunning) {
     PyErr_SetString(PyExc_SystemError, "Cannot activate an actuator from a non-active controller");
     return nullptr;
   }
@@ -451,7 +545,7 @@ PyObject *SCA_PythonController::PyActivate(PyObject *value)
 
 PyObject *SCA_PythonController::PyDeActivate(PyObject *value)
 {
-  if (m_sCurrentController != this) {
+  if (m_sCurrentController != this && !m_batchRunning) {
     PyErr_SetString(PyExc_SystemError,
                     "Cannot deactivate an actuator from a non-active controller");
     return nullptr;
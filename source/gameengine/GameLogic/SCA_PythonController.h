@@ -49,6 +49,13 @@ class SCA_PythonController : public SCA_IController {
   bool m_bModified;
   bool m_debug; /* use with SCA_PYEXEC_MODULE for reloading every logic run */
   int m_mode;
+  /// The module function is called once per frame with the list of its triggered controllers.
+  bool m_batched;
+  /// True while the batch containing the controller is executed.
+  bool m_batchRunning;
+
+  /// Triggered controllers of batched functions waiting for RunBatchedControllers().
+  static std::vector<SCA_PythonController *> m_sBatchedControllers;
 
  protected:
   std::string m_scriptText;
@@ -86,6 +93,10 @@ class SCA_PythonController : public SCA_IController {
     m_triggeredSensors.push_back(sensor);
   }
   bool IsTriggered(class SCA_ISensor *sensor);
+  bool IsBatchRunning() const
+  {
+    return m_batchRunning;
+  }
   bool Compile();
   bool Import();
   void ErrorPrint(const char *error_msg);
@@ -95,7 +106,15 @@ class SCA_PythonController : public SCA_IController {
   static PyObject *sPyGetCurrentController(PyObject *self);
   static const char *sPyAddActiveActuator__doc__;
   static PyObject *sPyAddActiveActuator(PyObject *self, PyObject *args);
-  static SCA_IActuator *LinkedActuatorFromPy(PyObject *value);
+  SCA_IActuator *LinkedActuatorFromPy(PyObject *value);
+
+  /** Call each batched module function once with the list of its controllers triggered since
+   * the last call, done after all the controllers of the frame were triggered.
+   */
+  static void RunBatchedControllers();
+
+  static const char *sPyBatchedController__doc__;
+  static PyObject *sPyBatchedController(PyObject *self, PyObject *value);
 
   EXP_PYMETHOD_O(SCA_PythonController, Activate);
   EXP_PYMETHOD_O(SCA_PythonController, DeActivate);
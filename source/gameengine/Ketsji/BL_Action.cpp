@@ -38,6 +38,7 @@
 #include "RNA_access.hh"
 
 #include "BL_ArmatureObject.h"
+#include "BL_Converter.h"
 #include "BL_IpoConvert.h"
 #include "CM_Message.h"
 
@@ -130,6 +131,8 @@ bool BL_Action::Play(const std::string &name,
     return false;
   }
 
+  KX_GetActiveEngine()->GetConverter()->RegisterLibraryUser(kxscene, m_obj, &m_action->id);
+
   // If we have the same settings, don't play again
   // This is to resolve potential issues with pulses on sensors such as the ones
   // reported in bug #29412. The fix is here so it works for both logic bricks and Python.
@@ -240,6 +243,51 @@ const std::string BL_Action::GetName()
   }
 }
 
+float BL_Action::GetStartFrame() const
+{
+  return m_startframe;
+}
+
+float BL_Action::GetEndFrame() const
+{
+  return m_endframe;
+}
+
+short BL_Action::GetPriority() const
+{
+  return m_priority;
+}
+
+float BL_Action::GetBlendIn() const
+{
+  return m_blendin;
+}
+
+short BL_Action::GetPlayMode() const
+{
+  return m_playmode;
+}
+
+float BL_Action::GetLayerWeight() const
+{
+  return m_layer_weight;
+}
+
+short BL_Action::GetIpoFlags() const
+{
+  return m_ipo_flags;
+}
+
+float BL_Action::GetSpeed() const
+{
+  return m_speed;
+}
+
+short BL_Action::GetBlendMode() const
+{
+  return m_blendmode;
+}
+
 void BL_Action::SetFrame(float frame)
 {
   // Clamp the frame to the start and end frame
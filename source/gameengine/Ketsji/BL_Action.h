@@ -121,6 +121,15 @@ class BL_Action {
   // Accessors
   float GetFrame();
   const std::string GetName();
+  float GetStartFrame() const;
+  float GetEndFrame() const;
+  short GetPriority() const;
+  float GetBlendIn() const;
+  short GetPlayMode() const;
+  float GetLayerWeight() const;
+  short GetIpoFlags() const;
+  float GetSpeed() const;
+  short GetBlendMode() const;
 
   struct bAction *GetAction();
 
@@ -133,6 +133,59 @@ void BL_ActionManager::StopAction(short layer)
   }
 }
 
+std::vector<BL_ActionManager::LayerState> BL_ActionManager::GetLayerStates()
+{
+  std::vector<LayerState> states;
+  for (const auto &pair : m_layers) {
+    BL_Action *action = pair.second;
+    if (action->IsDone()) {
+      continue;
+    }
+
+    LayerState state;
+    state.layer = pair.first;
+    state.name = action->GetName();
+    state.start = action->GetStartFrame();
+    state.end = action->GetEndFrame();
+    state.frame = action->GetFrame();
+    state.priority = action->GetPriority();
+    state.blendin = action->GetBlendIn();
+    state.playMode = action->GetPlayMode();
+    state.layerWeight = action->GetLayerWeight();
+    state.ipoFlags = action->GetIpoFlags();
+    state.speed = action->GetSpeed();
+    state.blendMode = action->GetBlendMode();
+    states.push_back(state);
+  }
+
+  return states;
+}
+
+void BL_ActionManager::SetLayerStates(const std::vector<LayerState> &states)
+{
+  for (const auto &pair : m_layers) {
+    delete pair.second;
+  }
+  m_layers.clear();
+
+  for (const LayerState &state : states) {
+    if (PlayAction(state.name,
+                   state.start,
+                   state.end,
+                   state.layer,
+                   state.priority,
+                   state.blendin,
+                   state.playMode,
+                   state.layerWeight,
+                   state.ipoFlags,
+                   state.speed,
+                   state.blendMode))
+    {
+      SetActionFrame(state.layer, state.frame);
+    }
+  }
+}
+
 void BL_ActionManager::RemoveTaggedActions()
 {
   for (BL_ActionMap::iterator it = m_layers.begin(); it != m_layers.end();) {
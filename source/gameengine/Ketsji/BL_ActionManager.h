@@ -28,6 +28,8 @@
 
 #include <iostream>
 #include <map>
+#include <string>
+#include <vector>
 
 // Currently, we use the max value of a short.
 // We should switch to unsigned short; doesn't make sense to support negative layers.
@@ -40,6 +42,23 @@ class BL_Action;
  * BL_ActionManager is responsible for handling a KX_GameObject's actions.
  */
 class BL_ActionManager {
+ public:
+  /// Playback parameters of the action playing on a layer, used to save and restore it.
+  struct LayerState {
+    short layer;
+    std::string name;
+    float start;
+    float end;
+    float frame;
+    short priority;
+    float blendin;
+    short playMode;
+    float layerWeight;
+    short ipoFlags;
+    float speed;
+    short blendMode;
+  };
+
  private:
   typedef std::map<short, BL_Action *> BL_ActionMap;
 
@@ -99,6 +118,16 @@ class BL_ActionManager {
    */
   void StopAction(short layer);
 
+  /**
+   * Get the state of the actions playing on all layers.
+   */
+  std::vector<LayerState> GetLayerStates();
+
+  /**
+   * Stop all actions and play the actions of the given states at their saved frame.
+   */
+  void SetLayerStates(const std::vector<LayerState> &states);
+
   /**
    * Remove playing tagged actions.
    */
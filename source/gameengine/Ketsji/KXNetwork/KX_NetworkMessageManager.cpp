@@ -32,6 +32,34 @@
 
 #include "KX_NetworkMessageManager.h"
 
+#include <cstring>
+
+/// Type of the reliable items sent to remote game instances.
+enum NetworkItemType : unsigned char { NETWORK_ITEM_MESSAGE = 0 };
+
+static void WriteString(std::string &buffer, const std::string &str)
+{
+  const unsigned short size = str.size();
+  buffer.append((const char *)&size, sizeof(size));
+  buffer.append(str);
+}
+
+static bool ReadString(const char *&data, const char *end, std::string &str)
+{
+  unsigned short size;
+  if (data + sizeof(size) > end) {
+    return false;
+  }
+  memcpy(&size, data, sizeof(size));
+  data += sizeof(size);
+  if (data + size > end) {
+    return false;
+  }
+  str.assign(data, size);
+  data += size;
+  return true;
+}
+
 KX_NetworkMessageManager::KX_NetworkMessageManager() : m_currentList(0)
 {
 }
@@ -45,6 +73,16 @@ void KX_NetworkMessageManager::AddMessage(KX_NetworkMessageManager::Message mess
 {
   // Put the new message in map for the given receiver and subject.
   m_messages[m_currentList][message.to][message.subject].push_back(message);
+
+  /* Messages of the network subjects cross the wire to the remote game instances, without
+   * their local sender. */
+  if (m_transport.IsOpen() && m_networkSubjects.count(message.subject)) {
+    std::string item(1, (char)NETWORK_ITEM_MESSAGE);
+    WriteString(item, message.to);
+    WriteString(item, message.subject);
+    WriteString(item, message.body);
+    m_transport.AddReliableItem(item);
+  }
 }
 
 const std::vector<KX_NetworkMessageManager::Message> KX_NetworkMessageManager::GetMessages(
@@ -87,3 +125,81 @@ void KX_NetworkMessageManager::ClearMessages()
   m_messages[1 - m_currentList].clear();
   m_currentList = 1 - m_currentList;
 }
+
+KX_NetworkTransport &KX_NetworkMessageManager::GetTransport()
+{
+  return m_transport;
+}
+
+void KX_NetworkMessageManager::SetNetworkSubjects(const std::vector<std::string> &subjects)
+{
+  m_networkSubjects = std::set<std::string>(subjects.begin(), subjects.end());
+}
+
+const std::set<std::string> &KX_NetworkMessageManager::GetNetworkSubjects() const
+{
+  return m_networkSubjects;
+}
+
+void KX_NetworkMessageManager::ReceivePackets()
+{
+  m_sceneStates.clear();
+  m_transport.Receive();
+
+  for (const KX_NetworkTransport::ReliableItem &item : m_transport.GetReceivedItems()) {
+    const char *data = item.data.data();
+    const char *end = data + item.data.size();
+    if (data == end || *data++ != NETWORK_ITEM_MESSAGE) {
+      continue;
+    }
+
+    Message message;
+    message.from = nullptr;
+    if (ReadString(data, end, message.to) && ReadString(data, end, message.subject) &&
+        ReadString(data, end, message.body))
+    {
+      m_messages[m_currentList][message.to][message.subject].push_back(message);
+    }
+  }
+
+  // Split the states in sections of each scene.
+  for (const KX_NetworkTransport::State &state : m_transport.GetReceivedStates()) {
+    const char *data = state.data.data();
+    const char *end = data + state.data.size();
+    std::string scene;
+    std::string sceneData;
+    while (data < end && ReadString(data, end, scene) && ReadString(data, end, sceneData)) {
+      m_sceneStates[scene].push_back({state.peerId, state.sequence, sceneData});
+    }
+  }
+}
+
+void KX_NetworkMessageManager::SendPackets()
+{
+  m_transport.Send();
+}
+
+const std::vector<KX_NetworkMessageManager::SceneState> &KX_NetworkMessageManager::GetSceneStates(
+    const std::string &scene)
+{
+  return m_sceneStates[scene];
+}
+
+unsigned int KX_NetworkMessageManager::GetSceneStateBudget(unsigned int peerIndex,
+                                                           const std::string &scene) const
+{
+  // Sizes of the scene name and data.
+  const unsigned int header = 2 * sizeof(unsigned short) + scene.size();
+  const unsigned int budget = m_transport.GetPeerStateBudget(peerIndex);
+  return (budget > header) ? budget - header : 0;
+}
+
+void KX_NetworkMessageManager::AddSceneState(unsigned int peerIndex,
+                                             const std::string &scene,
+                                             const std::string &data)
+{
+  std::string section;
+  WriteString(section, scene);
+  WriteString(section, data);
+  m_transport.AddPeerState(peerIndex, section);
+}
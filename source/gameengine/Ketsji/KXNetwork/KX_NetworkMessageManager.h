@@ -35,9 +35,12 @@ conflicts with KX_NetworkMessageManager::SendMessage */
 #endif
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "KX_NetworkTransport.h"
+
 class SCA_IObject;
 
 class KX_NetworkMessageManager {
@@ -53,6 +56,14 @@ class KX_NetworkMessageManager {
     std::string body;
   };
 
+  /// Replication state of a scene received from a remote game instance.
+  struct SceneState {
+    unsigned int peerId;
+    /// Sequence number of the packet, increasing for each peer.
+    unsigned int sequence;
+    std::string data;
+  };
+
  private:
   /** List of all messages, filtered by receiver object(s) name and subject name.
    * We use two lists, one handle sended message in the current frame and the other
@@ -65,11 +76,21 @@ class KX_NetworkMessageManager {
    */
   unsigned short m_currentList;
 
+  /// Transport to remote game instances, messages are also sent to them when opened.
+  KX_NetworkTransport m_transport;
+
+  /// Subjects of the messages sent to the remote game instances, other messages stay local.
+  std::set<std::string> m_networkSubjects;
+
+  /// Unreliable states received in the current frame, by scene name.
+  std::map<std::string, std::vector<SceneState>> m_sceneStates;
+
  public:
   KX_NetworkMessageManager();
   virtual ~KX_NetworkMessageManager();
 
-  /** Add a message in the next message list.
+  /** Add a message in the next message list, it is also sent to the remote game instances if
+   * its subject is a network subject.
    * \param message The given message to add.
    */
   void AddMessage(Message message);
@@ -81,4 +102,24 @@ class KX_NetworkMessageManager {
 
   /// Clear all messages
   void ClearMessages();
+
+  KX_NetworkTransport &GetTransport();
+
+  /// Set the subjects of the messages sent to the remote game instances, none by default.
+  void SetNetworkSubjects(const std::vector<std::string> &subjects);
+  const std::set<std::string> &GetNetworkSubjects() const;
+
+  /** Read the packets of the remote game instances, the received messages are added
+   * to the current message list and the scene states are available until the next call.
+   */
+  void ReceivePackets();
+  /// Send the queued messages and scene states to the remote game instances.
+  void SendPackets();
+
+  /// Get the states received for a scene in the current frame, in the order of reception.
+  const std::vector<SceneState> &GetSceneStates(const std::string &scene);
+  /// Size available for the state of a scene in the next packet sent to a peer.
+  unsigned int GetSceneStateBudget(unsigned int peerIndex, const std::string &scene) const;
+  /// Add the state of a scene to the next packet sent to a peer, data must fit in the budget.
+  void AddSceneState(unsigned int peerIndex, const std::string &scene, const std::string &data);
 };
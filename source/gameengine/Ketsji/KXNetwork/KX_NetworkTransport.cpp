@@ -0,0 +1,553 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KXNetwork/KX_NetworkTransport.cpp
+ *  \ingroup ketsjinet
+ */
+
+#ifdef WIN32
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#  include <fcntl.h>
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "KX_NetworkTransport.h"
+
+#include "BLI_time.h"
+
+#include "CM_Message.h"
+
+#ifdef WIN32
+typedef int socklen_t;
+#  define INVALID_SOCKET_HANDLE ((intptr_t)INVALID_SOCKET)
+#  define CLOSE_SOCKET(s) closesocket((SOCKET)s)
+#else
+#  define INVALID_SOCKET_HANDLE ((intptr_t)-1)
+#  define CLOSE_SOCKET(s) close((int)s)
+#endif
+
+/// Identifier of the packets of this protocol, "UPBN".
+static const uint32_t PACKET_MAGIC = 0x5550424e;
+/// Size of magic, sequence, ack and ack bits.
+static const unsigned int PACKET_HEADER_SIZE = 16;
+/// Size of the reliable item count.
+static const unsigned int RELIABLE_HEADER_SIZE = 2;
+/// Size of a reliable item identifier and size.
+static const unsigned int RELIABLE_ITEM_HEADER_SIZE = 6;
+
+const double KX_NetworkTransport::PEER_TIMEOUT = 10.0;
+
+template<class T> static void WriteData(std::string &buffer, T value)
+{
+  buffer.append((const char *)&value, sizeof(T));
+}
+
+template<class T>
+static bool ReadData(const unsigned char *&data, const unsigned char *end, T &value)
+{
+  if (data + sizeof(T) > end) {
+    return false;
+  }
+  memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return true;
+}
+
+KX_NetworkTransport::KX_NetworkTransport()
+    : m_socket(INVALID_SOCKET_HANDLE),
+      m_listen(false),
+      m_nextPeerId(0),
+      m_bandwidthBytes{0, 0},
+      m_bandwidthTime(0.0)
+{
+  memset(&m_statistics, 0, sizeof(Statistics));
+}
+
+KX_NetworkTransport::~KX_NetworkTransport()
+{
+  Close();
+}
+
+bool KX_NetworkTransport::OpenSocket(unsigned short port)
+{
+  Close();
+
+#ifdef WIN32
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+    CM_Error("network: failed to initialize sockets");
+    return false;
+  }
+#endif
+
+  m_socket = (intptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (m_socket == INVALID_SOCKET_HANDLE) {
+    CM_Error("network: failed to create socket");
+    return false;
+  }
+
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+
+  if (bind(m_socket, (const sockaddr *)&address, sizeof(address)) != 0) {
+    CM_Error("network: failed to bind socket on port " << port);
+    Close();
+    return false;
+  }
+
+  // The socket is polled each frame and must never block the game.
+#ifdef WIN32
+  u_long nonBlocking = 1;
+  ioctlsocket((SOCKET)m_socket, FIONBIO, &nonBlocking);
+#else
+  fcntl((int)m_socket, F_SETFL, fcntl((int)m_socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+  m_bandwidthTime = BLI_time_now_seconds();
+
+  return true;
+}
+
+bool KX_NetworkTransport::Listen(unsigned short port)
+{
+  if (!OpenSocket(port)) {
+    return false;
+  }
+
+  m_listen = true;
+  return true;
+}
+
+bool KX_NetworkTransport::Connect(const std::string &host, unsigned short port)
+{
+  // Use any local port, the remote instance answers to the address of the received packets.
+  if (!OpenSocket(0)) {
+    return false;
+  }
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  addrinfo *result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+    CM_Error("network: failed to resolve address \"" << host << "\"");
+    Close();
+    return false;
+  }
+
+  const uint32_t address = ((const sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(result);
+
+  m_listen = false;
+  AddPeer(address, htons(port), BLI_time_now_seconds());
+
+  return true;
+}
+
+void KX_NetworkTransport::Close()
+{
+  if (m_socket != INVALID_SOCKET_HANDLE) {
+    CLOSE_SOCKET(m_socket);
+    m_socket = INVALID_SOCKET_HANDLE;
+#ifdef WIN32
+    WSACleanup();
+#endif
+  }
+
+  m_peers.clear();
+  m_receivedItems.clear();
+  m_receivedStates.clear();
+  m_listen = false;
+}
+
+bool KX_NetworkTransport::IsOpen() const
+{
+  return m_socket != INVALID_SOCKET_HANDLE;
+}
+
+KX_NetworkTransport::Peer *KX_NetworkTransport::FindPeer(uint32_t address, uint16_t port)
+{
+  for (Peer &peer : m_peers) {
+    if (peer.address == address && peer.port == port) {
+      return &peer;
+    }
+  }
+  return nullptr;
+}
+
+KX_NetworkTransport::Peer &KX_NetworkTransport::AddPeer(uint32_t address,
+                                                        uint16_t port,
+                                                        double time)
+{
+  m_peers.emplace_back();
+  Peer &peer = m_peers.back();
+
+  peer.id = m_nextPeerId++;
+  peer.address = address;
+  peer.port = port;
+  // Sequence 0 is used in acknowledgements to tell that nothing was received.
+  peer.localSequence = 1;
+  peer.remoteSequence = 0;
+  peer.receivedBits = 0;
+  peer.hasReceived = false;
+  peer.lastReceiveTime = time;
+  peer.roundTripTime = 0.0f;
+  peer.lost = 0;
+  memset(peer.history, 0, sizeof(peer.history));
+  peer.nextReliableId = 1;
+  peer.expectedReliableId = 1;
+
+  return peer;
+}
+
+void KX_NetworkTransport::ProcessAck(Peer &peer, unsigned int sequence, double time)
+{
+  SentPacket &packet = peer.history[sequence % HISTORY_SIZE];
+  if (!packet.used || packet.acked || packet.sequence != sequence) {
+    return;
+  }
+
+  packet.acked = true;
+  peer.ackedSequences.push_back(sequence);
+
+  const float roundTripTime = (float)(time - packet.time);
+  peer.roundTripTime = (peer.roundTripTime == 0.0f) ?
+                           roundTripTime :
+                           peer.roundTripTime * 0.9f + roundTripTime * 0.1f;
+
+  // Items are always sent from the front of the queue, all items until the last are received.
+  while (!peer.reliableItems.empty() && peer.reliableItems.front().first <= packet.lastReliable) {
+    peer.reliableItems.pop_front();
+  }
+}
+
+void KX_NetworkTransport::ProcessPacket(Peer &peer,
+                                        const unsigned char *data,
+                                        unsigned int size,
+                                        double time)
+{
+  const unsigned char *end = data + size;
+
+  uint32_t magic, sequence, ack, ackBits;
+  if (!ReadData(data, end, magic) || magic != PACKET_MAGIC || !ReadData(data, end, sequence) ||
+      !ReadData(data, end, ack) || !ReadData(data, end, ackBits))
+  {
+    return;
+  }
+
+  // Update received sequence numbers, duplicated and too old packets are ignored.
+  if (!peer.hasReceived) {
+    peer.remoteSequence = sequence;
+    peer.receivedBits = 0;
+    peer.hasReceived = true;
+  }
+  else if (sequence > peer.remoteSequence) {
+    const unsigned int shift = sequence - peer.remoteSequence;
+    peer.receivedBits = (shift >= 32) ? 0 : (peer.receivedBits << shift);
+    if (shift <= 32) {
+      peer.receivedBits |= 1u << (shift - 1);
+    }
+    peer.remoteSequence = sequence;
+  }
+  else {
+    const unsigned int distance = peer.remoteSequence - sequence;
+    if (distance == 0 || distance > 32 || (peer.receivedBits & (1u << (distance - 1)))) {
+      return;
+    }
+    peer.receivedBits |= 1u << (distance - 1);
+  }
+
+  peer.lastReceiveTime = time;
+
+  // Acknowledgements of our packets.
+  if (ack != 0) {
+    ProcessAck(peer, ack, time);
+    for (unsigned int i = 0; i < 32 && ack > i + 1; ++i) {
+      if (ackBits & (1u << i)) {
+        ProcessAck(peer, ack - 1 - i, time);
+      }
+    }
+  }
+
+  // Reliable items, delivered in order and only once.
+  uint16_t numItems;
+  if (!ReadData(data, end, numItems)) {
+    return;
+  }
+  for (unsigned short i = 0; i < numItems; ++i) {
+    uint32_t id;
+    uint16_t itemSize;
+    if (!ReadData(data, end, id) || !ReadData(data, end, itemSize) || data + itemSize > end) {
+      return;
+    }
+    if (id == peer.expectedReliableId) {
+      m_receivedItems.push_back({peer.id, std::string((const char *)data, itemSize)});
+      ++peer.expectedReliableId;
+    }
+    data += itemSize;
+  }
+
+  // Remaining data is the state.
+  if (data < end) {
+    m_receivedStates.push_back({peer.id, sequence, std::string((const char *)data, end - data)});
+  }
+}
+
+void KX_NetworkTransport::Receive()
+{
+  m_receivedItems.clear();
+  m_receivedStates.clear();
+
+  if (!IsOpen()) {
+    return;
+  }
+
+  const double time = BLI_time_now_seconds();
+  unsigned char buffer[MAX_PACKET_SIZE];
+
+  while (true) {
+    sockaddr_in from;
+    socklen_t fromLength = sizeof(from);
+    const int size = recvfrom(
+        m_socket, (char *)buffer, sizeof(buffer), 0, (sockaddr *)&from, &fromLength);
+    if (size <= 0) {
+      break;
+    }
+
+    m_statistics.bytesReceived += size;
+    m_bandwidthBytes[0] += size;
+    ++m_statistics.packetsReceived;
+
+    // Ignore packets of other protocols before accepting a new peer.
+    if (size < (int)PACKET_HEADER_SIZE || memcmp(buffer, &PACKET_MAGIC, sizeof(uint32_t)) != 0) {
+      continue;
+    }
+
+    Peer *peer = FindPeer(from.sin_addr.s_addr, from.sin_port);
+    if (!peer) {
+      if (!m_listen) {
+        continue;
+      }
+      peer = &AddPeer(from.sin_addr.s_addr, from.sin_port, time);
+    }
+
+    ProcessPacket(*peer, buffer, size, time);
+  }
+
+  // Forget silent peers.
+  for (std::vector<Peer>::iterator it = m_peers.begin(); it != m_peers.end();) {
+    if ((time - it->lastReceiveTime) > PEER_TIMEOUT) {
+      CM_Warning("network: peer " << it->id << " timed out");
+      it = m_peers.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+void KX_NetworkTransport::SendPacket(Peer &peer, double time)
+{
+  std::string packet;
+  packet.reserve(MAX_PACKET_SIZE);
+
+  const unsigned int sequence = peer.localSequence++;
+  WriteData<uint32_t>(packet, PACKET_MAGIC);
+  WriteData<uint32_t>(packet, sequence);
+  WriteData<uint32_t>(packet, peer.hasReceived ? peer.remoteSequence : 0);
+  WriteData<uint32_t>(packet, peer.receivedBits);
+
+  // Reliable items from the front of the queue, as many as possible.
+  const unsigned int budget = MAX_PACKET_SIZE - peer.state.size();
+  const size_t numItemsOffset = packet.size();
+  WriteData<uint16_t>(packet, 0);
+
+  uint16_t numItems = 0;
+  unsigned int lastReliable = 0;
+  for (const std::pair<unsigned int, std::string> &item : peer.reliableItems) {
+    if (packet.size() + RELIABLE_ITEM_HEADER_SIZE + item.second.size() > budget) {
+      break;
+    }
+    WriteData<uint32_t>(packet, item.first);
+    WriteData<uint16_t>(packet, item.second.size());
+    packet.append(item.second);
+    lastReliable = item.first;
+    ++numItems;
+  }
+  memcpy(&packet[numItemsOffset], &numItems, sizeof(uint16_t));
+
+  packet.append(peer.state);
+  peer.state.clear();
+
+  SentPacket &sent = peer.history[sequence % HISTORY_SIZE];
+  if (sent.used && !sent.acked) {
+    ++peer.lost;
+    ++m_statistics.packetsLost;
+  }
+  sent.sequence = sequence;
+  sent.time = time;
+  sent.lastReliable = lastReliable;
+  sent.used = true;
+  sent.acked = false;
+
+  sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = peer.address;
+  to.sin_port = peer.port;
+
+  const int size = sendto(
+      m_socket, packet.data(), packet.size(), 0, (const sockaddr *)&to, sizeof(to));
+  if (size > 0) {
+    m_statistics.bytesSent += size;
+    m_bandwidthBytes[1] += size;
+    ++m_statistics.packetsSent;
+  }
+}
+
+void KX_NetworkTransport::UpdateBandwidth(double time)
+{
+  const double elapsed = time - m_bandwidthTime;
+  if (elapsed < 1.0) {
+    return;
+  }
+
+  m_statistics.bandwidthIn = (float)(m_bandwidthBytes[0] / elapsed);
+  m_statistics.bandwidthOut = (float)(m_bandwidthBytes[1] / elapsed);
+  m_bandwidthBytes[0] = 0;
+  m_bandwidthBytes[1] = 0;
+  m_bandwidthTime = time;
+}
+
+void KX_NetworkTransport::Send()
+{
+  if (!IsOpen()) {
+    return;
+  }
+
+  const double time = BLI_time_now_seconds();
+  for (Peer &peer : m_peers) {
+    SendPacket(peer, time);
+    peer.ackedSequences.clear();
+  }
+
+  UpdateBandwidth(time);
+}
+
+const std::vector<KX_NetworkTransport::ReliableItem> &KX_NetworkTransport::GetReceivedItems()
+    const
+{
+  return m_receivedItems;
+}
+
+const std::vector<KX_NetworkTransport::State> &KX_NetworkTransport::GetReceivedStates() const
+{
+  return m_receivedStates;
+}
+
+void KX_NetworkTransport::AddReliableItem(const std::string &data)
+{
+  if (data.size() + PACKET_HEADER_SIZE + RELIABLE_HEADER_SIZE + RELIABLE_ITEM_HEADER_SIZE >
+      MAX_PACKET_SIZE)
+  {
+    CM_Warning("network: reliable data of " << data.size() << " bytes is too big to be sent");
+    return;
+  }
+
+  for (Peer &peer : m_peers) {
+    peer.reliableItems.emplace_back(peer.nextReliableId++, data);
+  }
+}
+
+unsigned int KX_NetworkTransport::GetNumPeers() const
+{
+  return m_peers.size();
+}
+
+unsigned int KX_NetworkTransport::GetPeerId(unsigned int index) const
+{
+  return m_peers[index].id;
+}
+
+std::string KX_NetworkTransport::GetPeerAddress(unsigned int index) const
+{
+  const Peer &peer = m_peers[index];
+  in_addr address;
+  address.s_addr = peer.address;
+  return std::string(inet_ntoa(address)) + ":" + std::to_string(ntohs(peer.port));
+}
+
+float KX_NetworkTransport::GetPeerRoundTripTime(unsigned int index) const
+{
+  return m_peers[index].roundTripTime;
+}
+
+unsigned int KX_NetworkTransport::GetPeerLostPackets(unsigned int index) const
+{
+  return m_peers[index].lost;
+}
+
+unsigned int KX_NetworkTransport::GetPeerSequence(unsigned int index) const
+{
+  return m_peers[index].localSequence;
+}
+
+const std::vector<unsigned int> &KX_NetworkTransport::GetPeerAckedSequences(
+    unsigned int index) const
+{
+  return m_peers[index].ackedSequences;
+}
+
+unsigned int KX_NetworkTransport::GetPeerStateBudget(unsigned int index) const
+{
+  const Peer &peer = m_peers[index];
+  /* Keep room for the header and the first pending reliable item, the state must never
+   * starve the reliable channel. */
+  unsigned int reserved = PACKET_HEADER_SIZE + RELIABLE_HEADER_SIZE + peer.state.size();
+  if (!peer.reliableItems.empty()) {
+    reserved += RELIABLE_ITEM_HEADER_SIZE + peer.reliableItems.front().second.size();
+  }
+  return (reserved < MAX_PACKET_SIZE) ? MAX_PACKET_SIZE - reserved : 0;
+}
+
+void KX_NetworkTransport::AddPeerState(unsigned int index, const std::string &data)
+{
+  m_peers[index].state.append(data);
+}
+
+const KX_NetworkTransport::Statistics &KX_NetworkTransport::GetStatistics() const
+{
+  return m_statistics;
+}
@@ -0,0 +1,182 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_NetworkTransport.h
+ *  \ingroup ketsjinet
+ *  \brief UDP transport exchanging acknowledged packets with remote game instances.
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+/** Connection less UDP transport sending one packet per frame to each peer.
+ *
+ * Every packet is numbered and acknowledges the last packets received from the peer.
+ * Two channels are multiplexed in a packet:
+ * - The reliable channel, its items are resent until a packet containing them is acknowledged
+ *   and are received only once and in order.
+ * - The unreliable channel, containing state data. The owner of the data is notified of the
+ *   acknowledged packets to compute the next state as a delta of the state received by the peer.
+ */
+class KX_NetworkTransport {
+ public:
+  /// Maximum size of a packet, small enough to avoid IP fragmentation.
+  static const unsigned int MAX_PACKET_SIZE = 1200;
+  /// Number of sent packets remembered to process acknowledgements.
+  static const unsigned int HISTORY_SIZE = 256;
+  /// Time in seconds without any packet received after which a peer is disconnected.
+  static const double PEER_TIMEOUT;
+
+  struct Statistics {
+    unsigned long long bytesSent;
+    unsigned long long bytesReceived;
+    unsigned int packetsSent;
+    unsigned int packetsReceived;
+    /// Packets never acknowledged by the peer.
+    unsigned int packetsLost;
+    /// Bytes per second over the last second.
+    float bandwidthIn;
+    float bandwidthOut;
+  };
+
+  /// Reliable item received from a peer.
+  struct ReliableItem {
+    unsigned int peerId;
+    std::string data;
+  };
+
+  /// Unreliable state received from a peer.
+  struct State {
+    unsigned int peerId;
+    /// Sequence number of the packet containing the state.
+    unsigned int sequence;
+    std::string data;
+  };
+
+ private:
+  struct SentPacket {
+    unsigned int sequence;
+    double time;
+    /// Identifier of the last reliable item contained in the packet.
+    unsigned int lastReliable;
+    bool used;
+    bool acked;
+  };
+
+  struct Peer {
+    /// Unique identifier, never reused during the transport life.
+    unsigned int id;
+    uint32_t address;
+    uint16_t port;
+
+    /// Sequence number of the next packet to send.
+    unsigned int localSequence;
+    /// Most recent sequence number received and bit field of the 32 previous ones.
+    unsigned int remoteSequence;
+    uint32_t receivedBits;
+    bool hasReceived;
+    double lastReceiveTime;
+
+    /// Smoothed round trip time in seconds.
+    float roundTripTime;
+    unsigned int lost;
+
+    SentPacket history[HISTORY_SIZE];
+
+    /// Reliable items not yet acknowledged, with their identifier.
+    std::deque<std::pair<unsigned int, std::string>> reliableItems;
+    unsigned int nextReliableId;
+    /// Identifier of the next reliable item to deliver.
+    unsigned int expectedReliableId;
+
+    /// Sequence numbers of the packets acknowledged since the last send.
+    std::vector<unsigned int> ackedSequences;
+    /// State to send in the next packet.
+    std::string state;
+  };
+
+  /// Socket handle, stored as an integer to not expose platform headers.
+  intptr_t m_socket;
+  /// True when accepting packets from unknown addresses.
+  bool m_listen;
+  std::vector<Peer> m_peers;
+  unsigned int m_nextPeerId;
+
+  std::vector<ReliableItem> m_receivedItems;
+  std::vector<State> m_receivedStates;
+
+  Statistics m_statistics;
+  /// Bytes counted for the current bandwidth measure.
+  unsigned long long m_bandwidthBytes[2];
+  double m_bandwidthTime;
+
+  bool OpenSocket(unsigned short port);
+  Peer *FindPeer(uint32_t address, uint16_t port);
+  Peer &AddPeer(uint32_t address, uint16_t port, double time);
+  void ProcessAck(Peer &peer, unsigned int sequence, double time);
+  void ProcessPacket(Peer &peer, const unsigned char *data, unsigned int size, double time);
+  void SendPacket(Peer &peer, double time);
+  void UpdateBandwidth(double time);
+
+ public:
+  KX_NetworkTransport();
+  ~KX_NetworkTransport();
+
+  /// Open the transport and accept packets from any game instance on the given port.
+  bool Listen(unsigned short port);
+  /// Open the transport and start sending packets to the given address.
+  bool Connect(const std::string &host, unsigned short port);
+  /// Close the socket and forget all peers.
+  void Close();
+  bool IsOpen() const;
+
+  /// Read all pending packets, the received items and states are available until next call.
+  void Receive();
+  /// Send one packet to each peer with pending reliable items and states.
+  void Send();
+
+  const std::vector<ReliableItem> &GetReceivedItems() const;
+  const std::vector<State> &GetReceivedStates() const;
+
+  /// Queue a reliable item for all peers.
+  void AddReliableItem(const std::string &data);
+
+  unsigned int GetNumPeers() const;
+  unsigned int GetPeerId(unsigned int index) const;
+  std::string GetPeerAddress(unsigned int index) const;
+  /// Smoothed round trip time in seconds.
+  float GetPeerRoundTripTime(unsigned int index) const;
+  unsigned int GetPeerLostPackets(unsigned int index) const;
+  /// Sequence number of the next packet sent to the peer.
+  unsigned int GetPeerSequence(unsigned int index) const;
+  /// Sequence numbers of the packets acknowledged by the peer since the last send.
+  const std::vector<unsigned int> &GetPeerAckedSequences(unsigned int index) const;
+  /// Remaining size available for the state in the next packet.
+  unsigned int GetPeerStateBudget(unsigned int index) const;
+  /// Append state data to the next packet, the data size must fit in the budget.
+  void AddPeerState(unsigned int index, const std::string &data);
+
+  const Statistics &GetStatistics() const;
+};
@@ -139,6 +139,19 @@ MT_Transform KX_Camera::GetCameraToWorld() const
   return MT_Transform(NodeGetWorldPosition(), NodeGetWorldOrientation());
 }
 
+MT_Transform KX_Camera::GetRenderWorldToCamera() const
+{
+  MT_Vector3 position;
+  MT_Matrix3x3 orientation;
+  MT_Vector3 scaling;
+  NodeGetRenderTransform(position, orientation, scaling);
+
+  MT_Transform camtrans;
+  camtrans.invert(MT_Transform(position, orientation));
+
+  return camtrans;
+}
+
 /**
  * Sets the projection matrix that is used by the rasterizer.
  */
@@ -136,6 +136,8 @@ class KX_Camera : public KX_GameObject {
 
   MT_Transform GetWorldToCamera() const;
   MT_Transform GetCameraToWorld() const;
+  /// World to camera transform from the interpolated render transform.
+  MT_Transform GetRenderWorldToCamera() const;
 
   /** Sets the projection matrix that is used by the rasterizer. */
   void SetProjectionMatrix(const MT_Matrix4x4 &mat);
@@ -31,6 +31,8 @@
 
 #include "KX_CollisionEventManager.h"
 
+#include <algorithm>
+
 #include "KX_CollisionContactPoints.h"
 #include "PHY_IPhysicsController.h"
 #include "PHY_IPhysicsEnvironment.h"
@@ -54,7 +56,10 @@ KX_CollisionEventManager::~KX_CollisionEventManager()
 
 void KX_CollisionEventManager::RemoveNewCollisions()
 {
-  m_newCollisions.clear();
+  m_pairs.clear();
+  m_manifolds.clear();
+  m_sides.clear();
+  m_pairIndices.clear();
 }
 
 bool KX_CollisionEventManager::NewHandleCollision(PHY_IPhysicsController *ctrl1,
@@ -62,7 +67,23 @@ bool KX_CollisionEventManager::NewHandleCollision(PHY_IPhysicsController *ctrl1,
                                                   const PHY_ICollData *coll_data,
                                                   bool first)
 {
-  m_newCollisions.insert(NewCollision(ctrl1, ctrl2, coll_data, first));
+  const unsigned int numPairs = m_pairs.size();
+  const int manifoldIndex = m_manifolds.size();
+
+  // Compound shapes produce several manifolds for the same pair of objects.
+  const unsigned int pairIndex = m_pairIndices.lookup_or_add(std::minmax(ctrl1, ctrl2), numPairs);
+  if (pairIndex == numPairs) {
+    m_pairs.push_back({ctrl1, ctrl2, manifoldIndex, manifoldIndex});
+  }
+  else {
+    CollisionPair &pair = m_pairs[pairIndex];
+    m_manifolds[pair.lastManifold].next = manifoldIndex;
+    pair.lastManifold = manifoldIndex;
+  }
+
+  // Express the contact points side relatively to the first object of the pair.
+  const bool isFirst = (m_pairs[pairIndex].first == ctrl1) ? first : !first;
+  m_manifolds.push_back({coll_data, isFirst, -1});
 
   return false;
 }
@@ -179,40 +200,73 @@ void KX_CollisionEventManager::NextFrame()
     static_cast<SCA_CollisionSensor *>(sensor)->SynchronizeTransform();
   }
 
-  for (const NewCollision &collision : m_newCollisions) {
-    // Controllers
-    PHY_IPhysicsController *ctrl1 = collision.first;
-    PHY_IPhysicsController *ctrl2 = collision.second;
-    // Sensor iterator
-    std::list<SCA_ISensor *>::iterator sit;
-
-    // First client info
-    KX_ClientObjectInfo *client_info = static_cast<KX_ClientObjectInfo *>(
-        ctrl1->GetNewClientInfo());
-    // First gameobject
-    KX_GameObject *kxObj1 = KX_GameObject::GetClientObject(client_info);
-    // Invoke sensor response for each object
-    if (client_info) {
-      for (sit = client_info->m_sensors.begin(); sit != client_info->m_sensors.end(); ++sit) {
-        static_cast<SCA_CollisionSensor *>(*sit)->NewHandleCollision(ctrl1, ctrl2, nullptr);
+  // Group the pairs by object to process the sensors of an object for all its pairs at once.
+  for (unsigned int i = 0, size = m_pairs.size(); i < size; ++i) {
+    const CollisionPair &pair = m_pairs[i];
+    KX_ClientObjectInfo *info1 = static_cast<KX_ClientObjectInfo *>(
+        pair.first->GetNewClientInfo());
+    KX_ClientObjectInfo *info2 = static_cast<KX_ClientObjectInfo *>(
+        pair.second->GetNewClientInfo());
+    if (info1) {
+      m_sides.push_back({info1, i, true});
+    }
+    if (info2) {
+      m_sides.push_back({info2, i, false});
+    }
+  }
+
+  std::sort(m_sides.begin(), m_sides.end(), [](const CollisionSide &a, const CollisionSide &b) {
+    return (a.info == b.info) ? (a.pair < b.pair) : (a.info < b.info);
+  });
+
+  for (std::vector<CollisionSide>::const_iterator begin = m_sides.begin(), end;
+       begin != m_sides.end();
+       begin = end)
+  {
+    KX_ClientObjectInfo *info = begin->info;
+    end = std::find_if(
+        begin, m_sides.cend(), [info](const CollisionSide &side) { return side.info != info; });
+
+    // Invoke sensor response for each pair of the object.
+    for (SCA_ISensor *sensor : info->m_sensors) {
+      SCA_CollisionSensor *collisionSensor = static_cast<SCA_CollisionSensor *>(sensor);
+      for (std::vector<CollisionSide>::const_iterator it = begin; it != end; ++it) {
+        const CollisionPair &pair = m_pairs[it->pair];
+        if (it->first) {
+          collisionSensor->NewHandleCollision(pair.first, pair.second, nullptr);
+        }
+        else {
+          collisionSensor->NewHandleCollision(pair.second, pair.first, nullptr);
+        }
       }
     }
 
-    // Second client info
-    client_info = static_cast<KX_ClientObjectInfo *>(ctrl2->GetNewClientInfo());
-    // Second gameobject
-    KX_GameObject *kxObj2 = KX_GameObject::GetClientObject(client_info);
-    if (client_info) {
-      for (sit = client_info->m_sensors.begin(); sit != client_info->m_sensors.end(); ++sit) {
-        static_cast<SCA_CollisionSensor *>(*sit)->NewHandleCollision(ctrl2, ctrl1, nullptr);
+#ifdef WITH_PYTHON
+    // Run python callbacks for each manifold of the pairs.
+    KX_GameObject *gameobj = info->m_gameobject;
+    if (!gameobj || !gameobj->m_collisionCallbacks ||
+        PyList_GET_SIZE(gameobj->m_collisionCallbacks) == 0)
+    {
+      continue;
+    }
+
+    for (std::vector<CollisionSide>::const_iterator it = begin; it != end; ++it) {
+      const CollisionPair &pair = m_pairs[it->pair];
+      PHY_IPhysicsController *otherCtrl = it->first ? pair.second : pair.first;
+      KX_GameObject *collider = KX_GameObject::GetClientObject(
+          static_cast<KX_ClientObjectInfo *>(otherCtrl->GetNewClientInfo()));
+      if (!collider) {
+        continue;
+      }
+
+      for (int i = pair.firstManifold; i != -1; i = m_manifolds[i].next) {
+        const CollisionManifold &manifold = m_manifolds[i];
+        KX_CollisionContactPointList contactPointList(
+            manifold.colldata, it->first ? manifold.isFirst : !manifold.isFirst);
+        gameobj->RunCollisionCallbacks(collider, contactPointList);
       }
     }
-    // Run python callbacks
-    const PHY_ICollData *colldata = collision.colldata;
-    KX_CollisionContactPointList contactPointList0 = KX_CollisionContactPointList(colldata, collision.isFirst);
-    KX_CollisionContactPointList contactPointList1 = KX_CollisionContactPointList(colldata, !collision.isFirst);
-    kxObj1->RunCollisionCallbacks(kxObj2, contactPointList0);
-    kxObj2->RunCollisionCallbacks(kxObj1, contactPointList1);
+#endif  // WITH_PYTHON
   }
 
   for (SCA_ISensor *sensor : m_sensors) {
@@ -231,31 +285,3 @@ PHY_IPhysicsEnvironment *KX_CollisionEventManager::GetPhysicsEnvironment()
 {
   return m_physEnv;
 }
-
-KX_CollisionEventManager::NewCollision::NewCollision(PHY_IPhysicsController *_first,
-                                                     PHY_IPhysicsController *_second,
-                                                     const PHY_ICollData *_colldata,
-                                                     bool _isfirst)
-    : first(_first), second(_second), colldata(_colldata), isFirst(_isfirst)
-{
-}
-
-KX_CollisionEventManager::NewCollision::NewCollision(const NewCollision &to_copy)
-    : first(to_copy.first), second(to_copy.second), colldata(to_copy.colldata), isFirst(to_copy.isFirst)
-{
-}
-
-bool KX_CollisionEventManager::NewCollision::operator<(const NewCollision &other) const
-{
-  // see strict weak ordering: https://support.microsoft.com/en-us/kb/949171
-  if (first == other.first) {
-    if (second == other.second) {
-      if (colldata == other.colldata) {
-        return isFirst < other.isFirst;
-      }
-      return colldata < other.colldata;
-    }
-    return second < other.second;
-  }
-  return first < other.first;
-}
@@ -31,9 +31,10 @@
 
 #pragma once
 
-#include <set>
 #include <vector>
 
+#include "BLI_map.hh"
+
 #include "KX_GameObject.h"
 #include "SCA_CollisionSensor.h"
 #include "SCA_EventManager.h"
@@ -42,34 +43,43 @@ class SCA_ISensor;
 class PHY_IPhysicsEnvironment;
 
 class KX_CollisionEventManager : public SCA_EventManager {
-  /**
-   * Contains two colliding objects and the first contact point.
-   */
-  class NewCollision {
-   public:
-    PHY_IPhysicsController *first;
-    PHY_IPhysicsController *second;
+  /// Contact points of a manifold between two objects.
+  struct CollisionManifold {
     const PHY_ICollData *colldata;
+    /// The first object of the pair is the first object of the contact points.
     bool isFirst;
+    /// Index of the next manifold of the same pair, -1 for the last.
+    int next;
+  };
 
-    /**
-     * Creates a copy of the given PHY_ICollData; freeing that copy should be done by the owner of
-     * the NewCollision object.
-     *
-     * This allows us to efficiently store NewCollision objects in a std::set without creating more
-     * copies of colldata, as the NewCollision copy constructor reuses the pointer and doesn't
-     * clone it again. */
-    NewCollision(PHY_IPhysicsController *first,
-                 PHY_IPhysicsController *second,
-                 const PHY_ICollData *colldata,
-                 bool isFirst);
-    NewCollision(const NewCollision &to_copy);
-    bool operator<(const NewCollision &other) const;
+  /// Pair of colliding objects, unique in a frame.
+  struct CollisionPair {
+    PHY_IPhysicsController *first;
+    PHY_IPhysicsController *second;
+    /// Indices of the first and last manifold of the pair.
+    int firstManifold;
+    int lastManifold;
+  };
+
+  /// An object of a collision pair, used to dispatch all the pairs of an object at once.
+  struct CollisionSide {
+    KX_ClientObjectInfo *info;
+    unsigned int pair;
+    /// The object is the first of the pair.
+    bool first;
   };
 
   PHY_IPhysicsEnvironment *m_physEnv;
 
-  std::set<NewCollision> m_newCollisions;
+  /** Contiguous collision buffers filled during the physics step and cleared once dispatched,
+   * their capacity is kept between the frames to not allocate for each contact.
+   */
+  std::vector<CollisionPair> m_pairs;
+  std::vector<CollisionManifold> m_manifolds;
+  std::vector<CollisionSide> m_sides;
+  /// Index of each pair in m_pairs, the key is sorted to merge both object orders.
+  blender::Map<std::pair<PHY_IPhysicsController *, PHY_IPhysicsController *>, unsigned int>
+      m_pairIndices;
 
   static bool newCollisionResponse(void *client_data,
                                    PHY_IPhysicsController *ctrl1,
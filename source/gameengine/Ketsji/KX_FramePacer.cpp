@@ -0,0 +1,168 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_FramePacer.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "CM_Clock.h"
+#include "KX_PythonInit.h"
+
+/// Number of sleeps used to calibrate the sleep resolution.
+static const unsigned int CALIBRATION_SAMPLES = 5;
+/// Duration of a calibration sleep in seconds.
+static const double CALIBRATION_SLEEP = 1.0e-3;
+/// Maximum sleep resolution as a fraction of the time to wait, so that a wait can always sleep.
+static const double MAX_RESOLUTION_FACTOR = 0.5;
+/// Factor applied to the sleep resolution after each sleep or wait without sleep.
+static const double RESOLUTION_DECAY = 0.99;
+
+KX_FramePacer::KX_FramePacer()
+    : m_enabled(true), m_latency(0.5e-3), m_sleepResolution(CALIBRATION_SLEEP)
+{
+  ResetStatistics();
+}
+
+void KX_FramePacer::Sleep(const CM_Clock &clock, double duration, double maxResolution)
+{
+  const double start = clock.GetTimeSecond();
+  std::this_thread::sleep_for(std::chrono::nanoseconds((long long)(duration * 1.0e9)));
+  const double overshoot = clock.GetTimeSecond() - start - duration;
+
+  /* Follow immediately a larger overshoot to not miss the next frames, and decrease slowly when
+   * the system wakes up more precisely. A single long overshoot, as when the process was
+   * preempted, must not prevent the next waits to sleep. */
+  if (overshoot > m_sleepResolution) {
+    m_sleepResolution = std::min(overshoot, maxResolution);
+  }
+  else {
+    m_sleepResolution = m_sleepResolution * RESOLUTION_DECAY +
+                        std::max(overshoot, 0.0) * (1.0 - RESOLUTION_DECAY);
+  }
+}
+
+void KX_FramePacer::Calibrate(const CM_Clock &clock)
+{
+  m_sleepResolution = 0.0;
+  for (unsigned int i = 0; i < CALIBRATION_SAMPLES; ++i) {
+    const double start = clock.GetTimeSecond();
+    std::this_thread::sleep_for(
+        std::chrono::nanoseconds((long long)(CALIBRATION_SLEEP * 1.0e9)));
+    const double overshoot = clock.GetTimeSecond() - start - CALIBRATION_SLEEP;
+    m_sleepResolution = std::max(m_sleepResolution, overshoot);
+  }
+}
+
+void KX_FramePacer::Wait(const CM_Clock &clock, double time)
+{
+  if (!m_enabled) {
+    return;
+  }
+
+  const double start = clock.GetTimeSecond();
+  // The frame is already late, nothing to pace.
+  if (start >= time) {
+    return;
+  }
+
+  const double maxResolution = (time - start) * MAX_RESOLUTION_FACTOR;
+
+  /* Sleep while the wake up can't exceed the frame time minus the latency. The Python threads
+   * run during the sleeps, the GIL is taken back before spinning so the delay to get it is
+   * absorbed by the spin. */
+  double now = start;
+  bool slept = false;
+  {
+    KX_PythonThreadsAllowed allowThreads;
+    for (double remaining = time - now - m_sleepResolution - m_latency; remaining > 0.0;
+         remaining = time - now - m_sleepResolution - m_latency)
+    {
+      Sleep(clock, remaining, maxResolution);
+      now = clock.GetTimeSecond();
+      slept = true;
+    }
+  }
+
+  /* The resolution is only decreased by the sleeps, decrease it also when it prevented to sleep
+   * to not spin every following frame. */
+  if (!slept) {
+    m_sleepResolution *= RESOLUTION_DECAY;
+  }
+
+  const double sleepEnd = now;
+
+  // Spin the remaining time, yielding to the other threads.
+  while (now < time) {
+    std::this_thread::yield();
+    now = clock.GetTimeSecond();
+  }
+
+  const double error = now - time;
+  ++m_statistics.waits;
+  m_totalError += error;
+  m_statistics.meanError = m_totalError / m_statistics.waits;
+  m_statistics.maxError = std::max(m_statistics.maxError, error);
+  m_statistics.sleepTime += sleepEnd - start;
+  m_statistics.spinTime += now - sleepEnd;
+}
+
+bool KX_FramePacer::GetEnabled() const
+{
+  return m_enabled;
+}
+
+void KX_FramePacer::SetEnabled(bool enabled)
+{
+  m_enabled = enabled;
+}
+
+double KX_FramePacer::GetLatency() const
+{
+  return m_latency;
+}
+
+void KX_FramePacer::SetLatency(double latency)
+{
+  m_latency = std::max(latency, 0.0);
+}
+
+double KX_FramePacer::GetSleepResolution() const
+{
+  return m_sleepResolution;
+}
+
+const KX_FramePacer::Statistics &KX_FramePacer::GetStatistics() const
+{
+  return m_statistics;
+}
+
+void KX_FramePacer::ResetStatistics()
+{
+  m_statistics = {0, 0.0, 0.0, 0.0, 0.0};
+  m_totalError = 0.0;
+}
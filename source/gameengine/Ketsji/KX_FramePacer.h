@@ -0,0 +1,84 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_FramePacer.h
+ *  \ingroup ketsji
+ */
+
+#pragma once
+
+class CM_Clock;
+
+/** Wait for the next frame time without keeping a core busy.
+ *
+ * The thread sleeps while the remaining time is above the sleep resolution of the system
+ * plus a target latency, then spins until the frame time. The sleep resolution is calibrated
+ * at startup and adapted to the overshoot of every sleep, it is limited to half the time to
+ * wait and decays when a wait couldn't sleep.
+ */
+class KX_FramePacer {
+ public:
+  struct Statistics {
+    /// Number of waits.
+    unsigned int waits;
+    /// Mean and maximum delay after the frame time when a wait ends, in seconds.
+    double meanError;
+    double maxError;
+    /// Total time spent sleeping and spinning in seconds.
+    double sleepTime;
+    double spinTime;
+  };
+
+ private:
+  bool m_enabled;
+  /// Time before the frame time from which the thread spins instead of sleeping, in seconds.
+  double m_latency;
+  /// Estimated maximum overshoot of a sleep, in seconds.
+  double m_sleepResolution;
+
+  Statistics m_statistics;
+  double m_totalError;
+
+  /** Sleep the given duration and update the sleep resolution from the overshoot, limited to
+   * maxResolution. */
+  void Sleep(const CM_Clock &clock, double duration, double maxResolution);
+
+ public:
+  KX_FramePacer();
+
+  /// Estimate the sleep resolution of the system with a few short sleeps.
+  void Calibrate(const CM_Clock &clock);
+
+  /** Return when the clock reaches the given time in seconds, does nothing if disabled.
+   * The GIL is released while sleeping.
+   */
+  void Wait(const CM_Clock &clock, double time);
+
+  bool GetEnabled() const;
+  void SetEnabled(bool enabled);
+  double GetLatency() const;
+  void SetLatency(double latency);
+  double GetSleepResolution() const;
+
+  const Statistics &GetStatistics() const;
+  void ResetStatistics();
+};
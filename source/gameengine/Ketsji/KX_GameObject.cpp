@@ -38,6 +38,8 @@
 
 #include "KX_GameObject.h"
 
+#include <algorithm>
+
 #include "BKE_lib_id.hh"
 #include "BKE_mball.hh"
 #include "BKE_modifier.hh"
@@ -55,12 +57,16 @@
 #include "KX_LodLevel.h"
 #include "KX_LodManager.h"
 #include "KX_MeshProxy.h"
+#include "KX_MotionState.h"
 #include "KX_NetworkMessageScene.h"  //Needed for sendMessage()
 #include "KX_NodeRelationships.h"
 #include "KX_PolyProxy.h"
 #include "KX_PyMath.h"
 #include "KX_PythonComponent.h"
 #include "KX_RayCast.h"
+#include "PHY_IGraphicController.h"
+#include "PHY_IPhysicsEnvironment.h"
+#include "RAS_Polygon.h"
 #include "SCA_ISensor.h"
 #include "SG_Controller.h"
 
@@ -95,7 +101,14 @@ KX_GameObject::KX_GameObject()
       m_objectColor(1.0f, 1.0f, 1.0f, 1.0f),
       m_bVisible(true),
       m_bOccluder(false),
+      m_hasPreviousTransform(false),
+      m_renderInterpolated(false),
+      m_isolationDepsgraph(nullptr),
+      m_isolationRelationsCount(0),
+      m_transformIsolated(false),
       m_pPhysicsController(nullptr),
+      m_graphicController(nullptr),
+      m_culled(false),
       m_pSGNode(nullptr),
       m_pInstanceObjects(nullptr),
       m_pDupliGroupObject(nullptr),
@@ -198,6 +211,10 @@ KX_GameObject::~KX_GameObject()
     delete m_pPhysicsController;
   }
 
+  if (m_graphicController) {
+    delete m_graphicController;
+  }
+
   if (m_actionManager) {
     delete m_actionManager;
   }
@@ -219,6 +236,7 @@ KX_GameObject::~KX_GameObject()
 void KX_GameObject::SetBlenderObject(Object *obj)
 {
   m_pBlenderObject = obj;
+  m_isolationDepsgraph = nullptr;
   if (obj) {
     Scene *scene = GetScene()->GetBlenderScene();
     ViewLayer *view_layer = BKE_view_layer_default_view(scene);
@@ -253,9 +271,12 @@ void KX_GameObject::ForceIgnoreParentTx()
 void KX_GameObject::TagForTransformUpdate(bool is_overlay_pass, bool is_last_render_pass)
 {
   float object_to_world[4][4];
-  NodeGetWorldTransform().getValue(&object_to_world[0][0]);
+  NodeGetRenderTransform().getValue(&object_to_world[0][0]);
   bool staticObject = true;
-  if (GetSGNode()->IsDirty(SG_Node::DIRTY_RENDER)) {
+  /* An interpolated object moves at each render, and once more after the interpolation
+   * to reach its final transform. */
+  const bool interpolated = IsRenderTransformInterpolated();
+  if (GetSGNode()->IsDirty(SG_Node::DIRTY_RENDER) || interpolated || m_renderInterpolated) {
     staticObject = false;
     /* Wait the end of all render passes (main + custom viewports)
      * to clear dirty render because we want the objects to
@@ -264,6 +285,7 @@ void KX_GameObject::TagForTransformUpdate(bool is_overlay_pass, bool is_last_ren
     if (is_last_render_pass) {
       GetSGNode()->ClearDirty(SG_Node::DIRTY_RENDER);
       copy_m4_m4(m_prevobject_to_world, object_to_world);
+      m_renderInterpolated = interpolated;
     }
   }
 
@@ -310,7 +332,21 @@ void KX_GameObject::TagForTransformUpdate(bool is_overlay_pass, bool is_last_ren
     if (applyTransformToOrig) {
       /* NORMAL CASE */
       if (!staticObject && ob_orig->type != OB_MBALL) {
-        DEG_id_tag_update(&ob_orig->id, ID_RECALC_TRANSFORM);
+        /* Fast path when nothing else depends on the object transform. The isolation walks the
+         * depsgraph, it is computed again only when the relations are rebuilt. */
+        const uint64_t relationsCount = DEG_get_relations_update_count(depsgraph);
+        if (m_isolationDepsgraph != depsgraph || m_isolationRelationsCount != relationsCount) {
+          m_transformIsolated = DEG_object_transform_is_isolated(depsgraph, ob_orig);
+          m_isolationDepsgraph = depsgraph;
+          m_isolationRelationsCount = relationsCount;
+        }
+
+        if (m_transformIsolated) {
+          GetScene()->AddTransformUpdateObject(ob_orig);
+        }
+        else {
+          DEG_id_tag_update(&ob_orig->id, ID_RECALC_TRANSFORM);
+        }
       }
       /* SPECIAL CASE: EXPERIMENTAL -> TEST METABALLS (incomplete) (TODO restore elems position at
        * ge exit) */
@@ -331,7 +367,7 @@ void KX_GameObject::TagForTransformUpdate(bool is_overlay_pass, bool is_last_ren
 void KX_GameObject::TagForTransformUpdateEvaluated()
 {
   float object_to_world[4][4];
-  NodeGetWorldTransform().getValue(&object_to_world[0][0]);
+  NodeGetRenderTransform().getValue(&object_to_world[0][0]);
 
   bContext *C = KX_GetActiveEngine()->GetContext();
   Depsgraph *depsgraph = CTX_data_depsgraph_on_load(C);
@@ -919,7 +955,13 @@ void KX_GameObject::ProcessReplica()
   }
 
   m_pPhysicsController = nullptr;
+  m_isolationDepsgraph = nullptr;
+  // Created again by the next culling pass for the replica transform.
+  m_graphicController = nullptr;
+  m_culled = false;
   m_pSGNode = nullptr;
+  m_hasPreviousTransform = false;
+  m_renderInterpolated = false;
 
   /* Dupli group and instance list are set later in replication.
    * See KX_Scene::DupliGroupRecurse. */
@@ -1093,7 +1135,84 @@ void KX_GameObject::RemoveMeshes()
 
 bool KX_GameObject::UseCulling() const
 {
-  return false;
+  // Only the static geometry is culled, deformed meshes have varying bounds.
+  if (!m_pBlenderObject || IsDeformable()) {
+    return false;
+  }
+
+  switch (m_pBlenderObject->type) {
+    case OB_MESH:
+    case OB_CURVES_LEGACY:
+    case OB_SURF:
+    case OB_FONT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+PHY_IGraphicController *KX_GameObject::GetGraphicController() const
+{
+  return m_graphicController;
+}
+
+bool KX_GameObject::CreateGraphicController()
+{
+  BLI_assert(!m_graphicController);
+
+  Depsgraph *depsgraph = CTX_data_depsgraph_on_load(KX_GetActiveEngine()->GetContext());
+  Object *ob_eval = DEG_get_evaluated_object(depsgraph, m_pBlenderObject);
+  const std::optional<blender::Bounds<blender::float3>> bounds = BKE_object_boundbox_get(ob_eval);
+  if (!bounds) {
+    return false;
+  }
+
+  PHY_IPhysicsEnvironment *physEnv = GetScene()->GetPhysicsEnvironment();
+  PHY_IMotionState *motionState = new KX_MotionState(m_pSGNode);
+  m_graphicController = physEnv->CreateGraphicController(
+      motionState,
+      MT_Vector3(bounds->min.x, bounds->min.y, bounds->min.z),
+      MT_Vector3(bounds->max.x, bounds->max.y, bounds->max.z));
+  if (!m_graphicController) {
+    delete motionState;
+    return false;
+  }
+
+  m_graphicController->SetNewClientInfo(m_pClient_info);
+  m_graphicController->Activate(true);
+  return true;
+}
+
+bool KX_GameObject::GetCulled() const
+{
+  return m_culled;
+}
+
+void KX_GameObject::SetCulled(bool culled)
+{
+  m_culled = culled;
+}
+
+void KX_GameObject::SetBatchedObjects(
+    const std::vector<std::pair<unsigned int, std::string>> &objects)
+{
+  m_batchedObjects = objects;
+}
+
+std::string KX_GameObject::GetBatchedObjectName(unsigned int polygon) const
+{
+  // Find the last object starting before the polygon.
+  const auto it = std::upper_bound(
+      m_batchedObjects.begin(),
+      m_batchedObjects.end(),
+      polygon,
+      [](unsigned int index, const std::pair<unsigned int, std::string> &object) {
+        return index < object.first;
+      });
+  if (it == m_batchedObjects.begin()) {
+    return "";
+  }
+  return std::prev(it)->second;
 }
 
 void KX_GameObject::SetLodManager(KX_LodManager *lodManager)
@@ -1722,6 +1841,59 @@ MT_Transform KX_GameObject::NodeGetLocalTransform() const
   return m_pSGNode->GetLocalTransform();
 }
 
+void KX_GameObject::StorePreviousTransform()
+{
+  m_previousPosition = m_pSGNode->GetWorldPosition();
+  m_previousOrientation = m_pSGNode->GetWorldOrientation();
+  m_previousScaling = m_pSGNode->GetWorldScaling();
+  m_hasPreviousTransform = true;
+}
+
+bool KX_GameObject::IsRenderTransformInterpolated() const
+{
+  const KX_Scene *scene = static_cast<KX_Scene *>(m_pSGNode->GetSGClientInfo());
+  if (!m_hasPreviousTransform || scene->GetRenderInterpolation() >= 1.0f) {
+    return false;
+  }
+
+  const MT_Matrix3x3 &orientation = m_pSGNode->GetWorldOrientation();
+  return !(m_previousPosition == m_pSGNode->GetWorldPosition() &&
+           m_previousScaling == m_pSGNode->GetWorldScaling() &&
+           m_previousOrientation[0] == orientation[0] &&
+           m_previousOrientation[1] == orientation[1] &&
+           m_previousOrientation[2] == orientation[2]);
+}
+
+void KX_GameObject::NodeGetRenderTransform(MT_Vector3 &position,
+                                           MT_Matrix3x3 &orientation,
+                                           MT_Vector3 &scaling) const
+{
+  position = m_pSGNode->GetWorldPosition();
+  orientation = m_pSGNode->GetWorldOrientation();
+  scaling = m_pSGNode->GetWorldScaling();
+
+  if (!IsRenderTransformInterpolated()) {
+    return;
+  }
+
+  const KX_Scene *scene = static_cast<KX_Scene *>(m_pSGNode->GetSGClientInfo());
+  const float factor = scene->GetRenderInterpolation();
+  position = m_previousPosition.lerp(position, factor);
+  orientation.setRotation(
+      m_previousOrientation.getRotation().slerp(orientation.getRotation(), factor));
+  scaling = m_previousScaling.lerp(scaling, factor);
+}
+
+MT_Transform KX_GameObject::NodeGetRenderTransform() const
+{
+  MT_Vector3 position;
+  MT_Matrix3x3 orientation;
+  MT_Vector3 scaling;
+  NodeGetRenderTransform(position, orientation, scaling);
+
+  return MT_Transform(position, orientation.scaled(scaling[0], scaling[1], scaling[2]));
+}
+
 void KX_GameObject::UnregisterCollisionCallbacks()
 {
   if (!GetPhysicsController()) {
@@ -2214,6 +2386,7 @@ PyMethodDef KX_GameObject::Methods[] = {
     EXP_PYMETHODTABLE_KEYWORDS(KX_GameObject, rayCast),
     EXP_PYMETHODTABLE_O(KX_GameObject, getDistanceTo),
     EXP_PYMETHODTABLE_O(KX_GameObject, getVectTo),
+    EXP_PYMETHODTABLE_O(KX_GameObject, getBatchedObjectName),
     EXP_PYMETHODTABLE_KEYWORDS(KX_GameObject, sendMessage),
     EXP_PYMETHODTABLE(KX_GameObject, addDebugProperty),
 
@@ -4492,6 +4665,39 @@ EXP_PYMETHODDEF_DOC_O(KX_GameObject,
   return nullptr;
 }
 
+EXP_PYMETHODDEF_DOC_O(KX_GameObject,
+                      getBatchedObjectName,
+                      "getBatchedObjectName(polygon): get the name of the object merged by the "
+                      "static batching owning a polygon\n")
+{
+  unsigned int index;
+  if (PyObject_TypeCheck(value, &KX_PolyProxy::Type)) {
+    KX_PolyProxy *polyproxy = static_cast<KX_PolyProxy *> EXP_PROXY_REF(value);
+    if (!polyproxy) {
+      PyErr_SetString(PyExc_SystemError,
+                      "gameOb.getBatchedObjectName(polygon): KX_GameObject, " EXP_PROXY_ERROR_MSG);
+      return nullptr;
+    }
+    RAS_MeshObject *meshobj = polyproxy->GetMeshProxy()->GetMesh();
+    index = polyproxy->GetPolygon() - meshobj->GetPolygon(0);
+  }
+  else {
+    index = PyLong_AsUnsignedLong(value);
+    if (index == (unsigned int)-1 && PyErr_Occurred()) {
+      PyErr_SetString(PyExc_TypeError,
+                      "gameOb.getBatchedObjectName(polygon): KX_GameObject, expected a "
+                      "KX_PolyProxy or a polygon index");
+      return nullptr;
+    }
+  }
+
+  const std::string name = GetBatchedObjectName(index);
+  if (name.empty()) {
+    Py_RETURN_NONE;
+  }
+  return PyUnicode_FromStdString(name);
+}
+
 EXP_PYMETHODDEF_DOC_O(
     KX_GameObject,
     getVectTo,
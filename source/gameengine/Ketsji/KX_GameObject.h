@@ -40,6 +40,7 @@
 
 #include <stddef.h>
 
+#include "CM_Memory.h"
 #include "DNA_constraint_types.h" /* for constraint replication */
 #include "DNA_object_types.h"
 
@@ -58,8 +59,10 @@ class KX_LodManager;
 class KX_PythonComponent;
 class RAS_MeshObject;
 class PHY_IPhysicsController;
+class PHY_IGraphicController;
 class BL_ActionManager;
 struct Object;
+struct Depsgraph;
 class KX_CollisionContactPointList;
 struct bAction;
 
@@ -131,7 +134,27 @@ class KX_GameObject : public SCA_IObject {
   // Object activity culling settings converted from blender objects.
   ActivityCullingInfo m_activityCullingInfo;
 
+  /// World transform at the beginning of the last simulation frame, for render interpolation.
+  MT_Vector3 m_previousPosition;
+  MT_Matrix3x3 m_previousOrientation;
+  MT_Vector3 m_previousScaling;
+  bool m_hasPreviousTransform;
+  /// True if the last rendered transform was interpolated.
+  bool m_renderInterpolated;
+
+  /// Depsgraph and relations update count of the cached transform isolation, see
+  /// DEG_object_transform_is_isolated.
+  const Depsgraph *m_isolationDepsgraph;
+  uint64_t m_isolationRelationsCount;
+  bool m_transformIsolated;
+
   PHY_IPhysicsController *m_pPhysicsController;
+  /// Bounds of the object in the scene culling tree, created by the first culling pass.
+  PHY_IGraphicController *m_graphicController;
+  /// Outside of the camera frustum or occluded in the last culling pass.
+  bool m_culled;
+  /// Index of the first mesh polygon and name of each object merged by the static batching.
+  std::vector<std::pair<unsigned int, std::string>> m_batchedObjects;
   SG_Node *m_pSGNode;
 
   EXP_ListValue<KX_GameObject> *m_pInstanceObjects;
@@ -140,8 +163,6 @@ class KX_GameObject : public SCA_IObject {
   // The action manager is used to play/stop/update actions
   BL_ActionManager *m_actionManager;
 
-  BL_ActionManager *GetActionManager();
-
 #ifdef WITH_PYTHON
   EXP_ListValue<KX_PythonComponent> *m_components;
 #endif
@@ -166,6 +187,8 @@ class KX_GameObject : public SCA_IObject {
   void SyncTransformWithDepsgraph();
   void SetIsReplicaObject();
   float *GetPrevObjectMatToWorld();
+  /// Get the action manager, created and registered in the scene animated objects if needed.
+  BL_ActionManager *GetActionManager();
   BL_ActionManager *GetActionManagerNoCreate();
   /* END OF EEVEE INTEGRATION */
 
@@ -484,6 +507,18 @@ class KX_GameObject : public SCA_IObject {
   const MT_Vector3 &NodeGetLocalPosition() const;
   MT_Transform NodeGetLocalTransform() const;
 
+  /// Store the world transform before a simulation frame, see KX_Scene::StorePreviousTransforms.
+  void StorePreviousTransform();
+  /// Return true if the render transform is interpolated and differs from the world transform.
+  bool IsRenderTransformInterpolated() const;
+  /** Get the world transform to render, interpolated between the beginning and the end of the
+   * last simulation frame by the scene render interpolation factor.
+   */
+  void NodeGetRenderTransform(MT_Vector3 &position,
+                              MT_Matrix3x3 &orientation,
+                              MT_Vector3 &scaling) const;
+  MT_Transform NodeGetRenderTransform() const;
+
   /**
    * \section scene graph node accessor functions.
    */
@@ -682,6 +717,22 @@ class KX_GameObject : public SCA_IObject {
   /// Return true when the object can be culled.
   bool UseCulling() const;
 
+  PHY_IGraphicController *GetGraphicController() const;
+  /** Create the graphic controller from the bounds of the evaluated object and add it to the
+   * culling tree of the scene physics environment.
+   * \return False if the object has no bounds yet.
+   */
+  bool CreateGraphicController();
+
+  bool GetCulled() const;
+  void SetCulled(bool culled);
+
+  void SetBatchedObjects(const std::vector<std::pair<unsigned int, std::string>> &objects);
+  /** Return the name of the merged object owning a polygon of the mesh.
+   * \return An empty string if the object is not a static batch.
+   */
+  std::string GetBatchedObjectName(unsigned int polygon) const;
+
   /**
    * Was this object marked visible? (only for the explicit
    * visibility system).
@@ -830,6 +881,7 @@ class KX_GameObject : public SCA_IObject {
   EXP_PYMETHOD_DOC(KX_GameObject, rayCast);
   EXP_PYMETHOD_DOC_O(KX_GameObject, getDistanceTo);
   EXP_PYMETHOD_DOC_O(KX_GameObject, getVectTo);
+  EXP_PYMETHOD_DOC_O(KX_GameObject, getBatchedObjectName);
   EXP_PYMETHOD_DOC(KX_GameObject, sendMessage);
   EXP_PYMETHOD(KX_GameObject, ReinstancePhysicsMesh);
   EXP_PYMETHOD_O(KX_GameObject, ReplacePhysicsShape);
@@ -1075,4 +1127,6 @@ class KX_GameObject : public SCA_IObject {
   static PyMappingMethods Mapping;
   static PySequenceMethods Sequence;
 #endif
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_KETSJI, "KX_GameObject")
 };
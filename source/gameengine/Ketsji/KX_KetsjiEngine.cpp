@@ -47,18 +47,24 @@
 
 #include "BL_Converter.h"
 #include "BL_SceneConverter.h"
+#include "CM_Memory.h"
 #include "DEV_Joystick.h"  // for DEV_Joystick::HandleEvents
 #include "KX_Camera.h"
 #include "KX_Globals.h"
+#include "KX_NetworkMessageManager.h"
 #include "KX_NetworkMessageScene.h"
+#include "KX_NetworkReplication.h"
 #include "KX_PyConstraintBinding.h"
 #include "KX_PythonInit.h"  // for updatePythonJoysticks
+#include "KX_SceneSnapshot.h"
+#include "KX_StreamingManager.h"
 #include "PHY_IPhysicsEnvironment.h"
 #include "RAS_FrameBuffer.h"
 #include "RAS_ICanvas.h"
 #include "SCA_IInputDevice.h"
 
 #define DEFAULT_LOGIC_TIC_RATE 60.0
+#define DEFAULT_MAX_RENDER_RATE 240.0
 
 #ifdef FREE_WINDOWS /* XXX mingw64 (gcc 4.7.0) defines a macro for DrawText that translates to \
                        DrawTextA. Not good */
@@ -141,9 +147,11 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system,
       m_previousRealTime(0.0f),
       m_previous_deltaTime(0.0f),
       m_firstEngineFrame(true),
+      m_hasPreviousTransforms(false),
       m_maxLogicFrame(5),
       m_maxPhysicsFrame(5),
       m_ticrate(DEFAULT_LOGIC_TIC_RATE),
+      m_maxRenderRate(DEFAULT_MAX_RENDER_RATE),
       m_anim_framerate(25.0),
       m_doRender(true),
       m_exitkey(130),
@@ -168,6 +176,7 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system,
 
   m_scenes = new EXP_ListValue<KX_Scene>();
   m_renderingCameras = {};
+  m_snapshotWriter = new KX_SnapshotWriter();
 }
 
 /**
@@ -180,6 +189,9 @@ KX_KetsjiEngine::~KX_KetsjiEngine()
 #endif
 
   m_scenes->Release();
+
+  // Wait for the snapshot files being written.
+  delete m_snapshotWriter;
 }
 
 /* EEVEE integration */
@@ -257,6 +269,8 @@ void KX_KetsjiEngine::SetConverter(BL_Converter *converter)
 
 void KX_KetsjiEngine::StartEngine()
 {
+  m_framePacer.Calibrate(m_clock);
+
   // Reset the clock to start at 0.0.
   m_clock.Reset();
 
@@ -274,7 +288,7 @@ void KX_KetsjiEngine::EndFrame()
 {
   // Show profiling info
   m_logger.StartLog(tc_overhead);
-  if (m_flags & (SHOW_PROFILE | SHOW_FRAMERATE | SHOW_DEBUG_PROPERTIES)) {
+  if (m_flags & (SHOW_PROFILE | SHOW_FRAMERATE | SHOW_DEBUG_PROPERTIES | SHOW_MEMORY)) {
     RenderDebugProperties();
   }
 
@@ -300,6 +314,7 @@ void KX_KetsjiEngine::EndFrame()
 
   // Go to next profiling measurement, time spent after this call is shown in the next frame.
   m_logger.NextMeasurement();
+  NextMemoryMeasurement();
 
   m_logger.StartLog(tc_rasterizer);
   m_rasterizer->EndFrame();
@@ -309,7 +324,11 @@ void KX_KetsjiEngine::EndFrame()
 
   // swap backbuffer (drawing into this buffer) <-> front/visible buffer
   m_logger.StartLog(tc_latency);
-  m_canvas->SwapBuffers();
+  {
+    // The swap can wait for the vertical synchronization.
+    KX_PythonThreadsAllowed allowThreads;
+    m_canvas->SwapBuffers();
+  }
   m_logger.StartLog(tc_rasterizer);
 
   m_canvas->EndDraw();
@@ -319,7 +338,7 @@ void KX_KetsjiEngine::EndFrameViewportRender()
 {
   // Show profiling info
   m_logger.StartLog(tc_overhead);
-  if (m_flags & (SHOW_PROFILE | SHOW_FRAMERATE | SHOW_DEBUG_PROPERTIES)) {
+  if (m_flags & (SHOW_PROFILE | SHOW_FRAMERATE | SHOW_DEBUG_PROPERTIES | SHOW_MEMORY)) {
     RenderDebugProperties();
   }
 
@@ -345,6 +364,7 @@ void KX_KetsjiEngine::EndFrameViewportRender()
 
   // Go to next profiling measurement, time spent after this call is shown in the next frame.
   m_logger.NextMeasurement();
+  NextMemoryMeasurement();
 
   m_logger.StartLog(tc_rasterizer);
   // m_rasterizer->EndFrame();
@@ -383,6 +403,17 @@ KX_KetsjiEngine::FrameTimes KX_KetsjiEngine::GetFrameTimes()
 
   // Update time if the user is not controlling it.
   if (!(m_flags & USE_EXTERNAL_CLOCK)) {
+    /* In fixed framerate, wait the next frame instead of looping without any frame to proceed.
+     * When the render is interpolated between the frames, wait the next render frame limited
+     * by the maximum render rate. */
+    if ((m_flags & FIXED_FRAMERATE) && !m_firstEngineFrame) {
+      if (!(m_flags & INTERPOLATE_TRANSFORMS)) {
+        m_framePacer.Wait(m_clock, m_previousRealTime + 1.0 / m_ticrate);
+      }
+      else if (m_maxRenderRate > 0.0) {
+        m_framePacer.Wait(m_clock, m_clockTime + 1.0 / m_maxRenderRate);
+      }
+    }
     m_clockTime = m_clock.GetTimeSecond();
   }
 
@@ -395,6 +426,10 @@ KX_KetsjiEngine::FrameTimes KX_KetsjiEngine::GetFrameTimes()
   // Get elapsed time.
   double dt = m_clockTime - m_previousRealTime;
 
+  /* With interpolation the time remaining after the last fixed frame is kept for the next frames
+   * and used to interpolate the render, unless the frames were limited. */
+  bool keepRemainder = (m_flags & FIXED_FRAMERATE) && (m_flags & INTERPOLATE_TRANSFORMS);
+
   // Fix strange behavior of deltaTime and physics.
   const double averageFrameRate = GetAverageFrameRate();
   double maxDeltaTime = 1.5f;
@@ -410,6 +445,7 @@ KX_KetsjiEngine::FrameTimes KX_KetsjiEngine::GetFrameTimes()
   // having sudden movements.
   if (dt > maxDeltaTime) {
     dt = maxDeltaTime;  // set deltaTime to max value.
+    keepRemainder = false;
   }
 
   // Time of a frame (without scale).
@@ -439,22 +475,13 @@ KX_KetsjiEngine::FrameTimes KX_KetsjiEngine::GetFrameTimes()
   if (frames > maxFrames) {
     timestep = dt / maxFrames;
     frames = maxFrames;
+    keepRemainder = false;
   }
 
   // If the number of frame is non-zero, update previous time.
   if (frames > 0) {
-    m_previousRealTime = m_clockTime;
+    m_previousRealTime = keepRemainder ? m_previousRealTime + frames * timestep : m_clockTime;
   }
-  //// Else in case of fixed framerate, try to sleep until the next frame.
-  // else if (m_flags & FIXED_FRAMERATE) {
-  //  const double sleeptime = timestep - dt - 1.0e-3;
-  //  /* If the remaining time is greather than 1ms (sleep resolution) sleep this thread.
-  //   * The other 1ms will be busy wait.
-  //   */
-  //  if (sleeptime > 0.0) {
-  //    std::this_thread::sleep_for(std::chrono::nanoseconds((long)(sleeptime * 1.0e9)));
-  //  }
-  //}
 
   // Frame time with time scale.
   const double framestep = timestep * m_timescale;
@@ -463,21 +490,43 @@ KX_KetsjiEngine::FrameTimes KX_KetsjiEngine::GetFrameTimes()
   times.frames = frames;
   times.timestep = timestep;
   times.framestep = framestep;
+  times.interpolation = keepRemainder ?
+                            min_dd((m_clockTime - m_previousRealTime) / timestep, 1.0) :
+                            1.0;
 
   return times;
 }
 
+void KX_KetsjiEngine::SetRenderInterpolation(double interpolation)
+{
+  for (KX_Scene *scene : m_scenes) {
+    scene->SetRenderInterpolation(interpolation);
+  }
+}
+
 bool KX_KetsjiEngine::NextFrame()
 {
   m_logger.StartLog(tc_services);
 
   const FrameTimes times = GetFrameTimes();
 
+  if (!(m_flags & INTERPOLATE_TRANSFORMS)) {
+    m_hasPreviousTransforms = false;
+  }
+  // Interpolate only from transforms stored before the last frame.
+  const double interpolation = m_hasPreviousTransforms ? times.interpolation : 1.0;
+
   // Exit if zero frame is sheduled.
   if (times.frames == 0) {
     // Start logging time spent outside main loop
     m_logger.StartLog(tc_outside);
 
+    // Render the objects moving between the last and the next frame.
+    if (interpolation < 1.0) {
+      SetRenderInterpolation(interpolation);
+      return m_doRender;
+    }
+
     return false;
   }
 
@@ -485,6 +534,13 @@ bool KX_KetsjiEngine::NextFrame()
     m_frameTime += times.framestep;
 
     m_converter->MergeAsyncLoads();
+    m_converter->UpdateFreeingLibraries(BL_Converter::FREE_LIBRARY_BUDGET);
+
+    if (i == 0) {
+      for (KX_Scene *scene : m_scenes) {
+        scene->GetStreamingManager()->Update();
+      }
+    }
 
     m_inputDevice->ReleaseMoveEvent();
 
@@ -523,6 +579,11 @@ bool KX_KetsjiEngine::NextFrame()
       // set Python hooks for each scene
       KX_SetActiveScene(scene);
 
+      if (m_flags & INTERPOLATE_TRANSFORMS) {
+        m_logger.StartLog(tc_scenegraph);
+        scene->StorePreviousTransforms();
+      }
+
       // Process sensors, and controllers
       m_logger.StartLog(tc_logic);
       scene->LogicBeginFrame(m_frameTime, times.framestep);
@@ -546,6 +607,8 @@ bool KX_KetsjiEngine::NextFrame()
 
       m_logger.StartLog(tc_physics);
 
+      /* The GIL is kept, the physics step writes the game objects and scene graph nodes through
+       * the motion states. */
       // Perform physics calculations on the scene. This can involve
       // many iterations of the physics solver.
       scene->GetPhysicsEnvironment()->ProceedDeltaTime(
@@ -563,6 +626,16 @@ bool KX_KetsjiEngine::NextFrame()
     }
 
     m_logger.StartLog(tc_network);
+    if (m_networkMessageManager->GetTransport().IsOpen()) {
+      /* Received messages are added before swapping the message lists to be
+       * readable in this frame, states are applied before the logic. */
+      m_networkMessageManager->ReceivePackets();
+      for (KX_Scene *scene : m_scenes) {
+        scene->GetNetworkReplication()->Update(m_networkMessageManager,
+                                               scene->GetActiveCamera());
+      }
+      m_networkMessageManager->SendPackets();
+    }
     m_networkMessageManager->ClearMessages();
 
     // update system devices
@@ -573,6 +646,9 @@ bool KX_KetsjiEngine::NextFrame()
     ProcessScheduledScenes();
   }
 
+  m_hasPreviousTransforms = (m_flags & INTERPOLATE_TRANSFORMS);
+  SetRenderInterpolation(m_hasPreviousTransforms ? times.interpolation : 1.0);
+
   // Start logging time spent outside main loop
   m_logger.StartLog(tc_outside);
 
@@ -598,9 +674,13 @@ KX_KetsjiEngine::CameraRenderData KX_KetsjiEngine::GetCameraRenderData(
     rendercam->SetScene(scene);
     rendercam->SetCameraData(*camera->GetCameraData());
     rendercam->SetName("__stereo_" + camera->GetName() + "_" + std::to_string(eye) + "__");
-    rendercam->NodeSetGlobalOrientation(camera->NodeGetWorldOrientation());
-    rendercam->NodeSetWorldPosition(camera->NodeGetWorldPosition());
-    rendercam->NodeSetWorldScale(camera->NodeGetWorldScaling());
+    MT_Vector3 position;
+    MT_Matrix3x3 orientation;
+    MT_Vector3 scaling;
+    camera->NodeGetRenderTransform(position, orientation, scaling);
+    rendercam->NodeSetGlobalOrientation(orientation);
+    rendercam->NodeSetWorldPosition(position);
+    rendercam->NodeSetWorldScale(scaling);
     rendercam->NodeUpdateGS(0.0);
     rendercam->MarkForDeletion();
   }
@@ -621,7 +701,7 @@ KX_KetsjiEngine::CameraRenderData KX_KetsjiEngine::GetCameraRenderData(
 
   // Compute the camera matrices: modelview and projection.
   const MT_Matrix4x4 viewmat = m_rasterizer->GetViewMatrix(
-      eye, rendercam->GetWorldToCamera(), rendercam->GetCameraData()->m_perspective);
+      eye, rendercam->GetRenderWorldToCamera(), rendercam->GetCameraData()->m_perspective);
   const MT_Matrix4x4 projmat = GetCameraProjectionMatrix(scene, rendercam, eye, viewport, area);
   rendercam->SetModelviewMatrix(viewmat);
   rendercam->SetProjectionMatrix(projmat);
@@ -1062,7 +1142,7 @@ void KX_KetsjiEngine::RenderCamera(KX_Scene *scene,
                                    unsigned short pass)
 {
   KX_Camera *rendercam = cameraFrameData.m_renderCamera;
-  // KX_Camera *cullingcam = cameraFrameData.m_cullingCamera;
+  KX_Camera *cullingcam = cameraFrameData.m_cullingCamera;
   // const RAS_Rect &area = cameraFrameData.m_area;
   const RAS_Rect &viewport = cameraFrameData.m_viewport;
 
@@ -1082,6 +1162,11 @@ void KX_KetsjiEngine::RenderCamera(KX_Scene *scene,
   m_logger.StartLog(tc_animations);
   UpdateAnimations(scene);
 
+  if (scene->GetDbvtCulling()) {
+    m_logger.StartLog(tc_scenegraph);
+    scene->CalculateVisibleObjects(cullingcam, viewport);
+  }
+
   m_logger.StartLog(tc_rasterizer);
 
 #ifdef WITH_PYTHON
@@ -1309,10 +1394,59 @@ void KX_KetsjiEngine::RenderDebugProperties()
           MT_Vector2(xcoord + (int)(2.2 * profile_indent), ycoord), boxSize, white);
       ycoord += const_ysize;
     }
+
+    // Culling display, summed over the scenes using the DBVT culling.
+    bool culling = false;
+    unsigned int numVisible = 0;
+    unsigned int numCulled = 0;
+    for (KX_Scene *scene : m_scenes) {
+      if (scene->GetDbvtCulling()) {
+        culling = true;
+        numVisible += scene->GetNumVisibleObjects();
+        numCulled += scene->GetNumCulledObjects();
+      }
+    }
+
+    if (culling) {
+      debugDraw.RenderText2D("Culling:", MT_Vector2(xcoord + const_xindent, ycoord), white);
+
+      debugtxt = (boost::format("%d visible | %d culled") % numVisible % numCulled).str();
+      debugDraw.RenderText2D(
+          debugtxt, MT_Vector2(xcoord + const_xindent + profile_indent, ycoord), white);
+      ycoord += const_ysize;
+    }
   }
   // Add the ymargin for titles below the other section of debug info
   ycoord += title_y_top_margin;
 
+  // Memory display, allocation counts are those of the last frame.
+  if (m_flags & SHOW_MEMORY) {
+    debugDraw.RenderText2D(
+        "Memory", MT_Vector2(xcoord + const_xindent + title_xmargin, ycoord), white);
+
+    ycoord += const_ysize;
+    ycoord += title_y_bottom_margin;
+
+    for (int i = 0; i < CM_MEMORY_NUM_CATEGORIES; ++i) {
+      const CM_MemoryCategory category = (CM_MemoryCategory)i;
+      const CM_MemoryStatistics statistics = CM_MemoryGetStatistics(category);
+
+      debugDraw.RenderText2D(CM_MemoryGetCategoryName(category),
+                             MT_Vector2(xcoord + const_xindent, ycoord),
+                             white);
+
+      debugtxt = (boost::format("%.2fMB | peak %.2fMB | +%d -%d") %
+                  (statistics.current / 1048576.0f) % (statistics.peak / 1048576.0f) %
+                  statistics.frameAllocs % statistics.frameFrees)
+                     .str();
+      debugDraw.RenderText2D(
+          debugtxt, MT_Vector2(xcoord + const_xindent + profile_indent, ycoord), white);
+      ycoord += const_ysize;
+    }
+
+    ycoord += title_y_top_margin;
+  }
+
   /* Property display */
   if (m_flags & SHOW_DEBUG_PROPERTIES) {
     // Title for debugging("Debug properties")
@@ -1335,6 +1469,28 @@ void KX_KetsjiEngine::RenderDebugProperties()
   }
 }
 
+void KX_KetsjiEngine::NextMemoryMeasurement()
+{
+#ifdef WITH_PYTHON
+  for (int i = 0; i < CM_MEMORY_NUM_CATEGORIES; ++i) {
+    const CM_MemoryCategory category = (CM_MemoryCategory)i;
+    const CM_MemoryStatistics statistics = CM_MemoryGetStatistics(category);
+
+    PyObject *val = PyTuple_New(4);
+    PyTuple_SetItem(val, 0, PyLong_FromSize_t(statistics.current));
+    PyTuple_SetItem(val, 1, PyLong_FromSize_t(statistics.peak));
+    PyTuple_SetItem(val, 2, PyLong_FromUnsignedLong(statistics.frameAllocs));
+    PyTuple_SetItem(val, 3, PyLong_FromUnsignedLong(statistics.frameFrees));
+
+    const std::string label = std::string("Memory ") + CM_MemoryGetCategoryName(category);
+    PyDict_SetItemString(m_pyprofiledict, label.c_str(), val);
+    Py_DECREF(val);
+  }
+#endif
+
+  CM_MemoryNextFrame();
+}
+
 void KX_KetsjiEngine::DrawDebugCameraFrustum(KX_Scene *scene,
                                              RAS_DebugDraw &debugDraw,
                                              const CameraRenderData &cameraFrameData)
@@ -1495,6 +1651,16 @@ void KX_KetsjiEngine::SetTicRate(double ticrate)
   m_ticrate = ticrate;
 }
 
+double KX_KetsjiEngine::GetMaxRenderRate() const
+{
+  return m_maxRenderRate;
+}
+
+void KX_KetsjiEngine::SetMaxRenderRate(double rate)
+{
+  m_maxRenderRate = rate;
+}
+
 double KX_KetsjiEngine::GetTimeScale() const
 {
   return m_timescale;
@@ -1550,6 +1716,11 @@ double KX_KetsjiEngine::GetClockTime(void) const
   return m_clockTime;
 }
 
+KX_FramePacer &KX_KetsjiEngine::GetFramePacer()
+{
+  return m_framePacer;
+}
+
 void KX_KetsjiEngine::SetClockTime(double externalClockTime)
 {
   m_clockTime = externalClockTime;
@@ -37,6 +37,7 @@
 
 #include "CM_Clock.h"
 #include "EXP_Python.h"
+#include "KX_FramePacer.h"
 #include "KX_ISystem.h"
 #include "KX_Scene.h"
 #include "KX_TimeCategoryLogger.h"
@@ -47,6 +48,7 @@
 class KX_ISystem;
 class BL_Converter;
 class KX_NetworkMessageManager;
+class KX_SnapshotWriter;
 class RAS_ICanvas;
 class RAS_FrameBuffer;
 class SCA_IInputDevice;
@@ -90,7 +92,11 @@ class KX_KetsjiEngine {
     /// Automatic add debug properties to the debug list.
     AUTO_ADD_DEBUG_PROPERTIES = (1 << 6),
     /// Use override camera?
-    CAMERA_OVERRIDE = (1 << 7)
+    CAMERA_OVERRIDE = (1 << 7),
+    /// Interpolate the rendered transforms between fixed framerate frames?
+    INTERPOLATE_TRANSFORMS = (1 << 8),
+    /// Show the memory used by each game engine module on the game display?
+    SHOW_MEMORY = (1 << 9)
   };
 
  private:
@@ -140,6 +146,8 @@ class KX_KetsjiEngine {
   KX_ISystem *m_kxsystem;
   BL_Converter *m_converter;
   KX_NetworkMessageManager *m_networkMessageManager;
+  /// Writer of the scene snapshot files, shared by all scenes to outlive them.
+  KX_SnapshotWriter *m_snapshotWriter;
 #ifdef WITH_PYTHON
   PyObject *m_pyprofiledict;
 #endif
@@ -152,6 +160,8 @@ class KX_KetsjiEngine {
     double timestep;
     // Scaled duration of a frame.
     double framestep;
+    // Factor of the time elapsed since the last frame to interpolate the render, 1 to disable.
+    double interpolation;
   };
 
   CM_Clock m_clock;
@@ -183,12 +193,16 @@ class KX_KetsjiEngine {
   double m_previous_deltaTime;
   /// used to control strange behavior in clockTime physics when starting the game.
   bool m_firstEngineFrame;
+  /// True when the object transforms were stored before the last frame for interpolation.
+  bool m_hasPreviousTransforms;
 
   /// maximum number of consecutive logic frame
   int m_maxLogicFrame;
   /// maximum number of consecutive physics frame
   int m_maxPhysicsFrame;
   double m_ticrate;
+  /// Maximum number of render frames per second when the render is interpolated.
+  double m_maxRenderRate;
   /// for animation playback only - ipo and action
   double m_anim_framerate;
 
@@ -228,6 +242,8 @@ class KX_KetsjiEngine {
 
   /// Time logger.
   KX_TimeCategoryLogger m_logger;
+  /// Wait for the next fixed frame.
+  KX_FramePacer m_framePacer;
 
   /// Labels for profiling display.
   static const std::string m_profileLabels[tc_numCategories];
@@ -264,6 +280,8 @@ class KX_KetsjiEngine {
   /// EEVEE scene rendering
   void RenderCamera(KX_Scene *scene, class RAS_FrameBuffer *background_fb, const CameraRenderData &cameraFrameData, unsigned short pass);
   void RenderDebugProperties();
+  /// Export the memory statistics to the profile info and start counting a new frame.
+  void NextMemoryMeasurement();
   /// Debug draw cameras frustum of a scene.
   void DrawDebugCameraFrustum(KX_Scene *scene,
                               RAS_DebugDraw &debugDraw,
@@ -288,6 +306,8 @@ class KX_KetsjiEngine {
 
   void BeginFrame();
   FrameTimes GetFrameTimes();
+  /// Set the render interpolation factor of all scenes.
+  void SetRenderInterpolation(double interpolation);
 
  public:
   KX_KetsjiEngine(KX_ISystem *system,
@@ -343,6 +363,10 @@ class KX_KetsjiEngine {
   {
     return m_networkMessageManager;
   }
+  KX_SnapshotWriter *GetSnapshotWriter() const
+  {
+    return m_snapshotWriter;
+  }
 
   /// returns true if an update happened to indicate -> Render
   bool NextFrame();
@@ -393,6 +417,9 @@ class KX_KetsjiEngine {
    */
   double GetClockTime(void) const;
 
+  /// Return the pacer waiting for the next fixed frame.
+  KX_FramePacer &GetFramePacer();
+
   /**
    * Set the next render frame game time. It will impact also frame time, as
    * this one is derived from clocktime
@@ -417,6 +444,14 @@ class KX_KetsjiEngine {
    * Sets the number of logic updates per second.
    */
   void SetTicRate(double ticrate);
+  /**
+   * Gets the maximum number of render frames per second with render interpolation.
+   */
+  double GetMaxRenderRate() const;
+  /**
+   * Sets the maximum number of render frames per second with render interpolation.
+   */
+  void SetMaxRenderRate(double rate);
   /**
    * Gets the maximum number of logic frame before render frame
    */
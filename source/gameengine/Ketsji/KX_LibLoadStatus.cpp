@@ -38,6 +38,8 @@ KX_LibLoadStatus::KX_LibLoadStatus(class BL_Converter *kx_converter,
       m_data(nullptr),
       m_libname(path),
       m_progress(0.0f),
+      m_mergetime(0.0),
+      m_memory(0),
       m_finished(false)
 #ifdef WITH_PYTHON
       ,
@@ -137,6 +139,31 @@ void KX_LibLoadStatus::AddProgress(float progress)
   RunProgressCallback();
 }
 
+double KX_LibLoadStatus::GetTimeTaken() const
+{
+  return m_endtime - m_starttime;
+}
+
+double KX_LibLoadStatus::GetMergeTime() const
+{
+  return m_mergetime;
+}
+
+void KX_LibLoadStatus::AddMergeTime(double time)
+{
+  m_mergetime += time;
+}
+
+long long KX_LibLoadStatus::GetMemoryUsage() const
+{
+  return m_memory;
+}
+
+void KX_LibLoadStatus::AddMemoryUsage(long long size)
+{
+  m_memory += size;
+}
+
 #ifdef WITH_PYTHON
 
 PyMethodDef KX_LibLoadStatus::Methods[] = {
@@ -151,6 +178,8 @@ PyAttributeDef KX_LibLoadStatus::Attributes[] = {
     EXP_PYATTRIBUTE_FLOAT_RO("progress", KX_LibLoadStatus, m_progress),
     EXP_PYATTRIBUTE_STRING_RO("libraryName", KX_LibLoadStatus, m_libname),
     EXP_PYATTRIBUTE_RO_FUNCTION("timeTaken", KX_LibLoadStatus, pyattr_get_timetaken),
+    EXP_PYATTRIBUTE_RO_FUNCTION("mergeTime", KX_LibLoadStatus, pyattr_get_mergetime),
+    EXP_PYATTRIBUTE_RO_FUNCTION("memoryUsage", KX_LibLoadStatus, pyattr_get_memoryusage),
     EXP_PYATTRIBUTE_BOOL_RO("finished", KX_LibLoadStatus, m_finished),
     EXP_PYATTRIBUTE_NULL  // Sentinel
 };
@@ -266,4 +295,20 @@ PyObject *KX_LibLoadStatus::pyattr_get_timetaken(EXP_PyObjectPlus *self_v,
 
   return PyFloat_FromDouble(self->m_endtime - self->m_starttime);
 }
+
+PyObject *KX_LibLoadStatus::pyattr_get_mergetime(EXP_PyObjectPlus *self_v,
+                                                 const EXP_PYATTRIBUTE_DEF *attrdef)
+{
+  KX_LibLoadStatus *self = static_cast<KX_LibLoadStatus *>(self_v);
+
+  return PyFloat_FromDouble(self->m_mergetime);
+}
+
+PyObject *KX_LibLoadStatus::pyattr_get_memoryusage(EXP_PyObjectPlus *self_v,
+                                                   const EXP_PYATTRIBUTE_DEF *attrdef)
+{
+  KX_LibLoadStatus *self = static_cast<KX_LibLoadStatus *>(self_v);
+
+  return PyLong_FromLongLong(self->m_memory);
+}
 #endif  // WITH_PYTHON
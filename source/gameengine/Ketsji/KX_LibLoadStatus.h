@@ -38,6 +38,10 @@ class KX_LibLoadStatus : public EXP_PyObjectPlus {
   float m_progress;
   double m_starttime;
   double m_endtime;
+  /// Time spent merging the converted scenes.
+  double m_mergetime;
+  /// Approximate memory allocated by the loading and conversion.
+  long long m_memory;
 
   // The current status of this libload, used by the scene converter.
   bool m_finished;
@@ -73,6 +77,13 @@ class KX_LibLoadStatus : public EXP_PyObjectPlus {
   float GetProgress();
   void AddProgress(float progress);
 
+  /// Time in seconds between the start of the lib load and its end.
+  double GetTimeTaken() const;
+  double GetMergeTime() const;
+  void AddMergeTime(double time);
+  long long GetMemoryUsage() const;
+  void AddMemoryUsage(long long size);
+
 #ifdef WITH_PYTHON
   static PyObject *pyattr_get_onfinish(EXP_PyObjectPlus *self_v,
                                        const EXP_PYATTRIBUTE_DEF *attrdef);
@@ -87,5 +98,9 @@ class KX_LibLoadStatus : public EXP_PyObjectPlus {
 
   static PyObject *pyattr_get_timetaken(EXP_PyObjectPlus *self_v,
                                         const EXP_PYATTRIBUTE_DEF *attrdef);
+  static PyObject *pyattr_get_mergetime(EXP_PyObjectPlus *self_v,
+                                        const EXP_PYATTRIBUTE_DEF *attrdef);
+  static PyObject *pyattr_get_memoryusage(EXP_PyObjectPlus *self_v,
+                                          const EXP_PYATTRIBUTE_DEF *attrdef);
 #endif
 };
@@ -0,0 +1,718 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_NetworkReplication.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_NetworkReplication.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "CM_Serialize.h"
+#include "EXP_BoolValue.h"
+#include "EXP_Bytecode.h"
+#include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_StringValue.h"
+#include "KX_Camera.h"
+#include "KX_GameObject.h"
+#include "KX_NetworkMessageManager.h"
+
+/// Groups of a replicated object, followed by the groups of its properties.
+enum ReplicationGroup {
+  REPLICATION_GROUP_BINDING = 0,
+  REPLICATION_GROUP_TRANSFORM,
+  REPLICATION_GROUP_PROPERTIES
+};
+
+/// Flags of the groups present in an object entry.
+enum ReplicationEntryFlag : unsigned char {
+  REPLICATION_ENTRY_BINDING = (1 << 0),
+  REPLICATION_ENTRY_TRANSFORM = (1 << 1),
+  REPLICATION_ENTRY_PROPERTIES = (1 << 2)
+};
+
+/// Number of unacknowledged packets remembered for each peer, older packets are considered lost.
+static const unsigned int MAX_SENT_PACKETS = 64;
+/// Number of replication identifiers, limited by their size in the entries.
+static const unsigned int MAX_IDS = 1 << 16;
+
+/// Return true if the generation a is more recent than b, the generations wrap around.
+static bool IsNewerGeneration(unsigned char a, unsigned char b)
+{
+  return a != b && (unsigned char)(a - b) < 128;
+}
+
+/// Serialize the world transform of an object.
+static std::string SaveTransform(KX_GameObject *object)
+{
+  const MT_Vector3 &position = object->NodeGetWorldPosition();
+  const MT_Quaternion orientation = object->NodeGetWorldOrientation().getRotation();
+
+  std::string data;
+  for (unsigned short i = 0; i < 3; ++i) {
+    CM_WriteData<float>(data, position[i]);
+  }
+  for (unsigned short i = 0; i < 4; ++i) {
+    CM_WriteData<float>(data, orientation[i]);
+  }
+  return data;
+}
+
+static bool LoadTransform(const char *&data, const char *end, KX_GameObject *object)
+{
+  float values[7];
+  for (unsigned short i = 0; i < 7; ++i) {
+    if (!CM_ReadData(data, end, values[i])) {
+      return false;
+    }
+  }
+
+  if (object) {
+    object->NodeSetWorldPosition(MT_Vector3(values[0], values[1], values[2]));
+    object->NodeSetGlobalOrientation(
+        MT_Matrix3x3(MT_Quaternion(values[3], values[4], values[5], values[6])));
+    object->NodeUpdateGS(0.0f);
+  }
+  return true;
+}
+
+/// Serialize a game property, unsupported and missing properties produce empty data.
+static std::string SaveProperty(KX_GameObject *object, const std::string &name)
+{
+  std::string data;
+  EXP_BytecodeValue value;
+  EXP_Value *prop = object->GetProperty(name);
+  if (!prop || !EXP_BytecodeValue::FromValue(prop, value)) {
+    return data;
+  }
+
+  CM_WriteData<unsigned char>(data, value.m_type);
+  switch (value.m_type) {
+    case VALUE_INT_TYPE: {
+      CM_WriteData<cInt>(data, value.m_int);
+      break;
+    }
+    case VALUE_FLOAT_TYPE: {
+      CM_WriteData<float>(data, value.m_float);
+      break;
+    }
+    case VALUE_BOOL_TYPE: {
+      CM_WriteData<unsigned char>(data, value.m_bool);
+      break;
+    }
+    case VALUE_STRING_TYPE: {
+      data.append(*value.m_string);
+      break;
+    }
+    default: {
+      data.clear();
+      break;
+    }
+  }
+  return data;
+}
+
+static void LoadProperty(const std::string &data, KX_GameObject *object, const std::string &name)
+{
+  if (data.empty()) {
+    return;
+  }
+
+  const char *ptr = data.data() + 1;
+  const char *end = data.data() + data.size();
+  EXP_Value *value = nullptr;
+  switch (data[0]) {
+    case VALUE_INT_TYPE: {
+      cInt val;
+      if (CM_ReadData(ptr, end, val)) {
+        value = new EXP_IntValue(val);
+      }
+      break;
+    }
+    case VALUE_FLOAT_TYPE: {
+      float val;
+      if (CM_ReadData(ptr, end, val)) {
+        value = new EXP_FloatValue(val);
+      }
+      break;
+    }
+    case VALUE_BOOL_TYPE: {
+      unsigned char val;
+      if (CM_ReadData(ptr, end, val)) {
+        value = new EXP_BoolValue(val != 0);
+      }
+      break;
+    }
+    case VALUE_STRING_TYPE: {
+      value = new EXP_StringValue(std::string(ptr, end), name);
+      break;
+    }
+  }
+
+  if (!value) {
+    return;
+  }
+
+  // Same as gameobj[name] = value, keep the existing property object.
+  EXP_Value *oldprop = object->GetProperty(name);
+  if (oldprop) {
+    oldprop->SetValue(value);
+  }
+  else {
+    object->SetProperty(name, value);
+  }
+  value->Release();
+}
+
+KX_NetworkReplication::KX_NetworkReplication(const std::string &sceneName)
+    : m_sceneName(sceneName), m_nextId(0)
+{
+}
+
+KX_NetworkReplication::~KX_NetworkReplication()
+{
+}
+
+bool KX_NetworkReplication::SetNetworkId(KX_GameObject *object, unsigned int networkId)
+{
+  std::map<unsigned int, KX_GameObject *>::iterator it = m_networkObjects.find(networkId);
+  if (it != m_networkObjects.end()) {
+    return (it->second == object);
+  }
+
+  unsigned int previousId;
+  if (GetNetworkId(object, previousId)) {
+    m_networkObjects.erase(previousId);
+  }
+  m_networkObjects[networkId] = object;
+
+  // Replicate the object again to send the new binding.
+  std::vector<Object>::iterator objIt = std::find_if(
+      m_objects.begin(), m_objects.end(), [object](const Object &obj) {
+        return obj.m_object == object;
+      });
+  if (objIt != m_objects.end()) {
+    const std::vector<std::string> properties = objIt->m_properties;
+    AddObject(object, properties, objIt->m_radius);
+  }
+
+  return true;
+}
+
+bool KX_NetworkReplication::GetNetworkId(KX_GameObject *object, unsigned int &networkId) const
+{
+  for (const std::pair<const unsigned int, KX_GameObject *> &pair : m_networkObjects) {
+    if (pair.second == object) {
+      networkId = pair.first;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool KX_NetworkReplication::AllocateId(unsigned short &id)
+{
+  if (!m_freeIds.empty()) {
+    id = m_freeIds.back();
+    m_freeIds.pop_back();
+    return true;
+  }
+
+  if (m_nextId == MAX_IDS) {
+    return false;
+  }
+
+  id = m_nextId++;
+  m_generations.push_back(0);
+  return true;
+}
+
+void KX_NetworkReplication::ReleaseId(unsigned short id)
+{
+  const Despawn despawn = {id, m_generations[id]};
+  ++m_generations[id];
+  m_freeIds.push_back(id);
+
+  for (std::pair<const unsigned int, Peer> &pair : m_peers) {
+    Peer &peer = pair.second;
+    peer.m_groups.erase(id);
+    peer.m_despawns.push_back(despawn);
+  }
+}
+
+bool KX_NetworkReplication::AddObject(KX_GameObject *object,
+                                      const std::vector<std::string> &properties,
+                                      float radius)
+{
+  unsigned int networkId;
+  if (!GetNetworkId(object, networkId)) {
+    return false;
+  }
+
+  std::vector<Object>::iterator it = std::find_if(
+      m_objects.begin(), m_objects.end(), [object](const Object &obj) {
+        return obj.m_object == object;
+      });
+
+  /* A new identifier is used even if the object was already replicated, peers receive
+   * the new binding without any conflict with the previous property names. */
+  if (it != m_objects.end()) {
+    ReleaseId(it->m_id);
+  }
+
+  unsigned short id;
+  if (!AllocateId(id)) {
+    if (it != m_objects.end()) {
+      m_objects.erase(it);
+    }
+    return false;
+  }
+
+  if (it == m_objects.end()) {
+    m_objects.emplace_back();
+    it = m_objects.end() - 1;
+  }
+
+  Object &obj = *it;
+  obj.m_object = object;
+  obj.m_properties = properties;
+  obj.m_radius = radius;
+  obj.m_id = id;
+  obj.m_generation = m_generations[id];
+
+  obj.m_binding.clear();
+  CM_WriteData<uint32_t>(obj.m_binding, networkId);
+  CM_WriteData<unsigned char>(obj.m_binding, properties.size());
+  for (const std::string &name : properties) {
+    CM_WriteString(obj.m_binding, name);
+  }
+
+  return true;
+}
+
+void KX_NetworkReplication::RemoveObject(KX_GameObject *object)
+{
+  std::vector<Object>::iterator it = std::find_if(
+      m_objects.begin(), m_objects.end(), [object](const Object &obj) {
+        return obj.m_object == object;
+      });
+  if (it != m_objects.end()) {
+    ReleaseId(it->m_id);
+    m_objects.erase(it);
+  }
+}
+
+void KX_NetworkReplication::UnregisterObject(KX_GameObject *object)
+{
+  RemoveObject(object);
+
+  unsigned int networkId;
+  if (GetNetworkId(object, networkId)) {
+    m_networkObjects.erase(networkId);
+  }
+}
+
+void KX_NetworkReplication::ProcessAcks(Peer &peer, const std::vector<unsigned int> &sequences)
+{
+  for (unsigned int sequence : sequences) {
+    std::map<unsigned int, std::vector<SentGroup>>::iterator it = peer.m_sentGroups.find(
+        sequence);
+    if (it == peer.m_sentGroups.end()) {
+      continue;
+    }
+
+    for (SentGroup &sent : it->second) {
+      // Ignore the groups of the removed objects, their identifier may be used again.
+      std::map<unsigned short, std::vector<Group>>::iterator groupsIt = peer.m_groups.find(
+          sent.m_id);
+      if (groupsIt == peer.m_groups.end() || sent.m_generation != m_generations[sent.m_id] ||
+          sent.m_group >= groupsIt->second.size())
+      {
+        continue;
+      }
+      Group &group = groupsIt->second[sent.m_group];
+      // Acknowledgements can be received out of order, keep the most recent.
+      if (sequence > group.m_ackedSequence) {
+        group.m_acked = std::move(sent.m_data);
+        group.m_ackedSequence = sequence;
+      }
+    }
+
+    peer.m_sentGroups.erase(it);
+  }
+
+  for (unsigned int sequence : sequences) {
+    std::map<unsigned int, std::vector<Despawn>>::iterator it = peer.m_sentDespawns.find(
+        sequence);
+    if (it == peer.m_sentDespawns.end()) {
+      continue;
+    }
+
+    for (const Despawn &sent : it->second) {
+      peer.m_despawns.erase(std::remove_if(peer.m_despawns.begin(),
+                                           peer.m_despawns.end(),
+                                           [&sent](const Despawn &despawn) {
+                                             return despawn.m_id == sent.m_id &&
+                                                    despawn.m_generation == sent.m_generation;
+                                           }),
+                            peer.m_despawns.end());
+    }
+
+    peer.m_sentDespawns.erase(it);
+  }
+
+  // Forget the packets which will never be acknowledged, their despawns are still sent.
+  while (peer.m_sentGroups.size() > MAX_SENT_PACKETS) {
+    peer.m_sentGroups.erase(peer.m_sentGroups.begin());
+  }
+  while (peer.m_sentDespawns.size() > MAX_SENT_PACKETS) {
+    peer.m_sentDespawns.erase(peer.m_sentDespawns.begin());
+  }
+}
+
+void KX_NetworkReplication::SendState(KX_NetworkMessageManager *manager,
+                                      unsigned int peerIndex,
+                                      Peer &peer,
+                                      KX_Camera *camera)
+{
+  KX_NetworkTransport &transport = manager->GetTransport();
+  const unsigned int sequence = transport.GetPeerSequence(peerIndex);
+  const unsigned int budget = manager->GetSceneStateBudget(peerIndex, m_sceneName);
+
+  std::string data;
+
+  // Send our interest to the peer.
+  CM_WriteData<unsigned char>(data, camera != nullptr);
+  if (camera) {
+    const MT_Vector3 &position = camera->NodeGetWorldPosition();
+    for (unsigned short i = 0; i < 3; ++i) {
+      CM_WriteData<float>(data, position[i]);
+    }
+  }
+
+  // Send the despawns until acknowledged, as many as the packet can contain.
+  if (data.size() + sizeof(unsigned short) > budget) {
+    return;
+  }
+  const unsigned int despawnSize = sizeof(unsigned short) + sizeof(unsigned char);
+  const unsigned short numDespawns = std::min<unsigned int>(
+      {(unsigned int)peer.m_despawns.size(),
+       (unsigned int)(budget - data.size() - sizeof(unsigned short)) / despawnSize,
+       USHRT_MAX});
+  CM_WriteData<unsigned short>(data, numDespawns);
+  for (unsigned short i = 0; i < numDespawns; ++i) {
+    CM_WriteData<unsigned short>(data, peer.m_despawns[i].m_id);
+    CM_WriteData<unsigned char>(data, peer.m_despawns[i].m_generation);
+  }
+  if (numDespawns > 0) {
+    peer.m_sentDespawns[sequence].assign(peer.m_despawns.begin(),
+                                         peer.m_despawns.begin() + numDespawns);
+  }
+
+  std::vector<SentGroup> sentGroups;
+  const unsigned int numObjects = m_objects.size();
+  unsigned int numSent = 0;
+  for (; numSent < numObjects; ++numSent) {
+    const Object &obj = m_objects[(peer.m_firstObject + numSent) % numObjects];
+
+    if (obj.m_radius > 0.0f && peer.m_hasInterest &&
+        (obj.m_object->NodeGetWorldPosition() - peer.m_interest).length() > obj.m_radius)
+    {
+      continue;
+    }
+
+    std::vector<Group> &groups = peer.m_groups[obj.m_id];
+    const unsigned int numGroups = REPLICATION_GROUP_PROPERTIES + obj.m_properties.size();
+    if (groups.size() != numGroups) {
+      groups.resize(numGroups, {std::string(), 0, 0});
+    }
+
+    std::vector<std::string> values(numGroups);
+    values[REPLICATION_GROUP_BINDING] = obj.m_binding;
+    values[REPLICATION_GROUP_TRANSFORM] = SaveTransform(obj.m_object);
+    for (unsigned int i = 0, size = obj.m_properties.size(); i < size; ++i) {
+      values[REPLICATION_GROUP_PROPERTIES + i] = SaveProperty(obj.m_object, obj.m_properties[i]);
+    }
+
+    /* A group is sent when its value differs from the one received by the peer, or if it was
+     * sent since and the packet is not yet acknowledged: the peer may have applied a different
+     * value. A zero acknowledged sequence means the peer never received the group. */
+    std::vector<unsigned short> dirtyGroups;
+    for (unsigned short i = 0; i < numGroups; ++i) {
+      const Group &group = groups[i];
+      if (group.m_ackedSequence == 0 || group.m_acked != values[i] ||
+          group.m_sentSequence > group.m_ackedSequence)
+      {
+        dirtyGroups.push_back(i);
+      }
+    }
+
+    if (dirtyGroups.empty()) {
+      continue;
+    }
+
+    const bool bindingAcked = groups[REPLICATION_GROUP_BINDING].m_ackedSequence != 0;
+    unsigned char flags = 0;
+    std::vector<unsigned short> properties;
+    for (unsigned short i : dirtyGroups) {
+      if (i == REPLICATION_GROUP_BINDING) {
+        flags |= REPLICATION_ENTRY_BINDING;
+      }
+      else if (i == REPLICATION_GROUP_TRANSFORM) {
+        flags |= REPLICATION_ENTRY_TRANSFORM;
+      }
+      else {
+        flags |= REPLICATION_ENTRY_PROPERTIES;
+        properties.push_back(i - REPLICATION_GROUP_PROPERTIES);
+      }
+    }
+    // The peer can't interpret an entry without knowing the object.
+    if (!bindingAcked) {
+      flags |= REPLICATION_ENTRY_BINDING;
+    }
+
+    std::string entry;
+    CM_WriteData<unsigned short>(entry, obj.m_id);
+    CM_WriteData<unsigned char>(entry, obj.m_generation);
+    CM_WriteData<unsigned char>(entry, flags);
+    if (flags & REPLICATION_ENTRY_BINDING) {
+      CM_WriteString(entry, values[REPLICATION_GROUP_BINDING]);
+    }
+    if (flags & REPLICATION_ENTRY_TRANSFORM) {
+      entry.append(values[REPLICATION_GROUP_TRANSFORM]);
+    }
+    if (flags & REPLICATION_ENTRY_PROPERTIES) {
+      CM_WriteData<unsigned char>(entry, properties.size());
+      for (unsigned short index : properties) {
+        CM_WriteData<unsigned char>(entry, index);
+        CM_WriteString(entry, values[REPLICATION_GROUP_PROPERTIES + index]);
+      }
+    }
+
+    // The packet is full, the remaining objects are sent first in the next packet.
+    if (data.size() + entry.size() > budget) {
+      break;
+    }
+    data.append(entry);
+
+    for (unsigned short i = 0; i < numGroups; ++i) {
+      const bool sent = (i == REPLICATION_GROUP_BINDING && (flags & REPLICATION_ENTRY_BINDING)) ||
+                        (i == REPLICATION_GROUP_TRANSFORM &&
+                         (flags & REPLICATION_ENTRY_TRANSFORM)) ||
+                        std::find(dirtyGroups.begin(), dirtyGroups.end(), i) !=
+                            dirtyGroups.end();
+      if (sent) {
+        groups[i].m_sentSequence = sequence;
+        sentGroups.push_back({obj.m_id, obj.m_generation, i, std::move(values[i])});
+      }
+    }
+  }
+
+  if (numObjects > 0) {
+    peer.m_firstObject = (peer.m_firstObject + numSent) % numObjects;
+  }
+  if (!sentGroups.empty()) {
+    peer.m_sentGroups[sequence] = std::move(sentGroups);
+  }
+
+  manager->AddSceneState(peerIndex, m_sceneName, data);
+}
+
+void KX_NetworkReplication::ReceiveState(Peer &peer,
+                                         unsigned int sequence,
+                                         const std::string &data)
+{
+  const char *ptr = data.data();
+  const char *end = ptr + data.size();
+
+  unsigned char hasInterest;
+  if (!CM_ReadData(ptr, end, hasInterest)) {
+    return;
+  }
+  MT_Vector3 interest(0.0f, 0.0f, 0.0f);
+  if (hasInterest) {
+    for (unsigned short i = 0; i < 3; ++i) {
+      float value;
+      if (!CM_ReadData(ptr, end, value)) {
+        return;
+      }
+      interest[i] = value;
+    }
+  }
+  // The interest is sent in every state, only the most recent is kept.
+  if (sequence > peer.m_receivedSequence) {
+    peer.m_receivedSequence = sequence;
+    peer.m_hasInterest = hasInterest;
+    peer.m_interest = interest;
+  }
+
+  /* Drop the binding of the despawned objects. The despawn is kept to ignore a late binding of
+   * the same generation, a newer generation means the identifier was already reused. */
+  unsigned short numDespawns;
+  if (!CM_ReadData(ptr, end, numDespawns)) {
+    return;
+  }
+  for (unsigned short i = 0; i < numDespawns; ++i) {
+    unsigned short id;
+    unsigned char generation;
+    if (!CM_ReadData(ptr, end, id) || !CM_ReadData(ptr, end, generation)) {
+      return;
+    }
+
+    std::map<unsigned short, RemoteObject>::iterator it = peer.m_remoteObjects.find(id);
+    if (it == peer.m_remoteObjects.end() ||
+        !IsNewerGeneration(it->second.m_generation, generation))
+    {
+      peer.m_remoteObjects[id] = {generation, true, 0, {}, {}};
+    }
+  }
+
+  while (ptr < end) {
+    unsigned short id;
+    unsigned char generation;
+    unsigned char flags;
+    if (!CM_ReadData(ptr, end, id) || !CM_ReadData(ptr, end, generation) ||
+        !CM_ReadData(ptr, end, flags))
+    {
+      return;
+    }
+
+    if (flags & REPLICATION_ENTRY_BINDING) {
+      std::string binding;
+      if (!CM_ReadString(ptr, end, binding)) {
+        return;
+      }
+
+      // The binding of a generation never changes, it is only read once.
+      std::map<unsigned short, RemoteObject>::iterator it = peer.m_remoteObjects.find(id);
+      if (it == peer.m_remoteObjects.end() ||
+          IsNewerGeneration(generation, it->second.m_generation))
+      {
+        RemoteObject remote;
+        remote.m_generation = generation;
+        remote.m_despawned = false;
+        const char *bindingPtr = binding.data();
+        const char *bindingEnd = bindingPtr + binding.size();
+        uint32_t networkId;
+        unsigned char numProperties;
+        if (!CM_ReadData(bindingPtr, bindingEnd, networkId) ||
+            !CM_ReadData(bindingPtr, bindingEnd, numProperties))
+        {
+          return;
+        }
+        remote.m_networkId = networkId;
+        remote.m_properties.resize(numProperties);
+        for (std::string &name : remote.m_properties) {
+          if (!CM_ReadString(bindingPtr, bindingEnd, name)) {
+            return;
+          }
+        }
+        remote.m_sequences.resize(REPLICATION_GROUP_PROPERTIES + numProperties, 0);
+        peer.m_remoteObjects[id] = std::move(remote);
+      }
+    }
+
+    // Entries of unknown objects and other generations are read but not applied.
+    std::map<unsigned short, RemoteObject>::iterator remoteIt = peer.m_remoteObjects.find(id);
+    RemoteObject *remote = (remoteIt != peer.m_remoteObjects.end() &&
+                            remoteIt->second.m_generation == generation &&
+                            !remoteIt->second.m_despawned) ?
+                               &remoteIt->second :
+                               nullptr;
+    KX_GameObject *object = nullptr;
+    if (remote) {
+      std::map<unsigned int, KX_GameObject *>::const_iterator objectIt = m_networkObjects.find(
+          remote->m_networkId);
+      if (objectIt != m_networkObjects.end()) {
+        object = objectIt->second;
+      }
+    }
+
+    /* States can be received out of order, a group is applied only if it is newer than the last
+     * one applied: the older states may contain groups absent of the newer ones and their packet
+     * is acknowledged anyway. */
+    const auto applyGroup = [remote, object, sequence](unsigned int group) {
+      if (!object || group >= remote->m_sequences.size() ||
+          sequence <= remote->m_sequences[group])
+      {
+        return false;
+      }
+      remote->m_sequences[group] = sequence;
+      return true;
+    };
+
+    if (flags & REPLICATION_ENTRY_TRANSFORM) {
+      if (!LoadTransform(ptr, end, applyGroup(REPLICATION_GROUP_TRANSFORM) ? object : nullptr)) {
+        return;
+      }
+    }
+
+    if (flags & REPLICATION_ENTRY_PROPERTIES) {
+      unsigned char numProperties;
+      if (!CM_ReadData(ptr, end, numProperties)) {
+        return;
+      }
+      for (unsigned short i = 0; i < numProperties; ++i) {
+        unsigned char index;
+        std::string value;
+        if (!CM_ReadData(ptr, end, index) || !CM_ReadString(ptr, end, value)) {
+          return;
+        }
+        if (applyGroup(REPLICATION_GROUP_PROPERTIES + index)) {
+          LoadProperty(value, object, remote->m_properties[index]);
+        }
+      }
+    }
+  }
+}
+
+void KX_NetworkReplication::Update(KX_NetworkMessageManager *manager, KX_Camera *camera)
+{
+  KX_NetworkTransport &transport = manager->GetTransport();
+  const unsigned int numPeers = transport.GetNumPeers();
+
+  // Forget disconnected peers.
+  for (std::map<unsigned int, Peer>::iterator it = m_peers.begin(); it != m_peers.end();) {
+    bool connected = false;
+    for (unsigned int i = 0; i < numPeers; ++i) {
+      if (transport.GetPeerId(i) == it->first) {
+        connected = true;
+        break;
+      }
+    }
+    it = connected ? std::next(it) : m_peers.erase(it);
+  }
+
+  for (const KX_NetworkMessageManager::SceneState &state : manager->GetSceneStates(m_sceneName))
+  {
+    ReceiveState(m_peers[state.peerId], state.sequence, state.data);
+  }
+
+  for (unsigned int i = 0; i < numPeers; ++i) {
+    Peer &peer = m_peers[transport.GetPeerId(i)];
+    ProcessAcks(peer, transport.GetPeerAckedSequences(i));
+    SendState(manager, i, peer, camera);
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_NetworkReplication.h
+ *  \ingroup ketsji
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MT_Vector3.h"
+
+class KX_Camera;
+class KX_GameObject;
+class KX_NetworkMessageManager;
+
+/** Replication of object transforms and properties of a scene to the remote game instances.
+ *
+ * Objects are identified across game instances by a network identifier given by the user,
+ * replicas of the same object can then be replicated independently.
+ * Each replicated object is split in groups of data: its binding (network identifier and
+ * property names), its world transform and each of its replicated properties. A group is sent
+ * to a peer until a packet containing its current value is acknowledged, unchanged groups are
+ * not sent. Objects further than their interest radius from the active camera of the peer are
+ * not sent. The receiver applies the states on the objects of the same network identifier in its
+ * scene of the same name, each group is applied only if it is newer than the last one applied.
+ *
+ * The replication identifiers of the removed objects are reused with a new generation, a
+ * despawn of the previous generation is sent to the peers until acknowledged so that they drop
+ * its binding. Entries of another generation than the binding known by the receiver are ignored.
+ */
+class KX_NetworkReplication {
+ private:
+  struct Object {
+    KX_GameObject *m_object;
+    /// Names of the replicated properties.
+    std::vector<std::string> m_properties;
+    /// Interest radius, 0 to replicate at any distance.
+    float m_radius;
+    /// Identifier of the replication in the states, changed when the object is replicated again.
+    unsigned short m_id;
+    /// Generation of the identifier, changed each time the identifier is reused.
+    unsigned char m_generation;
+    /// Binding data: network identifier and property names.
+    std::string m_binding;
+  };
+
+  /// Replication of a group of an object to a peer.
+  struct Group {
+    /// Last value received by the peer.
+    std::string m_acked;
+    unsigned int m_ackedSequence;
+    /// Sequence of the last packet containing the group.
+    unsigned int m_sentSequence;
+  };
+
+  /// Group data sent in a packet.
+  struct SentGroup {
+    unsigned short m_id;
+    unsigned char m_generation;
+    unsigned short m_group;
+    std::string m_data;
+  };
+
+  /// Replication identifier no longer used by an object.
+  struct Despawn {
+    unsigned short m_id;
+    unsigned char m_generation;
+  };
+
+  /// Object replicated by a peer.
+  struct RemoteObject {
+    unsigned char m_generation;
+    /// True when the peer stopped replicating this generation, the binding is dropped.
+    bool m_despawned;
+    unsigned int m_networkId;
+    std::vector<std::string> m_properties;
+    /// Sequence of the last state applied for each group.
+    std::vector<unsigned int> m_sequences;
+  };
+
+  struct Peer {
+    /// Replication of each group of each object by identifier.
+    std::map<unsigned short, std::vector<Group>> m_groups;
+    /// Groups sent in each packet not yet acknowledged, by packet sequence.
+    std::map<unsigned int, std::vector<SentGroup>> m_sentGroups;
+    /// Despawns sent in every packet until one of them is acknowledged.
+    std::vector<Despawn> m_despawns;
+    /// Despawns sent in each packet not yet acknowledged, by packet sequence.
+    std::map<unsigned int, std::vector<Despawn>> m_sentDespawns;
+    /// Position of the active camera of the peer.
+    MT_Vector3 m_interest;
+    bool m_hasInterest;
+    /// Sequence of the most recent state received, used for the interest.
+    unsigned int m_receivedSequence;
+    /** Objects replicated by the peer, by identifier. Despawned objects are kept without
+     * binding to ignore their late entries, until their identifier is reused. */
+    std::map<unsigned short, RemoteObject> m_remoteObjects;
+    /// Index of the first object to send, rotated to share the packet size between objects.
+    unsigned int m_firstObject;
+  };
+
+  std::string m_sceneName;
+  /// Objects with a network identifier, replicated or receiving remote states.
+  std::map<unsigned int, KX_GameObject *> m_networkObjects;
+  std::vector<Object> m_objects;
+  /// Next identifier never used.
+  unsigned int m_nextId;
+  /// Identifiers of the removed objects, reused before the new ones.
+  std::vector<unsigned short> m_freeIds;
+  /// Current generation of each identifier used.
+  std::vector<unsigned char> m_generations;
+  /// Replication state of each peer by peer identifier.
+  std::map<unsigned int, Peer> m_peers;
+
+  /// Get an unused identifier, return false if all the identifiers are used.
+  bool AllocateId(unsigned short &id);
+  /// Free the identifier of a removed object and send its despawn to the peers.
+  void ReleaseId(unsigned short id);
+  void ProcessAcks(Peer &peer, const std::vector<unsigned int> &sequences);
+  void SendState(KX_NetworkMessageManager *manager,
+                 unsigned int peerIndex,
+                 Peer &peer,
+                 KX_Camera *camera);
+  void ReceiveState(Peer &peer, unsigned int sequence, const std::string &data);
+
+ public:
+  KX_NetworkReplication(const std::string &sceneName);
+  ~KX_NetworkReplication();
+
+  /** Identify an object across the game instances, remote states of this identifier are
+   * applied to the object.
+   * \return False if the identifier is used by another object.
+   */
+  bool SetNetworkId(KX_GameObject *object, unsigned int networkId);
+  /// Return false if the object has no network identifier.
+  bool GetNetworkId(KX_GameObject *object, unsigned int &networkId) const;
+
+  /** Replicate an object to the remote game instances.
+   * \param properties The names of the game properties to replicate.
+   * \param radius The interest radius, the object is not sent to a peer if its active camera is
+   * further, 0 to always send.
+   * \return False if the object has no network identifier or if too many objects are replicated.
+   */
+  bool AddObject(KX_GameObject *object, const std::vector<std::string> &properties, float radius);
+  /// Stop replicating an object.
+  void RemoveObject(KX_GameObject *object);
+  /// Stop replicating an object and forget its network identifier, called when it is removed.
+  void UnregisterObject(KX_GameObject *object);
+
+  /** Apply the received states and send the state of the replicated objects to all peers.
+   * \param camera The active camera of the scene sent as interest to the peers, can be nullptr.
+   */
+  void Update(KX_NetworkMessageManager *manager, KX_Camera *camera);
+};
@@ -0,0 +1,273 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_ObjectData.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_ObjectData.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "BLI_utildefines.h"
+
+#include "KX_GameObject.h"
+#include "PHY_IPhysicsController.h"
+#include "SG_Node.h"
+
+static const KX_ObjectDataInfo objectDataInfos[] = {
+    {"worldPosition", KX_OBJECT_DATA_WORLD_POSITION, 3, false},
+    {"localPosition", KX_OBJECT_DATA_LOCAL_POSITION, 3, false},
+    {"worldOrientation", KX_OBJECT_DATA_WORLD_ORIENTATION, 9, false},
+    {"localOrientation", KX_OBJECT_DATA_LOCAL_ORIENTATION, 9, false},
+    {"worldScale", KX_OBJECT_DATA_WORLD_SCALE, 3, false},
+    {"localScale", KX_OBJECT_DATA_LOCAL_SCALE, 3, false},
+    {"worldLinearVelocity", KX_OBJECT_DATA_WORLD_LINEAR_VELOCITY, 3, true},
+    {"localLinearVelocity", KX_OBJECT_DATA_LOCAL_LINEAR_VELOCITY, 3, true},
+    {"worldAngularVelocity", KX_OBJECT_DATA_WORLD_ANGULAR_VELOCITY, 3, true},
+    {"localAngularVelocity", KX_OBJECT_DATA_LOCAL_ANGULAR_VELOCITY, 3, true}};
+
+const KX_ObjectDataInfo *KX_FindObjectData(const char *name)
+{
+  for (const KX_ObjectDataInfo &info : objectDataInfos) {
+    if (strcmp(info.name, name) == 0) {
+      return &info;
+    }
+  }
+
+  return nullptr;
+}
+
+void KX_GatherObjectData(const std::vector<KX_GameObject *> &objects,
+                         const KX_ObjectDataInfo *info,
+                         float *data)
+{
+  for (KX_GameObject *gameobj : objects) {
+    switch (info->type) {
+      case KX_OBJECT_DATA_WORLD_POSITION: {
+        gameobj->NodeGetWorldPosition().getValue(data);
+        break;
+      }
+      case KX_OBJECT_DATA_LOCAL_POSITION: {
+        gameobj->NodeGetLocalPosition().getValue(data);
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_ORIENTATION:
+      case KX_OBJECT_DATA_LOCAL_ORIENTATION: {
+        const MT_Matrix3x3 &rot = (info->type == KX_OBJECT_DATA_WORLD_ORIENTATION) ?
+                                      gameobj->NodeGetWorldOrientation() :
+                                      gameobj->NodeGetLocalOrientation();
+        // Row major as mathutils.Matrix.
+        for (unsigned short row = 0; row < 3; ++row) {
+          for (unsigned short col = 0; col < 3; ++col) {
+            data[row * 3 + col] = rot[row][col];
+          }
+        }
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_SCALE: {
+        gameobj->NodeGetWorldScaling().getValue(data);
+        break;
+      }
+      case KX_OBJECT_DATA_LOCAL_SCALE: {
+        gameobj->NodeGetLocalScaling().getValue(data);
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_LINEAR_VELOCITY:
+      case KX_OBJECT_DATA_LOCAL_LINEAR_VELOCITY: {
+        gameobj->GetLinearVelocity(info->type == KX_OBJECT_DATA_LOCAL_LINEAR_VELOCITY)
+            .getValue(data);
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_ANGULAR_VELOCITY:
+      case KX_OBJECT_DATA_LOCAL_ANGULAR_VELOCITY: {
+        gameobj->GetAngularVelocity(info->type == KX_OBJECT_DATA_LOCAL_ANGULAR_VELOCITY)
+            .getValue(data);
+        break;
+      }
+    }
+    data += info->size;
+  }
+}
+
+static SG_Node *GetRootNode(SG_Node *node)
+{
+  while (node->GetSGParent()) {
+    node = node->GetSGParent();
+  }
+  return node;
+}
+
+static bool IsParentModified(SG_Node *node)
+{
+  for (SG_Node *parent = node->GetSGParent(); parent; parent = parent->GetSGParent()) {
+    if (parent->IsModified()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void ScatterVelocities(const std::vector<KX_GameObject *> &objects,
+                              const KX_ObjectDataInfo *info,
+                              const float *data)
+{
+  for (KX_GameObject *gameobj : objects) {
+    switch (info->type) {
+      case KX_OBJECT_DATA_WORLD_LINEAR_VELOCITY:
+      case KX_OBJECT_DATA_LOCAL_LINEAR_VELOCITY: {
+        gameobj->setLinearVelocity(MT_Vector3(data),
+                                   info->type == KX_OBJECT_DATA_LOCAL_LINEAR_VELOCITY);
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_ANGULAR_VELOCITY:
+      case KX_OBJECT_DATA_LOCAL_ANGULAR_VELOCITY: {
+        gameobj->setAngularVelocity(MT_Vector3(data),
+                                    info->type == KX_OBJECT_DATA_LOCAL_ANGULAR_VELOCITY);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    data += info->size;
+  }
+}
+
+void KX_ScatterObjectData(const std::vector<KX_GameObject *> &objects,
+                          const KX_ObjectDataInfo *info,
+                          const float *data)
+{
+  if (info->physics) {
+    ScatterVelocities(objects, info, data);
+    return;
+  }
+
+  const bool worldSpace = ELEM(info->type,
+                               KX_OBJECT_DATA_WORLD_POSITION,
+                               KX_OBJECT_DATA_WORLD_ORIENTATION,
+                               KX_OBJECT_DATA_WORLD_SCALE);
+
+  /* Write the nodes only, the KX_GameObject setters of a root object would synchronize its
+   * physics controller for each object. */
+  for (KX_GameObject *gameobj : objects) {
+    SG_Node *node = gameobj->GetSGNode();
+    const bool child = (node->GetSGParent() != nullptr);
+
+    // The world data of a child is relative to its parent, which can be modified by a previous
+    // object of the list.
+    if (child && worldSpace && IsParentModified(node)) {
+      GetRootNode(node)->UpdateWorldData(0.0);
+    }
+
+    switch (info->type) {
+      case KX_OBJECT_DATA_WORLD_POSITION:
+      case KX_OBJECT_DATA_LOCAL_POSITION: {
+        const MT_Vector3 pos(data);
+        if (child && worldSpace) {
+          gameobj->NodeSetWorldPosition(pos);
+        }
+        else {
+          node->SetLocalPosition(pos);
+        }
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_ORIENTATION:
+      case KX_OBJECT_DATA_LOCAL_ORIENTATION: {
+        const MT_Matrix3x3 rot(data[0],
+                               data[1],
+                               data[2],
+                               data[3],
+                               data[4],
+                               data[5],
+                               data[6],
+                               data[7],
+                               data[8]);
+        if (child && worldSpace) {
+          gameobj->NodeSetGlobalOrientation(rot);
+        }
+        else {
+          node->SetLocalOrientation(rot);
+        }
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_SCALE:
+      case KX_OBJECT_DATA_LOCAL_SCALE: {
+        const MT_Vector3 scale(data);
+        if (child && worldSpace) {
+          gameobj->NodeSetWorldScale(scale);
+        }
+        else {
+          node->SetLocalScale(scale);
+        }
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    data += info->size;
+  }
+
+  /* Update the world transform of each modified hierarchy once, it synchronizes the physics
+   * controllers of the non dynamic objects. */
+  std::vector<SG_Node *> roots(objects.size());
+  std::transform(objects.begin(), objects.end(), roots.begin(), [](KX_GameObject *gameobj) {
+    return GetRootNode(gameobj->GetSGNode());
+  });
+  std::sort(roots.begin(), roots.end());
+  roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+  for (SG_Node *root : roots) {
+    root->UpdateWorldData(0.0);
+  }
+
+  // Synchronize the physics controllers of the root objects, the children follow their parent.
+  for (KX_GameObject *gameobj : objects) {
+    PHY_IPhysicsController *controller = gameobj->GetPhysicsController();
+    SG_Node *node = gameobj->GetSGNode();
+    if (!controller || node->GetSGParent()) {
+      continue;
+    }
+
+    switch (info->type) {
+      case KX_OBJECT_DATA_WORLD_POSITION:
+      case KX_OBJECT_DATA_LOCAL_POSITION: {
+        controller->SetPosition(node->GetLocalPosition());
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_ORIENTATION:
+      case KX_OBJECT_DATA_LOCAL_ORIENTATION: {
+        controller->SetOrientation(node->GetLocalOrientation());
+        break;
+      }
+      case KX_OBJECT_DATA_WORLD_SCALE:
+      case KX_OBJECT_DATA_LOCAL_SCALE: {
+        controller->SetScaling(node->GetLocalScale());
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+}
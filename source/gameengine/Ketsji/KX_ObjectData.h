@@ -0,0 +1,73 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_ObjectData.h
+ *  \ingroup ketsji
+ */
+
+#pragma once
+
+#include <vector>
+
+class KX_GameObject;
+
+/// Object data exchanged in bulk by scene.gatherObjectData and scene.scatterObjectData.
+enum KX_ObjectDataType {
+  KX_OBJECT_DATA_WORLD_POSITION = 0,
+  KX_OBJECT_DATA_LOCAL_POSITION,
+  KX_OBJECT_DATA_WORLD_ORIENTATION,
+  KX_OBJECT_DATA_LOCAL_ORIENTATION,
+  KX_OBJECT_DATA_WORLD_SCALE,
+  KX_OBJECT_DATA_LOCAL_SCALE,
+  KX_OBJECT_DATA_WORLD_LINEAR_VELOCITY,
+  KX_OBJECT_DATA_LOCAL_LINEAR_VELOCITY,
+  KX_OBJECT_DATA_WORLD_ANGULAR_VELOCITY,
+  KX_OBJECT_DATA_LOCAL_ANGULAR_VELOCITY
+};
+
+struct KX_ObjectDataInfo {
+  const char *name;
+  KX_ObjectDataType type;
+  /// Number of floats per object.
+  unsigned short size;
+  /// True if the data is stored in the physics controller.
+  bool physics;
+};
+
+/// Return the data of the given name, nullptr if unknown.
+const KX_ObjectDataInfo *KX_FindObjectData(const char *name);
+
+/** Copy the data of the objects into a float array of info->size floats per object, the
+ * orientations are row major.
+ */
+void KX_GatherObjectData(const std::vector<KX_GameObject *> &objects,
+                         const KX_ObjectDataInfo *info,
+                         float *data);
+
+/** Set the data of the objects from a float array of info->size floats per object.
+ * The transforms are written to the scene graph nodes first, then the world transform of each
+ * modified hierarchy is updated once and the physics controllers of the root objects are
+ * synchronized from their node in a single pass.
+ */
+void KX_ScatterObjectData(const std::vector<KX_GameObject *> &objects,
+                          const KX_ObjectDataInfo *info,
+                          const float *data);
@@ -40,6 +40,7 @@
 #include "PHY_IPhysicsEnvironment.h"
 
 #ifdef WITH_BULLET
+#  include "CcdBvhCache.h"
 #  include "LinearMath/btIDebugDraw.h"
 #endif
 
@@ -67,6 +68,14 @@ PyDoc_STRVAR(gPySetNumTimeSubSteps__doc__,
              "setNumTimeSubSteps(int numsubstep)\n"
              "This sets the number of substeps for each physics proceed. Tradeoff quality for "
              "performance.");
+PyDoc_STRVAR(gPySetUseSensorQueries__doc__,
+             "setUseSensorQueries(bool use)\n"
+             "This resolves the near and radar sensors with one broadphase query per physics step "
+             "instead of simulating them in the physics world.");
+PyDoc_STRVAR(gPySetBvhCacheDirectory__doc__,
+             "setBvhCacheDirectory(string directory)\n"
+             "This sets the directory where the BVHs of the static triangle mesh shapes are saved "
+             "and loaded from, an empty string disables the cache files.");
 
 PyDoc_STRVAR(gPySetDeactivationTime__doc__,
              "setDeactivationTime(float time)\n"
@@ -180,6 +189,34 @@ static PyObject *gPySetNumIterations(PyObject *self, PyObject *args, PyObject *k
   Py_RETURN_NONE;
 }
 
+static PyObject *gPySetUseSensorQueries(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  int use;
+  if (PyArg_ParseTuple(args, "p", &use)) {
+    if (KX_GetPhysicsEnvironment()) {
+      KX_GetPhysicsEnvironment()->SetUseSensorQueries(use);
+    }
+  }
+  else {
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *gPySetBvhCacheDirectory(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  const char *directory;
+  if (!PyArg_ParseTuple(args, "s:setBvhCacheDirectory", &directory)) {
+    return nullptr;
+  }
+
+#  ifdef WITH_BULLET
+  CcdBvhCache::SetDirectory(directory);
+#  endif
+
+  Py_RETURN_NONE;
+}
+
 static PyObject *gPySetDeactivationTime(PyObject *self, PyObject *args, PyObject *kwds)
 {
   float deactive_time;
@@ -618,6 +655,16 @@ static struct PyMethodDef physicsconstraints_methods[] = {
      METH_VARARGS,
      (const char *)gPySetNumTimeSubSteps__doc__},
 
+    {"setUseSensorQueries",
+     (PyCFunction)gPySetUseSensorQueries,
+     METH_VARARGS,
+     (const char *)gPySetUseSensorQueries__doc__},
+
+    {"setBvhCacheDirectory",
+     (PyCFunction)gPySetBvhCacheDirectory,
+     METH_VARARGS,
+     (const char *)gPySetBvhCacheDirectory__doc__},
+
     {"setDeactivationTime",
      (PyCFunction)gPySetDeactivationTime,
      METH_VARARGS,
@@ -168,6 +168,7 @@ static void KX_MACRO_addTypesToDict_fn(PyObject *dict, const char *name, long va
 
 // temporarily python stuff, will be put in another place later !
 #  include "EXP_Python.h"
+#  include "EXP_PythonBytecodeCache.h"
 #  include "SCA_PythonController.h"
 // List of methods defined in the module
 
@@ -314,6 +315,152 @@ static PyObject *gPySendMessage(PyObject *, PyObject *args)
   Py_RETURN_NONE;
 }
 
+PyDoc_STRVAR(gPyNetworkListen_doc,
+             "networkListen(port)\n"
+             "open the network transport and accept the game instances connecting on the port");
+static PyObject *gPyNetworkListen(PyObject *, PyObject *args)
+{
+  int port;
+  if (!PyArg_ParseTuple(args, "i:networkListen", &port)) {
+    return nullptr;
+  }
+
+  if (port < 0 || port > 65535) {
+    PyErr_SetString(PyExc_ValueError, "networkListen(port): port must be in range [0, 65535]");
+    return nullptr;
+  }
+
+  KX_NetworkTransport &transport =
+      KX_GetActiveEngine()->GetNetworkMessageManager()->GetTransport();
+  if (!transport.Listen(port)) {
+    PyErr_Format(PyExc_RuntimeError, "networkListen(port): failed to listen on port %i", port);
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyNetworkConnect_doc,
+             "networkConnect(host, port)\n"
+             "open the network transport and connect to a listening game instance");
+static PyObject *gPyNetworkConnect(PyObject *, PyObject *args)
+{
+  const char *host;
+  int port;
+  if (!PyArg_ParseTuple(args, "si:networkConnect", &host, &port)) {
+    return nullptr;
+  }
+
+  if (port < 0 || port > 65535) {
+    PyErr_SetString(PyExc_ValueError,
+                    "networkConnect(host, port): port must be in range [0, 65535]");
+    return nullptr;
+  }
+
+  KX_NetworkTransport &transport =
+      KX_GetActiveEngine()->GetNetworkMessageManager()->GetTransport();
+  if (!transport.Connect(host, port)) {
+    PyErr_Format(
+        PyExc_RuntimeError, "networkConnect(host, port): failed to connect to %s:%i", host, port);
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyNetworkClose_doc,
+             "networkClose()\n"
+             "close the network transport and disconnect all game instances");
+static PyObject *gPyNetworkClose(PyObject *)
+{
+  KX_GetActiveEngine()->GetNetworkMessageManager()->GetTransport().Close();
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPySetNetworkMessageSubjects_doc,
+             "setNetworkMessageSubjects(subjects)\n"
+             "set the subjects of the messages sent to the remote game instances");
+static PyObject *gPySetNetworkMessageSubjects(PyObject *, PyObject *value)
+{
+  PyObject *seq = PySequence_Fast(
+      value, "setNetworkMessageSubjects(subjects): expected a sequence");
+  if (!seq) {
+    return nullptr;
+  }
+
+  std::vector<std::string> subjects;
+  for (Py_ssize_t i = 0, size = PySequence_Fast_GET_SIZE(seq); i < size; ++i) {
+    const char *subject = _PyUnicode_AsString(PySequence_Fast_GET_ITEM(seq, i));
+    if (!subject) {
+      Py_DECREF(seq);
+      PyErr_SetString(PyExc_TypeError,
+                      "setNetworkMessageSubjects(subjects): expected a sequence of strings");
+      return nullptr;
+    }
+    subjects.push_back(subject);
+  }
+  Py_DECREF(seq);
+
+  KX_GetActiveEngine()->GetNetworkMessageManager()->SetNetworkSubjects(subjects);
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyGetNetworkMessageSubjects_doc,
+             "getNetworkMessageSubjects()\n"
+             "returns the subjects of the messages sent to the remote game instances");
+static PyObject *gPyGetNetworkMessageSubjects(PyObject *)
+{
+  const std::set<std::string> &subjects =
+      KX_GetActiveEngine()->GetNetworkMessageManager()->GetNetworkSubjects();
+  PyObject *list = PyList_New(subjects.size());
+  Py_ssize_t i = 0;
+  for (const std::string &subject : subjects) {
+    PyList_SET_ITEM(list, i++, PyUnicode_FromStdString(subject));
+  }
+  return list;
+}
+
+PyDoc_STRVAR(gPyGetNetworkStatistics_doc,
+             "getNetworkStatistics()\n"
+             "returns a dictionary with the network transport statistics");
+static PyObject *gPyGetNetworkStatistics(PyObject *)
+{
+  const KX_NetworkTransport &transport =
+      KX_GetActiveEngine()->GetNetworkMessageManager()->GetTransport();
+  const KX_NetworkTransport::Statistics &stats = transport.GetStatistics();
+
+  PyObject *dict = PyDict_New();
+  PyObject *item;
+
+#define ADD_ITEM(dict, name, value) \
+  item = value; \
+  PyDict_SetItemString(dict, name, item); \
+  Py_DECREF(item);
+
+  ADD_ITEM(dict, "bytesSent", PyLong_FromUnsignedLongLong(stats.bytesSent));
+  ADD_ITEM(dict, "bytesReceived", PyLong_FromUnsignedLongLong(stats.bytesReceived));
+  ADD_ITEM(dict, "packetsSent", PyLong_FromUnsignedLong(stats.packetsSent));
+  ADD_ITEM(dict, "packetsReceived", PyLong_FromUnsignedLong(stats.packetsReceived));
+  ADD_ITEM(dict, "packetsLost", PyLong_FromUnsignedLong(stats.packetsLost));
+  ADD_ITEM(dict, "bandwidthIn", PyFloat_FromDouble(stats.bandwidthIn));
+  ADD_ITEM(dict, "bandwidthOut", PyFloat_FromDouble(stats.bandwidthOut));
+
+  const unsigned int numPeers = transport.GetNumPeers();
+  PyObject *peers = PyList_New(numPeers);
+  for (unsigned int i = 0; i < numPeers; ++i) {
+    PyObject *peer = PyDict_New();
+    ADD_ITEM(peer, "address", PyUnicode_FromStdString(transport.GetPeerAddress(i)));
+    ADD_ITEM(peer, "roundTripTime", PyFloat_FromDouble(transport.GetPeerRoundTripTime(i)));
+    ADD_ITEM(peer, "packetsLost", PyLong_FromUnsignedLong(transport.GetPeerLostPackets(i)));
+    PyList_SET_ITEM(peers, i, peer);
+  }
+  ADD_ITEM(dict, "peers", peers);
+
+#undef ADD_ITEM
+
+  return dict;
+}
+
 // this gets a pointer to an array filled with floats
 static PyObject *gPyGetSpectrum(PyObject *)
 {
@@ -384,6 +531,21 @@ static PyObject *gPyGetMaxLogicFrame(PyObject *)
   return PyLong_FromLong(KX_GetActiveEngine()->GetMaxLogicFrame());
 }
 
+static PyObject *gPySetMergeTimeBudget(PyObject *, PyObject *args)
+{
+  double budget;
+  if (!PyArg_ParseTuple(args, "d:setMergeTimeBudget", &budget))
+    return nullptr;
+
+  KX_GetActiveEngine()->GetConverter()->SetMergeTimeBudget(std::max(budget, 0.0));
+  Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetMergeTimeBudget(PyObject *)
+{
+  return PyFloat_FromDouble(KX_GetActiveEngine()->GetConverter()->GetMergeTimeBudget());
+}
+
 static PyObject *gPySetMaxPhysicsFrame(PyObject *, PyObject *args)
 {
   int frame;
@@ -446,6 +608,91 @@ static PyObject *gPySetUseExternalClock(PyObject *, PyObject *args)
   Py_RETURN_NONE;
 }
 
+static PyObject *gPyGetUseRenderInterpolation(PyObject *)
+{
+  return PyBool_FromLong(
+      KX_GetActiveEngine()->GetFlag(KX_KetsjiEngine::INTERPOLATE_TRANSFORMS));
+}
+
+static PyObject *gPySetUseRenderInterpolation(PyObject *, PyObject *args)
+{
+  int interpolate;
+
+  if (!PyArg_ParseTuple(args, "p:setUseRenderInterpolation", &interpolate))
+    return nullptr;
+
+  KX_GetActiveEngine()->SetFlag(KX_KetsjiEngine::INTERPOLATE_TRANSFORMS, (bool)interpolate);
+  Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetMaxRenderRate(PyObject *)
+{
+  return PyFloat_FromDouble(KX_GetActiveEngine()->GetMaxRenderRate());
+}
+
+static PyObject *gPySetMaxRenderRate(PyObject *, PyObject *args)
+{
+  double rate;
+  if (!PyArg_ParseTuple(args, "d:setMaxRenderRate", &rate))
+    return nullptr;
+
+  KX_GetActiveEngine()->SetMaxRenderRate(std::max(rate, 0.0));
+  Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetFramePacing(PyObject *)
+{
+  return PyBool_FromLong(KX_GetActiveEngine()->GetFramePacer().GetEnabled());
+}
+
+static PyObject *gPySetFramePacing(PyObject *, PyObject *args)
+{
+  int enabled;
+  double latency = -1.0;
+
+  if (!PyArg_ParseTuple(args, "p|d:setFramePacing", &enabled, &latency))
+    return nullptr;
+
+  KX_FramePacer &pacer = KX_GetActiveEngine()->GetFramePacer();
+  pacer.SetEnabled(enabled);
+  if (latency >= 0.0) {
+    pacer.SetLatency(latency);
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetFramePacingStatistics(PyObject *)
+{
+  const KX_FramePacer &pacer = KX_GetActiveEngine()->GetFramePacer();
+  const KX_FramePacer::Statistics &stats = pacer.GetStatistics();
+
+  PyObject *dict = PyDict_New();
+  PyObject *item;
+
+#define ADD_ITEM(name, value) \
+  item = value; \
+  PyDict_SetItemString(dict, name, item); \
+  Py_DECREF(item);
+
+  ADD_ITEM("waits", PyLong_FromUnsignedLong(stats.waits));
+  ADD_ITEM("meanError", PyFloat_FromDouble(stats.meanError));
+  ADD_ITEM("maxError", PyFloat_FromDouble(stats.maxError));
+  ADD_ITEM("sleepTime", PyFloat_FromDouble(stats.sleepTime));
+  ADD_ITEM("spinTime", PyFloat_FromDouble(stats.spinTime));
+  ADD_ITEM("latency", PyFloat_FromDouble(pacer.GetLatency()));
+  ADD_ITEM("sleepResolution", PyFloat_FromDouble(pacer.GetSleepResolution()));
+
+#undef ADD_ITEM
+
+  return dict;
+}
+
+static PyObject *gPyResetFramePacingStatistics(PyObject *)
+{
+  KX_GetActiveEngine()->GetFramePacer().ResetStatistics();
+  Py_RETURN_NONE;
+}
+
 static PyObject *gPyGetClockTime(PyObject *)
 {
   return PyFloat_FromDouble(KX_GetActiveEngine()->GetClockTime());
@@ -789,10 +1036,35 @@ static struct PyMethodDef game_methods[] = {
      METH_NOARGS,
      (const char *)gPyLoadGlobalDict_doc},
     {"sendMessage", (PyCFunction)gPySendMessage, METH_VARARGS, (const char *)gPySendMessage_doc},
+    {"networkListen",
+     (PyCFunction)gPyNetworkListen,
+     METH_VARARGS,
+     (const char *)gPyNetworkListen_doc},
+    {"networkConnect",
+     (PyCFunction)gPyNetworkConnect,
+     METH_VARARGS,
+     (const char *)gPyNetworkConnect_doc},
+    {"networkClose", (PyCFunction)gPyNetworkClose, METH_NOARGS, (const char *)gPyNetworkClose_doc},
+    {"setNetworkMessageSubjects",
+     (PyCFunction)gPySetNetworkMessageSubjects,
+     METH_O,
+     (const char *)gPySetNetworkMessageSubjects_doc},
+    {"getNetworkMessageSubjects",
+     (PyCFunction)gPyGetNetworkMessageSubjects,
+     METH_NOARGS,
+     (const char *)gPyGetNetworkMessageSubjects_doc},
+    {"getNetworkStatistics",
+     (PyCFunction)gPyGetNetworkStatistics,
+     METH_NOARGS,
+     (const char *)gPyGetNetworkStatistics_doc},
     {"getCurrentController",
      (PyCFunction)SCA_PythonController::sPyGetCurrentController,
      METH_NOARGS,
      SCA_PythonController::sPyGetCurrentController__doc__},
+    {"batchedController",
+     (PyCFunction)SCA_PythonController::sPyBatchedController,
+     METH_O,
+     SCA_PythonController::sPyBatchedController__doc__},
     {"getCurrentScene", (PyCFunction)gPyGetCurrentScene, METH_NOARGS, gPyGetCurrentScene_doc},
     {"getInactiveSceneNames",
      (PyCFunction)gPyGetInactiveSceneNames,
@@ -813,6 +1085,14 @@ static struct PyMethodDef game_methods[] = {
      (PyCFunction)gPySetMaxLogicFrame,
      METH_VARARGS,
      (const char *)"Sets the max number of logic frame per render frame"},
+    {"getMergeTimeBudget",
+     (PyCFunction)gPyGetMergeTimeBudget,
+     METH_NOARGS,
+     (const char *)"Gets the max time in seconds spent merging asynchronous lib loads per frame"},
+    {"setMergeTimeBudget",
+     (PyCFunction)gPySetMergeTimeBudget,
+     METH_VARARGS,
+     (const char *)"Sets the max time in seconds spent merging asynchronous lib loads per frame"},
     {"getMaxPhysicsFrame",
      (PyCFunction)gPyGetMaxPhysicsFrame,
      METH_NOARGS,
@@ -861,6 +1141,38 @@ static struct PyMethodDef game_methods[] = {
      (PyCFunction)gPySetUseExternalClock,
      METH_VARARGS,
      (const char *)"Set if we use the time provided by an external clock"},
+    {"getUseRenderInterpolation",
+     (PyCFunction)gPyGetUseRenderInterpolation,
+     METH_NOARGS,
+     (const char *)"Get if the rendered transforms are interpolated between fixed frames"},
+    {"setUseRenderInterpolation",
+     (PyCFunction)gPySetUseRenderInterpolation,
+     METH_VARARGS,
+     (const char *)"Set if the rendered transforms are interpolated between fixed frames"},
+    {"getMaxRenderRate",
+     (PyCFunction)gPyGetMaxRenderRate,
+     METH_NOARGS,
+     (const char *)"Get the maximum render rate with render interpolation"},
+    {"setMaxRenderRate",
+     (PyCFunction)gPySetMaxRenderRate,
+     METH_VARARGS,
+     (const char *)"Set the maximum render rate with render interpolation"},
+    {"getFramePacing",
+     (PyCFunction)gPyGetFramePacing,
+     METH_NOARGS,
+     (const char *)"Get if the engine waits for the next fixed frame"},
+    {"setFramePacing",
+     (PyCFunction)gPySetFramePacing,
+     METH_VARARGS,
+     (const char *)"Set if the engine waits for the next fixed frame and the spin latency"},
+    {"getFramePacingStatistics",
+     (PyCFunction)gPyGetFramePacingStatistics,
+     METH_NOARGS,
+     (const char *)"Get the accuracy of the waits for the next fixed frame"},
+    {"resetFramePacingStatistics",
+     (PyCFunction)gPyResetFramePacingStatistics,
+     METH_NOARGS,
+     (const char *)"Reset the frame pacing statistics"},
     {"getClockTime",
      (PyCFunction)gPyGetClockTime,
      METH_NOARGS,
@@ -1261,6 +1573,16 @@ static PyObject *gPyShowProfile(PyObject *, PyObject *args)
   Py_RETURN_NONE;
 }
 
+static PyObject *gPyShowMemory(PyObject *, PyObject *args)
+{
+  int visible;
+  if (!PyArg_ParseTuple(args, "i:showMemory", &visible))
+    return nullptr;
+
+  KX_GetActiveEngine()->SetFlag(KX_KetsjiEngine::SHOW_MEMORY, visible);
+  Py_RETURN_NONE;
+}
+
 static PyObject *gPyShowProperties(PyObject *, PyObject *args)
 {
   int visible;
@@ -1375,6 +1697,10 @@ static struct PyMethodDef rasterizer_methods[] = {
     {"getVsync", (PyCFunction)gPyGetVsync, METH_NOARGS, ""},
     {"showFramerate", (PyCFunction)gPyShowFramerate, METH_VARARGS, "show or hide the framerate"},
     {"showProfile", (PyCFunction)gPyShowProfile, METH_VARARGS, "show or hide the profile"},
+    {"showMemory",
+     (PyCFunction)gPyShowMemory,
+     METH_VARARGS,
+     "show or hide the memory used by each module"},
     {"showProperties",
      (PyCFunction)gPyShowProperties,
      METH_VARARGS,
@@ -1974,6 +2300,30 @@ void removeImportMain(struct Main *maggie)
   bpy_import_main_extra_remove(maggie);
 }
 
+static PyObject *compilePythonText(const char *buf, const char *filepath)
+{
+  return EXP_CompilePythonScript(buf, filepath);
+}
+
+/* Compile the scripts and text modules through a bytecode cache stored in the user cache
+ * directory, so unchanged scripts are not compiled again at each launch. */
+static void initPythonBytecodeCache()
+{
+  char path[FILE_MAX] = "";
+  char cachedir[FILE_MAX];
+  if (BKE_appdir_folder_caches(cachedir, sizeof(cachedir))) {
+    BLI_path_join(path, sizeof(path), cachedir, "bge_bytecode");
+  }
+  EXP_SetPythonBytecodeCacheDirectory(path);
+  bpy_text_compile_func_set(compilePythonText);
+}
+
+static void exitPythonBytecodeCache()
+{
+  bpy_text_compile_func_set(nullptr);
+  EXP_ClearPythonBytecodeCache();
+}
+
 PyDoc_STRVAR(BGE_module_documentation,
              "This module contains submodules for the Blender Game Engine.\n");
 
@@ -2225,6 +2575,7 @@ void postInitGamePlayerPythonScripting(
   bpy_import_init(PyEval_GetBuiltins());
 
   bpy_import_main_set(maggie);
+  initPythonBytecodeCache();
 
 #  ifdef WITH_FLUID
   /* Required to prevent assertion error, see:
@@ -2297,6 +2648,7 @@ void exitGamePlayerPythonScripting()
   restorePySysObjects(); /* get back the original sys.path and clear the backup */
 
   // Py_Finalize();
+  exitPythonBytecodeCache();
   bpy_import_main_set(nullptr);
   EXP_PyObjectPlus::ClearDeprecationWarning();
 }
@@ -2462,6 +2814,7 @@ void initGamePythonScripting(Main *maggie, bContext *C, bool *audioDeviceIsIniti
   bpy_import_init(PyEval_GetBuiltins());
 
   bpy_import_main_set(maggie);
+  initPythonBytecodeCache();
 
   initPySysObjects(maggie);
 
@@ -2509,6 +2862,7 @@ void exitGamePythonScripting()
   }
 
   restorePySysObjects(); /* get back the original sys.path and clear the backup */
+  exitPythonBytecodeCache();
   bpy_import_main_set(nullptr);
   EXP_PyObjectPlus::ClearDeprecationWarning();
 }
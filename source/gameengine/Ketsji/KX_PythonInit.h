@@ -83,6 +83,37 @@ void updatePythonJoysticks(short (&addrem)[JOYINDEX_MAX]);
 void addImportMain(struct Main *maggie);
 void removeImportMain(struct Main *maggie);
 
+/** Release the GIL in its scope to let the Python threads run while the engine waits: frame
+ * pacing sleeps, buffer swap and system event polling.
+ *
+ * The code in the scope must respect these invariants:
+ * - It never calls the Python C API and never changes a reference count, even indirectly:
+ *   no logic bricks, no game Python callbacks, no proxy creation or release.
+ * - It never reads nor writes the game data or the Blender data, which the Python threads can
+ *   change with the bge API in the scope as between two instructions of a game script.
+ * The GIL is therefore kept during the physics step, writing the game objects through the motion
+ * states, the input event dispatch, the depsgraph evaluation and the draw.
+ */
+class KX_PythonThreadsAllowed {
+#ifdef WITH_PYTHON
+ private:
+  PyThreadState *m_threadState;
+
+ public:
+  KX_PythonThreadsAllowed()
+      : m_threadState((Py_IsInitialized() && PyGILState_Check()) ? PyEval_SaveThread() : nullptr)
+  {
+  }
+
+  ~KX_PythonThreadsAllowed()
+  {
+    if (m_threadState) {
+      PyEval_RestoreThread(m_threadState);
+    }
+  }
+#endif
+};
+
 typedef int (*PyNextFrameFunc)(void *);
 
 struct PyNextFrameState {
@@ -41,6 +41,8 @@
 #include "BKE_modifier.hh"
 #include "BKE_object.hh"
 #include "BKE_screen.hh"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
 #include "BLI_task.h"
 #include "DEG_depsgraph_query.hh"
 #include "DNA_camera_types.h"
@@ -75,9 +77,14 @@
 #include "KX_LodManager.h"
 #include "KX_MotionState.h"
 #include "KX_NetworkMessageScene.h"
+#include "KX_NetworkReplication.h"
 #include "KX_NodeRelationships.h"
+#include "KX_ObjectData.h"
 #include "KX_ObstacleSimulation.h"
 #include "KX_PyMath.h"
+#include "KX_SceneSnapshot.h"
+#include "KX_StreamingManager.h"
+#include "PHY_IGraphicController.h"
 #include "PHY_IPhysicsController.h"
 #include "PHY_IPhysicsEnvironment.h"
 #include "RAS_BucketManager.h"
@@ -158,6 +165,8 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
 
   m_dbvt_culling = false;
   m_dbvt_occlusion_res = 0;
+  m_numVisibleObjects = 0;
+  m_numCulledObjects = 0;
   m_activityCulling = false;
   m_objectlist = new EXP_ListValue<KX_GameObject>();
   m_parentlist = new EXP_ListValue<KX_GameObject>();
@@ -186,6 +195,9 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
   m_logicmgr->RegisterEventManager(joymgr);
 
   m_networkScene = new KX_NetworkMessageScene(messageManager);
+  m_networkReplication = new KX_NetworkReplication(sceneName);
+  m_streamingManager = new KX_StreamingManager(this);
+  m_renderInterpolation = 1.0f;
 
   m_rootnode = nullptr;
 
@@ -429,6 +441,9 @@ KX_Scene::~KX_Scene()
   if (m_networkScene)
     delete m_networkScene;
 
+  delete m_networkReplication;
+  delete m_streamingManager;
+
   if (m_bucketmanager) {
     delete m_bucketmanager;
   }
@@ -436,6 +451,15 @@ KX_Scene::~KX_Scene()
     delete m_sceneConverter;
   }
 
+  for (Object *ob : m_staticBatchObjects) {
+    ID *mesh = (ID *)ob->data;
+    BKE_id_delete(bmain, ob);
+    BKE_id_delete(bmain, mesh);
+  }
+  if (!m_staticBatchObjects.empty()) {
+    DEG_relations_tag_update(bmain);
+  }
+
   RestoreRestrictFlags();
   m_obRestrictFlags.clear();
 
@@ -745,6 +769,10 @@ void KX_Scene::RenderAfterCameraSetup(KX_Camera *cam,
     /* Update compatibles blender physics simulations */
     Object *ob = gameobj->GetBlenderObject();
     TagBlenderPhysicsObject(scene, ob);
+    /* Culled objects are not drawn, their transform stays dirty until they are visible. */
+    if (m_dbvt_culling && gameobj->GetCulled()) {
+      continue;
+    }
     gameobj->TagForTransformUpdate(is_overlay_pass, is_last_render_pass);
   }
 
@@ -755,8 +783,14 @@ void KX_Scene::RenderAfterCameraSetup(KX_Camera *cam,
     m_idsToUpdateInAllRenderPasses.clear();
   }
 
+  /* Objects only moved don't need a depsgraph evaluation. */
+  DEG_evaluate_transforms(depsgraph, m_transformUpdateObjects);
+  m_transformUpdateObjects.clear();
+
   /* We need the changes to be flushed before each draw loop! */
-  BKE_scene_graph_update_tagged(depsgraph, bmain);
+  if (!DEG_is_fully_evaluated(depsgraph)) {
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
 
   /* Update evaluated object object_to_world according to SceneGraph. */
   for (KX_GameObject *gameobj : GetObjectList()) {
@@ -1222,11 +1256,21 @@ void KX_Scene::RestoreRestrictFlags()
   }
 }
 
+void KX_Scene::AddStaticBatchObject(Object *ob)
+{
+  m_staticBatchObjects.push_back(ob);
+}
+
 void KX_Scene::TagForCollectionRemap()
 {
   m_collectionRemap = true;
 }
 
+void KX_Scene::AddTransformUpdateObject(Object *ob)
+{
+  m_transformUpdateObjects.push_back(ob);
+}
+
 KX_GameObject *KX_Scene::GetGameObjectFromObject(Object *ob)
 {
   return m_sceneConverter->FindGameObject(ob);
@@ -1616,6 +1660,8 @@ KX_GameObject *KX_Scene::AddNodeReplicaObject(SG_Node *node, KX_GameObject *game
   KX_GameObject *newobj = (KX_GameObject *)gameobj->GetReplica();
   m_map_gameobject_to_replica[gameobj] = newobj;
 
+  KX_GetActiveEngine()->GetConverter()->RegisterLibraryReplica(this, gameobj, newobj);
+
   // also register 'timers' (time properties) of the replica
   int numprops = newobj->GetPropertyCount();
 
@@ -2192,6 +2238,9 @@ bool KX_Scene::NewRemoveObject(KX_GameObject *gameobj)
   if (group)
     group->RemoveInstanceObject(gameobj);
 
+  m_networkReplication->UnregisterObject(gameobj);
+  KX_GetActiveEngine()->GetConverter()->UnregisterLibraryObject(this, gameobj);
+
   if (m_obstacleSimulation) {
     m_obstacleSimulation->DestroyObstacleForObj(gameobj);
   }
@@ -2254,6 +2303,9 @@ void KX_Scene::ReplaceMesh(KX_GameObject *gameobj,
     return;
   }
 
+  KX_GetActiveEngine()->GetConverter()->RegisterLibraryUser(
+      this, gameobj, (ID *)mesh->GetOrigMesh());
+
   if (use_gfx) {
     gameobj->RemoveMeshes();
     gameobj->AddMesh(mesh);
@@ -2315,6 +2367,55 @@ void KX_Scene::PhysicsCullingCallback(KX_ClientObjectInfo *objectInfo, void *cul
     // ideally, invisible objects should be removed from the culling tree temporarily
     return;
   }
+
+  gameobj->SetCulled(false);
+}
+
+void KX_Scene::CalculateVisibleObjects(KX_Camera *cam, const RAS_Rect &viewport)
+{
+  m_numVisibleObjects = 0;
+  m_numCulledObjects = 0;
+
+  if (!cam) {
+    return;
+  }
+
+  for (KX_GameObject *gameobj : GetObjectList()) {
+    PHY_IGraphicController *ctrl = gameobj->GetGraphicController();
+    if (!ctrl && gameobj->UseCulling()) {
+      gameobj->CreateGraphicController();
+      ctrl = gameobj->GetGraphicController();
+    }
+    else if (ctrl && gameobj->GetSGNode()->IsDirty(SG_Node::DIRTY_RENDER)) {
+      ctrl->SetGraphicTransform();
+    }
+    // Objects out of the culling tree are always visible, others are set visible by the callback.
+    gameobj->SetCulled(ctrl != nullptr);
+  }
+
+  const SG_Frustum &frustum = cam->GetFrustum();
+  const int view[4] = {
+      viewport.GetLeft(), viewport.GetBottom(), viewport.GetWidth(), viewport.GetHeight()};
+  if (!m_physicsEnvironment->CullingTest(PhysicsCullingCallback,
+                                         this,
+                                         frustum.GetPlanes(),
+                                         m_dbvt_occlusion_res,
+                                         view,
+                                         frustum.GetMatrix()))
+  {
+    for (KX_GameObject *gameobj : GetObjectList()) {
+      gameobj->SetCulled(false);
+    }
+  }
+
+  for (KX_GameObject *gameobj : GetObjectList()) {
+    if (gameobj->GetCulled()) {
+      ++m_numCulledObjects;
+    }
+    else {
+      ++m_numVisibleObjects;
+    }
+  }
 }
 
 void KX_Scene::RenderDebugProperties(RAS_DebugDraw &debugDraw,
@@ -2585,11 +2686,38 @@ void KX_Scene::UpdateObjectActivity(void)
   }
 }
 
+void KX_Scene::StorePreviousTransforms()
+{
+  for (KX_GameObject *gameobj : m_objectlist) {
+    gameobj->StorePreviousTransform();
+  }
+}
+
+void KX_Scene::SetRenderInterpolation(float factor)
+{
+  m_renderInterpolation = factor;
+}
+
+float KX_Scene::GetRenderInterpolation() const
+{
+  return m_renderInterpolation;
+}
+
 KX_NetworkMessageScene *KX_Scene::GetNetworkMessageScene()
 {
   return m_networkScene;
 }
 
+KX_NetworkReplication *KX_Scene::GetNetworkReplication()
+{
+  return m_networkReplication;
+}
+
+KX_StreamingManager *KX_Scene::GetStreamingManager()
+{
+  return m_streamingManager;
+}
+
 void KX_Scene::SetNetworkMessageScene(KX_NetworkMessageScene *newScene)
 {
   m_networkScene = newScene;
@@ -2662,11 +2790,15 @@ static void MergeScene_GameObject(KX_GameObject *gameobj, KX_Scene *to, KX_Scene
     MergeScene_LogicBrick(controller, from, to);
   }
 
-  /* graphics controller */
+  /* physics and graphics controllers */
   PHY_IController *ctrl = gameobj->GetPhysicsController();
   if (ctrl) {
     ctrl->SetPhysicsEnvironment(to->GetPhysicsEnvironment());
   }
+  ctrl = gameobj->GetGraphicController();
+  if (ctrl) {
+    ctrl->SetPhysicsEnvironment(to->GetPhysicsEnvironment());
+  }
 
   /* SG_Node can hold a scene reference */
   SG_Node *sg = gameobj->GetSGNode();
@@ -2714,6 +2846,9 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 
   GetBucketManager()->MergeBucketManager(other->GetBucketManager());
 
+  // Index the objects of a library scene to free them with the library.
+  KX_GetActiveEngine()->GetConverter()->RegisterLibraryObjects(this, other);
+
   /* active + inactive == all ??? - lets hope so */
   for (KX_GameObject *gameobj : *other->GetObjectList()) {
     MergeScene_GameObject(gameobj, this, other);
@@ -2908,6 +3043,20 @@ PyMethodDef KX_Scene::Methods[] = {
     EXP_PYMETHODTABLE(KX_Scene, addOverlayCollection),
     EXP_PYMETHODTABLE(KX_Scene, removeOverlayCollection),
     EXP_PYMETHODTABLE(KX_Scene, getGameObjectFromObject),
+    EXP_PYMETHODTABLE_NOARGS(KX_Scene, physicsSnapshot),
+    EXP_PYMETHODTABLE_O(KX_Scene, physicsRestore),
+    EXP_PYMETHODTABLE_NOARGS(KX_Scene, stateSnapshot),
+    EXP_PYMETHODTABLE_O(KX_Scene, stateRestore),
+    EXP_PYMETHODTABLE(KX_Scene, saveState),
+    EXP_PYMETHODTABLE_O(KX_Scene, loadState),
+    EXP_PYMETHODTABLE(KX_Scene, setNetworkId),
+    EXP_PYMETHODTABLE(KX_Scene, replicateObject),
+    EXP_PYMETHODTABLE_O(KX_Scene, unreplicateObject),
+    EXP_PYMETHODTABLE(KX_Scene, addStreamingChunk),
+    EXP_PYMETHODTABLE_O(KX_Scene, removeStreamingChunk),
+    EXP_PYMETHODTABLE_NOARGS(KX_Scene, getStreamingStatistics),
+    EXP_PYMETHODTABLE(KX_Scene, gatherObjectData),
+    EXP_PYMETHODTABLE(KX_Scene, scatterObjectData),
 
     /* dict style access */
     EXP_PYMETHODTABLE(KX_Scene, get),
@@ -3226,6 +3375,36 @@ int KX_Scene::pyattr_set_gravity(EXP_PyObjectPlus *self_v,
   return PY_SET_ATTR_SUCCESS;
 }
 
+PyObject *KX_Scene::pyattr_get_streaming_memory_budget(EXP_PyObjectPlus *self_v,
+                                                       const EXP_PYATTRIBUTE_DEF *attrdef)
+{
+  KX_Scene *self = static_cast<KX_Scene *>(self_v);
+
+  return PyLong_FromLongLong(self->m_streamingManager->GetMemoryBudget());
+}
+
+int KX_Scene::pyattr_set_streaming_memory_budget(EXP_PyObjectPlus *self_v,
+                                                 const EXP_PYATTRIBUTE_DEF *attrdef,
+                                                 PyObject *value)
+{
+  KX_Scene *self = static_cast<KX_Scene *>(self_v);
+
+  const long long budget = PyLong_AsLongLong(value);
+  if (budget == -1 && PyErr_Occurred()) {
+    PyErr_SetString(PyExc_TypeError,
+                    "scene.streamingMemoryBudget = int: KX_Scene, expected an int");
+    return PY_SET_ATTR_FAIL;
+  }
+  if (budget < 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "scene.streamingMemoryBudget = int: KX_Scene, expected a positive value");
+    return PY_SET_ATTR_FAIL;
+  }
+
+  self->m_streamingManager->SetMemoryBudget(budget);
+  return PY_SET_ATTR_SUCCESS;
+}
+
 PyAttributeDef KX_Scene::Attributes[] = {
     EXP_PYATTRIBUTE_RO_FUNCTION("name", KX_Scene, pyattr_get_name),
     EXP_PYATTRIBUTE_RO_FUNCTION("objects", KX_Scene, pyattr_get_objects),
@@ -3249,8 +3428,13 @@ PyAttributeDef KX_Scene::Attributes[] = {
     EXP_PYATTRIBUTE_RW_FUNCTION(
         "pre_draw_setup", KX_Scene, pyattr_get_drawing_callback, pyattr_set_drawing_callback),
     EXP_PYATTRIBUTE_RW_FUNCTION("gravity", KX_Scene, pyattr_get_gravity, pyattr_set_gravity),
+    EXP_PYATTRIBUTE_RW_FUNCTION("streamingMemoryBudget",
+                                KX_Scene,
+                                pyattr_get_streaming_memory_budget,
+                                pyattr_set_streaming_memory_budget),
     EXP_PYATTRIBUTE_BOOL_RO("activityCulling", KX_Scene, m_activityCulling),
-    EXP_PYATTRIBUTE_BOOL_RO("dbvt_culling", KX_Scene, m_dbvt_culling),
+    EXP_PYATTRIBUTE_BOOL_RW("dbvt_culling", KX_Scene, m_dbvt_culling),
+    EXP_PYATTRIBUTE_INT_RW("dbvt_occlusion_res", 0, 1024, true, KX_Scene, m_dbvt_occlusion_res),
     EXP_PYATTRIBUTE_RO_FUNCTION("logger", KX_Scene, KX_PythonProxy::pyattr_get_logger),
     EXP_PYATTRIBUTE_RO_FUNCTION("loggerName", KX_Scene, KX_PythonProxy::pyattr_get_logger_name),
     EXP_PYATTRIBUTE_NULL  // Sentinel
@@ -3602,6 +3786,517 @@ EXP_PYMETHODDEF_DOC(KX_Scene,
   Py_RETURN_NONE;
 }
 
+EXP_PYMETHODDEF_DOC_NOARGS(KX_Scene,
+                           physicsSnapshot,
+                           "physicsSnapshot()\n"
+                           "Save the state of the rigid bodies and constraints in a bytes object.\n")
+{
+  std::vector<unsigned char> snapshot;
+  if (!m_physicsEnvironment || !m_physicsEnvironment->SaveSnapshot(snapshot)) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "scene.physicsSnapshot(): physics engine doesn't support snapshots");
+    return nullptr;
+  }
+
+  return PyBytes_FromStringAndSize((const char *)snapshot.data(), snapshot.size());
+}
+
+EXP_PYMETHODDEF_DOC_O(KX_Scene,
+                      physicsRestore,
+                      "physicsRestore(snapshot)\n"
+                      "Restore the state of the rigid bodies and constraints from a snapshot.\n")
+{
+  Py_buffer buffer;
+  if (PyObject_GetBuffer(value, &buffer, PyBUF_SIMPLE) == -1) {
+    PyErr_SetString(PyExc_TypeError,
+                    "scene.physicsRestore(snapshot): expected a bytes-like object");
+    return nullptr;
+  }
+
+  const bool restored = m_physicsEnvironment &&
+                        m_physicsEnvironment->RestoreSnapshot(
+                            (const unsigned char *)buffer.buf, buffer.len);
+  PyBuffer_Release(&buffer);
+
+  if (!restored) {
+    PyErr_SetString(PyExc_ValueError,
+                    "scene.physicsRestore(snapshot): snapshot doesn't match the scene physics "
+                    "objects");
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC_NOARGS(KX_Scene,
+                           stateSnapshot,
+                           "stateSnapshot()\n"
+                           "Save the game state of the objects in a bytes object.\n")
+{
+  const std::string snapshot = KX_SceneSnapshot::Save(this);
+  return PyBytes_FromStringAndSize(snapshot.data(), snapshot.size());
+}
+
+EXP_PYMETHODDEF_DOC_O(KX_Scene,
+                      stateRestore,
+                      "stateRestore(snapshot)\n"
+                      "Restore the game state of the objects from a snapshot.\n")
+{
+  Py_buffer buffer;
+  if (PyObject_GetBuffer(value, &buffer, PyBUF_SIMPLE) == -1) {
+    PyErr_SetString(PyExc_TypeError, "scene.stateRestore(snapshot): expected a bytes-like object");
+    return nullptr;
+  }
+
+  const bool restored = KX_SceneSnapshot::Restore(this, (const char *)buffer.buf, buffer.len);
+  PyBuffer_Release(&buffer);
+
+  if (!restored) {
+    PyErr_SetString(PyExc_ValueError, "scene.stateRestore(snapshot): invalid snapshot");
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC(KX_Scene,
+                    saveState,
+                    "saveState(filepath, compress=True)\n"
+                    "Save the game state of the objects in a file written in the background.\n")
+{
+  const char *path;
+  int compress = 1;
+  if (!PyArg_ParseTuple(args, "s|i:saveState", &path, &compress)) {
+    return nullptr;
+  }
+
+  char abs_path[FILE_MAX];
+  BLI_strncpy(abs_path, path, sizeof(abs_path));
+  BLI_path_abs(abs_path, KX_GetMainPath().c_str());
+
+  KX_GetActiveEngine()->GetSnapshotWriter()->Write(
+      abs_path, KX_SceneSnapshot::Save(this), compress != 0);
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC_O(KX_Scene,
+                      loadState,
+                      "loadState(filepath)\n"
+                      "Restore the game state of the objects from a file written by saveState.\n")
+{
+  const char *path = _PyUnicode_AsString(value);
+  if (!path) {
+    PyErr_SetString(PyExc_TypeError, "scene.loadState(filepath): expected a string");
+    return nullptr;
+  }
+
+  char abs_path[FILE_MAX];
+  BLI_strncpy(abs_path, path, sizeof(abs_path));
+  BLI_path_abs(abs_path, KX_GetMainPath().c_str());
+
+  // The file could be still written by a previous call to saveState.
+  KX_GetActiveEngine()->GetSnapshotWriter()->Wait();
+
+  std::string snapshot;
+  if (!KX_SceneSnapshot::ReadFile(abs_path, snapshot)) {
+    PyErr_Format(PyExc_IOError, "scene.loadState(filepath): cannot read file \"%s\"", path);
+    return nullptr;
+  }
+
+  if (!KX_SceneSnapshot::Restore(this, snapshot.data(), snapshot.size())) {
+    PyErr_Format(PyExc_ValueError, "scene.loadState(filepath): invalid snapshot \"%s\"", path);
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC(KX_Scene,
+                    setNetworkId,
+                    "setNetworkId(object, networkId)\n"
+                    "Identify an object across the game instances, the states replicated by the "
+                    "remote instances for this id are applied to the object.\n")
+{
+  PyObject *pyobj;
+  unsigned int networkId;
+
+  if (!PyArg_ParseTuple(args, "OI:setNetworkId", &pyobj, &networkId)) {
+    return nullptr;
+  }
+
+  KX_GameObject *gameobj;
+  if (!ConvertPythonToGameObject(m_logicmgr,
+                                 pyobj,
+                                 &gameobj,
+                                 false,
+                                 "scene.setNetworkId(object, networkId): KX_Scene")) {
+    return nullptr;
+  }
+
+  if (!m_networkReplication->SetNetworkId(gameobj, networkId)) {
+    PyErr_Format(PyExc_ValueError,
+                 "scene.setNetworkId(object, networkId): id %u is used by another object",
+                 networkId);
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC(KX_Scene,
+                    replicateObject,
+                    "replicateObject(object, properties=[], radius=0.0)\n"
+                    "Replicate the transform and properties of an object to the remote game "
+                    "instances.\n")
+{
+  PyObject *pyobj;
+  PyObject *pyprops = nullptr;
+  float radius = 0.0f;
+
+  if (!PyArg_ParseTuple(args, "O|Of:replicateObject", &pyobj, &pyprops, &radius)) {
+    return nullptr;
+  }
+
+  KX_GameObject *gameobj;
+  if (!ConvertPythonToGameObject(m_logicmgr,
+                                 pyobj,
+                                 &gameobj,
+                                 false,
+                                 "scene.replicateObject(object, properties, radius): KX_Scene")) {
+    return nullptr;
+  }
+
+  std::vector<std::string> properties;
+  if (pyprops) {
+    PyObject *seq = PySequence_Fast(
+        pyprops, "scene.replicateObject(object, properties, radius): expected a sequence");
+    if (!seq) {
+      return nullptr;
+    }
+    for (Py_ssize_t i = 0, size = PySequence_Fast_GET_SIZE(seq); i < size; ++i) {
+      const char *name = _PyUnicode_AsString(PySequence_Fast_GET_ITEM(seq, i));
+      if (!name) {
+        Py_DECREF(seq);
+        PyErr_SetString(PyExc_TypeError,
+                        "scene.replicateObject(object, properties, radius): expected a "
+                        "sequence of property names");
+        return nullptr;
+      }
+      properties.push_back(name);
+    }
+    Py_DECREF(seq);
+  }
+
+  if (properties.size() > 255) {
+    PyErr_SetString(PyExc_ValueError,
+                    "scene.replicateObject(object, properties, radius): too many properties");
+    return nullptr;
+  }
+
+  unsigned int networkId;
+  if (!m_networkReplication->GetNetworkId(gameobj, networkId)) {
+    PyErr_SetString(PyExc_ValueError,
+                    "scene.replicateObject(object, properties, radius): the object has no "
+                    "network id, see scene.setNetworkId");
+    return nullptr;
+  }
+
+  if (!m_networkReplication->AddObject(gameobj, properties, radius)) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "scene.replicateObject(object, properties, radius): too many replicated "
+                    "objects");
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC_O(KX_Scene,
+                      unreplicateObject,
+                      "unreplicateObject(object)\n"
+                      "Stop replicating an object to the remote game instances.\n")
+{
+  KX_GameObject *gameobj;
+  if (!ConvertPythonToGameObject(
+          m_logicmgr, value, &gameobj, false, "scene.unreplicateObject(object): KX_Scene")) {
+    return nullptr;
+  }
+
+  m_networkReplication->RemoveObject(gameobj);
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC(KX_Scene,
+                    addStreamingChunk,
+                    "addStreamingChunk(path, min, max, loadDistance, unloadDistance=0.0)\n"
+                    "Register a library loaded when the active camera is near its bounding box.\n")
+{
+  const char *path;
+  PyObject *pymin;
+  PyObject *pymax;
+  float loadDistance;
+  float unloadDistance = 0.0f;
+
+  if (!PyArg_ParseTuple(args,
+                        "sOOf|f:addStreamingChunk",
+                        &path,
+                        &pymin,
+                        &pymax,
+                        &loadDistance,
+                        &unloadDistance))
+  {
+    return nullptr;
+  }
+
+  MT_Vector3 min;
+  MT_Vector3 max;
+  if (!PyVecTo(pymin, min) || !PyVecTo(pymax, max)) {
+    return nullptr;
+  }
+
+  char abs_path[FILE_MAX];
+  // Make the path absolute
+  BLI_strncpy(abs_path, path, sizeof(abs_path));
+  BLI_path_abs(abs_path, KX_GetMainPath().c_str());
+
+  if (!m_streamingManager->AddChunk(abs_path, min, max, loadDistance, unloadDistance)) {
+    PyErr_Format(PyExc_ValueError,
+                 "scene.addStreamingChunk(path, ...): chunk \"%s\" already registered",
+                 path);
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC_O(KX_Scene,
+                      removeStreamingChunk,
+                      "removeStreamingChunk(path)\n"
+                      "Unregister a streamed library and free it if loaded.\n")
+{
+  const char *path = _PyUnicode_AsString(value);
+  if (!path) {
+    PyErr_SetString(PyExc_TypeError, "scene.removeStreamingChunk(path): expected a string");
+    return nullptr;
+  }
+
+  char abs_path[FILE_MAX];
+  BLI_strncpy(abs_path, path, sizeof(abs_path));
+  BLI_path_abs(abs_path, KX_GetMainPath().c_str());
+
+  if (!m_streamingManager->RemoveChunk(abs_path)) {
+    PyErr_Format(PyExc_ValueError,
+                 "scene.removeStreamingChunk(path): chunk \"%s\" not registered or being loaded",
+                 path);
+    return nullptr;
+  }
+
+  Py_RETURN_NONE;
+}
+
+EXP_PYMETHODDEF_DOC_NOARGS(KX_Scene,
+                           getStreamingStatistics,
+                           "getStreamingStatistics()\n"
+                           "returns a dictionary with the state of each streamed library.\n")
+{
+  static const char *stateNames[] = {"UNLOADED", "LOADING", "LOADED", "FAILED"};
+
+  PyObject *dict = PyDict_New();
+  PyObject *item;
+
+#define ADD_ITEM(dict, name, value) \
+  item = value; \
+  PyDict_SetItemString(dict, name, item); \
+  Py_DECREF(item);
+
+  for (const KX_StreamingManager::Chunk &chunk : m_streamingManager->GetChunks()) {
+    PyObject *stats = PyDict_New();
+    ADD_ITEM(stats, "state", PyUnicode_FromString(stateNames[chunk.m_state]));
+    ADD_ITEM(stats, "distance", PyFloat_FromDouble(chunk.m_distance));
+    ADD_ITEM(stats, "loadTime", PyFloat_FromDouble(chunk.m_loadTime));
+    ADD_ITEM(stats, "mergeTime", PyFloat_FromDouble(chunk.m_mergeTime));
+    ADD_ITEM(stats, "memoryUsage", PyLong_FromLongLong(chunk.m_memory));
+    ADD_ITEM(stats, "loadCount", PyLong_FromUnsignedLong(chunk.m_loadCount));
+    ADD_ITEM(dict, chunk.m_path.c_str(), stats);
+  }
+
+#undef ADD_ITEM
+
+  return dict;
+}
+
+/** Convert the arguments shared by scene.gatherObjectData and scene.scatterObjectData.
+ * \param objects The converted game objects, all having a physics controller if the data needs.
+ * \param info The converted data name.
+ */
+static bool ConvertPythonToObjectData(SCA_LogicManager *logicmgr,
+                                      PyObject *pyobjects,
+                                      const char *name,
+                                      std::vector<KX_GameObject *> &objects,
+                                      const KX_ObjectDataInfo *&info,
+                                      const char *error_prefix)
+{
+  info = KX_FindObjectData(name);
+  if (!info) {
+    PyErr_Format(PyExc_ValueError, "%s: unknown data \"%s\"", error_prefix, name);
+    return false;
+  }
+
+  PyObject *seq = PySequence_Fast(pyobjects, "expected a sequence of game objects");
+  if (!seq) {
+    return false;
+  }
+
+  const Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+  objects.resize(size);
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    if (!ConvertPythonToGameObject(
+            logicmgr, PySequence_Fast_GET_ITEM(seq, i), &objects[i], false, error_prefix))
+    {
+      Py_DECREF(seq);
+      return false;
+    }
+
+    if (info->physics && !objects[i]->GetPhysicsController()) {
+      PyErr_Format(PyExc_AttributeError,
+                   "%s: object \"%s\" has no physics controller for \"%s\"",
+                   error_prefix,
+                   objects[i]->GetName().c_str(),
+                   name);
+      Py_DECREF(seq);
+      return false;
+    }
+  }
+  Py_DECREF(seq);
+
+  return true;
+}
+
+/// Get a C contiguous float buffer of the expected number of floats.
+static bool GetObjectDataBuffer(
+    PyObject *pybuffer, Py_buffer *buffer, int flags, size_t size, const char *error_prefix)
+{
+  if (PyObject_GetBuffer(pybuffer, buffer, flags | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == -1) {
+    return false;
+  }
+
+  const char *format = buffer->format ? buffer->format : "B";
+  // Skip the byte order character, only the native one is valid for a float.
+  if (ELEM(format[0], '@', '=', '<', '>', '!')) {
+    ++format;
+  }
+
+  if (!STREQ(format, "f") || buffer->itemsize != sizeof(float)) {
+    PyErr_Format(PyExc_TypeError, "%s: expected a buffer of 32 bits floats", error_prefix);
+    PyBuffer_Release(buffer);
+    return false;
+  }
+
+  if ((size_t)buffer->len != size * sizeof(float)) {
+    PyErr_Format(PyExc_ValueError,
+                 "%s: expected a buffer of %zu floats, got %zd",
+                 error_prefix,
+                 size,
+                 buffer->len / buffer->itemsize);
+    PyBuffer_Release(buffer);
+    return false;
+  }
+
+  return true;
+}
+
+EXP_PYMETHODDEF_DOC(KX_Scene,
+                    gatherObjectData,
+                    "gatherObjectData(objects, data, buffer=None)\n"
+                    "Copy a transform or velocity of many objects into a float buffer.\n")
+{
+  PyObject *pyobjects;
+  const char *name;
+  PyObject *pybuffer = Py_None;
+
+  if (!PyArg_ParseTuple(args, "Os|O:gatherObjectData", &pyobjects, &name, &pybuffer)) {
+    return nullptr;
+  }
+
+  static const char *error_prefix = "scene.gatherObjectData(objects, data, buffer)";
+
+  std::vector<KX_GameObject *> objects;
+  const KX_ObjectDataInfo *info;
+  if (!ConvertPythonToObjectData(m_logicmgr, pyobjects, name, objects, info, error_prefix)) {
+    return nullptr;
+  }
+
+  const size_t size = objects.size() * info->size;
+
+  // Fill the user buffer.
+  if (pybuffer != Py_None) {
+    Py_buffer buffer;
+    if (!GetObjectDataBuffer(pybuffer, &buffer, PyBUF_WRITABLE, size, error_prefix)) {
+      return nullptr;
+    }
+    KX_GatherObjectData(objects, info, (float *)buffer.buf);
+    PyBuffer_Release(&buffer);
+
+    Py_INCREF(pybuffer);
+    return pybuffer;
+  }
+
+  // Or a new buffer exposed as a two dimensional float memoryview.
+  PyObject *bytes = PyByteArray_FromStringAndSize(nullptr, size * sizeof(float));
+  if (!bytes) {
+    return nullptr;
+  }
+  KX_GatherObjectData(objects, info, (float *)PyByteArray_AS_STRING(bytes));
+
+  PyObject *view = PyMemoryView_FromObject(bytes);
+  Py_DECREF(bytes);
+  if (!view) {
+    return nullptr;
+  }
+
+  // A shape can't contain a zero, an empty list gives an empty one dimensional buffer.
+  PyObject *shaped = objects.empty() ?
+                         PyObject_CallMethod(view, "cast", "s", "f") :
+                         PyObject_CallMethod(view,
+                                             "cast",
+                                             "s(nn)",
+                                             "f",
+                                             (Py_ssize_t)objects.size(),
+                                             (Py_ssize_t)info->size);
+  Py_DECREF(view);
+  return shaped;
+}
+
+EXP_PYMETHODDEF_DOC(KX_Scene,
+                    scatterObjectData,
+                    "scatterObjectData(objects, data, buffer)\n"
+                    "Set a transform or velocity of many objects from a float buffer.\n")
+{
+  PyObject *pyobjects;
+  const char *name;
+  PyObject *pybuffer;
+
+  if (!PyArg_ParseTuple(args, "OsO:scatterObjectData", &pyobjects, &name, &pybuffer)) {
+    return nullptr;
+  }
+
+  static const char *error_prefix = "scene.scatterObjectData(objects, data, buffer)";
+
+  std::vector<KX_GameObject *> objects;
+  const KX_ObjectDataInfo *info;
+  if (!ConvertPythonToObjectData(m_logicmgr, pyobjects, name, objects, info, error_prefix)) {
+    return nullptr;
+  }
+
+  Py_buffer buffer;
+  if (!GetObjectDataBuffer(
+          pybuffer, &buffer, PyBUF_SIMPLE, objects.size() * info->size, error_prefix)) {
+    return nullptr;
+  }
+  KX_ScatterObjectData(objects, info, (const float *)buffer.buf);
+  PyBuffer_Release(&buffer);
+
+  Py_RETURN_NONE;
+}
+
 bool ConvertPythonToScene(PyObject *value,
                           KX_Scene **scene,
                           bool py_none_ok,
@@ -37,6 +37,7 @@
 
 #include "DNA_ID.h"  // For IDRecalcFlag
 
+#include "CM_Memory.h"
 #include "EXP_PyObjectPlus.h"
 #include "EXP_Value.h"
 #include "KX_PhysicsEngineEnums.h"
@@ -64,6 +65,8 @@ class SCA_MouseManager;
 class SCA_ISystem;
 class SCA_IInputDevice;
 class KX_NetworkMessageScene;
+class KX_NetworkReplication;
+class KX_StreamingManager;
 class KX_NetworkMessageManager;
 class SG_Node;
 class SG_Node;
@@ -136,7 +139,11 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   bool m_isPythonMainLoop;
   std::vector<KX_GameObject *> m_kxobWithLod;
   std::map<Object *, char> m_obRestrictFlags;
+  /// Blender objects created by the static batching, deleted with the scene.
+  std::vector<Object *> m_staticBatchObjects;
   bool m_collectionRemap;
+  /// Moved objects updated without depsgraph evaluation, see DEG_evaluate_transforms.
+  std::vector<Object *> m_transformUpdateObjects;
   std::vector<BackupObj *> m_backupObList;
   int m_backupOverlayFlag;
   int m_backupOverlayGameFlag;
@@ -209,6 +216,13 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
    * Network scene.
    */
   KX_NetworkMessageScene *m_networkScene;
+  /// Replication of the objects to the remote game instances.
+  KX_NetworkReplication *m_networkReplication;
+  /// Loading of the chunk libraries near the active camera.
+  KX_StreamingManager *m_streamingManager;
+
+  /// Factor between the previous and current simulation transforms of the rendered objects.
+  float m_renderInterpolation;
 
   /**
    * A temporary variable used to parent objects together on
@@ -277,6 +291,10 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
    */
   int m_dbvt_occlusion_res;
 
+  /// Number of objects visible and culled by the last culling pass.
+  unsigned int m_numVisibleObjects;
+  unsigned int m_numCulledObjects;
+
   /**
    * The framing settings used by this scene
    */
@@ -356,7 +374,9 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   void RemoveObjFromLodObjList(KX_GameObject *gameobj);
   void BackupRestrictFlag(Object *ob, char restrictFlag);
   void RestoreRestrictFlags();
+  void AddStaticBatchObject(Object *ob);
   void TagForCollectionRemap();
+  void AddTransformUpdateObject(Object *ob);
   KX_GameObject *GetGameObjectFromObject(Object *ob);
   void BackupObjectsMatToWorld(BackupObj *back);
   void RestoreObjectsMatToWorld();
@@ -474,6 +494,8 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
    */
   void SetNetworkMessageScene(KX_NetworkMessageScene *newScene);
   KX_NetworkMessageScene *GetNetworkMessageScene();
+  KX_NetworkReplication *GetNetworkReplication();
+  KX_StreamingManager *GetStreamingManager();
 
   /// \section Debug draw.
   void RenderDebugProperties(RAS_DebugDraw &debugDraw,
@@ -502,6 +524,14 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   // Update the activity box settings for objects in this scene, if needed.
   void UpdateObjectActivity(void);
 
+  /// Store the world transform of all objects before a simulation frame.
+  void StorePreviousTransforms();
+  /** Set the factor used to interpolate the rendered transforms from the transforms before the
+   * last simulation frame (0) to the current transforms (1).
+   */
+  void SetRenderInterpolation(float factor);
+  float GetRenderInterpolation() const;
+
   // Enable/disable activity culling.
   void SetActivityCulling(bool b);
 
@@ -522,6 +552,21 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   {
     return m_dbvt_occlusion_res;
   }
+  unsigned int GetNumVisibleObjects() const
+  {
+    return m_numVisibleObjects;
+  }
+  unsigned int GetNumCulledObjects() const
+  {
+    return m_numCulledObjects;
+  }
+
+  /** Flag as culled the objects outside of the camera frustum or occluded, using the DBVT
+   * culling tree of the physics environment.
+   * \param cam The camera to cull from.
+   * \param viewport The viewport of the camera, used by the occlusion buffer.
+   */
+  void CalculateVisibleObjects(KX_Camera *cam, const RAS_Rect &viewport);
 
   void SetBlenderSceneConverter(class BL_SceneConverter *sceneConverter);
   class BL_SceneConverter *GetBlenderSceneConverter();
@@ -579,6 +624,20 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   EXP_PYMETHOD_DOC(KX_Scene, addOverlayCollection);
   EXP_PYMETHOD_DOC(KX_Scene, removeOverlayCollection);
   EXP_PYMETHOD_DOC(KX_Scene, getGameObjectFromObject);
+  EXP_PYMETHOD_DOC_NOARGS(KX_Scene, physicsSnapshot);
+  EXP_PYMETHOD_DOC_O(KX_Scene, physicsRestore);
+  EXP_PYMETHOD_DOC_NOARGS(KX_Scene, stateSnapshot);
+  EXP_PYMETHOD_DOC_O(KX_Scene, stateRestore);
+  EXP_PYMETHOD_DOC(KX_Scene, saveState);
+  EXP_PYMETHOD_DOC_O(KX_Scene, loadState);
+  EXP_PYMETHOD_DOC(KX_Scene, setNetworkId);
+  EXP_PYMETHOD_DOC(KX_Scene, replicateObject);
+  EXP_PYMETHOD_DOC_O(KX_Scene, unreplicateObject);
+  EXP_PYMETHOD_DOC(KX_Scene, addStreamingChunk);
+  EXP_PYMETHOD_DOC_O(KX_Scene, removeStreamingChunk);
+  EXP_PYMETHOD_DOC_NOARGS(KX_Scene, getStreamingStatistics);
+  EXP_PYMETHOD_DOC(KX_Scene, gatherObjectData);
+  EXP_PYMETHOD_DOC(KX_Scene, scatterObjectData);
 
   /* attributes */
   static PyObject *pyattr_get_name(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef);
@@ -617,6 +676,11 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   static int pyattr_set_gravity(EXP_PyObjectPlus *self_v,
                                 const EXP_PYATTRIBUTE_DEF *attrdef,
                                 PyObject *value);
+  static PyObject *pyattr_get_streaming_memory_budget(EXP_PyObjectPlus *self_v,
+                                                      const EXP_PYATTRIBUTE_DEF *attrdef);
+  static int pyattr_set_streaming_memory_budget(EXP_PyObjectPlus *self_v,
+                                                const EXP_PYATTRIBUTE_DEF *attrdef,
+                                                PyObject *value);
 
   /* getitem/setitem */
   static PyMappingMethods Mapping;
@@ -642,6 +706,8 @@ class KX_Scene : public KX_PythonProxy, public SCA_IScene {
   // void PrintStats(int verbose_level) {
   //	m_bucketmanager->PrintStats(verbose_level)
   //}
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_KETSJI, "KX_Scene")
 };
 
 #ifdef WITH_PYTHON
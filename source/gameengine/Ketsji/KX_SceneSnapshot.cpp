@@ -0,0 +1,630 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file gameengine/Ketsji/KX_SceneSnapshot.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_SceneSnapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <zstd.h>
+
+#include "BLI_fileops.h"
+#include "BLI_task.h"
+#include "MEM_guardedalloc.h"
+
+#include "BL_ActionManager.h"
+#include "CM_Message.h"
+#include "CM_Serialize.h"
+#include "CM_Utils.h"
+#include "EXP_BoolValue.h"
+#include "EXP_Bytecode.h"
+#include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_StringValue.h"
+#include "KX_GameObject.h"
+#include "KX_Scene.h"
+#include "PHY_IPhysicsController.h"
+
+static const char SNAPSHOT_MAGIC[4] = {'B', 'G', 'S', 'S'};
+static const int SNAPSHOT_COMPRESSION_LEVEL = 3;
+
+enum SnapshotObjectFlag : unsigned char {
+  /// The object has no parent.
+  SNAPSHOT_OBJECT_ROOT = (1 << 0),
+  SNAPSHOT_OBJECT_VISIBLE = (1 << 1),
+  /// The object is dynamic, its velocities are saved.
+  SNAPSHOT_OBJECT_DYNAMIC = (1 << 2)
+};
+
+/// State of an object read from a snapshot.
+struct SnapshotObject {
+  std::string m_name;
+  unsigned char m_flags;
+  unsigned int m_state;
+  float m_transform[10];
+  float m_velocities[6];
+  std::vector<std::pair<std::string, EXP_Value *>> m_properties;
+  std::vector<BL_ActionManager::LayerState> m_layers;
+
+  SnapshotObject() = default;
+  SnapshotObject(const SnapshotObject &other) = delete;
+
+  ~SnapshotObject()
+  {
+    for (const auto &pair : m_properties) {
+      pair.second->Release();
+    }
+  }
+};
+
+static void SaveProperty(std::string &data, const std::string &name, EXP_Value *prop)
+{
+  EXP_BytecodeValue value;
+  if (!EXP_BytecodeValue::FromValue(prop, value)) {
+    return;
+  }
+
+  switch (value.m_type) {
+    case VALUE_INT_TYPE: {
+      CM_WriteString(data, name);
+      CM_WriteData<unsigned char>(data, value.m_type);
+      CM_WriteData<cInt>(data, value.m_int);
+      break;
+    }
+    case VALUE_FLOAT_TYPE: {
+      CM_WriteString(data, name);
+      CM_WriteData<unsigned char>(data, value.m_type);
+      CM_WriteData<float>(data, value.m_float);
+      break;
+    }
+    case VALUE_BOOL_TYPE: {
+      CM_WriteString(data, name);
+      CM_WriteData<unsigned char>(data, value.m_type);
+      CM_WriteData<unsigned char>(data, value.m_bool);
+      break;
+    }
+    case VALUE_STRING_TYPE: {
+      CM_WriteString(data, name);
+      CM_WriteData<unsigned char>(data, value.m_type);
+      CM_WriteData<unsigned int>(data, value.m_string->size());
+      data.append(*value.m_string);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+static EXP_Value *LoadProperty(const char *&data, const char *end, const std::string &name)
+{
+  unsigned char type;
+  if (!CM_ReadData(data, end, type)) {
+    return nullptr;
+  }
+
+  switch (type) {
+    case VALUE_INT_TYPE: {
+      cInt val;
+      return CM_ReadData(data, end, val) ? new EXP_IntValue(val) : nullptr;
+    }
+    case VALUE_FLOAT_TYPE: {
+      float val;
+      return CM_ReadData(data, end, val) ? new EXP_FloatValue(val) : nullptr;
+    }
+    case VALUE_BOOL_TYPE: {
+      unsigned char val;
+      return CM_ReadData(data, end, val) ? new EXP_BoolValue(val != 0) : nullptr;
+    }
+    case VALUE_STRING_TYPE: {
+      unsigned int size;
+      if (!CM_ReadData(data, end, size) || data + size > end) {
+        return nullptr;
+      }
+      EXP_Value *value = new EXP_StringValue(std::string(data, size), name);
+      data += size;
+      return value;
+    }
+  }
+
+  return nullptr;
+}
+
+static void SaveObject(std::string &data, KX_GameObject *gameobj)
+{
+  PHY_IPhysicsController *ctrl = gameobj->GetPhysicsController();
+  const bool dynamic = ctrl && ctrl->IsDynamic();
+
+  unsigned char flags = 0;
+  if (!gameobj->GetParent()) {
+    flags |= SNAPSHOT_OBJECT_ROOT;
+  }
+  if (gameobj->GetVisible()) {
+    flags |= SNAPSHOT_OBJECT_VISIBLE;
+  }
+  if (dynamic) {
+    flags |= SNAPSHOT_OBJECT_DYNAMIC;
+  }
+
+  CM_WriteString(data, gameobj->GetName());
+  CM_WriteData<unsigned char>(data, flags);
+  CM_WriteData<unsigned int>(data, gameobj->GetState());
+
+  const MT_Vector3 &position = gameobj->NodeGetWorldPosition();
+  const MT_Quaternion orientation = gameobj->NodeGetWorldOrientation().getRotation();
+  const MT_Vector3 &scale = gameobj->NodeGetWorldScaling();
+  for (unsigned short i = 0; i < 3; ++i) {
+    CM_WriteData<float>(data, position[i]);
+  }
+  for (unsigned short i = 0; i < 4; ++i) {
+    CM_WriteData<float>(data, orientation[i]);
+  }
+  for (unsigned short i = 0; i < 3; ++i) {
+    CM_WriteData<float>(data, scale[i]);
+  }
+
+  if (dynamic) {
+    const MT_Vector3 linvel = gameobj->GetLinearVelocity();
+    const MT_Vector3 angvel = gameobj->GetAngularVelocity();
+    for (unsigned short i = 0; i < 3; ++i) {
+      CM_WriteData<float>(data, linvel[i]);
+    }
+    for (unsigned short i = 0; i < 3; ++i) {
+      CM_WriteData<float>(data, angvel[i]);
+    }
+  }
+
+  // The number of saved properties is only known after their conversion.
+  const size_t numPropertiesOffset = data.size();
+  CM_WriteData<unsigned short>(data, 0);
+  unsigned short numProperties = 0;
+  const int count = gameobj->GetPropertyCount();
+  for (int i = 0; i < count; ++i) {
+    EXP_Value *prop = gameobj->GetProperty(i);
+    const size_t size = data.size();
+    SaveProperty(data, prop->GetName(), prop);
+    if (data.size() != size) {
+      ++numProperties;
+    }
+  }
+  memcpy(&data[numPropertiesOffset], &numProperties, sizeof(numProperties));
+
+  BL_ActionManager *actionManager = gameobj->GetActionManagerNoCreate();
+  const std::vector<BL_ActionManager::LayerState> layers =
+      actionManager ? actionManager->GetLayerStates() :
+                      std::vector<BL_ActionManager::LayerState>();
+  CM_WriteData<unsigned short>(data, layers.size());
+  for (const BL_ActionManager::LayerState &layer : layers) {
+    CM_WriteData<short>(data, layer.layer);
+    CM_WriteString(data, layer.name);
+    CM_WriteData<float>(data, layer.start);
+    CM_WriteData<float>(data, layer.end);
+    CM_WriteData<float>(data, layer.frame);
+    CM_WriteData<short>(data, layer.priority);
+    CM_WriteData<float>(data, layer.blendin);
+    CM_WriteData<short>(data, layer.playMode);
+    CM_WriteData<float>(data, layer.layerWeight);
+    CM_WriteData<short>(data, layer.ipoFlags);
+    CM_WriteData<float>(data, layer.speed);
+    CM_WriteData<short>(data, layer.blendMode);
+  }
+}
+
+static bool LoadObject(const char *&data, const char *end, SnapshotObject &object)
+{
+  if (!CM_ReadString(data, end, object.m_name) || !CM_ReadData(data, end, object.m_flags) ||
+      !CM_ReadData(data, end, object.m_state))
+  {
+    return false;
+  }
+
+  for (float &value : object.m_transform) {
+    if (!CM_ReadData(data, end, value)) {
+      return false;
+    }
+  }
+
+  if (object.m_flags & SNAPSHOT_OBJECT_DYNAMIC) {
+    for (float &value : object.m_velocities) {
+      if (!CM_ReadData(data, end, value)) {
+        return false;
+      }
+    }
+  }
+
+  unsigned short numProperties;
+  if (!CM_ReadData(data, end, numProperties)) {
+    return false;
+  }
+  for (unsigned short i = 0; i < numProperties; ++i) {
+    std::string name;
+    if (!CM_ReadString(data, end, name)) {
+      return false;
+    }
+    EXP_Value *value = LoadProperty(data, end, name);
+    if (!value) {
+      return false;
+    }
+    object.m_properties.emplace_back(name, value);
+  }
+
+  unsigned short numLayers;
+  if (!CM_ReadData(data, end, numLayers)) {
+    return false;
+  }
+  object.m_layers.resize(numLayers);
+  for (BL_ActionManager::LayerState &layer : object.m_layers) {
+    if (!CM_ReadData(data, end, layer.layer) || !CM_ReadString(data, end, layer.name) ||
+        !CM_ReadData(data, end, layer.start) || !CM_ReadData(data, end, layer.end) ||
+        !CM_ReadData(data, end, layer.frame) || !CM_ReadData(data, end, layer.priority) ||
+        !CM_ReadData(data, end, layer.blendin) || !CM_ReadData(data, end, layer.playMode) ||
+        !CM_ReadData(data, end, layer.layerWeight) || !CM_ReadData(data, end, layer.ipoFlags) ||
+        !CM_ReadData(data, end, layer.speed) || !CM_ReadData(data, end, layer.blendMode))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void RestoreObject(KX_GameObject *gameobj, const SnapshotObject &object)
+{
+  const float *transform = object.m_transform;
+  gameobj->NodeSetWorldPosition(MT_Vector3(transform[0], transform[1], transform[2]));
+  gameobj->NodeSetGlobalOrientation(
+      MT_Matrix3x3(MT_Quaternion(transform[3], transform[4], transform[5], transform[6])));
+  gameobj->NodeSetWorldScale(MT_Vector3(transform[7], transform[8], transform[9]));
+  gameobj->NodeUpdateGS(0.0f);
+
+  if (object.m_flags & SNAPSHOT_OBJECT_DYNAMIC) {
+    const float *velocities = object.m_velocities;
+    gameobj->setLinearVelocity(MT_Vector3(velocities[0], velocities[1], velocities[2]), false);
+    gameobj->setAngularVelocity(MT_Vector3(velocities[3], velocities[4], velocities[5]), false);
+  }
+
+  gameobj->SetState(object.m_state);
+  gameobj->SetVisible(object.m_flags & SNAPSHOT_OBJECT_VISIBLE, false);
+
+  for (const auto &pair : object.m_properties) {
+    // Same as gameobj[name] = value, keep the existing property object.
+    EXP_Value *oldprop = gameobj->GetProperty(pair.first);
+    if (oldprop) {
+      oldprop->SetValue(pair.second);
+    }
+    else {
+      gameobj->SetProperty(pair.first, pair.second);
+    }
+  }
+
+  BL_ActionManager *actionManager = object.m_layers.empty() ?
+                                        gameobj->GetActionManagerNoCreate() :
+                                        gameobj->GetActionManager();
+  if (actionManager) {
+    actionManager->SetLayerStates(object.m_layers);
+  }
+}
+
+/// Read all the objects of a snapshot, before any change to the scene.
+static bool LoadSnapshot(const char *data, size_t size, std::vector<SnapshotObject> &objects)
+{
+  const char *end = data + size;
+  unsigned int version;
+  unsigned int numObjects;
+  if (size < sizeof(SNAPSHOT_MAGIC) || memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+    return false;
+  }
+  data += sizeof(SNAPSHOT_MAGIC);
+  if (!CM_ReadData(data, end, version) || version != KX_SceneSnapshot::VERSION ||
+      !CM_ReadData(data, end, numObjects))
+  {
+    return false;
+  }
+
+  objects = std::vector<SnapshotObject>(numObjects);
+  for (SnapshotObject &object : objects) {
+    if (!LoadObject(data, end, object)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/// Restore the snapshot objects into the objects of the same name in order.
+static void RestoreObjectsByName(const std::vector<KX_GameObject *> &sceneObjects,
+                                 const std::vector<SnapshotObject> &objects)
+{
+  std::map<std::string, std::vector<KX_GameObject *>> objectsByName;
+  for (KX_GameObject *gameobj : sceneObjects) {
+    objectsByName[gameobj->GetName()].push_back(gameobj);
+  }
+
+  std::map<std::string, unsigned int> numRestored;
+  for (const SnapshotObject &object : objects) {
+    const std::vector<KX_GameObject *> &candidates = objectsByName[object.m_name];
+    unsigned int &index = numRestored[object.m_name];
+    if (index < candidates.size()) {
+      RestoreObject(candidates[index++], object);
+    }
+  }
+}
+
+std::string KX_SceneSnapshot::Save(KX_Scene *scene)
+{
+  std::vector<KX_GameObject *> objects;
+  for (KX_GameObject *gameobj : scene->GetObjectList()) {
+    objects.push_back(gameobj);
+  }
+
+  return SaveObjects(objects);
+}
+
+std::string KX_SceneSnapshot::SaveObjects(const std::vector<KX_GameObject *> &objects)
+{
+  std::string data;
+  data.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  CM_WriteData<unsigned int>(data, VERSION);
+  CM_WriteData<unsigned int>(data, objects.size());
+
+  for (KX_GameObject *gameobj : objects) {
+    SaveObject(data, gameobj);
+  }
+
+  return data;
+}
+
+bool KX_SceneSnapshot::RestoreObjects(const std::vector<KX_GameObject *> &objects,
+                                      const char *data,
+                                      size_t size)
+{
+  std::vector<SnapshotObject> snapshotObjects;
+  if (!LoadSnapshot(data, size, snapshotObjects)) {
+    return false;
+  }
+
+  RestoreObjectsByName(objects, snapshotObjects);
+  return true;
+}
+
+bool KX_SceneSnapshot::Restore(KX_Scene *scene, const char *data, size_t size)
+{
+  std::vector<SnapshotObject> objects;
+  if (!LoadSnapshot(data, size, objects)) {
+    return false;
+  }
+
+  EXP_ListValue<KX_GameObject> *inactiveList = scene->GetInactiveList();
+
+  /* Difference between the number of root objects in the snapshot and in the scene, only the
+   * objects which can be added from the inactive layers are added or removed. */
+  std::map<std::string, int> numMissing;
+  for (const SnapshotObject &object : objects) {
+    if (object.m_flags & SNAPSHOT_OBJECT_ROOT) {
+      ++numMissing[object.m_name];
+    }
+  }
+
+  std::vector<KX_GameObject *> sceneObjects;
+  for (KX_GameObject *gameobj : scene->GetObjectList()) {
+    sceneObjects.push_back(gameobj);
+    if (!gameobj->GetParent()) {
+      --numMissing[gameobj->GetName()];
+    }
+  }
+
+  // Remove the last added objects in excess with their children.
+  std::set<const SG_Node *> removedNodes;
+  for (std::vector<KX_GameObject *>::reverse_iterator it = sceneObjects.rbegin();
+       it != sceneObjects.rend();
+       ++it)
+  {
+    KX_GameObject *gameobj = *it;
+    const std::string &name = gameobj->GetName();
+    if (!gameobj->GetParent() && numMissing[name] < 0 && inactiveList->FindValue(name)) {
+      ++numMissing[name];
+      removedNodes.insert(gameobj->GetSGNode());
+      scene->DelayedRemoveObject(gameobj);
+    }
+  }
+
+  for (const auto &pair : numMissing) {
+    KX_GameObject *original = inactiveList->FindValue(pair.first);
+    if (!original) {
+      continue;
+    }
+    for (int i = 0; i < pair.second; ++i) {
+      KX_GameObject *replica = scene->AddReplicaObject(original, nullptr);
+      // release here because AddReplicaObject AddRef's
+      replica->Release();
+    }
+  }
+
+  // Match the objects by name in the order of the scene.
+  std::vector<KX_GameObject *> restoredObjects;
+  for (KX_GameObject *gameobj : scene->GetObjectList()) {
+    if (removedNodes.find(gameobj->GetSGNode()->GetRootSGParent()) == removedNodes.end()) {
+      restoredObjects.push_back(gameobj);
+    }
+  }
+
+  RestoreObjectsByName(restoredObjects, objects);
+  return true;
+}
+
+bool KX_SceneSnapshot::ReadFile(const std::string &path, std::string &data)
+{
+  size_t size;
+  char *buffer = (char *)BLI_file_read_binary_as_mem(path.c_str(), 0, &size);
+  if (!buffer) {
+    return false;
+  }
+
+  bool success = true;
+  if (size >= 4 && BLI_file_magic_is_zstd(buffer)) {
+    ZSTD_DCtx *ctx = ZSTD_createDCtx();
+    ZSTD_inBuffer input = {buffer, size, 0};
+    std::vector<char> chunk(ZSTD_DStreamOutSize());
+    size_t ret;
+    do {
+      ZSTD_outBuffer output = {chunk.data(), chunk.size(), 0};
+      ret = ZSTD_decompressStream(ctx, &output, &input);
+      if (ZSTD_isError(ret)) {
+        break;
+      }
+      data.append(chunk.data(), output.pos);
+      // Continue while the input is not consumed or the output is not flushed.
+      if (input.pos == input.size && output.pos < output.size) {
+        break;
+      }
+    } while (ret != 0);
+    ZSTD_freeDCtx(ctx);
+    success = (ret == 0);
+  }
+  else {
+    data.assign(buffer, size);
+  }
+
+  MEM_freeN(buffer);
+  return success;
+}
+
+struct KX_SnapshotWriter::File {
+  /// Locked while the file is written.
+  CM_ThreadMutex m_mutex;
+  /// Index of the last write requested, older pending writes are skipped.
+  unsigned int m_lastRequest = 0;
+};
+
+/// Data of a snapshot file to write in a background task.
+struct KX_SnapshotWriter::Task {
+  File *m_file;
+  unsigned int m_request;
+  std::string m_path;
+  std::string m_data;
+  bool m_compress;
+};
+
+static bool write_snapshot_compressed(FILE *file, const std::string &data)
+{
+  ZSTD_CCtx *ctx = ZSTD_createCCtx();
+  ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, SNAPSHOT_COMPRESSION_LEVEL);
+
+  // Compress and write by chunks of the recommended stream output size.
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  std::vector<char> chunk(ZSTD_CStreamOutSize());
+  bool success = true;
+  size_t remaining;
+  do {
+    ZSTD_outBuffer output = {chunk.data(), chunk.size(), 0};
+    remaining = ZSTD_compressStream2(ctx, &output, &input, ZSTD_e_end);
+    if (ZSTD_isError(remaining) || fwrite(chunk.data(), 1, output.pos, file) != output.pos) {
+      success = false;
+      break;
+    }
+  } while (remaining != 0);
+
+  ZSTD_freeCCtx(ctx);
+  return success;
+}
+
+void KX_SnapshotWriter::WriteTask(TaskPool *__restrict pool, void *taskdata)
+{
+  const Task *task = static_cast<Task *>(taskdata);
+  KX_SnapshotWriter *writer = static_cast<KX_SnapshotWriter *>(BLI_task_pool_user_data(pool));
+
+  /* Serialize the writes of a file so that an older snapshot never replaces a newer one,
+   * the request index is read under the file lock as a newer write can be requested meanwhile. */
+  task->m_file->m_mutex.Lock();
+  writer->m_filesMutex.Lock();
+  const bool outdated = task->m_request != task->m_file->m_lastRequest;
+  writer->m_filesMutex.Unlock();
+  if (outdated) {
+    task->m_file->m_mutex.Unlock();
+    return;
+  }
+
+  // Write in a temporary file to never leave a partial snapshot file.
+  const std::string tmppath = CM_UniqueTemporaryPath(task->m_path);
+  FILE *file = BLI_fopen(tmppath.c_str(), "wb");
+  if (!file) {
+    CM_Error("cannot open snapshot file: " << tmppath);
+    task->m_file->m_mutex.Unlock();
+    return;
+  }
+
+  const bool written = task->m_compress ?
+                           write_snapshot_compressed(file, task->m_data) :
+                           fwrite(task->m_data.data(), 1, task->m_data.size(), file) ==
+                               task->m_data.size();
+  fclose(file);
+
+  if (!written || BLI_rename_overwrite(tmppath.c_str(), task->m_path.c_str()) != 0) {
+    CM_Error("cannot write snapshot file: " << task->m_path);
+    BLI_delete(tmppath.c_str(), false, false);
+  }
+
+  task->m_file->m_mutex.Unlock();
+}
+
+void KX_SnapshotWriter::FreeTask(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  delete static_cast<KX_SnapshotWriter::Task *>(taskdata);
+}
+
+KX_SnapshotWriter::KX_SnapshotWriter()
+{
+  m_taskpool = BLI_task_pool_create(this, TASK_PRIORITY_LOW);
+}
+
+KX_SnapshotWriter::~KX_SnapshotWriter()
+{
+  BLI_task_pool_work_and_wait(m_taskpool);
+  BLI_task_pool_free(m_taskpool);
+}
+
+void KX_SnapshotWriter::Write(const std::string &path, std::string &&data, bool compress)
+{
+  m_filesMutex.Lock();
+  std::unique_ptr<File> &file = m_files[path];
+  if (!file) {
+    file.reset(new File());
+  }
+  const unsigned int request = ++file->m_lastRequest;
+  m_filesMutex.Unlock();
+
+  Task *task = new Task{file.get(), request, path, std::move(data), compress};
+  BLI_task_pool_push(m_taskpool, WriteTask, task, true, FreeTask);
+}
+
+void KX_SnapshotWriter::Wait()
+{
+  BLI_task_pool_work_and_wait(m_taskpool);
+}
@@ -0,0 +1,101 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file KX_SceneSnapshot.h
+ *  \ingroup ketsji
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CM_Thread.h"
+
+class KX_GameObject;
+class KX_Scene;
+struct TaskPool;
+
+/** Binary snapshot of the game state of a scene, used for save games and level transitions.
+ *
+ * For each object the snapshot contains its world transform, logic state, visibility,
+ * physics velocities, game properties and the actions playing on its layers.
+ * Objects are matched by name and order on restore. The objects added from the inactive
+ * layers are added or removed to match the number of objects in the snapshot.
+ */
+class KX_SceneSnapshot {
+ public:
+  /// Version of the snapshot format, snapshots of other versions are refused.
+  static const unsigned int VERSION = 1;
+
+  static std::string Save(KX_Scene *scene);
+  /** Restore a snapshot made by Save.
+   * \return False if the data is not a valid snapshot of the current version, the scene is
+   * then left unchanged.
+   */
+  static bool Restore(KX_Scene *scene, const char *data, size_t size);
+
+  /// Save the given objects in the same format as Save.
+  static std::string SaveObjects(const std::vector<KX_GameObject *> &objects);
+  /** Restore a snapshot into the given objects, matched by name and order. Unlike Restore no
+   * object is added or removed.
+   * \return False if the data is not a valid snapshot of the current version.
+   */
+  static bool RestoreObjects(const std::vector<KX_GameObject *> &objects,
+                             const char *data,
+                             size_t size);
+
+  /** Read a snapshot file written by KX_SnapshotWriter, compressed or not.
+   * \return False if the file can't be read or decompressed.
+   */
+  static bool ReadFile(const std::string &path, std::string &data);
+};
+
+/// Write snapshot files in background tasks, optionally compressed with zstd.
+class KX_SnapshotWriter {
+ private:
+  /// Writes requested for a file path.
+  struct File;
+  struct Task;
+
+  TaskPool *m_taskpool;
+  std::map<std::string, std::unique_ptr<File>> m_files;
+  CM_ThreadMutex m_filesMutex;
+
+  /** Write the data of a task, the writes of a path are serialized and skipped when a newer
+   * write of the same path is requested.
+   */
+  static void WriteTask(TaskPool *__restrict pool, void *taskdata);
+  static void FreeTask(TaskPool *__restrict pool, void *taskdata);
+
+ public:
+  KX_SnapshotWriter();
+  /// Wait for the pending writes.
+  ~KX_SnapshotWriter();
+
+  void Write(const std::string &path, std::string &&data, bool compress);
+  /// Wait for the pending writes, called before reading a snapshot file.
+  void Wait();
+};
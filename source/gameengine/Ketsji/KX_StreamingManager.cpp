@@ -0,0 +1,275 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_StreamingManager.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_StreamingManager.h"
+
+#include <algorithm>
+
+#include "BL_Converter.h"
+#include "CM_Message.h"
+#include "KX_Camera.h"
+#include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
+#include "KX_LibLoadStatus.h"
+#include "KX_Scene.h"
+
+KX_StreamingManager::KX_StreamingManager(KX_Scene *scene) : m_scene(scene), m_memoryBudget(0)
+{
+}
+
+KX_StreamingManager::Chunk *KX_StreamingManager::FindChunk(const std::string &path)
+{
+  for (Chunk &chunk : m_chunks) {
+    if (chunk.m_path == path) {
+      return &chunk;
+    }
+  }
+
+  return nullptr;
+}
+
+bool KX_StreamingManager::AddChunk(const std::string &path,
+                                   const MT_Vector3 &min,
+                                   const MT_Vector3 &max,
+                                   float loadDistance,
+                                   float unloadDistance)
+{
+  if (FindChunk(path)) {
+    return false;
+  }
+
+  Chunk chunk;
+  chunk.m_path = path;
+  chunk.m_min = MT_Vector3(std::min(min.x(), max.x()),
+                           std::min(min.y(), max.y()),
+                           std::min(min.z(), max.z()));
+  chunk.m_max = MT_Vector3(std::max(min.x(), max.x()),
+                           std::max(min.y(), max.y()),
+                           std::max(min.z(), max.z()));
+  chunk.m_loadDistance = loadDistance;
+  chunk.m_unloadDistance = std::max(loadDistance, unloadDistance);
+  chunk.m_state = CHUNK_UNLOADED;
+  chunk.m_distance = 0.0f;
+  chunk.m_loadTime = 0.0;
+  chunk.m_mergeTime = 0.0;
+  chunk.m_memory = 0;
+  chunk.m_loadCount = 0;
+
+  m_chunks.push_back(chunk);
+
+  return true;
+}
+
+bool KX_StreamingManager::RemoveChunk(const std::string &path)
+{
+  for (std::vector<Chunk>::iterator it = m_chunks.begin(), end = m_chunks.end(); it != end;
+       ++it)
+  {
+    if (it->m_path != path) {
+      continue;
+    }
+
+    if (it->m_state == CHUNK_LOADING || (it->m_state == CHUNK_LOADED && !FreeChunk(*it))) {
+      return false;
+    }
+
+    m_chunks.erase(it);
+    return true;
+  }
+
+  return false;
+}
+
+const std::vector<KX_StreamingManager::Chunk> &KX_StreamingManager::GetChunks() const
+{
+  return m_chunks;
+}
+
+long long KX_StreamingManager::GetMemoryBudget() const
+{
+  return m_memoryBudget;
+}
+
+void KX_StreamingManager::SetMemoryBudget(long long budget)
+{
+  m_memoryBudget = std::max(budget, 0LL);
+}
+
+bool KX_StreamingManager::LoadChunk(Chunk &chunk)
+{
+  BL_Converter *converter = KX_GetActiveEngine()->GetConverter();
+
+  char *err_str = nullptr;
+  KX_LibLoadStatus *status = converter->LinkBlendFilePath(
+      chunk.m_path.c_str(),
+      (char *)"Scene",
+      m_scene,
+      &err_str,
+      BL_Converter::LIB_LOAD_ASYNC | BL_Converter::LIB_LOAD_LOAD_SCRIPTS);
+
+  if (!status) {
+    CM_Error("failed to stream chunk \"" << chunk.m_path << "\": " << (err_str ? err_str : ""));
+    chunk.m_state = CHUNK_FAILED;
+    return false;
+  }
+
+  chunk.m_state = CHUNK_LOADING;
+
+  return true;
+}
+
+bool KX_StreamingManager::FreeChunk(Chunk &chunk)
+{
+  BL_Converter *converter = KX_GetActiveEngine()->GetConverter();
+  // The chunk could have been freed with LibFree.
+  if (converter->GetMainDynamicPath(chunk.m_path) && !converter->FreeBlendFile(chunk.m_path)) {
+    return false;
+  }
+
+  chunk.m_state = CHUNK_UNLOADED;
+
+  return true;
+}
+
+void KX_StreamingManager::Update()
+{
+  if (m_chunks.empty()) {
+    return;
+  }
+
+  KX_Camera *camera = m_scene->GetActiveCamera();
+  if (!camera) {
+    return;
+  }
+
+  const MT_Vector3 &position = camera->NodeGetWorldPosition();
+  BL_Converter *converter = KX_GetActiveEngine()->GetConverter();
+
+  unsigned int numLoading = 0;
+  // Memory used by the loaded chunks and estimated for the loading chunks from their last load.
+  long long memoryUsed = 0;
+  std::vector<Chunk *> candidates;
+  std::vector<Chunk *> loaded;
+
+  for (Chunk &chunk : m_chunks) {
+    // Distance to the closest point of the bounding box.
+    MT_Vector3 delta;
+    for (unsigned short i = 0; i < 3; ++i) {
+      delta[i] = std::max(std::max(chunk.m_min[i] - position[i], position[i] - chunk.m_max[i]),
+                          MT_Scalar(0.0));
+    }
+    chunk.m_distance = delta.length();
+
+    switch (chunk.m_state) {
+      case CHUNK_LOADING: {
+        /* The status is owned by the converter and deleted when the library is freed, it is
+         * looked up by path every frame instead of being kept. */
+        KX_LibLoadStatus *status = converter->GetLibLoadStatus(chunk.m_path);
+        if (!status) {
+          chunk.m_state = CHUNK_UNLOADED;
+          break;
+        }
+
+        if (!status->IsFinished()) {
+          memoryUsed += chunk.m_memory;
+          ++numLoading;
+          break;
+        }
+
+        chunk.m_loadTime = status->GetTimeTaken();
+        chunk.m_mergeTime = status->GetMergeTime();
+        chunk.m_memory = status->GetMemoryUsage();
+        ++chunk.m_loadCount;
+        chunk.m_state = CHUNK_LOADED;
+        ATTR_FALLTHROUGH;
+      }
+      case CHUNK_LOADED: {
+        if (!converter->GetMainDynamicPath(chunk.m_path)) {
+          // Freed with LibFree, load it again when needed.
+          chunk.m_state = CHUNK_UNLOADED;
+        }
+        else if (chunk.m_distance > chunk.m_unloadDistance) {
+          FreeChunk(chunk);
+        }
+        else {
+          memoryUsed += chunk.m_memory;
+          loaded.push_back(&chunk);
+        }
+        break;
+      }
+      case CHUNK_UNLOADED: {
+        if (chunk.m_distance <= chunk.m_loadDistance) {
+          candidates.push_back(&chunk);
+        }
+        break;
+      }
+      case CHUNK_FAILED: {
+        break;
+      }
+    }
+  }
+
+  if (m_memoryBudget > 0 && memoryUsed > m_memoryBudget) {
+    // Free the farthest chunks kept only by their unload distance first.
+    std::sort(loaded.begin(), loaded.end(), [](const Chunk *a, const Chunk *b) {
+      return a->m_distance > b->m_distance;
+    });
+
+    for (Chunk *chunk : loaded) {
+      if (memoryUsed <= m_memoryBudget || chunk->m_distance <= chunk->m_loadDistance) {
+        break;
+      }
+      if (FreeChunk(*chunk)) {
+        memoryUsed -= chunk->m_memory;
+      }
+    }
+  }
+
+  // Load the nearest chunks first.
+  std::sort(candidates.begin(), candidates.end(), [](const Chunk *a, const Chunk *b) {
+    return a->m_distance < b->m_distance;
+  });
+
+  for (Chunk *chunk : candidates) {
+    if (numLoading >= MAX_LOADING_CHUNKS) {
+      break;
+    }
+    /* The memory of a chunk is known after its first load, a chunk never loaded is only
+     * loaded while the budget is not reached. */
+    if (m_memoryBudget > 0) {
+      const bool overBudget = (chunk->m_loadCount > 0) ?
+                                  (memoryUsed + chunk->m_memory > m_memoryBudget) :
+                                  (memoryUsed >= m_memoryBudget);
+      if (overBudget) {
+        continue;
+      }
+    }
+    if (LoadChunk(*chunk)) {
+      memoryUsed += chunk->m_memory;
+      ++numLoading;
+    }
+  }
+}
@@ -0,0 +1,104 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_StreamingManager.h
+ *  \ingroup ketsji
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MT_Vector3.h"
+
+class KX_Scene;
+
+/** Loading and freeing of chunk libraries merged into a scene depending on the distance of
+ * their bounding box to the active camera.
+ *
+ * The chunks are loaded asynchronously with LibLoad, the nearest first, and merged within the
+ * merge time budget of the converter. A chunk is freed when the camera goes further than its
+ * unload distance, larger than its load distance to avoid loading and freeing repeatedly.
+ * An optional memory budget frees the farthest chunks outside of their load distance first and
+ * delays the loading of new chunks while the loaded chunks use more memory than the budget.
+ */
+class KX_StreamingManager {
+ public:
+  /// Maximum number of chunks being converted at the same time.
+  static const unsigned int MAX_LOADING_CHUNKS = 2;
+
+  enum ChunkState { CHUNK_UNLOADED = 0, CHUNK_LOADING, CHUNK_LOADED, CHUNK_FAILED };
+
+  struct Chunk {
+    /// Absolute path of the library.
+    std::string m_path;
+    MT_Vector3 m_min;
+    MT_Vector3 m_max;
+    float m_loadDistance;
+    float m_unloadDistance;
+
+    ChunkState m_state;
+    /// Distance of the bounding box to the camera at the last update.
+    float m_distance;
+
+    /// Statistics of the last load.
+    double m_loadTime;
+    double m_mergeTime;
+    long long m_memory;
+    unsigned int m_loadCount;
+  };
+
+ private:
+  KX_Scene *m_scene;
+  std::vector<Chunk> m_chunks;
+  /// Maximum memory used by the loaded chunks in bytes, 0 for no limit.
+  long long m_memoryBudget;
+
+  Chunk *FindChunk(const std::string &path);
+  bool LoadChunk(Chunk &chunk);
+  bool FreeChunk(Chunk &chunk);
+
+ public:
+  KX_StreamingManager(KX_Scene *scene);
+
+  /** Register a chunk library.
+   * \param path The absolute path of the library.
+   * \param min, max The bounding box of the chunk in world space.
+   * \param unloadDistance The distance to free the chunk, at least the load distance.
+   */
+  bool AddChunk(const std::string &path,
+                const MT_Vector3 &min,
+                const MT_Vector3 &max,
+                float loadDistance,
+                float unloadDistance);
+  /// Unregister a chunk and free it if loaded, fails while the chunk is loading.
+  bool RemoveChunk(const std::string &path);
+
+  const std::vector<Chunk> &GetChunks() const;
+
+  long long GetMemoryBudget() const;
+  void SetMemoryBudget(long long budget);
+
+  /// Start loading the chunks near the active camera and free the far chunks.
+  void Update();
+};
@@ -32,6 +32,7 @@
 
 #include "BKE_main.hh"
 #include "BKE_sound.h"
+#include "BLI_threads.h"
 #include "DNA_scene_types.h"
 #include "wm_event_types.hh"
 
@@ -264,6 +265,9 @@ void LA_Launcher::InitEngine()
     AUD_Device_setSpeedOfSound(device, m_startScene->audio.speed_of_sound);
     AUD_Device_setDopplerFactor(device, m_startScene->audio.doppler_factor);
     AUD_Device_setDistanceModel(device, AUD_DistanceModel(m_startScene->audio.distance_model));
+    // Games can play many 3D sounds at once, mix them in parallel and skip the silent ones.
+    AUD_Device_setMixingThreads(device, BLI_system_thread_count());
+    AUD_Device_setVirtualizationVolume(device, 0.0f);
   }
 #endif  // WITH_AUDASPACE
 
@@ -362,6 +366,7 @@ void LA_Launcher::ExitEngine()
   if (m_audioDeviceIsInitialized) {
     // Stop all remaining playing sounds.
     AUD_Device_stopAll(BKE_sound_get_device());
+    AUD_Device_setMixingThreads(BKE_sound_get_device(), 1);
   }
 #endif  // WITH_AUDASPACE
 
@@ -481,7 +486,11 @@ bool LA_Launcher::EngineNextFrame()
     }
   }
 
-  m_system->processEvents(false);
+  {
+    // Only wait for the system events, their dispatch writes the input device read by Python.
+    KX_PythonThreadsAllowed allowThreads;
+    m_system->processEvents(false);
+  }
   m_system->dispatchEvents();
 
   if (m_inputDevice->GetInput((SCA_IInputDevice::SCA_EnumInputs)m_ketsjiEngine->GetExitKey())
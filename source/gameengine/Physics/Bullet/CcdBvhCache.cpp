@@ -0,0 +1,294 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file gameengine/Physics/Bullet/CcdBvhCache.cpp
+ *  \ingroup physbullet
+ */
+
+#include "CcdBvhCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btStridingMeshInterface.h"
+
+#include "CM_Message.h"
+#include "CM_Thread.h"
+#include "CM_Utils.h"
+
+/// Header of a cache file, followed by the serialized BVH.
+struct CcdBvhCacheHeader {
+  /// Identify the format, its version and the endianness.
+  uint32_t magic;
+  /// Size of btScalar, the BVH layout depends on the precision.
+  uint32_t scalarSize;
+  uint64_t hash;
+  uint32_t numVertices;
+  uint32_t numTriangles;
+  uint32_t dataSize;
+  uint32_t padding;
+};
+
+static const uint32_t bvhCacheMagic = ('B' << 24) | ('V' << 16) | ('H' << 8) | 1;
+
+struct CcdBvhCacheEntry {
+  btOptimizedBvh *m_bvh;
+  /// Buffer containing the BVH when loaded from a file, nullptr when built.
+  void *m_buffer;
+  unsigned int m_numVertices;
+  unsigned int m_numTriangles;
+  unsigned int m_users;
+  /// Copy of the mesh content, compared on hash hits to exclude hash collisions.
+  btAlignedObjectArray<btScalar> m_vertices;
+  std::vector<int> m_indices;
+};
+
+static std::string bvhCacheDirectory;
+/// Entries by mesh hash, meshes colliding on the hash have their own entries.
+static std::multimap<uint64_t, CcdBvhCacheEntry> bvhCacheEntries;
+static CM_ThreadMutex bvhCacheMutex;
+
+/// FNV-1a hash of the mesh content.
+static uint64_t bvh_cache_hash(const btAlignedObjectArray<btScalar> &vertices,
+                               const std::vector<int> &indices)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  const auto hashData = [&hash](const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+  };
+
+  const uint32_t sizes[2] = {(uint32_t)vertices.size(), (uint32_t)indices.size()};
+  hashData(sizes, sizeof(sizes));
+  if (vertices.size() > 0) {
+    hashData(&vertices[0], vertices.size() * sizeof(btScalar));
+  }
+  if (!indices.empty()) {
+    hashData(indices.data(), indices.size() * sizeof(int));
+  }
+
+  return hash;
+}
+
+/// Return true when the entry was created from the same mesh content.
+static bool bvh_cache_match(const CcdBvhCacheEntry &entry,
+                            const btAlignedObjectArray<btScalar> &vertices,
+                            const std::vector<int> &indices)
+{
+  if (entry.m_vertices.size() != vertices.size() || entry.m_indices.size() != indices.size()) {
+    return false;
+  }
+  if (vertices.size() > 0 &&
+      memcmp(&entry.m_vertices[0], &vertices[0], vertices.size() * sizeof(btScalar)) != 0)
+  {
+    return false;
+  }
+  if (!indices.empty() &&
+      memcmp(entry.m_indices.data(), indices.data(), indices.size() * sizeof(int)) != 0)
+  {
+    return false;
+  }
+  return true;
+}
+
+static std::string bvh_cache_path(uint64_t hash)
+{
+  std::stringstream path;
+  path << bvhCacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << hash
+       << ".bvh";
+  return path.str();
+}
+
+static bool bvh_cache_load(CcdBvhCacheEntry &entry, uint64_t hash)
+{
+  std::ifstream file(bvh_cache_path(hash), std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  CcdBvhCacheHeader header;
+  if (!file.read((char *)&header, sizeof(header)) || header.magic != bvhCacheMagic ||
+      header.scalarSize != sizeof(btScalar) || header.hash != hash ||
+      header.numVertices != entry.m_numVertices || header.numTriangles != entry.m_numTriangles)
+  {
+    return false;
+  }
+
+  // The BVH is deserialized in place and requires an aligned buffer.
+  void *buffer = btAlignedAlloc(header.dataSize, 16);
+  if (!file.read((char *)buffer, header.dataSize)) {
+    btAlignedFree(buffer);
+    return false;
+  }
+
+  btOptimizedBvh *bvh = btOptimizedBvh::deSerializeInPlace(buffer, header.dataSize, false);
+  if (!bvh) {
+    btAlignedFree(buffer);
+    return false;
+  }
+
+  entry.m_bvh = bvh;
+  entry.m_buffer = buffer;
+  return true;
+}
+
+static void bvh_cache_save(const CcdBvhCacheEntry &entry, uint64_t hash)
+{
+  CcdBvhCacheHeader header;
+  header.magic = bvhCacheMagic;
+  header.scalarSize = sizeof(btScalar);
+  header.hash = hash;
+  header.numVertices = entry.m_numVertices;
+  header.numTriangles = entry.m_numTriangles;
+  header.dataSize = entry.m_bvh->calculateSerializeBufferSize();
+  header.padding = 0;
+
+  void *buffer = btAlignedAlloc(header.dataSize, 16);
+  if (!entry.m_bvh->serializeInPlace(buffer, header.dataSize, false)) {
+    btAlignedFree(buffer);
+    return;
+  }
+
+  /* Write to a temporary file first to never leave a partial file readable by other instances,
+   * its name is unique as other instances can save the same BVH concurrently. */
+  const std::string path = bvh_cache_path(hash);
+  const std::string tmpPath = CM_UniqueTemporaryPath(path);
+  bool written;
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    written = file && file.write((const char *)&header, sizeof(header)) &&
+              file.write((const char *)buffer, header.dataSize);
+  }
+  btAlignedFree(buffer);
+
+  if (!written || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    CM_Warning("failed to write the BVH cache file " << path);
+  }
+}
+
+void CcdBvhCache::SetDirectory(const std::string &directory)
+{
+  bvhCacheMutex.Lock();
+  bvhCacheDirectory = directory;
+  bvhCacheMutex.Unlock();
+}
+
+const std::string &CcdBvhCache::GetDirectory()
+{
+  return bvhCacheDirectory;
+}
+
+btOptimizedBvh *CcdBvhCache::Acquire(btStridingMeshInterface *meshInterface,
+                                     const btAlignedObjectArray<btScalar> &vertices,
+                                     const std::vector<int> &indices)
+{
+  const uint64_t hash = bvh_cache_hash(vertices, indices);
+
+  bvhCacheMutex.Lock();
+
+  // Files are only named from the hash, they are not used for meshes colliding on the hash.
+  bool collision = false;
+  for (std::multimap<uint64_t, CcdBvhCacheEntry>::iterator it = bvhCacheEntries.find(hash),
+                                                           end = bvhCacheEntries.end();
+       it != end && it->first == hash;
+       ++it)
+  {
+    if (bvh_cache_match(it->second, vertices, indices)) {
+      ++it->second.m_users;
+      btOptimizedBvh *bvh = it->second.m_bvh;
+      bvhCacheMutex.Unlock();
+      return bvh;
+    }
+    collision = true;
+  }
+
+  CcdBvhCacheEntry entry;
+  entry.m_bvh = nullptr;
+  entry.m_buffer = nullptr;
+  entry.m_numVertices = vertices.size() / 3;
+  entry.m_numTriangles = indices.size() / 3;
+  entry.m_users = 1;
+  entry.m_vertices = vertices;
+  entry.m_indices = indices;
+
+  const bool useFile = !bvhCacheDirectory.empty() && !collision;
+  if (!useFile || !bvh_cache_load(entry, hash)) {
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+    meshInterface->calculateAabbBruteForce(aabbMin, aabbMax);
+
+    void *mem = btAlignedAlloc(sizeof(btOptimizedBvh), 16);
+    entry.m_bvh = new (mem) btOptimizedBvh();
+    entry.m_bvh->build(meshInterface, true, aabbMin, aabbMax);
+
+    if (useFile) {
+      bvh_cache_save(entry, hash);
+    }
+  }
+
+  bvhCacheEntries.emplace(hash, entry);
+
+  bvhCacheMutex.Unlock();
+
+  return entry.m_bvh;
+}
+
+void CcdBvhCache::Release(btOptimizedBvh *bvh)
+{
+  bvhCacheMutex.Lock();
+
+  for (std::multimap<uint64_t, CcdBvhCacheEntry>::iterator it = bvhCacheEntries.begin(),
+                                                           end = bvhCacheEntries.end();
+       it != end;
+       ++it)
+  {
+    CcdBvhCacheEntry &entry = it->second;
+    if (entry.m_bvh != bvh) {
+      continue;
+    }
+
+    if (--entry.m_users == 0) {
+      // A loaded BVH uses the memory of its buffer.
+      entry.m_bvh->~btOptimizedBvh();
+      if (entry.m_buffer) {
+        btAlignedFree(entry.m_buffer);
+      }
+      else {
+        btAlignedFree(entry.m_bvh);
+      }
+      bvhCacheEntries.erase(it);
+    }
+    break;
+  }
+
+  bvhCacheMutex.Unlock();
+}
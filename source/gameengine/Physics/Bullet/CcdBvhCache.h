@@ -0,0 +1,61 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file CcdBvhCache.h
+ *  \ingroup physbullet
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btScalar.h"
+
+class btOptimizedBvh;
+class btStridingMeshInterface;
+
+/** Cache of the BVHs of static triangle mesh shapes.
+ *
+ * The BVHs are indexed by a hash of the triangle mesh content, shapes of identical meshes share
+ * the same BVH even across libraries loaded at runtime. When a cache directory is set the BVHs
+ * are also saved in files named from the hash and loaded instead of being built at next runs.
+ */
+class CcdBvhCache {
+ public:
+  /// Set the directory of the cache files, an empty directory disables the files.
+  static void SetDirectory(const std::string &directory);
+  static const std::string &GetDirectory();
+
+  /** Return the BVH of a triangle mesh, loaded from the cache or built.
+   * \param meshInterface The mesh interface using the vertices and indices.
+   * \param vertices The vertex coordinates, 3 values per vertex.
+   * \param indices The vertex indices, 3 per triangle.
+   * \return A BVH to release with Release() when the shapes using it are deleted.
+   */
+  static btOptimizedBvh *Acquire(btStridingMeshInterface *meshInterface,
+                                 const btAlignedObjectArray<btScalar> &vertices,
+                                 const std::vector<int> &indices);
+  static void Release(btOptimizedBvh *bvh);
+};
@@ -37,6 +37,7 @@
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 #include "LinearMath/btConvexHull.h"
 
+#include "CcdBvhCache.h"
 #include "CcdPhysicsEnvironment.h"
 #include "KX_GameObject.h"
 #include "RAS_DisplayArray.h"
@@ -2004,6 +2005,8 @@ void CcdShapeConstructionInfo::ProcessReplica()
   m_meshObject = nullptr;
   m_triangleIndexVertexArray = nullptr;
   m_forceReInstance = false;
+  m_optimizedBvh = nullptr;
+  m_useBvhCache = true;
   m_shapeProxy = nullptr;
   m_vertexArray.clear();
   m_polygonIndexArray.clear();
@@ -2643,6 +2646,8 @@ bool CcdShapeConstructionInfo::UpdateMesh(class KX_GameObject *from_gameobj,
   if (m_triangleIndexVertexArray) {
     m_forceReInstance = true;
   }
+  // Meshes updated at runtime are likely deformed every frame, don't fill the cache with them.
+  m_useBvhCache = false;
 
   // Make sure to also replace the mesh in the shape map! Otherwise we leave dangling references
   // when we free. Note, this whole business could cause issues with shared meshes. If we update
@@ -2773,11 +2778,28 @@ btCollisionShape *CcdShapeConstructionInfo::CreateBulletShape(btScalar margin,
                                                                         3 * sizeof(btScalar));
           }
 
+          if (m_optimizedBvh) {
+            CcdBvhCache::Release(m_optimizedBvh);
+            m_optimizedBvh = nullptr;
+          }
+
           m_forceReInstance = false;
         }
 
-        btBvhTriangleMeshShape *unscaledShape = new btBvhTriangleMeshShape(
-            m_triangleIndexVertexArray, true, useBvh);
+        // The welded meshes don't use the vertex and index arrays the cache is indexed with.
+        if (useBvh && m_useBvhCache && m_weldingThreshold1 == 0.0f && !m_optimizedBvh) {
+          m_optimizedBvh = CcdBvhCache::Acquire(
+              m_triangleIndexVertexArray, m_vertexArray, m_triFaceArray);
+        }
+
+        btBvhTriangleMeshShape *unscaledShape;
+        if (useBvh && m_optimizedBvh) {
+          unscaledShape = new btBvhTriangleMeshShape(m_triangleIndexVertexArray, true, false);
+          unscaledShape->setOptimizedBvh(m_optimizedBvh);
+        }
+        else {
+          unscaledShape = new btBvhTriangleMeshShape(m_triangleIndexVertexArray, true, useBvh);
+        }
         unscaledShape->setMargin(margin);
         collisionShape = new btScaledBvhTriangleMeshShape(unscaledShape,
                                                           btVector3(1.0f, 1.0f, 1.0f));
@@ -2825,6 +2847,9 @@ CcdShapeConstructionInfo::~CcdShapeConstructionInfo()
 
   if (m_triangleIndexVertexArray)
     delete m_triangleIndexVertexArray;
+  if (m_optimizedBvh) {
+    CcdBvhCache::Release(m_optimizedBvh);
+  }
   m_vertexArray.clear();
   if (m_shapeType == PHY_SHAPE_MESH && m_meshObject != nullptr) {
     std::map<RAS_MeshObject *, CcdShapeConstructionInfo *>::iterator mit = m_meshShapeMap.find(
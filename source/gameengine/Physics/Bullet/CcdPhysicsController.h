@@ -31,6 +31,7 @@
 #include "LinearMath/btTransform.h"
 #include "btBulletDynamicsCommon.h"
 
+#include "CM_Memory.h"
 #include "CM_RefCount.h"
 #include "CcdMathUtils.h"
 #include "PHY_ICharacter.h"
@@ -80,6 +81,8 @@ class CcdShapeConstructionInfo : public CM_RefCount<CcdShapeConstructionInfo> {
         m_meshObject(nullptr),
         m_triangleIndexVertexArray(nullptr),
         m_forceReInstance(false),
+        m_optimizedBvh(nullptr),
+        m_useBvhCache(true),
         m_weldingThreshold1(0.0f),
         m_shapeProxy(nullptr)
   {
@@ -198,10 +201,16 @@ class CcdShapeConstructionInfo : public CM_RefCount<CcdShapeConstructionInfo> {
   std::vector<CcdShapeConstructionInfo *> m_shapeArray;
   /// use gimpact for concave dynamic/moving collision detection
   bool m_forceReInstance;
+  /// BVH of the triangle mesh shared through CcdBvhCache, nullptr if the shapes own their BVH.
+  btOptimizedBvh *m_optimizedBvh;
+  /// Use CcdBvhCache for the triangle mesh, disabled once the mesh is updated at runtime.
+  bool m_useBvhCache;
   /// welding closeby vertices together can improve softbody stability etc.
   float m_weldingThreshold1;
   /// only used for PHY_SHAPE_PROXY, pointer to actual shape info
   CcdShapeConstructionInfo *m_shapeProxy;
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_PHYSICS, "CcdShapeConstructionInfo")
 };
 
 struct CcdConstructionInfo {
@@ -270,6 +279,7 @@ struct CcdConstructionInfo {
         m_bRigid(false),
         m_bSoft(false),
         m_bSensor(false),
+        m_bNearSensor(false),
         m_bCharacter(false),
         m_bGimpact(false),
         m_collisionFilterGroup(DynamicFilter),
@@ -387,6 +397,8 @@ struct CcdConstructionInfo {
   bool m_bRigid;
   bool m_bSoft;
   bool m_bSensor;
+  /// Controller of a Near or Radar sensor, see CreateSphereController and CreateConeController.
+  bool m_bNearSensor;
   bool m_bCharacter;
   /// use Gimpact for mesh body
   bool m_bGimpact;
@@ -895,6 +907,8 @@ class CcdPhysicsController : public PHY_IPhysicsController {
   // CCD methods
   virtual void SetCcdMotionThreshold(float val);
   virtual void SetCcdSweptSphereRadius(float val);
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_PHYSICS, "CcdPhysicsController")
 };
 
 /// DefaultMotionState implements standard motionstate, using btTransform
@@ -21,12 +21,17 @@
 
 #include "CcdPhysicsEnvironment.h"
 
+#include <algorithm>
+
 #include "BKE_object.hh"
 #include "BLI_bounds_types.hh"
+#include "BLI_task.hh"
 #include "DNA_object_force_types.h"
 #include "DNA_scene_types.h"
 
+#include "BulletCollision/CollisionDispatch/btCollisionObjectWrapper.h"
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "BulletCollision/CollisionDispatch/btManifoldResult.h"
 #include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
 #include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
 #include "BulletDynamics/ConstraintSolver/btNNCGConstraintSolver.h"
@@ -100,32 +105,96 @@ class VehicleClosestRayResultCallback : public btCollisionWorld::ClosestRayResul
   }
 };
 
+/** Broadphase ray test reporting the objects to a ray result callback, as done by
+ * btCollisionWorld::rayTest but without the traversal stack shared by the broadphase.
+ */
+struct VehicleRayTester : btDbvt::ICollide {
+  btTransform m_rayFromTrans;
+  btTransform m_rayToTrans;
+  btVector3 m_rayDirectionInverse;
+  unsigned int m_signs[3];
+  btScalar m_lambdaMax;
+  btCollisionWorld::RayResultCallback &m_resultCallback;
+
+  VehicleRayTester(const btVector3 &from,
+                   const btVector3 &to,
+                   btCollisionWorld::RayResultCallback &resultCallback)
+      : m_rayFromTrans(btMatrix3x3::getIdentity(), from),
+        m_rayToTrans(btMatrix3x3::getIdentity(), to),
+        m_resultCallback(resultCallback)
+  {
+    const btVector3 rayDir = (to - from).normalized();
+    for (unsigned short i = 0; i < 3; ++i) {
+      m_rayDirectionInverse[i] = (rayDir[i] == 0.0f) ? BT_LARGE_FLOAT : 1.0f / rayDir[i];
+      m_signs[i] = m_rayDirectionInverse[i] < 0.0f;
+    }
+    m_lambdaMax = rayDir.dot(to - from);
+  }
+
+  void Process(const btDbvtNode *leaf)
+  {
+    // Terminate further ray tests once the closest hit fraction reached zero.
+    if (m_resultCallback.m_closestHitFraction == 0.0f) {
+      return;
+    }
+
+    btBroadphaseProxy *proxy = (btBroadphaseProxy *)leaf->data;
+    btCollisionObject *object = (btCollisionObject *)proxy->m_clientObject;
+    if (m_resultCallback.needsCollision(proxy)) {
+      btSoftRigidDynamicsWorld::rayTestSingle(m_rayFromTrans,
+                                              m_rayToTrans,
+                                              object,
+                                              object->getCollisionShape(),
+                                              object->getWorldTransform(),
+                                              m_resultCallback);
+    }
+  }
+};
+
 class BlenderVehicleRaycaster : public btDefaultVehicleRaycaster {
  private:
+  /// Result of a wheel ray cast ahead by CastWheelRays.
+  struct CachedRay {
+    btVector3 m_from;
+    btVector3 m_to;
+    btVehicleRaycasterResult m_result;
+    void *m_object;
+  };
+
   btDynamicsWorld *m_dynamicsWorld;
   unsigned short m_mask;
+  /// Broadphase traversal stack, owned by the raycaster to cast rays of several vehicles at once.
+  btAlignedObjectArray<const btDbvtNode *> m_stack;
+  /// Wheel rays cast by CastWheelRays, consumed in order by castRay.
+  std::vector<CachedRay> m_cachedRays;
+  unsigned int m_nextCachedRay;
 
- public:
-  BlenderVehicleRaycaster(btDynamicsWorld *world)
-      : btDefaultVehicleRaycaster(world),
-        m_dynamicsWorld(world),
-        m_mask((1 << OB_MAX_COL_MASKS) - 1)
-  {
-  }
-
-  virtual void *castRay(const btVector3 &from,
-                        const btVector3 &to,
-                        btVehicleRaycasterResult &result)
+  void *RayTest(const btVector3 &from, const btVector3 &to, btVehicleRaycasterResult &result)
   {
-    //	RayResultCallback& resultCallback;
-
     VehicleClosestRayResultCallback rayCallback(from, to, m_mask);
 
     // We override btDefaultVehicleRaycaster so we can set this flag, otherwise our
     // vehicles go crazy (http://bulletphysics.org/Bullet/phpBB3/viewtopic.php?t=9662)
     rayCallback.m_flags |= btTriangleRaycastCallback::kF_UseSubSimplexConvexCastRaytest;
 
-    m_dynamicsWorld->rayTest(from, to, rayCallback);
+    /* Traverse the broadphase trees with our own stack as btDbvtBroadphase::rayTest shares one
+     * stack between all callers, the broadphase is only read. */
+    VehicleRayTester tester(from, to, rayCallback);
+    const btVector3 zero(0.0f, 0.0f, 0.0f);
+    btDbvtBroadphase *broadphase = static_cast<btDbvtBroadphase *>(
+        m_dynamicsWorld->getBroadphase());
+    for (const btDbvt &set : broadphase->m_sets) {
+      set.rayTestInternal(set.m_root,
+                          from,
+                          to,
+                          tester.m_rayDirectionInverse,
+                          tester.m_signs,
+                          tester.m_lambdaMax,
+                          zero,
+                          zero,
+                          m_stack,
+                          tester);
+    }
 
     if (rayCallback.hasHit()) {
       const btRigidBody *body = btRigidBody::upcast(rayCallback.m_collisionObject);
@@ -140,6 +209,61 @@ class BlenderVehicleRaycaster : public btDefaultVehicleRaycaster {
     return nullptr;
   }
 
+ public:
+  BlenderVehicleRaycaster(btDynamicsWorld *world)
+      : btDefaultVehicleRaycaster(world),
+        m_dynamicsWorld(world),
+        m_mask((1 << OB_MAX_COL_MASKS) - 1),
+        m_nextCachedRay(0)
+  {
+  }
+
+  virtual void *castRay(const btVector3 &from,
+                        const btVector3 &to,
+                        btVehicleRaycasterResult &result)
+  {
+    // Use the ray cast ahead when the wheel didn't move since.
+    if (m_nextCachedRay < m_cachedRays.size()) {
+      const CachedRay &ray = m_cachedRays[m_nextCachedRay++];
+      if (ray.m_from == from && ray.m_to == to) {
+        if (ray.m_object) {
+          result = ray.m_result;
+        }
+        return ray.m_object;
+      }
+    }
+
+    return RayTest(from, to, result);
+  }
+
+  /** Cast the rays of all the wheels of a vehicle as btRaycastVehicle::rayCast does, the results
+   * are used by the next vehicle update. Rays of different vehicles can be cast at once.
+   */
+  void CastWheelRays(btRaycastVehicle *vehicle)
+  {
+    const int numWheels = vehicle->getNumWheels();
+    m_cachedRays.resize(numWheels);
+    m_nextCachedRay = 0;
+
+    for (int i = 0; i < numWheels; ++i) {
+      btWheelInfo &wheel = vehicle->getWheelInfo(i);
+      vehicle->updateWheelTransformsWS(wheel, false);
+
+      const btScalar raylen = wheel.getSuspensionRestLength() + wheel.m_wheelsRadius;
+      CachedRay &ray = m_cachedRays[i];
+      ray.m_from = wheel.m_raycastInfo.m_hardPointWS;
+      ray.m_to = ray.m_from + wheel.m_raycastInfo.m_wheelDirectionWS * raylen;
+      ray.m_object = RayTest(ray.m_from, ray.m_to, ray.m_result);
+    }
+  }
+
+  /// Discard the rays cast ahead, so that rays cast outside of a vehicle update are not cached.
+  void ClearWheelRays()
+  {
+    m_cachedRays.clear();
+    m_nextCachedRay = 0;
+  }
+
   short GetRayCastMask() const
   {
     return m_mask;
@@ -155,12 +279,14 @@ class WrapperVehicle : public PHY_IVehicle {
   btRaycastVehicle *m_vehicle;
   BlenderVehicleRaycaster *m_raycaster;
   PHY_IPhysicsController *m_chassis;
+  /// True when the vehicle is updated by the physics steps, its chassis is in the world.
+  bool m_active;
 
  public:
   WrapperVehicle(btRaycastVehicle *vehicle,
                  BlenderVehicleRaycaster *raycaster,
                  PHY_IPhysicsController *chassis)
-      : m_vehicle(vehicle), m_raycaster(raycaster), m_chassis(chassis)
+      : m_vehicle(vehicle), m_raycaster(raycaster), m_chassis(chassis), m_active(false)
   {
   }
 
@@ -186,6 +312,21 @@ class WrapperVehicle : public PHY_IVehicle {
     return m_chassis;
   }
 
+  BlenderVehicleRaycaster *GetRaycaster()
+  {
+    return m_raycaster;
+  }
+
+  bool GetActive() const
+  {
+    return m_active;
+  }
+
+  void SetActive(bool active)
+  {
+    m_active = active;
+  }
+
   virtual void AddWheel(PHY_IMotionState *motionState,
                         MT_Vector3 connectionPoint,
                         MT_Vector3 downDirection,
@@ -204,6 +345,15 @@ class WrapperVehicle : public PHY_IVehicle {
     info.m_clientInfo = motionState;
   }
 
+  /// Compute the wheel transforms used by SyncWheels, can be called for several vehicles at once.
+  void UpdateWheelTransforms()
+  {
+    for (int i = 0, numWheels = GetNumWheels(); i < numWheels; ++i) {
+      m_vehicle->updateWheelTransform(i, false);
+    }
+  }
+
+  /// Set the wheel transforms to the wheel motion states.
   void SyncWheels()
   {
     int numWheels = GetNumWheels();
@@ -211,8 +361,7 @@ class WrapperVehicle : public PHY_IVehicle {
     for (i = 0; i < numWheels; i++) {
       btWheelInfo &info = m_vehicle->getWheelInfo(i);
       PHY_IMotionState *motionState = (PHY_IMotionState *)info.m_clientInfo;
-      m_vehicle->updateWheelTransform(i, false);
-      const btTransform trans = m_vehicle->getWheelInfo(i).m_worldTransform;
+      const btTransform &trans = info.m_worldTransform;
       /* Bullet 2.89: See void btRaycastVehicle::updateWheelTransform
        * Use m_worldTransform.getBasis as setBasis is used to update
        * wheel transformation
@@ -344,6 +493,29 @@ class WrapperVehicle : public PHY_IVehicle {
   }
 };
 
+/** Bullet action updating all the vehicles of an environment at once, the wheel rays of all the
+ * vehicles are cast in parallel before the serial update of the suspensions and frictions.
+ */
+class CcdVehicleAction : public btActionInterface {
+ private:
+  CcdPhysicsEnvironment *m_physEnv;
+
+ public:
+  CcdVehicleAction(CcdPhysicsEnvironment *physEnv) : m_physEnv(physEnv)
+  {
+  }
+
+  virtual void updateAction(btCollisionWorld * /*collisionWorld*/, btScalar step)
+  {
+    m_physEnv->UpdateVehicles(step);
+  }
+
+  virtual void debugDraw(btIDebugDraw *debugDrawer)
+  {
+    m_physEnv->DebugDrawVehicles(debugDrawer);
+  }
+};
+
 class CcdOverlapFilterCallBack : public btOverlapFilterCallback {
  private:
   class CcdPhysicsEnvironment *m_physEnv;
@@ -376,6 +548,7 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(PHY_SolverType solverType, bool use
       m_linearDeactivationThreshold(0.8f),
       m_angularDeactivationThreshold(1.0f),
       m_contactBreakingThreshold(0.02f),
+      m_useSensorQueries(false),
       m_solver(nullptr),
       m_filterCallback(nullptr),
       m_ghostPairCallback(nullptr),
@@ -408,18 +581,40 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(PHY_SolverType solverType, bool use
   // btDiscreteDynamicsWorld(dispatcher,m_broadphase,m_solver,m_collisionConfiguration);
   m_dynamicsWorld = new btSoftRigidDynamicsWorld(
       dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+  /* The manifolds and the islands are processed in the order of the broadphase pairs, which
+   * depends on the history of the world. Sort them so that stepping after a restore of a
+   * snapshot gives the same result as stepping continuously. */
+  m_dynamicsWorld->getDispatchInfo().m_deterministicOverlappingPairs = true;
   m_dynamicsWorld->setInternalTickCallback(&CcdPhysicsEnvironment::StaticSimulationSubtickCallback,
                                            this);
+  m_dynamicsWorld->setInternalTickCallback(
+      &CcdPhysicsEnvironment::StaticSimulationPretickCallback, this, true);
+  // Vehicles are not added as separate actions, they are all updated by this action.
+  m_vehicleAction = new CcdVehicleAction(this);
+  m_dynamicsWorld->addAction(m_vehicleAction);
   // m_dynamicsWorld->getSolverInfo().m_linearSlop = 0.01f;
   // m_dynamicsWorld->getSolverInfo().m_solverMode=	SOLVER_USE_WARMSTARTING +
   // SOLVER_USE_2_FRICTION_DIRECTIONS +	SOLVER_RANDMIZE_ORDER +	SOLVER_USE_FRICTION_WARMSTARTING;
 
   m_debugDrawer = nullptr;
   SetGravity(0.0f, 0.0f, -9.81f);
+
+  m_sensorQueryManifold = new btPersistentManifold();
 }
 
 void CcdPhysicsEnvironment::AddCcdPhysicsController(CcdPhysicsController *ctrl)
 {
+  // near and radar sensors resolved with queries are not added to the dynamics world
+  if (m_useSensorQueries && ctrl->GetConstructionInfo().m_bNearSensor) {
+    if (std::find(m_sensorQueries.begin(), m_sensorQueries.end(), ctrl) ==
+        m_sensorQueries.end()) {
+      // this m_userPointer is used by the broadphase filter, see QuerySensor
+      ctrl->GetCollisionObject()->setUserPointer(ctrl);
+      m_sensorQueries.push_back(ctrl);
+    }
+    return;
+  }
+
   // the controller is already added we do nothing
   if (!m_controllers.insert(ctrl).second) {
     return;
@@ -446,8 +641,7 @@ void CcdPhysicsEnvironment::AddCcdPhysicsController(CcdPhysicsController *ctrl)
     // Handle potential vehicle constraints
     for (WrapperVehicle *wrapperVehicle : m_wrapperVehicles) {
       if (wrapperVehicle->GetChassis() == ctrl) {
-        btRaycastVehicle *vehicle = wrapperVehicle->GetVehicle();
-        m_dynamicsWorld->addVehicle(vehicle);
+        wrapperVehicle->SetActive(true);
       }
     }
   }
@@ -506,7 +700,7 @@ void CcdPhysicsEnvironment::RemoveConstraint(btTypedConstraint *con, bool free)
 
 void CcdPhysicsEnvironment::RemoveVehicle(WrapperVehicle *vehicle, bool free)
 {
-  m_dynamicsWorld->removeVehicle(vehicle->GetVehicle());
+  vehicle->SetActive(false);
   if (free) {
     CM_ListRemoveIfFound(m_wrapperVehicles, vehicle);
     delete vehicle;
@@ -519,7 +713,7 @@ void CcdPhysicsEnvironment::RemoveVehicle(CcdPhysicsController *ctrl, bool free)
        it != m_wrapperVehicles.end();) {
     WrapperVehicle *vehicle = *it;
     if (vehicle->GetChassis() == ctrl) {
-      m_dynamicsWorld->removeVehicle(vehicle->GetVehicle());
+      vehicle->SetActive(false);
       if (free) {
         it = m_wrapperVehicles.erase(it);
         delete vehicle;
@@ -560,6 +754,14 @@ void CcdPhysicsEnvironment::RestoreConstraint(CcdPhysicsController *ctrl, btType
 bool CcdPhysicsEnvironment::RemoveCcdPhysicsController(CcdPhysicsController *ctrl,
                                                        bool freeConstraints)
 {
+  // sensors resolved with queries are not in the dynamics world
+  std::vector<CcdPhysicsController *>::iterator sensorIt = std::find(
+      m_sensorQueries.begin(), m_sensorQueries.end(), ctrl);
+  if (sensorIt != m_sensorQueries.end()) {
+    m_sensorQueries.erase(sensorIt);
+    return true;
+  }
+
   // if the physics controller is already removed we do nothing
   if (!m_controllers.erase(ctrl)) {
     return false;
@@ -658,7 +860,13 @@ bool CcdPhysicsEnvironment::IsActiveCcdPhysicsController(CcdPhysicsController *c
 
 void CcdPhysicsEnvironment::AddCcdGraphicController(CcdGraphicController *ctrl)
 {
-  if (m_cullingTree && !ctrl->GetBroadphaseHandle()) {
+  // The culling tree is created with the first object to cull.
+  if (!m_cullingTree) {
+    m_cullingCache = new btNullPairCache();
+    m_cullingTree = new btDbvtBroadphase(m_cullingCache);
+  }
+
+  if (!ctrl->GetBroadphaseHandle()) {
     btVector3 minAabb;
     btVector3 maxAabb;
     ctrl->GetAabb(minAabb, maxAabb);
@@ -721,6 +929,30 @@ void CcdPhysicsEnvironment::SimulationSubtickCallback(btScalar timeStep)
   }
 }
 
+void CcdPhysicsEnvironment::StaticSimulationPretickCallback(btDynamicsWorld *world,
+                                                            btScalar timeStep)
+{
+  CcdPhysicsEnvironment *this_ = static_cast<CcdPhysicsEnvironment *>(world->getWorldUserInfo());
+  this_->SimulationPretickCallback(timeStep);
+}
+
+void CcdPhysicsEnvironment::SimulationPretickCallback(btScalar timeStep)
+{
+  /* The sensors in the dynamics world report the contacts found by the collision detection of
+   * the last sub step, before the objects are moved: query the sensors at the same point. */
+  m_sensorQueryHits.clear();
+  if (m_sensorQueries.empty()) {
+    return;
+  }
+
+  // The broadphase is updated by the collision detection, which didn't run yet for this tick.
+  m_dynamicsWorld->updateAabbs();
+
+  for (CcdPhysicsController *sensorCtrl : m_sensorQueries) {
+    QuerySensor(sensorCtrl);
+  }
+}
+
 bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, float interval)
 {
   std::set<CcdPhysicsController *>::iterator it;
@@ -746,9 +978,16 @@ bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, flo
     (*it)->SynchronizeMotionStates(timeStep);
   }
 
-  for (i = 0; i < m_wrapperVehicles.size(); i++) {
-    WrapperVehicle *veh = m_wrapperVehicles[i];
-    veh->SyncWheels();
+  // Compute the wheel transforms in parallel, the motion states are set in order.
+  blender::threading::parallel_for(
+      blender::IndexRange(m_wrapperVehicles.size()), 16, [&](const blender::IndexRange range) {
+        for (const int64_t index : range) {
+          m_wrapperVehicles[index]->UpdateWheelTransforms();
+        }
+      });
+
+  for (WrapperVehicle *vehicle : m_wrapperVehicles) {
+    vehicle->SyncWheels();
   }
 
   CallbackTriggers();
@@ -756,6 +995,42 @@ bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, flo
   return true;
 }
 
+void CcdPhysicsEnvironment::UpdateVehicles(float timeStep)
+{
+  m_activeVehicles.clear();
+  for (WrapperVehicle *vehicle : m_wrapperVehicles) {
+    if (vehicle->GetActive()) {
+      m_activeVehicles.push_back(vehicle);
+    }
+  }
+
+  /* Cast the wheel rays of all the vehicles in parallel, the broadphase and the objects
+   * transforms are not modified until all the vehicles are updated. */
+  blender::threading::parallel_for(
+      blender::IndexRange(m_activeVehicles.size()), 8, [&](const blender::IndexRange range) {
+        for (const int64_t index : range) {
+          WrapperVehicle *vehicle = m_activeVehicles[index];
+          vehicle->GetRaycaster()->CastWheelRays(vehicle->GetVehicle());
+        }
+      });
+
+  /* Apply the suspension and friction impulses in the order the vehicles were created, as the
+   * vehicles used to be updated by Bullet. */
+  for (WrapperVehicle *vehicle : m_activeVehicles) {
+    vehicle->GetVehicle()->updateVehicle(timeStep);
+    vehicle->GetRaycaster()->ClearWheelRays();
+  }
+}
+
+void CcdPhysicsEnvironment::DebugDrawVehicles(btIDebugDraw *debugDrawer)
+{
+  for (WrapperVehicle *vehicle : m_wrapperVehicles) {
+    if (vehicle->GetActive()) {
+      vehicle->GetVehicle()->debugDraw(debugDrawer);
+    }
+  }
+}
+
 void CcdPhysicsEnvironment::UpdateSoftBodies()
 {
   std::set<CcdPhysicsController *>::iterator it;
@@ -1944,6 +2219,482 @@ bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback,
   return true;
 }
 
+PHY_IGraphicController *CcdPhysicsEnvironment::CreateGraphicController(
+    PHY_IMotionState *motionState, const MT_Vector3 &aabbMin, const MT_Vector3 &aabbMax)
+{
+  CcdGraphicController *ctrl = new CcdGraphicController(this, motionState);
+  ctrl->SetLocalAabb(aabbMin, aabbMax);
+  return ctrl;
+}
+
+/// Header of a physics snapshot.
+struct CcdSnapshotHeader {
+  unsigned int m_magic;
+  unsigned int m_numBodies;
+  unsigned int m_numConstraints;
+  unsigned int m_numPairs;
+  unsigned int m_numManifolds;
+  /// Total number of contact points of the manifolds.
+  unsigned int m_numContacts;
+  /// Seed of the solver used when randomizing the constraints order.
+  unsigned int m_solverSeed;
+  /// Time accumulated by the world and not yet simulated by a fixed sub step.
+  btScalar m_localTime;
+};
+
+/// Dynamic state of a rigid body in a physics snapshot.
+struct CcdBodySnapshot {
+  /// Address of the rigid body used to check the snapshot matches the world.
+  uint64_t m_id;
+  /// Basis rows and origin.
+  btScalar m_transform[12];
+  btScalar m_interpolationTransform[12];
+  /// Linear, angular, interpolation linear and interpolation angular velocities.
+  btScalar m_velocities[12];
+  /// Total force and torque applied before the next step.
+  btScalar m_forces[6];
+  btScalar m_deactivationTime;
+  btScalar m_hitFraction;
+  int m_activationState;
+};
+
+/// State of a constraint in a physics snapshot.
+struct CcdConstraintSnapshot {
+  uint64_t m_id;
+  btScalar m_appliedImpulse;
+  int m_enabled;
+};
+
+/// Overlapping pair of the broadphase in a physics snapshot.
+struct CcdPairSnapshot {
+  uint64_t m_object0;
+  uint64_t m_object1;
+};
+
+/// Contact manifold of two bodies in a physics snapshot, followed by its contact points.
+struct CcdManifoldSnapshot {
+  uint64_t m_body0;
+  uint64_t m_body1;
+  int m_numContacts;
+  int m_padding;
+};
+
+static const unsigned int CCD_SNAPSHOT_MAGIC = 0x50485953;  // "PHYS"
+
+/// Access to the time accumulated by the world which is not exposed by Bullet.
+class CcdSnapshotWorldAccess : public btSoftRigidDynamicsWorld {
+ public:
+  static btScalar &LocalTime(btDiscreteDynamicsWorld *world)
+  {
+    btScalar btDiscreteDynamicsWorld::*localTime = &CcdSnapshotWorldAccess::m_localTime;
+    return world->*localTime;
+  }
+};
+
+static void SaveSnapshotVector(const btVector3 &vec, btScalar *data)
+{
+  data[0] = vec.x();
+  data[1] = vec.y();
+  data[2] = vec.z();
+}
+
+static btVector3 LoadSnapshotVector(const btScalar *data)
+{
+  return btVector3(data[0], data[1], data[2]);
+}
+
+static void SaveSnapshotTransform(const btTransform &trans, btScalar *data)
+{
+  for (unsigned short i = 0; i < 3; ++i) {
+    SaveSnapshotVector(trans.getBasis()[i], data + i * 3);
+  }
+  SaveSnapshotVector(trans.getOrigin(), data + 9);
+}
+
+static btTransform LoadSnapshotTransform(const btScalar *data)
+{
+  const btMatrix3x3 basis(
+      data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7], data[8]);
+  return btTransform(basis, LoadSnapshotVector(data + 9));
+}
+
+/// Return true if the body state is part of the snapshots.
+static bool IsSnapshotBody(btRigidBody *body)
+{
+  return body && !body->isStaticOrKinematicObject();
+}
+
+/// Identifier of a collision object in the snapshots.
+static uint64_t SnapshotId(const void *object)
+{
+  return (uint64_t)(uintptr_t)object;
+}
+
+/// Identifiers of the objects of a pair ordered to be compared regardless of the pair order.
+static std::pair<uint64_t, uint64_t> SnapshotPairKey(uint64_t id0, uint64_t id1)
+{
+  return (id0 < id1) ? std::make_pair(id0, id1) : std::make_pair(id1, id0);
+}
+
+/// Broadphase proxies of the collision objects sorted by identifier.
+typedef std::vector<std::pair<uint64_t, btBroadphaseProxy *>> CcdSnapshotProxies;
+
+static btBroadphaseProxy *FindSnapshotProxy(const CcdSnapshotProxies &proxies, uint64_t id)
+{
+  CcdSnapshotProxies::const_iterator it = std::lower_bound(
+      proxies.begin(), proxies.end(), std::make_pair(id, (btBroadphaseProxy *)nullptr));
+  return (it != proxies.end() && it->first == id) ? it->second : nullptr;
+}
+
+/// Size of a snapshot with the counts of its header.
+static size_t SnapshotSize(const CcdSnapshotHeader &header)
+{
+  return sizeof(CcdSnapshotHeader) + header.m_numBodies * sizeof(CcdBodySnapshot) +
+         header.m_numConstraints * sizeof(CcdConstraintSnapshot) +
+         header.m_numPairs * sizeof(CcdPairSnapshot) +
+         header.m_numManifolds * sizeof(CcdManifoldSnapshot) +
+         header.m_numContacts * sizeof(btManifoldPoint);
+}
+
+bool CcdPhysicsEnvironment::SaveSnapshot(std::vector<unsigned char> &snapshot)
+{
+  const btCollisionObjectArray &objects = m_dynamicsWorld->getCollisionObjectArray();
+  const int numObjects = objects.size();
+  const int numConstraints = m_dynamicsWorld->getNumConstraints();
+  btDispatcher *dispatcher = m_dynamicsWorld->getDispatcher();
+  const int numManifolds = dispatcher->getNumManifolds();
+  const btBroadphasePairArray &pairs = m_dynamicsWorld->getPairCache()->getOverlappingPairArray();
+
+  CcdSnapshotHeader header;
+  header.m_magic = CCD_SNAPSHOT_MAGIC;
+  header.m_numBodies = 0;
+  header.m_numConstraints = numConstraints;
+  header.m_numPairs = pairs.size();
+  header.m_numManifolds = 0;
+  header.m_numContacts = 0;
+  // Both solver types are sequential impulse solvers.
+  header.m_solverSeed = static_cast<btSequentialImpulseConstraintSolver *>(m_solver)
+                            ->getRandSeed();
+  header.m_localTime = CcdSnapshotWorldAccess::LocalTime(m_dynamicsWorld);
+  for (int i = 0; i < numObjects; ++i) {
+    if (IsSnapshotBody(btRigidBody::upcast(objects[i]))) {
+      ++header.m_numBodies;
+    }
+  }
+  // Only the manifolds with contacts are saved, the others are cleared on restore.
+  for (int i = 0; i < numManifolds; ++i) {
+    const int numContacts = dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+    if (numContacts > 0) {
+      ++header.m_numManifolds;
+      header.m_numContacts += numContacts;
+    }
+  }
+
+  snapshot.resize(SnapshotSize(header));
+  unsigned char *data = snapshot.data();
+  memcpy(data, &header, sizeof(CcdSnapshotHeader));
+  data += sizeof(CcdSnapshotHeader);
+
+  for (int i = 0; i < numObjects; ++i) {
+    btRigidBody *body = btRigidBody::upcast(objects[i]);
+    if (!IsSnapshotBody(body)) {
+      continue;
+    }
+
+    CcdBodySnapshot state;
+    state.m_id = SnapshotId(body);
+    SaveSnapshotTransform(body->getWorldTransform(), state.m_transform);
+    SaveSnapshotTransform(body->getInterpolationWorldTransform(), state.m_interpolationTransform);
+    SaveSnapshotVector(body->getLinearVelocity(), state.m_velocities);
+    SaveSnapshotVector(body->getAngularVelocity(), state.m_velocities + 3);
+    SaveSnapshotVector(body->getInterpolationLinearVelocity(), state.m_velocities + 6);
+    SaveSnapshotVector(body->getInterpolationAngularVelocity(), state.m_velocities + 9);
+    SaveSnapshotVector(body->getTotalForce(), state.m_forces);
+    SaveSnapshotVector(body->getTotalTorque(), state.m_forces + 3);
+    state.m_deactivationTime = body->getDeactivationTime();
+    state.m_hitFraction = body->getHitFraction();
+    state.m_activationState = body->getActivationState();
+
+    memcpy(data, &state, sizeof(CcdBodySnapshot));
+    data += sizeof(CcdBodySnapshot);
+  }
+
+  for (int i = 0; i < numConstraints; ++i) {
+    btTypedConstraint *con = m_dynamicsWorld->getConstraint(i);
+
+    CcdConstraintSnapshot state;
+    state.m_id = SnapshotId(con);
+    state.m_appliedImpulse = con->internalGetAppliedImpulse();
+    state.m_enabled = con->isEnabled();
+
+    memcpy(data, &state, sizeof(CcdConstraintSnapshot));
+    data += sizeof(CcdConstraintSnapshot);
+  }
+
+  // The islands are built from the broadphase pairs, including the pairs without contact.
+  for (int i = 0; i < pairs.size(); ++i) {
+    CcdPairSnapshot state;
+    state.m_object0 = SnapshotId(pairs[i].m_pProxy0->m_clientObject);
+    state.m_object1 = SnapshotId(pairs[i].m_pProxy1->m_clientObject);
+
+    memcpy(data, &state, sizeof(CcdPairSnapshot));
+    data += sizeof(CcdPairSnapshot);
+  }
+
+  // The contact points and their impulses are used to warm start the solver of the next step.
+  for (int i = 0; i < numManifolds; ++i) {
+    const btPersistentManifold *manifold = dispatcher->getManifoldByIndexInternal(i);
+    if (manifold->getNumContacts() == 0) {
+      continue;
+    }
+
+    CcdManifoldSnapshot state;
+    state.m_body0 = SnapshotId(manifold->getBody0());
+    state.m_body1 = SnapshotId(manifold->getBody1());
+    state.m_numContacts = manifold->getNumContacts();
+    state.m_padding = 0;
+
+    memcpy(data, &state, sizeof(CcdManifoldSnapshot));
+    data += sizeof(CcdManifoldSnapshot);
+
+    for (int j = 0; j < state.m_numContacts; ++j) {
+      btManifoldPoint point = manifold->getContactPoint(j);
+      // Data of the contact callbacks are not part of the snapshot.
+      point.m_userPersistentData = nullptr;
+      memcpy(data, &point, sizeof(btManifoldPoint));
+      data += sizeof(btManifoldPoint);
+    }
+  }
+
+  return true;
+}
+
+bool CcdPhysicsEnvironment::RestoreSnapshot(const unsigned char *snapshot, size_t size)
+{
+  if (size < sizeof(CcdSnapshotHeader)) {
+    return false;
+  }
+
+  const unsigned char *data = snapshot;
+  CcdSnapshotHeader header;
+  memcpy(&header, data, sizeof(CcdSnapshotHeader));
+  data += sizeof(CcdSnapshotHeader);
+
+  if (header.m_magic != CCD_SNAPSHOT_MAGIC ||
+      header.m_numConstraints != (unsigned int)m_dynamicsWorld->getNumConstraints() ||
+      size != SnapshotSize(header))
+  {
+    return false;
+  }
+
+  const btCollisionObjectArray &objects = m_dynamicsWorld->getCollisionObjectArray();
+  const int numObjects = objects.size();
+
+  // Check that the snapshot was made with the same bodies before modifying any of them.
+  const unsigned char *bodyData = data;
+  unsigned int numBodies = 0;
+  for (int i = 0; i < numObjects; ++i) {
+    btRigidBody *body = btRigidBody::upcast(objects[i]);
+    if (!IsSnapshotBody(body)) {
+      continue;
+    }
+    if (numBodies == header.m_numBodies) {
+      return false;
+    }
+
+    uint64_t id;
+    memcpy(&id, bodyData + numBodies * sizeof(CcdBodySnapshot), sizeof(uint64_t));
+    if (id != SnapshotId(body)) {
+      return false;
+    }
+    ++numBodies;
+  }
+
+  if (numBodies != header.m_numBodies) {
+    return false;
+  }
+
+  const unsigned char *constraintData = bodyData + numBodies * sizeof(CcdBodySnapshot);
+  for (unsigned int i = 0; i < header.m_numConstraints; ++i) {
+    uint64_t id;
+    memcpy(&id, constraintData + i * sizeof(CcdConstraintSnapshot), sizeof(uint64_t));
+    if (id != SnapshotId(m_dynamicsWorld->getConstraint(i))) {
+      return false;
+    }
+  }
+
+  // Check that the pairs and the manifolds use objects of the world.
+  CcdSnapshotProxies proxies;
+  proxies.reserve(numObjects);
+  for (int i = 0; i < numObjects; ++i) {
+    if (objects[i]->getBroadphaseHandle()) {
+      proxies.emplace_back(SnapshotId(objects[i]), objects[i]->getBroadphaseHandle());
+    }
+  }
+  std::sort(proxies.begin(), proxies.end());
+
+  const unsigned char *pairData = constraintData +
+                                  header.m_numConstraints * sizeof(CcdConstraintSnapshot);
+  std::vector<std::pair<uint64_t, uint64_t>> pairKeys(header.m_numPairs);
+  for (unsigned int i = 0; i < header.m_numPairs; ++i) {
+    CcdPairSnapshot state;
+    memcpy(&state, pairData + i * sizeof(CcdPairSnapshot), sizeof(CcdPairSnapshot));
+    if (!FindSnapshotProxy(proxies, state.m_object0) ||
+        !FindSnapshotProxy(proxies, state.m_object1))
+    {
+      return false;
+    }
+    pairKeys[i] = SnapshotPairKey(state.m_object0, state.m_object1);
+  }
+  std::sort(pairKeys.begin(), pairKeys.end());
+
+  const unsigned char *manifoldData = pairData + header.m_numPairs * sizeof(CcdPairSnapshot);
+  size_t offset = 0;
+  for (unsigned int i = 0; i < header.m_numManifolds; ++i) {
+    CcdManifoldSnapshot state;
+    memcpy(&state, manifoldData + offset, sizeof(CcdManifoldSnapshot));
+    offset += sizeof(CcdManifoldSnapshot) + state.m_numContacts * sizeof(btManifoldPoint);
+    if (state.m_numContacts < 0 || offset > size - (manifoldData - snapshot) ||
+        !FindSnapshotProxy(proxies, state.m_body0) || !FindSnapshotProxy(proxies, state.m_body1))
+    {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < numObjects; ++i) {
+    btRigidBody *body = btRigidBody::upcast(objects[i]);
+    if (!IsSnapshotBody(body)) {
+      continue;
+    }
+
+    CcdBodySnapshot state;
+    memcpy(&state, bodyData, sizeof(CcdBodySnapshot));
+    bodyData += sizeof(CcdBodySnapshot);
+
+    body->setWorldTransform(LoadSnapshotTransform(state.m_transform));
+    body->setInterpolationWorldTransform(LoadSnapshotTransform(state.m_interpolationTransform));
+    body->setLinearVelocity(LoadSnapshotVector(state.m_velocities));
+    body->setAngularVelocity(LoadSnapshotVector(state.m_velocities + 3));
+    body->setInterpolationLinearVelocity(LoadSnapshotVector(state.m_velocities + 6));
+    body->setInterpolationAngularVelocity(LoadSnapshotVector(state.m_velocities + 9));
+    body->clearForces();
+    body->applyCentralForce(LoadSnapshotVector(state.m_forces));
+    body->applyTorque(LoadSnapshotVector(state.m_forces + 3));
+    body->forceActivationState(state.m_activationState);
+    body->setDeactivationTime(state.m_deactivationTime);
+    body->setHitFraction(state.m_hitFraction);
+    body->updateInertiaTensor();
+    m_dynamicsWorld->updateSingleAabb(body);
+
+    // Update the game object.
+    CcdPhysicsController *ctrl = static_cast<CcdPhysicsController *>(body->getUserPointer());
+    if (ctrl) {
+      ctrl->SynchronizeMotionStates(0.0f);
+    }
+  }
+
+  for (unsigned int i = 0; i < header.m_numConstraints; ++i) {
+    CcdConstraintSnapshot state;
+    memcpy(&state, constraintData, sizeof(CcdConstraintSnapshot));
+    constraintData += sizeof(CcdConstraintSnapshot);
+
+    btTypedConstraint *con = m_dynamicsWorld->getConstraint(i);
+    con->internalSetAppliedImpulse(state.m_appliedImpulse);
+    con->setEnabled(state.m_enabled);
+  }
+
+  /* Restore the broadphase pairs of the snapshot, the islands are built from them. The pairs
+   * not in the snapshot are removed with their collision algorithm and manifolds. */
+  btOverlappingPairCache *pairCache = m_dynamicsWorld->getPairCache();
+  btCollisionDispatcher *dispatcher = static_cast<btCollisionDispatcher *>(
+      m_dynamicsWorld->getDispatcher());
+  btBroadphasePairArray &pairs = pairCache->getOverlappingPairArray();
+  // Removing a pair moves the last pair to its index, iterate from the end.
+  for (int i = pairs.size() - 1; i >= 0; --i) {
+    btBroadphaseProxy *proxy0 = pairs[i].m_pProxy0;
+    btBroadphaseProxy *proxy1 = pairs[i].m_pProxy1;
+    if (!std::binary_search(pairKeys.begin(),
+                            pairKeys.end(),
+                            SnapshotPairKey(SnapshotId(proxy0->m_clientObject),
+                                            SnapshotId(proxy1->m_clientObject))))
+    {
+      pairCache->removeOverlappingPair(proxy0, proxy1, dispatcher);
+    }
+  }
+  for (unsigned int i = 0; i < header.m_numPairs; ++i) {
+    CcdPairSnapshot state;
+    memcpy(&state, pairData, sizeof(CcdPairSnapshot));
+    pairData += sizeof(CcdPairSnapshot);
+
+    btBroadphaseProxy *proxy0 = FindSnapshotProxy(proxies, state.m_object0);
+    btBroadphaseProxy *proxy1 = FindSnapshotProxy(proxies, state.m_object1);
+    if (!pairCache->findPair(proxy0, proxy1)) {
+      pairCache->addOverlappingPair(proxy0, proxy1);
+    }
+  }
+
+  /* Replace the contacts by the ones of the snapshot: their impulses warm start the next step
+   * as if the simulation never left the snapshot state. The manifolds are found through the
+   * collision algorithm of their pair, manifolds of the same bodies are matched in order,
+   * they only come from compound shapes. */
+  for (int i = 0, numManifolds = dispatcher->getNumManifolds(); i < numManifolds; ++i) {
+    dispatcher->getManifoldByIndexInternal(i)->clearManifold();
+  }
+
+  btManifoldArray pairManifolds;
+  for (unsigned int i = 0; i < header.m_numManifolds; ++i) {
+    CcdManifoldSnapshot state;
+    memcpy(&state, manifoldData, sizeof(CcdManifoldSnapshot));
+    manifoldData += sizeof(CcdManifoldSnapshot);
+
+    btBroadphasePair *pair = pairCache->findPair(FindSnapshotProxy(proxies, state.m_body0),
+                                                 FindSnapshotProxy(proxies, state.m_body1));
+    btPersistentManifold *manifold = nullptr;
+    if (pair) {
+      pairManifolds.resize(0);
+      if (!pair->m_algorithm) {
+        // The pair was added by the restore, only its algorithm creates its manifolds.
+        dispatcher->getNearCallback()(*pair, *dispatcher, m_dynamicsWorld->getDispatchInfo());
+        if (pair->m_algorithm) {
+          pair->m_algorithm->getAllContactManifolds(pairManifolds);
+          for (int j = 0; j < pairManifolds.size(); ++j) {
+            pairManifolds[j]->clearManifold();
+          }
+        }
+      }
+      else {
+        pair->m_algorithm->getAllContactManifolds(pairManifolds);
+      }
+
+      for (int j = 0; j < pairManifolds.size(); ++j) {
+        btPersistentManifold *pairManifold = pairManifolds[j];
+        if (pairManifold->getNumContacts() == 0 &&
+            SnapshotId(pairManifold->getBody0()) == state.m_body0 &&
+            SnapshotId(pairManifold->getBody1()) == state.m_body1)
+        {
+          manifold = pairManifold;
+          break;
+        }
+      }
+    }
+
+    for (int j = 0; j < state.m_numContacts; ++j) {
+      btManifoldPoint point;
+      memcpy(&point, manifoldData, sizeof(btManifoldPoint));
+      manifoldData += sizeof(btManifoldPoint);
+      if (manifold) {
+        // The point was valid in the snapshot, skip the breaking distance check.
+        manifold->addManifoldPoint(point, true);
+      }
+    }
+  }
+
+  static_cast<btSequentialImpulseConstraintSolver *>(m_solver)->setRandSeed(header.m_solverSeed);
+  CcdSnapshotWorldAccess::LocalTime(m_dynamicsWorld) = header.m_localTime;
+
+  return true;
+}
+
 int CcdPhysicsEnvironment::GetNumContactPoints()
 {
   return 0;
@@ -1981,6 +2732,13 @@ void CcdPhysicsEnvironment::MergeEnvironment(PHY_IPhysicsEnvironment *other_env)
     other->RemoveCcdPhysicsController(ctrl, true);
     this->AddCcdPhysicsController(ctrl);
   }
+
+  while (!other->m_sensorQueries.empty()) {
+    CcdPhysicsController *ctrl = other->m_sensorQueries.front();
+
+    other->RemoveCcdPhysicsController(ctrl, true);
+    this->AddCcdPhysicsController(ctrl);
+  }
 }
 
 CcdPhysicsEnvironment::~CcdPhysicsEnvironment()
@@ -1993,6 +2751,7 @@ CcdPhysicsEnvironment::~CcdPhysicsEnvironment()
   // first delete scene, then dispatcher, because pairs have to release manifolds on the dispatcher
   // delete m_dispatcher;
   delete m_dynamicsWorld;
+  delete m_vehicleAction;
 
   if (nullptr != m_ownDispatcher)
     delete m_ownDispatcher;
@@ -2020,6 +2779,12 @@ CcdPhysicsEnvironment::~CcdPhysicsEnvironment()
 
   if (nullptr != m_cullingCache)
     delete m_cullingCache;
+
+  for (CcdCollData *collData : m_collDatas) {
+    delete collData;
+  }
+
+  delete m_sensorQueryManifold;
 }
 
 btTypedConstraint *CcdPhysicsEnvironment::GetConstraintById(int constraintId)
@@ -2045,6 +2810,37 @@ void CcdPhysicsEnvironment::AddSensor(PHY_IPhysicsController *ctrl)
   AddCcdPhysicsController(ctrl1);
 }
 
+void CcdPhysicsEnvironment::SetUseSensorQueries(bool useQueries)
+{
+  if (m_useSensorQueries == useQueries) {
+    return;
+  }
+
+  /* Move the registered near and radar sensors between the dynamics world and the queries,
+   * AddCcdPhysicsController chooses where they go. */
+  std::vector<CcdPhysicsController *> sensors;
+  if (useQueries) {
+    for (CcdPhysicsController *ctrl : m_controllers) {
+      if (ctrl->GetConstructionInfo().m_bNearSensor) {
+        sensors.push_back(ctrl);
+      }
+    }
+  }
+  else {
+    sensors = m_sensorQueries;
+  }
+
+  for (CcdPhysicsController *ctrl : sensors) {
+    RemoveCcdPhysicsController(ctrl, true);
+  }
+
+  m_useSensorQueries = useQueries;
+
+  for (CcdPhysicsController *ctrl : sensors) {
+    AddCcdPhysicsController(ctrl);
+  }
+}
+
 bool CcdPhysicsEnvironment::RemoveCollisionCallback(PHY_IPhysicsController *ctrl)
 {
   CcdPhysicsController *ccdCtrl = (CcdPhysicsController *)ctrl;
@@ -2072,11 +2868,13 @@ bool CcdPhysicsEnvironment::RequestCollisionCallback(PHY_IPhysicsController *ctr
 void CcdPhysicsEnvironment::CallbackTriggers()
 {
   if (!m_triggerCallbacks[PHY_OBJECT_RESPONSE]) {
+    m_sensorQueryHits.clear();
     return;
   }
 
   // Walk over all overlapping pairs, and if one of the involved bodies is registered for trigger
   // callback, perform callback
+  unsigned int numCollDatas = 0;
   btDispatcher *dispatcher = m_dynamicsWorld->getDispatcher();
   for (unsigned int i = 0, numManifolds = dispatcher->getNumManifolds(); i < numManifolds; i++) {
     btPersistentManifold *manifold = dispatcher->getManifoldByIndexInternal(i);
@@ -2112,9 +2910,129 @@ void CcdPhysicsEnvironment::CallbackTriggers()
       manifold->clearManifold();  // refreshContactPoints(rb0->getCenterOfMassTransform(),rb1->getCenterOfMassTransform());
     }
 
-    const CcdCollData *coll_data = new CcdCollData(manifold);
+    // The contact data of the previous step were consumed by the logic, reuse them.
+    if (numCollDatas == m_collDatas.size()) {
+      m_collDatas.push_back(new CcdCollData(manifold));
+    }
+    else {
+      *m_collDatas[numCollDatas] = CcdCollData(manifold);
+    }
+    const CcdCollData *coll_data = m_collDatas[numCollDatas++];
     m_triggerCallbacks[PHY_OBJECT_RESPONSE](m_triggerCallbacksUserPtrs[PHY_OBJECT_RESPONSE], ctrl0, ctrl1, coll_data, first);
   }
+
+  // Report the sensors resolved with queries, their contacts are cleared as the ones above.
+  for (const std::pair<CcdPhysicsController *, CcdPhysicsController *> &hit : m_sensorQueryHits) {
+    if (numCollDatas == m_collDatas.size()) {
+      m_collDatas.push_back(new CcdCollData(m_sensorQueryManifold));
+    }
+    else {
+      *m_collDatas[numCollDatas] = CcdCollData(m_sensorQueryManifold);
+    }
+    const CcdCollData *coll_data = m_collDatas[numCollDatas++];
+    m_triggerCallbacks[PHY_OBJECT_RESPONSE](
+        m_triggerCallbacksUserPtrs[PHY_OBJECT_RESPONSE], hit.first, hit.second, coll_data, true);
+  }
+  m_sensorQueryHits.clear();
+}
+
+/// Collect the objects of the broadphase accepted by the overlap filter for a sensor.
+class CcdSensorQueryCallback : public btBroadphaseAabbCallback {
+  btBroadphaseProxy *m_sensorProxy;
+  btOverlapFilterCallback *m_filterCallback;
+  std::vector<btCollisionObject *> &m_objects;
+
+ public:
+  CcdSensorQueryCallback(btBroadphaseProxy *sensorProxy,
+                         btOverlapFilterCallback *filterCallback,
+                         std::vector<btCollisionObject *> &objects)
+      : m_sensorProxy(sensorProxy), m_filterCallback(filterCallback), m_objects(objects)
+  {
+  }
+
+  virtual bool process(const btBroadphaseProxy *proxy)
+  {
+    btBroadphaseProxy *objProxy = const_cast<btBroadphaseProxy *>(proxy);
+    if (m_filterCallback->needBroadphaseCollision(m_sensorProxy, objProxy)) {
+      m_objects.push_back(static_cast<btCollisionObject *>(objProxy->m_clientObject));
+    }
+    return true;
+  }
+};
+
+void CcdPhysicsEnvironment::QuerySensor(CcdPhysicsController *sensorCtrl)
+{
+  btCollisionObject *sensorObj = sensorCtrl->GetCollisionObject();
+  const btTransform &sensorTrans = sensorObj->getWorldTransform();
+
+  // Same AABB as the sensor would have in the broadphase, see btCollisionWorld::updateSingleAabb.
+  btVector3 aabbMin, aabbMax;
+  sensorObj->getCollisionShape()->getAabb(sensorTrans, aabbMin, aabbMax);
+  const btVector3 threshold(
+      gContactBreakingThreshold, gContactBreakingThreshold, gContactBreakingThreshold);
+  aabbMin -= threshold;
+  aabbMax += threshold;
+
+  // The pairs are filtered as the pairs of the sensor in the broadphase.
+  btBroadphaseProxy sensorProxy(aabbMin,
+                                aabbMax,
+                                sensorObj,
+                                sensorCtrl->GetCollisionFilterGroup(),
+                                sensorCtrl->GetCollisionFilterMask());
+  m_sensorQueryObjects.clear();
+  CcdSensorQueryCallback callback(&sensorProxy, m_filterCallback, m_sensorQueryObjects);
+  m_broadphase->aabbTest(aabbMin, aabbMax, callback);
+
+  /* The broadphase order depends on the history of its tree, report the objects in their
+   * creation order instead. */
+  std::sort(m_sensorQueryObjects.begin(),
+            m_sensorQueryObjects.end(),
+            [](const btCollisionObject *obj1, const btCollisionObject *obj2) {
+              return obj1->getBroadphaseHandle()->m_uniqueId <
+                     obj2->getBroadphaseHandle()->m_uniqueId;
+            });
+
+  btDispatcher *dispatcher = m_dynamicsWorld->getDispatcher();
+  const btDispatcherInfo &dispatchInfo = m_dynamicsWorld->getDispatchInfo();
+  const btCollisionObjectWrapper sensorWrap(
+      nullptr, sensorObj->getCollisionShape(), sensorObj, sensorTrans, -1, -1);
+  btManifoldArray manifolds;
+
+  for (btCollisionObject *obj : m_sensorQueryObjects) {
+    // Same narrow phase as btCollisionDispatcher::defaultNearCallback.
+    if (!dispatcher->needsCollision(sensorObj, obj)) {
+      continue;
+    }
+
+    const btCollisionObjectWrapper objWrap(
+        nullptr, obj->getCollisionShape(), obj, obj->getWorldTransform(), -1, -1);
+    btCollisionAlgorithm *algorithm = dispatcher->findAlgorithm(
+        &sensorWrap, &objWrap, nullptr, BT_CONTACT_POINT_ALGORITHMS);
+    if (!algorithm) {
+      continue;
+    }
+
+    btManifoldResult result(&sensorWrap, &objWrap);
+    algorithm->processCollision(&sensorWrap, &objWrap, dispatchInfo, &result);
+
+    bool touching = false;
+    manifolds.resize(0);
+    algorithm->getAllContactManifolds(manifolds);
+    for (int i = 0, size = manifolds.size(); i < size; ++i) {
+      if (manifolds[i]->getNumContacts() > 0) {
+        touching = true;
+        break;
+      }
+    }
+
+    algorithm->~btCollisionAlgorithm();
+    dispatcher->freeCollisionAlgorithm(algorithm);
+
+    if (touching) {
+      m_sensorQueryHits.emplace_back(sensorCtrl,
+                                     static_cast<CcdPhysicsController *>(obj->getUserPointer()));
+    }
+  }
 }
 
 PHY_CollisionTestResult CcdPhysicsEnvironment::CheckCollision(PHY_IPhysicsController *ctrl0, PHY_IPhysicsController *ctrl1)
@@ -2247,6 +3165,7 @@ PHY_IPhysicsController *CcdPhysicsEnvironment::CreateSphereController(float radi
   cinfo.m_collisionGroup = 0xFFFF;
   cinfo.m_collisionMask = 0xFFFF;
   cinfo.m_bSensor = true;
+  cinfo.m_bNearSensor = true;
   motionState->m_worldTransform.setIdentity();
   motionState->m_worldTransform.setOrigin(ToBullet(position));
 
@@ -2614,10 +3533,9 @@ PHY_IVehicle *CcdPhysicsEnvironment::CreateVehicle(PHY_IPhysicsController *ctrl)
   btRaycastVehicle *vehicle = new btRaycastVehicle(
       tuning, ((CcdPhysicsController *)ctrl)->GetRigidBody(), raycaster);
   WrapperVehicle *wrapperVehicle = new WrapperVehicle(vehicle, raycaster, ctrl);
+  wrapperVehicle->SetActive(true);
   m_wrapperVehicles.push_back(wrapperVehicle);
 
-  m_dynamicsWorld->addVehicle(vehicle);
-
   vehicle->setUserConstraintId(gConstraintUid++);
   vehicle->setUserConstraintType(PHY_VEHICLE_CONSTRAINT);
 
@@ -2645,6 +3563,7 @@ PHY_IPhysicsController *CcdPhysicsEnvironment::CreateConeController(float conera
   cinfo.m_collisionGroup = 0xFFFF;
   cinfo.m_collisionMask = 0xFFFF;
   cinfo.m_bSensor = true;
+  cinfo.m_bNearSensor = true;
   motionState->m_worldTransform.setIdentity();
   //	motionState->m_worldTransform.setOrigin(btVector3(position[0],position[1],position[2]));
 
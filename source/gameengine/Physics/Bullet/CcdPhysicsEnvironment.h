@@ -31,6 +31,7 @@
 #include "LinearMath/btTransform.h"
 #include "LinearMath/btVector3.h"
 
+#include "CM_Memory.h"
 #include "CcdPhysicsController.h"
 #include "KX_Globals.h"
 #include "KX_KetsjiEngine.h"
@@ -39,11 +40,13 @@
 class btTypedConstraint;
 class btDispatcher;
 class WrapperVehicle;
+class CcdCollData;
 class btPersistentManifold;
 class btBroadphaseInterface;
 struct btDbvtBroadphase;
 class btOverlappingPairCache;
 class btIDebugDraw;
+class btActionInterface;
 class btDynamicsWorld;
 class PHY_IVehicle;
 class CcdGraphicController;
@@ -92,7 +95,22 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
   float m_angularDeactivationThreshold;
   float m_contactBreakingThreshold;
 
+  /// Resolve the sensors controllers with broadphase queries, see SetUseSensorQueries.
+  bool m_useSensorQueries;
+  /// Near and radar sensors controllers resolved with queries, in the order they were added.
+  std::vector<CcdPhysicsController *> m_sensorQueries;
+  /// Objects overlapping the sensor being queried, kept to not allocate for each query.
+  std::vector<btCollisionObject *> m_sensorQueryObjects;
+  /// Sensor and object controllers touching in the last sub step, reported by CallbackTriggers.
+  std::vector<std::pair<CcdPhysicsController *, CcdPhysicsController *>> m_sensorQueryHits;
+  /** Contact manifold passed to the sensor callbacks, sensors have no contact response and their
+   * manifolds are always cleared before the callbacks.
+   */
+  btPersistentManifold *m_sensorQueryManifold;
+
   void ProcessFhSprings(double curTime, float timeStep);
+  /// Find the objects touching a sensor controller not added to the dynamics world.
+  void QuerySensor(CcdPhysicsController *sensorCtrl);
 
  public:
   CcdPhysicsEnvironment(PHY_SolverType solverType, bool useDbvtCulling);
@@ -141,6 +159,11 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
    */
   static void StaticSimulationSubtickCallback(btDynamicsWorld *world, btScalar timeStep);
   void SimulationSubtickCallback(btScalar timeStep);
+  /** Called by Bullet before every (sub)tick, resolves the sensors queries with the transforms
+   * used by the collision detection of the tick.
+   */
+  static void StaticSimulationPretickCallback(btDynamicsWorld *world, btScalar timeStep);
+  void SimulationPretickCallback(btScalar timeStep);
 
   virtual void DebugDrawWorld();
   //		virtual bool		proceedDeltaTimeOneStep(float timeStep);
@@ -206,10 +229,14 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
                            int occlusionRes,
                            const int *viewport,
                            const MT_Matrix4x4 &matrix);
+  virtual PHY_IGraphicController *CreateGraphicController(PHY_IMotionState *motionState,
+                                                          const MT_Vector3 &aabbMin,
+                                                          const MT_Vector3 &aabbMax);
 
   // Methods for gamelogic collision/physics callbacks
   virtual void AddSensor(PHY_IPhysicsController *ctrl);
   virtual void RemoveSensor(PHY_IPhysicsController *ctrl);
+  virtual void SetUseSensorQueries(bool useQueries);
   virtual void AddCollisionCallback(int response_class, PHY_ResponseCallback callback, void *user);
   virtual bool RequestCollisionCallback(PHY_IPhysicsController *ctrl);
   virtual bool RemoveCollisionCallback(PHY_IPhysicsController *ctrl);
@@ -221,6 +248,9 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
 
   virtual int GetNumContactPoints();
 
+  virtual bool SaveSnapshot(std::vector<unsigned char> &snapshot);
+  virtual bool RestoreSnapshot(const unsigned char *snapshot, size_t size);
+
   virtual void GetContactPoint(int i,
                                float &hitX,
                                float &hitY,
@@ -272,6 +302,13 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
 
   void SyncMotionStates(float timeStep);
 
+  /** Update all the vehicles whose chassis is in the world, called by Bullet for each sub step.
+   * The wheel rays of all the vehicles are cast in parallel, then the suspension and friction
+   * impulses are applied serially in creation order.
+   */
+  void UpdateVehicles(float timeStep);
+  void DebugDrawVehicles(btIDebugDraw *debugDrawer);
+
   class btSoftRigidDynamicsWorld *GetDynamicsWorld()
   {
     return m_dynamicsWorld;
@@ -306,6 +343,15 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
   void *m_triggerCallbacksUserPtrs[PHY_NUM_RESPONSE];
 
   std::vector<WrapperVehicle *> m_wrapperVehicles;
+  /// Bullet action updating all the vehicles, see UpdateVehicles.
+  btActionInterface *m_vehicleAction;
+  /// Vehicles updated by the current step, kept to not allocate for each step.
+  std::vector<WrapperVehicle *> m_activeVehicles;
+
+  /** Contact data passed to the collision callbacks, reused at each step instead of
+   * allocating one per manifold. The data are valid until the next step.
+   */
+  std::vector<CcdCollData *> m_collDatas;
 
   /** use explicit btSoftRigidDynamicsWorld/btDiscreteDynamicsWorld* so that we have access to
    * btDiscreteDynamicsWorld::addRigidBody(body,filter,group)
@@ -325,6 +371,8 @@ class CcdPhysicsEnvironment : public PHY_IPhysicsEnvironment {
   class btDispatcher *m_ownDispatcher;
 
   virtual void ExportFile(const std::string &filename);
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_PHYSICS, "CcdPhysicsEnvironment")
 };
 
 class CcdCollData : public PHY_ICollData {
@@ -38,12 +38,14 @@
 #include "PHY_DynamicTypes.h"
 
 #include <array>
+#include <vector>
 
 class PHY_IConstraint;
 class PHY_IVehicle;
 class PHY_ICharacter;
 class RAS_MeshObject;
 class PHY_IPhysicsController;
+class PHY_IGraphicController;
 
 class RAS_MeshObject;
 class KX_GameObject;
@@ -251,10 +253,26 @@ class PHY_IPhysicsEnvironment {
                            int occlusionRes,
                            const int *viewport,
                            const MT_Matrix4x4 &matrix) = 0;
+  /** Create a graphic controller for the culling of an object, its bounds are given in the
+   * object space and its transform is read from the motion state.
+   * \return nullptr if the environment doesn't support culling.
+   */
+  virtual PHY_IGraphicController *CreateGraphicController(PHY_IMotionState *motionState,
+                                                          const MT_Vector3 &aabbMin,
+                                                          const MT_Vector3 &aabbMax)
+  {
+    return nullptr;
+  }
 
   // Methods for gamelogic collision/physics callbacks
   virtual void AddSensor(PHY_IPhysicsController *ctrl) = 0;
   virtual void RemoveSensor(PHY_IPhysicsController *ctrl) = 0;
+  /** Resolve the Near and Radar sensors with queries on the shared broadphase before each
+   * physics sub step instead of simulating their controller in the physics world.
+   */
+  virtual void SetUseSensorQueries(bool useQueries)
+  {
+  }
   virtual void AddCollisionCallback(int response_class,
                                     PHY_ResponseCallback callback,
                                     void *user) = 0;
@@ -269,6 +287,26 @@ class PHY_IPhysicsEnvironment {
 
   virtual void ExportFile(const std::string &filename){};
 
+  /** Save the dynamic state of all the rigid bodies and constraints (transforms, velocities,
+   * activation and applied impulses), the contacts and the solver state in a binary buffer.
+   * Stepping after a restore of the snapshot gives the same result as stepping continuously
+   * from the saved state.
+   * The snapshot is only valid for the same environment as long as no physics objects
+   * are added or removed.
+   * \return False if the environment doesn't support snapshots.
+   */
+  virtual bool SaveSnapshot(std::vector<unsigned char> &snapshot)
+  {
+    return false;
+  }
+  /** Restore a snapshot made by SaveSnapshot.
+   * \return False if the snapshot doesn't match the current objects of the environment.
+   */
+  virtual bool RestoreSnapshot(const unsigned char *snapshot, size_t size)
+  {
+    return false;
+  }
+
   virtual void MergeEnvironment(PHY_IPhysicsEnvironment *other_env) = 0;
 
   virtual void ConvertObject(BL_SceneConverter *converter,
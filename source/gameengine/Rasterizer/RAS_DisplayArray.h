@@ -136,5 +136,7 @@ template<class Vertex> class RAS_DisplayArray : public virtual RAS_IDisplayArray
     for (unsigned int i = 0; i < size; ++i) {
       m_vertexPtrs[i] = (RAS_IVertex *)&m_vertexes[i];
     }
+
+    UpdateMemoryAccounting(m_vertexes.capacity() * sizeof(Vertex));
   }
 };
@@ -33,6 +33,7 @@
 
 #include <vector>
 
+#include "CM_Memory.h"
 #include "CM_RefCount.h"
 #include "MT_Transform.h"
 #include "RAS_Rasterizer.h"
@@ -84,6 +85,8 @@ class RAS_DisplayArrayBucket {
 
   /// Replace the material bucket of this display array bucket by the one given.
   void ChangeMaterialBucket(RAS_MaterialBucket *bucket);
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_RASTERIZER, "RAS_DisplayArrayBucket")
 };
 
 typedef std::vector<RAS_DisplayArrayBucket *> RAS_DisplayArrayBucketList;
@@ -29,7 +29,7 @@
 #include <epoxy/gl.h>
 
 RAS_IDisplayArray::RAS_IDisplayArray(PrimitiveType type, const RAS_VertexFormat &format)
-    : m_type(type), m_modifiedFlag(NONE_MODIFIED), m_format(format)
+    : m_type(type), m_modifiedFlag(NONE_MODIFIED), m_format(format), m_accountedMemory(0)
 {
 }
 
@@ -38,12 +38,32 @@ RAS_IDisplayArray::RAS_IDisplayArray(const RAS_IDisplayArray &other)
       m_modifiedFlag(other.m_modifiedFlag),
       m_format(other.m_format),
       m_vertexInfos(other.m_vertexInfos),
-      m_indices(other.m_indices)
+      m_indices(other.m_indices),
+      m_accountedMemory(0)
 {
 }
 
 RAS_IDisplayArray::~RAS_IDisplayArray()
 {
+  if (m_accountedMemory > 0) {
+    CM_MemoryFree(CM_MEMORY_RASTERIZER, m_accountedMemory);
+  }
+}
+
+void RAS_IDisplayArray::UpdateMemoryAccounting(size_t vertexMemory)
+{
+  const size_t memory = vertexMemory + m_vertexInfos.capacity() * sizeof(RAS_VertexInfo) +
+                        m_vertexPtrs.capacity() * sizeof(RAS_IVertex *) +
+                        m_indices.capacity() * sizeof(unsigned int);
+  if (memory == m_accountedMemory) {
+    return;
+  }
+
+  if (m_accountedMemory > 0) {
+    CM_MemoryFree(CM_MEMORY_RASTERIZER, m_accountedMemory);
+  }
+  CM_MemoryAlloc(CM_MEMORY_RASTERIZER, memory);
+  m_accountedMemory = memory;
 }
 
 #define NEW_DISPLAY_ARRAY_UV(vertformat, uv, color, primtype) \
@@ -29,6 +29,7 @@
 #include <memory>
 #include <vector>
 
+#include "CM_Memory.h"
 #include "RAS_Vertex.h"
 
 class RAS_IDisplayArray {
@@ -54,9 +55,16 @@ class RAS_IDisplayArray {
   std::vector<RAS_IVertex *> m_vertexPtrs;
   /// The indices used for rendering.
   std::vector<unsigned int> m_indices;
+  /// Size of the vertex and index data accounted to the rasterizer memory.
+  size_t m_accountedMemory;
 
   RAS_IDisplayArray(const RAS_IDisplayArray &other);
 
+  /** Account the memory used by the vertex and index data.
+   * \param vertexMemory The memory allocated for the vertices in the derived class.
+   */
+  void UpdateMemoryAccounting(size_t vertexMemory);
+
  public:
   RAS_IDisplayArray(PrimitiveType type, const RAS_VertexFormat &format);
   virtual ~RAS_IDisplayArray();
@@ -181,6 +189,8 @@ class RAS_IDisplayArray {
 
   /// Return the type of the display array.
   virtual Type GetType() const;
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_RASTERIZER, "RAS_IDisplayArray")
 };
 
 typedef std::vector<RAS_IDisplayArray *> RAS_IDisplayArrayList;
@@ -31,6 +31,7 @@
 
 #pragma once
 
+#include "CM_Memory.h"
 #include "MT_Transform.h"
 #include "RAS_DisplayArrayBucket.h"
 
@@ -66,4 +67,6 @@ class RAS_MaterialBucket {
   RAS_IPolyMaterial *m_material;
   RAS_MaterialShader *m_shader;
   RAS_DisplayArrayBucketList m_displayArrayBucketList;
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_RASTERIZER, "RAS_MaterialBucket")
 };
@@ -40,6 +40,7 @@
 #include <string>
 #include <vector>
 
+#include "CM_Memory.h"
 #include "MT_Transform.h"
 #include "MT_Vector2.h"
 #include "RAS_MaterialBucket.h"
@@ -166,4 +167,6 @@ class RAS_MeshObject {
   };
 
   std::vector<std::vector<SharedVertex>> m_sharedvertex_map;
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_RASTERIZER, "RAS_MeshObject")
 };
@@ -40,6 +40,16 @@ struct PyFilter {
 /// base class for pixel filters
 class FilterBase {
  public:
+  /// support of row conversion
+  enum RowMode {
+    /// only pixel conversion is available
+    ROW_NONE,
+    /// filter converts source pixels with convertRow
+    ROW_SOURCE,
+    /// filter modifies pixels converted by previous filters with filterRow
+    ROW_FILTER
+  };
+
   /// constructor
   FilterBase(void);
   /// destructor
@@ -71,6 +81,21 @@ class FilterBase {
     return findFirst()->getPixelSize();
   }
 
+  /// get row conversion support, filters using neighbour pixels or pixel positions don't support it
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_NONE;
+  }
+  /// convert row of source pixels, used for ROW_SOURCE filters
+  virtual void convertRow(
+      unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+  {
+  }
+  /// filter row of converted pixels in place, used for ROW_FILTER filters
+  virtual void filterRow(unsigned int *row, short y, short *size)
+  {
+  }
+
  protected:
   /// previous pixel filter
   PyFilter *m_previous;
@@ -7,6 +7,10 @@
 
 #include "FilterBlueScreen.h"
 
+#include <algorithm>
+
+#include "BLI_simd.hh"
+
 // implementation FilterBlueScreen
 
 // constructor
@@ -38,6 +42,48 @@ void FilterBlueScreen::setLimits(unsigned short minLimit, unsigned short maxLimi
   m_limitDist = m_squareLimits[1] - m_squareLimits[0];
 }
 
+// filter row of converted pixels
+void FilterBlueScreen::filterRow(unsigned int *row, short y, short *size)
+{
+  short x = 0;
+#if BLI_HAVE_SSE2
+  // process 4 pixels at once, squared distances fit in signed 32 bits lanes
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  const __m128i alphaMask = _mm_set1_epi32(int(0xFF000000));
+  // red and green differences are computed as 16 bits pairs, blue with a zero pair
+  const __m128i redGreenColor = _mm_set1_epi32(int(m_color[0] | (m_color[1] << 16)));
+  const __m128i blueColor = _mm_set1_epi32(int(m_color[2]));
+  // limits above any possible distance are clamped to keep signed comparisons valid
+  const __m128i minLimit = _mm_set1_epi32(int(std::min(m_squareLimits[0], 0x7FFFFFFFu)));
+  const __m128i maxLimit = _mm_set1_epi32(int(std::min(m_squareLimits[1], 0x7FFFFFFFu)));
+  const __m128d limitDist = _mm_set1_pd(double(m_limitDist));
+  for (; x + 4 <= size[0]; x += 4) {
+    __m128i pix = _mm_loadu_si128((__m128i *)(row + x));
+    __m128i redGreen = _mm_sub_epi16(
+        _mm_or_si128(_mm_and_si128(pix, mask),
+                     _mm_and_si128(_mm_slli_epi32(pix, 8), _mm_set1_epi32(0xFF0000))),
+        redGreenColor);
+    __m128i blue = _mm_sub_epi16(_mm_and_si128(_mm_srli_epi32(pix, 16), mask), blueColor);
+    __m128i dist = _mm_add_epi32(_mm_madd_epi16(redGreen, redGreen), _mm_madd_epi16(blue, blue));
+    // alpha between limits, the division is exact in double precision
+    __m128i scaled = _mm_slli_epi32(_mm_sub_epi32(dist, minLimit), 8);
+    __m128d alphaLow = _mm_div_pd(_mm_cvtepi32_pd(scaled), limitDist);
+    __m128d alphaHigh = _mm_div_pd(
+        _mm_cvtepi32_pd(_mm_shuffle_epi32(scaled, _MM_SHUFFLE(1, 0, 3, 2))), limitDist);
+    __m128i alpha = _mm_unpacklo_epi64(_mm_cvttpd_epi32(alphaLow), _mm_cvttpd_epi32(alphaHigh));
+    // fully opaque color above the max limit, fully transparent color below the min limit
+    __m128i belowMax = _mm_cmpgt_epi32(maxLimit, dist);
+    alpha = _mm_or_si128(_mm_and_si128(belowMax, alpha), _mm_andnot_si128(belowMax, mask));
+    alpha = _mm_and_si128(_mm_cmpgt_epi32(dist, minLimit), alpha);
+    _mm_storeu_si128((__m128i *)(row + x),
+                     _mm_or_si128(_mm_andnot_si128(alphaMask, pix), _mm_slli_epi32(alpha, 24)));
+  }
+#endif
+  // remaining pixels
+  for (; x < size[0]; ++x)
+    row[x] = tFilter(row + x, x, y, size, 1, row[x]);
+}
+
 // cast Filter pointer to FilterBlueScreen
 inline FilterBlueScreen *getFilter(PyFilter *self)
 {
@@ -36,6 +36,14 @@ class FilterBlueScreen : public FilterBase {
   /// set limits for color variation
   void setLimits(unsigned short minLimit, unsigned short maxLimit);
 
+  /// row filtering is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_FILTER;
+  }
+  /// filter row of converted pixels
+  virtual void filterRow(unsigned int *row, short y, short *size);
+
  protected:
   ///  blue screen color (red component first)
   unsigned char m_color[3];
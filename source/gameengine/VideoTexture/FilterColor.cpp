@@ -7,8 +7,37 @@
 
 #include "FilterColor.h"
 
+#include "BLI_simd.hh"
+
 // implementation FilterGray
 
+// filter row of converted pixels
+void FilterGray::filterRow(unsigned int *row, short y, short *size)
+{
+  short x = 0;
+#if BLI_HAVE_SSE2
+  // process 4 pixels at once, products fit in the low 16 bits of each lane
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  const __m128i alphaMask = _mm_set1_epi32(int(0xFF000000));
+  for (; x + 4 <= size[0]; x += 4) {
+    __m128i pix = _mm_loadu_si128((__m128i *)(row + x));
+    __m128i red = _mm_and_si128(pix, mask);
+    __m128i green = _mm_and_si128(_mm_srli_epi32(pix, 8), mask);
+    __m128i blue = _mm_and_si128(_mm_srli_epi32(pix, 16), mask);
+    __m128i gray = _mm_add_epi32(
+        _mm_add_epi32(_mm_mullo_epi16(blue, _mm_set1_epi32(28)),
+                      _mm_mullo_epi16(green, _mm_set1_epi32(151))),
+        _mm_mullo_epi16(red, _mm_set1_epi32(77)));
+    gray = _mm_srli_epi32(gray, 8);
+    gray = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16)));
+    _mm_storeu_si128((__m128i *)(row + x), _mm_or_si128(gray, _mm_and_si128(pix, alphaMask)));
+  }
+#endif
+  // remaining pixels
+  for (; x < size[0]; ++x)
+    row[x] = tFilter(row + x, x, y, size, 1, row[x]);
+}
+
 // attributes structure
 static PyGetSetDef filterGrayGetSets[] = {  // attributes from FilterBase class
     {(char *)"previous",
@@ -70,6 +99,51 @@ FilterColor::FilterColor(void)
       m_matrix[r][c] = (r == c) ? 256 : 0;
 }
 
+#if BLI_HAVE_SSE2
+// calculate one color component of 4 pixels, channels are stored as pairs of 16 bits values
+static inline __m128i calcColorSSE(__m128i redGreen, __m128i blueAlpha, const short *coefs)
+{
+  // coefficients as pairs of 16 bits values matching the channel pairs
+  unsigned int coefRG = (unsigned short)coefs[0] | ((unsigned int)(unsigned short)coefs[1] << 16);
+  unsigned int coefBA = (unsigned short)coefs[2] | ((unsigned int)(unsigned short)coefs[3] << 16);
+  __m128i color = _mm_add_epi32(
+      _mm_add_epi32(_mm_madd_epi16(redGreen, _mm_set1_epi32(int(coefRG))),
+                    _mm_madd_epi16(blueAlpha, _mm_set1_epi32(int(coefBA)))),
+      _mm_set1_epi32(coefs[4]));
+  return _mm_and_si128(_mm_srai_epi32(color, 8), _mm_set1_epi32(0xFF));
+}
+#endif
+
+// filter row of converted pixels
+void FilterColor::filterRow(unsigned int *row, short y, short *size)
+{
+  short x = 0;
+#if BLI_HAVE_SSE2
+  // process 4 pixels at once
+  const __m128i lowMask = _mm_set1_epi32(0xFF);
+  const __m128i highMask = _mm_set1_epi32(0xFF0000);
+  for (; x + 4 <= size[0]; x += 4) {
+    __m128i pix = _mm_loadu_si128((__m128i *)(row + x));
+    // split channels to (red, green) and (blue, alpha) pairs for multiply-add
+    __m128i redGreen = _mm_or_si128(_mm_and_si128(pix, lowMask),
+                                    _mm_and_si128(_mm_slli_epi32(pix, 8), highMask));
+    __m128i blueAlpha = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pix, 16), lowMask),
+                                     _mm_and_si128(_mm_srli_epi32(pix, 8), highMask));
+    __m128i color = calcColorSSE(redGreen, blueAlpha, m_matrix[0]);
+    color = _mm_or_si128(color,
+                         _mm_slli_epi32(calcColorSSE(redGreen, blueAlpha, m_matrix[1]), 8));
+    color = _mm_or_si128(color,
+                         _mm_slli_epi32(calcColorSSE(redGreen, blueAlpha, m_matrix[2]), 16));
+    color = _mm_or_si128(color,
+                         _mm_slli_epi32(calcColorSSE(redGreen, blueAlpha, m_matrix[3]), 24));
+    _mm_storeu_si128((__m128i *)(row + x), color);
+  }
+#endif
+  // remaining pixels
+  for (; x < size[0]; ++x)
+    row[x] = tFilter(row + x, x, y, size, 1, row[x]);
+}
+
 // set color matrix
 void FilterColor::setMatrix(ColorMatrix &mat)
 {
@@ -213,6 +287,7 @@ FilterLevel::FilterLevel(void)
     levels[r][1] = 0xFF;
     levels[r][2] = 0xFF;
   }
+  calcTable();
 }
 
 // set color levels
@@ -224,6 +299,29 @@ void FilterLevel::setLevels(ColorLevel &lev)
       levels[r][c] = lev[r][c];
     levels[r][2] = lev[r][0] < lev[r][1] ? lev[r][1] - lev[r][0] : 1;
   }
+  calcTable();
+}
+
+// update precalculated color components
+void FilterLevel::calcTable(void)
+{
+  for (int c = 0; c < 256; ++c) {
+    // pixel with all components set to the same value
+    unsigned int val = c * 0x01010101;
+    for (short idx = 0; idx < 4; ++idx)
+      m_table[idx][c] = calcColor(val, idx);
+  }
+}
+
+// filter row of converted pixels
+void FilterLevel::filterRow(unsigned int *row, short y, short *size)
+{
+  for (short x = 0; x < size[0]; ++x)
+    VT_RGBA(row[x],
+            m_table[0][VT_R(row[x])],
+            m_table[1][VT_G(row[x])],
+            m_table[2][VT_B(row[x])],
+            m_table[3][VT_A(row[x])]);
 }
 
 // cast Filter pointer to FilterLevel
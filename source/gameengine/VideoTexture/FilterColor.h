@@ -22,6 +22,14 @@ class FilterGray : public FilterBase {
   {
   }
 
+  /// row filtering is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_FILTER;
+  }
+  /// filter row of converted pixels
+  virtual void filterRow(unsigned int *row, short y, short *size);
+
  protected:
   /// filter pixel template, source int buffer
   template<class SRC>
@@ -76,6 +84,14 @@ class FilterColor : public FilterBase {
   /// set color matrix
   void setMatrix(ColorMatrix &mat);
 
+  /// row filtering is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_FILTER;
+  }
+  /// filter row of converted pixels
+  virtual void filterRow(unsigned int *row, short y, short *size);
+
  protected:
   ///  color calculation matrix
   ColorMatrix m_matrix;
@@ -140,9 +156,22 @@ class FilterLevel : public FilterBase {
   /// set color matrix
   void setLevels(ColorLevel &lev);
 
+  /// row filtering is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_FILTER;
+  }
+  /// filter row of converted pixels
+  virtual void filterRow(unsigned int *row, short y, short *size);
+
  protected:
   ///  color calculation matrix
   ColorLevel levels;
+  /// precalculated color components for row filtering
+  unsigned char m_table[4][256];
+
+  /// update precalculated color components
+  void calcTable(void);
 
   /// calculate one color component
   unsigned int calcColor(unsigned int val, short idx)
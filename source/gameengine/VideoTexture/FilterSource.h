@@ -28,6 +28,19 @@ class FilterRGB24 : public FilterBase {
     return 3;
   }
 
+  /// row conversion is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_SOURCE;
+  }
+  /// convert row of source pixels
+  virtual void convertRow(
+      unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+  {
+    for (short x = 0; x < size[0]; ++x, ++dst, src += pixSize)
+      VT_RGBA(*dst, src[0], src[1], src[2], 0xFF);
+  }
+
  protected:
   /// filter pixel, source byte buffer
   virtual unsigned int filter(
@@ -56,6 +69,23 @@ class FilterRGBA32 : public FilterBase {
     return 4;
   }
 
+  /// row conversion is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_SOURCE;
+  }
+  /// convert row of source pixels
+  virtual void convertRow(
+      unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+  {
+    // same layout, copy whole row
+    if (pixSize == 4)
+      memcpy(dst, src, size[0] * sizeof(unsigned int));
+    else
+      for (short x = 0; x < size[0]; ++x, ++dst, src += pixSize)
+        VT_RGBA(*dst, src[0], src[1], src[2], src[3]);
+  }
+
  protected:
   /// filter pixel, source byte buffer
   virtual unsigned int filter(
@@ -88,6 +118,19 @@ class FilterBGRA32 : public FilterBase {
     return 4;
   }
 
+  /// row conversion is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_SOURCE;
+  }
+  /// convert row of source pixels
+  virtual void convertRow(
+      unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+  {
+    for (short x = 0; x < size[0]; ++x, ++dst, src += pixSize)
+      VT_RGBA(*dst, src[2], src[1], src[0], src[3]);
+  }
+
  protected:
   /// filter pixel, source byte buffer
   virtual unsigned int filter(
@@ -116,6 +159,19 @@ class FilterBGR24 : public FilterBase {
     return 3;
   }
 
+  /// row conversion is supported
+  virtual RowMode getRowMode(void)
+  {
+    return ROW_SOURCE;
+  }
+  /// convert row of source pixels
+  virtual void convertRow(
+      unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+  {
+    for (short x = 0; x < size[0]; ++x, ++dst, src += pixSize)
+      VT_RGBA(*dst, src[2], src[1], src[0], 0xFF);
+  }
+
  protected:
   /// filter pixel, source byte buffer
   virtual unsigned int filter(
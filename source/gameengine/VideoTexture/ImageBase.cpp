@@ -8,6 +8,8 @@
 #include "ImageBase.h"
 
 #include <epoxy/gl.h>
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 #include "MEM_guardedalloc.h"
 #include "bgl.h"
 
@@ -52,8 +54,10 @@ ImageBase::ImageBase(bool staticSrc)
 ImageBase::~ImageBase(void)
 {
   // release image
-  if (m_image)
+  if (m_image) {
     MEM_freeN(m_image);
+    CM_MemoryFree(CM_MEMORY_VIDEOTEXTURE, m_imgSize * sizeof(unsigned int));
+  }
 }
 
 // release python objects
@@ -192,6 +196,47 @@ void ImageBase::swapImageBR()
   }
 }
 
+// convert image by rows
+bool ImageBase::convImageRows(FilterBase &filter, unsigned char *srcBuff, short *srcSize)
+{
+  // collect filter chain, from last to first filter
+  blender::Vector<FilterBase *, 8> chain;
+  for (FilterBase *filt = &filter; filt != nullptr;
+       filt = filt->getPrevious() != nullptr ? filt->getPrevious()->m_filter : nullptr)
+  {
+    // filters without row support use per pixel conversion
+    if (filt->getRowMode() == FilterBase::ROW_NONE)
+      return false;
+    chain.append(filt);
+  }
+  // first filter has to read the source
+  if (chain.last()->getRowMode() != FilterBase::ROW_SOURCE)
+    return false;
+
+  const unsigned int pixSize = filter.firstPixelSize();
+  const short width = m_size[0];
+  const short height = m_size[1];
+  const bool flip = m_flip;
+  unsigned int *dstBuff = m_image;
+
+  blender::threading::parallel_for(
+      blender::IndexRange(height), 32, [&](const blender::IndexRange range) {
+        for (const int64_t row : range) {
+          // source row, as for pixel conversion y is the position in the source image
+          const short y = short(flip ? height - 1 - row : row);
+          unsigned char *src = srcBuff + size_t(y) * width * pixSize;
+          unsigned int *dst = dstBuff + size_t(row) * width;
+          for (int idx = int(chain.size()) - 1; idx >= 0; --idx) {
+            if (chain[idx]->getRowMode() == FilterBase::ROW_SOURCE)
+              chain[idx]->convertRow(src, dst, y, srcSize, pixSize);
+            else
+              chain[idx]->filterRow(dst, y, srcSize);
+          }
+        }
+      });
+  return true;
+}
+
 // initialize image data
 void ImageBase::init(short width, short height)
 {
@@ -210,12 +255,15 @@ void ImageBase::init(short width, short height)
     unsigned int newSize = width * height;
     // if new buffer is larger than previous
     if (newSize > m_imgSize) {
-      // set new buffer size
-      m_imgSize = newSize;
       // release previous and create new buffer
-      if (m_image)
+      if (m_image) {
         MEM_freeN(m_image);
+        CM_MemoryFree(CM_MEMORY_VIDEOTEXTURE, m_imgSize * sizeof(unsigned int));
+      }
+      // set new buffer size
+      m_imgSize = newSize;
       m_image = (unsigned int *)MEM_mallocN(m_imgSize * sizeof(unsigned int), "ImageBase init");
+      CM_MemoryAlloc(CM_MEMORY_VIDEOTEXTURE, m_imgSize * sizeof(unsigned int));
     }
     // new image size
     m_size[0] = width;
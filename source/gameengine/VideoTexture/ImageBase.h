@@ -9,6 +9,7 @@
 
 #include <vector>
 
+#include "CM_Memory.h"
 #include "Common.h"
 #include "EXP_PyObjectPlus.h"
 #include "FilterBase.h"
@@ -180,6 +181,15 @@ class ImageBase {
   /// perform loop detection
   bool loopDetect(ImageBase *img);
 
+  /// convert image by rows using the row functions of the filter chain, return false if
+  /// the chain doesn't support row conversion
+  bool convImageRows(FilterBase &filter, unsigned char *srcBuff, short *srcSize);
+  /// row conversion is available only for byte sources
+  template<class SRC> bool convImageRows(FilterBase &filter, SRC srcBuff, short *srcSize)
+  {
+    return false;
+  }
+
   /// template for image conversion
   template<class FLT, class SRC> void convImage(FLT &filter, SRC srcBuff, short *srcSize)
   {
@@ -188,7 +198,10 @@ class ImageBase {
     // pixel size from filter
     unsigned int pixSize = filter.firstPixelSize();
     // if no scaling is needed
-    if (srcSize[0] == m_size[0] && srcSize[1] == m_size[1])
+    if (srcSize[0] == m_size[0] && srcSize[1] == m_size[1]) {
+      // convert whole rows in parallel if the filter chain supports it
+      if (convImageRows(filter, srcBuff, srcSize))
+        return;
       // if flipping isn't required
       if (!m_flip)
         // copy bitmap
@@ -206,6 +219,7 @@ class ImageBase {
             // copy pixel
             *dstBuff = filter.convert(srcBuff, x, y, srcSize, pixSize);
       }
+    }
     // else scale picture (nearest neighbor)
     else {
       // interpolation accumulator
@@ -279,6 +293,8 @@ class ImageBase {
     // source was processed
     m_avail = true;
   }
+
+  CM_MEMORY_CLASS_ALLOC_FUNCS(CM_MEMORY_VIDEOTEXTURE, "ImageBase")
 };
 
 // python structure for image filter
@@ -16,18 +16,21 @@
 #    endif
 #  endif
 
+#  include <algorithm>
 #  include <stdint.h>
 #  include <string>
 
 #  include "MEM_guardedalloc.h"
 
-#  include "Exception.h"
+#  include "BLI_task.hh"
 #  include "BLI_time.h"
 
+#  include "Exception.h"
 
 extern "C" {
 #  include <libavcodec/avcodec.h>
 #  include <libavutil/imgutils.h>
+#  include <libavutil/pixdesc.h>
 #  include <libswscale/swscale.h>
 }
 
@@ -69,7 +72,9 @@ VideoFFmpeg::VideoFFmpeg(HRESULT *hRslt)
       m_isThreaded(false),
       m_isStreaming(false),
       m_stopThread(false),
-      m_cacheStarted(false)
+      m_cacheStarted(false),
+      m_demuxEnded(false),
+      m_droppedFrames(0)
 {
   // set video format
   m_format = RGB24;
@@ -77,12 +82,8 @@ VideoFFmpeg::VideoFFmpeg(HRESULT *hRslt)
   setFlip(true);
   // construction is OK
   *hRslt = S_OK;
-  BLI_listbase_clear(&m_thread);
-  pthread_mutex_init(&m_cacheMutex, nullptr);
-  BLI_listbase_clear(&m_frameCacheFree);
-  BLI_listbase_clear(&m_frameCacheBase);
-  BLI_listbase_clear(&m_packetCacheFree);
-  BLI_listbase_clear(&m_packetCacheBase);
+  BLI_listbase_clear(&m_demuxThread);
+  BLI_listbase_clear(&m_decodeThread);
 }
 
 // destructor
@@ -130,6 +131,7 @@ bool VideoFFmpeg::release()
     sws_freeContext(m_imgConvertCtx);
     m_imgConvertCtx = nullptr;
   }
+  freeConvertSlices();
   m_status = SourceStopped;
   m_lastFrame = -1;
   return true;
@@ -317,7 +319,10 @@ int VideoFFmpeg::openStream(const char *filename,
   }
   m_frameRGB = allocFrameRGB();
 
-  if (!m_imgConvertCtx) {
+  if (m_imgConvertCtx) {
+    initConvertSlices((m_format == RGBA32) ? AV_PIX_FMT_RGBA : AV_PIX_FMT_RGB24);
+  }
+  else {
     avcodec_free_context(&m_codecCtx);
     m_codecCtx = nullptr;
     avformat_close_input(&m_formatCtx);
@@ -335,40 +340,115 @@ int VideoFFmpeg::openStream(const char *filename,
   return 0;
 }
 
+void VideoFFmpeg::initConvertSlices(AVPixelFormat dstFormat)
+{
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(m_codecCtx->pix_fmt);
+  // palette and bitstream formats can't be addressed by rows
+  if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                               AV_PIX_FMT_FLAG_HWACCEL))) {
+    return;
+  }
+
+  // slices must start on a chroma row and be big enough to be worth a task
+  const int align = 1 << desc->log2_chroma_h;
+  const int minHeight = 64;
+  const int height = m_codecCtx->height;
+  const int count = std::min(BLI_system_thread_count(), height / minHeight);
+  if (count < 2) {
+    return;
+  }
+
+  const int sliceHeight = ((height / count) / align) * align;
+  for (int i = 0; i < count; ++i) {
+    ConvertSlice slice;
+    slice.y = i * sliceHeight;
+    // last slice takes the remaining rows
+    slice.height = (i == count - 1) ? height - slice.y : sliceHeight;
+    slice.ctx = sws_getContext(m_codecCtx->width,
+                               slice.height,
+                               m_codecCtx->pix_fmt,
+                               m_codecCtx->width,
+                               slice.height,
+                               dstFormat,
+                               SWS_FAST_BILINEAR,
+                               nullptr,
+                               nullptr,
+                               nullptr);
+    if (!slice.ctx) {
+      // fallback on the single context conversion
+      freeConvertSlices();
+      return;
+    }
+    m_convertSlices.push_back(slice);
+  }
+}
+
+void VideoFFmpeg::freeConvertSlices()
+{
+  for (ConvertSlice &slice : m_convertSlices) {
+    sws_freeContext(slice.ctx);
+  }
+  m_convertSlices.clear();
+}
+
+void VideoFFmpeg::convertFrame(AVFrame *input, AVFrame *output)
+{
+  if (m_convertSlices.empty()) {
+    // convert to RGB24
+    sws_scale(m_imgConvertCtx,
+              input->data,
+              input->linesize,
+              0,
+              m_codecCtx->height,
+              output->data,
+              output->linesize);
+    return;
+  }
+
+  const int chromaShift = av_pix_fmt_desc_get(m_codecCtx->pix_fmt)->log2_chroma_h;
+  blender::threading::parallel_for(
+      blender::IndexRange(m_convertSlices.size()), 1, [&](const blender::IndexRange range) {
+        for (const int64_t i : range) {
+          const ConvertSlice &slice = m_convertSlices[i];
+          // offset source planes to the first row of the slice, planes 1 and 2 are chroma
+          const uint8_t *src[AV_NUM_DATA_POINTERS];
+          for (int p = 0; p < AV_NUM_DATA_POINTERS; ++p) {
+            const int row = (p == 1 || p == 2) ? (slice.y >> chromaShift) : slice.y;
+            src[p] = input->data[p] ? input->data[p] + row * input->linesize[p] : nullptr;
+          }
+          uint8_t *dst[1] = {output->data[0] + slice.y * output->linesize[0]};
+
+          sws_scale(slice.ctx, src, input->linesize, 0, slice.height, dst, output->linesize);
+        }
+      });
+}
+
 /*
- * This thread is used to load video frame asynchronously.
- * It provides a frame caching service.
+ * These threads are used to load video frame asynchronously.
+ * They provide a frame caching service.
  * The main thread is responsible for positioning the frame pointer in the
- * file correctly before calling startCache() which starts this thread.
- * The cache is organized in two layers: 1) a cache of 20-30 undecoded packets to keep
- * memory and CPU low 2) a cache of 5 decoded frames.
+ * file correctly before calling startCache() which starts the threads.
+ * The cache is organized as a pipeline: 1) the demux thread reads a cache of 20-30
+ * undecoded packets to keep memory and CPU low 2) the decode thread decodes them and
+ * converts them to RGB in parallel slices into a cache of decoded frames.
+ * Each stage communicates with the next one with lock-free single producer single
+ * consumer queues, one for the ready items and one to give back the unused items.
  * If the main thread does not find the frame in the cache (because the video has restarted
  * or because the GE is lagging), it stops the cache with StopCache() (this is a synchronous
- * function: it sends a signal to stop the cache thread and wait for confirmation), then
- * change the position in the stream and restarts the cache thread.
+ * function: it sends a signal to stop the cache threads and wait for confirmation), then
+ * change the position in the stream and restarts the cache threads.
  */
-void *VideoFFmpeg::cacheThread(void *data)
+void *VideoFFmpeg::demuxThread(void *data)
 {
   VideoFFmpeg *video = (VideoFFmpeg *)data;
-  // holds the frame that is being decoded
-  CacheFrame *currentFrame = nullptr;
   CachePacket *cachePacket;
-  bool endOfFile = false;
-  int frameFinished = 0;
-  double timeBase = av_q2d(video->m_formatCtx->streams[video->m_videoStream]->time_base);
-  int64_t startTs = video->m_formatCtx->streams[video->m_videoStream]->start_time;
-
-  if (startTs == AV_NOPTS_VALUE)
-    startTs = 0;
 
   while (!video->m_stopThread) {
-    // packet cache is used solely by this thread, no need to lock
     // In case the stream/file contains other stream than the one we are looking for,
     // allow a bit of cycling to get rid quickly of those frames
-    frameFinished = 0;
-    while (!endOfFile &&
-           (cachePacket = (CachePacket *)video->m_packetCacheFree.first) != nullptr &&
-           frameFinished < 25) {
+    int skipped = 0;
+    bool idle = true;
+    while ((cachePacket = video->m_packetCacheFree.front()) != nullptr && skipped < 25) {
       // free packet => packet cache is not full yet, just read more
       if (av_read_frame(video->m_formatCtx, &cachePacket->packet) >= 0) {
         if (cachePacket->packet.stream_index == video->m_videoStream) {
@@ -377,122 +457,133 @@ void *VideoFFmpeg::cacheThread(void *data)
           av_packet_ref(&newPacket, &cachePacket->packet);
           cachePacket->packet = newPacket;
 
-          BLI_remlink(&video->m_packetCacheFree, cachePacket);
-          BLI_addtail(&video->m_packetCacheBase, cachePacket);
-          break;
+          video->m_packetCacheFree.pop();
+          video->m_packetCacheBase.push(cachePacket);
+          idle = false;
         }
         else {
           // this is not a good packet for us, just leave it on free queue
           // Note: here we could handle sound packet
           av_packet_unref(&cachePacket->packet);
-          frameFinished++;
+          skipped++;
         }
       }
       else {
-        if (video->m_isFile)
-          // this mark the end of the file
-          endOfFile = true;
+        if (video->m_isFile) {
+          // this mark the end of the file, the decode thread flushes the remaining packets
+          video->m_demuxEnded.store(true, std::memory_order_release);
+          return 0;
+        }
         // if we cannot read a packet, no need to continue
         break;
       }
     }
-    // frame cache is also used by main thread, lock
+    // small sleep to avoid unnecessary looping when the cache is full or the stream is late
+    if (idle) {
+      BLI_time_sleep_ms(5);
+    }
+  }
+  return 0;
+}
+
+void *VideoFFmpeg::decodeThread(void *data)
+{
+  VideoFFmpeg *video = (VideoFFmpeg *)data;
+  // holds the frame that is being decoded
+  CacheFrame *currentFrame = nullptr;
+  CachePacket *cachePacket;
+  double timeBase = av_q2d(video->m_formatCtx->streams[video->m_videoStream]->time_base);
+  int64_t startTs = video->m_formatCtx->streams[video->m_videoStream]->start_time;
+
+  if (startTs == AV_NOPTS_VALUE)
+    startTs = 0;
+
+  while (!video->m_stopThread) {
+    bool idle = true;
     if (currentFrame == nullptr) {
       // no current frame being decoded, take free one
-      pthread_mutex_lock(&video->m_cacheMutex);
-      if ((currentFrame = (CacheFrame *)video->m_frameCacheFree.first) != nullptr)
-        BLI_remlink(&video->m_frameCacheFree, currentFrame);
-      pthread_mutex_unlock(&video->m_cacheMutex);
+      currentFrame = video->m_frameCacheFree.pop();
     }
-    if (currentFrame != nullptr) {
-      // this frame is out of free and busy queue, we can manipulate it without locking
-      frameFinished = 0;
-      while (!frameFinished &&
-             (cachePacket = (CachePacket *)video->m_packetCacheBase.first) != nullptr) {
-        BLI_remlink(&video->m_packetCacheBase, cachePacket);
-        // use m_frame because when caching, it is not used in main thread
-        // we can't use currentFrame directly because we need to convert to RGB first
-        avcodec_send_packet(video->m_codecCtx, &cachePacket->packet);
-        frameFinished = avcodec_receive_frame(video->m_codecCtx, video->m_frame) == 0;
-
-        if (frameFinished) {
-          AVFrame *input = video->m_frame;
-
-          /* This means the data wasnt read properly, this check stops crashing */
-          if (input->data[0] != 0 || input->data[1] != 0 || input->data[2] != 0 ||
-              input->data[3] != 0) {
-            if (video->m_deinterlace) {
-              if (av_image_deinterlace((AVFrame *)video->m_frameDeinterlaced,
-                                       (const AVFrame *)video->m_frame,
-                                       video->m_codecCtx->pix_fmt,
-                                       video->m_codecCtx->width,
-                                       video->m_codecCtx->height) >= 0) {
-                input = video->m_frameDeinterlaced;
-              }
+    while (currentFrame != nullptr && (cachePacket = video->m_packetCacheBase.pop()) != nullptr) {
+      idle = false;
+      // use m_frame because when caching, it is not used in main thread
+      // we can't use currentFrame directly because we need to convert to RGB first
+      avcodec_send_packet(video->m_codecCtx, &cachePacket->packet);
+      const bool frameFinished = avcodec_receive_frame(video->m_codecCtx, video->m_frame) == 0;
+
+      if (frameFinished) {
+        AVFrame *input = video->m_frame;
+
+        /* This means the data wasnt read properly, this check stops crashing */
+        if (input->data[0] != 0 || input->data[1] != 0 || input->data[2] != 0 ||
+            input->data[3] != 0) {
+          if (video->m_deinterlace) {
+            if (av_image_deinterlace((AVFrame *)video->m_frameDeinterlaced,
+                                     (const AVFrame *)video->m_frame,
+                                     video->m_codecCtx->pix_fmt,
+                                     video->m_codecCtx->width,
+                                     video->m_codecCtx->height) >= 0) {
+              input = video->m_frameDeinterlaced;
             }
-            // convert to RGB24
-            sws_scale(video->m_imgConvertCtx,
-                      input->data,
-                      input->linesize,
-                      0,
-                      video->m_codecCtx->height,
-                      currentFrame->frame->data,
-                      currentFrame->frame->linesize);
-            // move frame to queue, this frame is necessarily the next one
-            video->m_curPosition = (long)((cachePacket->packet.dts - startTs) *
-                                              (video->m_baseFrameRate * timeBase) +
-                                          0.5);
-            currentFrame->framePosition = video->m_curPosition;
-            pthread_mutex_lock(&video->m_cacheMutex);
-            BLI_addtail(&video->m_frameCacheBase, currentFrame);
-            pthread_mutex_unlock(&video->m_cacheMutex);
-            currentFrame = nullptr;
           }
+          video->convertFrame(input, currentFrame->frame);
+          // move frame to queue, this frame is necessarily the next one
+          video->m_curPosition = (long)((cachePacket->packet.dts - startTs) *
+                                            (video->m_baseFrameRate * timeBase) +
+                                        0.5);
+          currentFrame->framePosition = video->m_curPosition;
+          video->m_frameCacheBase.push(currentFrame);
+          // continue decoding if another frame is free
+          currentFrame = video->m_frameCacheFree.pop();
         }
-        av_packet_unref(&cachePacket->packet);
-        BLI_addtail(&video->m_packetCacheFree, cachePacket);
-      }
-      if (currentFrame && endOfFile) {
-        // no more packet and end of file => put a special frame that indicates that
-        currentFrame->framePosition = -1;
-        pthread_mutex_lock(&video->m_cacheMutex);
-        BLI_addtail(&video->m_frameCacheBase, currentFrame);
-        pthread_mutex_unlock(&video->m_cacheMutex);
-        currentFrame = nullptr;
-        // no need to stay any longer in this thread
-        break;
       }
+      av_packet_unref(&cachePacket->packet);
+      video->m_packetCacheFree.push(cachePacket);
+    }
+    // the packet queue must be checked after the end flag as the demux thread
+    // pushes its last packets before setting it
+    if (currentFrame && video->m_demuxEnded.load(std::memory_order_acquire) &&
+        video->m_packetCacheBase.front() == nullptr) {
+      // no more packet and end of file => put a special frame that indicates that
+      currentFrame->framePosition = -1;
+      video->m_frameCacheBase.push(currentFrame);
+      currentFrame = nullptr;
+      // no need to stay any longer in this thread
+      break;
     }
     // small sleep to avoid unnecessary looping
-    BLI_time_sleep_ms(10);
+    if (idle) {
+      BLI_time_sleep_ms(5);
+    }
   }
   // before quitting, put back the current frame to queue to allow freeing
   if (currentFrame) {
-    pthread_mutex_lock(&video->m_cacheMutex);
-    BLI_addtail(&video->m_frameCacheFree, currentFrame);
-    pthread_mutex_unlock(&video->m_cacheMutex);
+    video->m_frameCacheFree.push(currentFrame);
   }
   return 0;
 }
 
-// start thread to cache video frame from file/capture/stream
+// start threads to cache video frame from file/capture/stream
 // this function should be called only when the position in the stream is set for the
 // first frame to cache
 bool VideoFFmpeg::startCache()
 {
   if (!m_cacheStarted && m_isThreaded) {
     m_stopThread = false;
+    m_demuxEnded = false;
     for (int i = 0; i < CACHE_FRAME_SIZE; i++) {
       CacheFrame *frame = new CacheFrame();
       frame->frame = allocFrameRGB();
-      BLI_addtail(&m_frameCacheFree, frame);
+      m_frameCacheFree.push(frame);
     }
     for (int i = 0; i < CACHE_PACKET_SIZE; i++) {
       CachePacket *packet = new CachePacket();
-      BLI_addtail(&m_packetCacheFree, packet);
+      m_packetCacheFree.push(packet);
     }
-    BLI_threadpool_init(&m_thread, cacheThread, 1);
-    BLI_threadpool_insert(&m_thread, this);
+    BLI_threadpool_init(&m_demuxThread, demuxThread, 1);
+    BLI_threadpool_insert(&m_demuxThread, this);
+    BLI_threadpool_init(&m_decodeThread, decodeThread, 1);
+    BLI_threadpool_insert(&m_decodeThread, this);
     m_cacheStarted = true;
   }
   return m_cacheStarted;
@@ -502,29 +593,26 @@ void VideoFFmpeg::stopCache()
 {
   if (m_cacheStarted) {
     m_stopThread = true;
-    BLI_threadpool_end(&m_thread);
-    // now delete the cache
+    BLI_threadpool_end(&m_demuxThread);
+    BLI_threadpool_end(&m_decodeThread);
+    // now delete the cache, the threads are stopped so any thread can consume the queues
     CacheFrame *frame;
     CachePacket *packet;
-    while ((frame = (CacheFrame *)m_frameCacheBase.first) != nullptr) {
-      BLI_remlink(&m_frameCacheBase, frame);
+    while ((frame = m_frameCacheBase.pop()) != nullptr) {
       MEM_freeN(frame->frame->data[0]);
       av_free(frame->frame);
       delete frame;
     }
-    while ((frame = (CacheFrame *)m_frameCacheFree.first) != nullptr) {
-      BLI_remlink(&m_frameCacheFree, frame);
+    while ((frame = m_frameCacheFree.pop()) != nullptr) {
       MEM_freeN(frame->frame->data[0]);
       av_free(frame->frame);
       delete frame;
     }
-    while ((packet = (CachePacket *)m_packetCacheBase.first) != nullptr) {
-      BLI_remlink(&m_packetCacheBase, packet);
+    while ((packet = m_packetCacheBase.pop()) != nullptr) {
       av_packet_unref(&packet->packet);
       delete packet;
     }
-    while ((packet = (CachePacket *)m_packetCacheFree.first) != nullptr) {
-      BLI_remlink(&m_packetCacheFree, packet);
+    while ((packet = m_packetCacheFree.pop()) != nullptr) {
       delete packet;
     }
     m_cacheStarted = false;
@@ -538,12 +626,9 @@ void VideoFFmpeg::releaseFrame(AVFrame *frame)
     return;
   }
   // this frame MUST be the first one of the queue
-  pthread_mutex_lock(&m_cacheMutex);
-  CacheFrame *cacheFrame = (CacheFrame *)m_frameCacheBase.first;
-  assert(cacheFrame != nullptr && cacheFrame->frame == frame);
-  BLI_remlink(&m_frameCacheBase, cacheFrame);
-  BLI_addtail(&m_frameCacheFree, cacheFrame);
-  pthread_mutex_unlock(&m_cacheMutex);
+  CacheFrame *cacheFrame = m_frameCacheBase.pop();
+  BLI_assert(cacheFrame != nullptr && cacheFrame->frame == frame);
+  m_frameCacheFree.push(cacheFrame);
 }
 
 // open video file
@@ -870,11 +955,9 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
   if (m_cacheStarted) {
     // when cache is active, we must not read the file directly
     do {
-      pthread_mutex_lock(&m_cacheMutex);
-      frame = (CacheFrame *)m_frameCacheBase.first;
-      pthread_mutex_unlock(&m_cacheMutex);
-      // no need to remove the frame from the queue: the cache thread does not touch the head, only
-      // the tail
+      // no need to remove the frame from the queue: the decode thread does not touch the head,
+      // only the tail
+      frame = m_frameCacheBase.front();
       if (frame == nullptr) {
         // no frame in cache, in case of file it is an abnormal situation
         if (m_isFile) {
@@ -903,10 +986,9 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
         return nullptr;
       }
       // this frame is not useful, release it
-      pthread_mutex_lock(&m_cacheMutex);
-      BLI_remlink(&m_frameCacheBase, frame);
-      BLI_addtail(&m_frameCacheFree, frame);
-      pthread_mutex_unlock(&m_cacheMutex);
+      m_frameCacheBase.pop();
+      m_frameCacheFree.push(frame);
+      ++m_droppedFrames;
     } while (true);
   }
   double timeBase = av_q2d(m_formatCtx->streams[m_videoStream]->time_base);
@@ -1032,14 +1114,7 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
             input = m_frameDeinterlaced;
           }
         }
-        // convert to RGB24
-        sws_scale(m_imgConvertCtx,
-                  input->data,
-                  input->linesize,
-                  0,
-                  m_codecCtx->height,
-                  m_frameRGB->data,
-                  m_frameRGB->linesize);
+        convertFrame(input, m_frameRGB);
         av_packet_unref(&packet);
         frameLoaded = true;
         break;
@@ -1161,6 +1236,27 @@ static int VideoFFmpeg_setDeinterlace(PyImage *self, PyObject *value, void *clos
   return 0;
 }
 
+// get cache occupancy
+static PyObject *VideoFFmpeg_getCache(PyImage *self, void *closure)
+{
+  VideoFFmpeg *video = getFFmpeg(self);
+  return Py_BuildValue("{s:I,s:I,s:I,s:I}",
+                       "frames",
+                       video->getCachedFrames(),
+                       "frames_capacity",
+                       (unsigned int)CACHE_FRAME_SIZE,
+                       "packets",
+                       video->getCachedPackets(),
+                       "packets_capacity",
+                       (unsigned int)CACHE_PACKET_SIZE);
+}
+
+// get number of dropped frames
+static PyObject *VideoFFmpeg_getDropped(PyImage *self, void *closure)
+{
+  return PyLong_FromUnsignedLong(getFFmpeg(self)->getDroppedFrames());
+}
+
 // methods structure
 static PyMethodDef videoMethods[] = {  // methods from VideoBase class
     {"play", (PyCFunction)Video_play, METH_NOARGS, "Play (restart) video"},
@@ -1219,6 +1315,16 @@ static PyGetSetDef videoGetSets[] = {  // methods from VideoBase class
      (setter)VideoFFmpeg_setDeinterlace,
      (char *)"deinterlace image",
      nullptr},
+    {(char *)"cache",
+     (getter)VideoFFmpeg_getCache,
+     nullptr,
+     (char *)"occupancy of the frame and packet cache",
+     nullptr},
+    {(char *)"dropped",
+     (getter)VideoFFmpeg_getDropped,
+     nullptr,
+     (char *)"number of decoded frames skipped because they were late",
+     nullptr},
     {nullptr}};
 
 // python type declaration
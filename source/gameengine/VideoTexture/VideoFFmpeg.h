@@ -13,7 +13,8 @@
 #    include <inttypes.h>
 #  endif
 
-#  include <pthread.h>
+#  include <atomic>
+#  include <vector>
 
 #  include "BLI_blenlib.h"
 #  include "BLI_threads.h"
@@ -22,7 +23,6 @@
 extern "C" {
 #  include "ffmpeg_compat.h"
 #  include <libavcodec/avcodec.h>
-#  include <pthread.h>
 }
 
 #  include "VideoBase.h"
@@ -30,6 +30,65 @@ extern "C" {
 #  define CACHE_FRAME_SIZE 10
 #  define CACHE_PACKET_SIZE 30
 
+/** Single producer single consumer lock-free queue of pointers.
+ * push() must be called only from the producer thread, front() and pop() only from the
+ * consumer thread.
+ */
+template<class Item, unsigned int Size> class VideoCacheRing {
+ public:
+  VideoCacheRing() : m_head(0), m_tail(0)
+  {
+  }
+
+  /// add an item at the end of the queue, return false if the queue is full
+  bool push(Item *item)
+  {
+    const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+    const unsigned int next = (tail + 1) % (Size + 1);
+    if (next == m_head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    m_items[tail] = item;
+    m_tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /// get the first item without removing it, nullptr if the queue is empty
+  Item *front()
+  {
+    const unsigned int head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return m_items[head];
+  }
+
+  /// remove and return the first item, nullptr if the queue is empty
+  Item *pop()
+  {
+    Item *item = front();
+    if (item) {
+      m_head.store((m_head.load(std::memory_order_relaxed) + 1) % (Size + 1),
+                   std::memory_order_release);
+    }
+    return item;
+  }
+
+  /// number of items in the queue, only an estimate when called from a third thread
+  unsigned int size() const
+  {
+    const unsigned int head = m_head.load(std::memory_order_acquire);
+    const unsigned int tail = m_tail.load(std::memory_order_acquire);
+    return (tail + Size + 1 - head) % (Size + 1);
+  }
+
+ private:
+  // one more slot than capacity to distinguish full from empty
+  Item *m_items[Size + 1];
+  std::atomic<unsigned int> m_head;
+  std::atomic<unsigned int> m_tail;
+};
+
 // type VideoFFmpeg declaration
 class VideoFFmpeg : public VideoBase {
  public:
@@ -81,6 +140,21 @@ class VideoFFmpeg : public VideoBase {
   {
     return (m_isImage) ? (char *)m_imageName.c_str() : nullptr;
   }
+  /// number of decoded frames ready in the cache
+  unsigned int getCachedFrames(void)
+  {
+    return m_frameCacheBase.size();
+  }
+  /// number of packets waiting for decoding in the cache
+  unsigned int getCachedPackets(void)
+  {
+    return m_packetCacheBase.size();
+  }
+  /// number of decoded frames skipped because they were late
+  unsigned long getDroppedFrames(void)
+  {
+    return m_droppedFrames;
+  }
 
  protected:
   AVFormatContext *m_formatCtx;
@@ -93,6 +167,13 @@ class VideoFFmpeg : public VideoBase {
   AVFrame *m_frameRGB;
   // conversion from raw to RGB is done with sws_scale
   struct SwsContext *m_imgConvertCtx;
+  // horizontal slices of the frame converted in parallel, empty if not supported by the format
+  struct ConvertSlice {
+    struct SwsContext *ctx;
+    int y;
+    int height;
+  };
+  std::vector<ConvertSlice> m_convertSlices;
   // should the codec be deinterlaced?
   bool m_deinterlace;
   // number of frame of preseek
@@ -154,6 +235,13 @@ class VideoFFmpeg : public VideoBase {
   /// common function to video file and capture
   int openStream(const char *filename, const AVInputFormat *inputFormat, AVDictionary **formatParams);
 
+  /// create the slice conversion contexts
+  void initConvertSlices(AVPixelFormat dstFormat);
+  /// free the slice conversion contexts
+  void freeConvertSlices();
+  /// convert a decoded frame to RGB, slices are converted in parallel when possible
+  void convertFrame(AVFrame *input, AVFrame *output);
+
   /// check if a frame is available and load it in pFrame, return true if a frame could be
   /// retrieved
   AVFrame *grabFrame(long frame);
@@ -167,26 +255,35 @@ class VideoFFmpeg : public VideoBase {
 
  private:
   typedef struct {
-    Link link;
     long framePosition;
     AVFrame *frame;
   } CacheFrame;
   typedef struct {
-    Link link;
     AVPacket packet;
   } CachePacket;
 
-  bool m_stopThread;
+  std::atomic<bool> m_stopThread;
   bool m_cacheStarted;
-  ListBase m_thread;
-  ListBase m_frameCacheBase;   // list of frames that are ready
-  ListBase m_frameCacheFree;   // list of frames that are unused
-  ListBase m_packetCacheBase;  // list of packets that are ready for decoding
-  ListBase m_packetCacheFree;  // list of packets that are unused
-  pthread_mutex_t m_cacheMutex;
+  /// demux thread reading the packets
+  ListBase m_demuxThread;
+  /// decode thread decoding the packets and converting the frames
+  ListBase m_decodeThread;
+  /// set by the demux thread when the end of the file is reached
+  std::atomic<bool> m_demuxEnded;
+  /// frames that are ready, produced by decode thread, consumed by main thread
+  VideoCacheRing<CacheFrame, CACHE_FRAME_SIZE> m_frameCacheBase;
+  /// frames that are unused, produced by main thread, consumed by decode thread
+  VideoCacheRing<CacheFrame, CACHE_FRAME_SIZE> m_frameCacheFree;
+  /// packets ready for decoding, produced by demux thread, consumed by decode thread
+  VideoCacheRing<CachePacket, CACHE_PACKET_SIZE> m_packetCacheBase;
+  /// packets that are unused, produced by decode thread, consumed by demux thread
+  VideoCacheRing<CachePacket, CACHE_PACKET_SIZE> m_packetCacheFree;
+  /// number of decoded frames skipped by the main thread
+  unsigned long m_droppedFrames;
 
   AVFrame *allocFrameRGB();
-  static void *cacheThread(void *);
+  static void *demuxThread(void *);
+  static void *decodeThread(void *);
 };
 
 inline VideoFFmpeg *getFFmpeg(PyImage *self)
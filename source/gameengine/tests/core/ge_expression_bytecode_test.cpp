@@ -0,0 +1,275 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/tests/core/ge_expression_bytecode_test.cpp
+ *  \ingroup expressions
+ *
+ * Parity of the bytecode interpreter used by the expression controller with the
+ * evaluation of the expression tree.
+ */
+
+#include "testing/testing.h"
+
+#include "EXP_BoolValue.h"
+#include "EXP_Bytecode.h"
+#include "EXP_FloatValue.h"
+#include "EXP_InputParser.h"
+#include "EXP_StringValue.h"
+
+namespace {
+
+class ExpressionBytecodeTest : public testing::Test {
+ protected:
+  /// Owner of the properties read by the identifiers, as the controller for logic bricks.
+  EXP_IntValue *m_context;
+  std::vector<EXP_Expression *> m_expressions;
+
+  void SetUp() override
+  {
+    m_context = new EXP_IntValue(0, "context");
+    SetProperty("a", new EXP_IntValue(3));
+    SetProperty("b", new EXP_IntValue(-4));
+    SetProperty("zero", new EXP_IntValue(0));
+    SetProperty("f", new EXP_FloatValue(2.5f));
+    SetProperty("flag", new EXP_BoolValue(true));
+    SetProperty("s", new EXP_StringValue("foo", ""));
+  }
+
+  void TearDown() override
+  {
+    for (EXP_Expression *expr : m_expressions) {
+      expr->Release();
+    }
+    m_context->Release();
+  }
+
+  void SetProperty(const std::string &name, EXP_Value *value)
+  {
+    m_context->SetProperty(name, value);
+    value->Release();
+  }
+
+  EXP_Expression *Parse(const std::string &text)
+  {
+    EXP_Parser parser;
+    parser.SetContext(m_context->AddRef());
+    EXP_Expression *expr = parser.ProcessText(text);
+    m_expressions.push_back(expr);
+    return expr;
+  }
+
+  /// Check that the program produces the value of the tree.
+  void ExpectSameValue(EXP_BytecodeProgram *program, EXP_Expression *expr, const std::string &text)
+  {
+    EXP_BytecodeValue result;
+    ASSERT_TRUE(program->Execute(result)) << text;
+
+    EXP_Value *value = expr->Calculate();
+    ASSERT_FALSE(value->IsError()) << text;
+    ASSERT_EQ(result.m_type, value->GetValueType()) << text;
+
+    switch (result.m_type) {
+      case VALUE_INT_TYPE: {
+        EXPECT_EQ(result.m_int, static_cast<EXP_IntValue *>(value)->GetInt()) << text;
+        break;
+      }
+      case VALUE_FLOAT_TYPE: {
+        EXPECT_FLOAT_EQ(result.m_float, static_cast<EXP_FloatValue *>(value)->GetFloat()) << text;
+        break;
+      }
+      case VALUE_BOOL_TYPE: {
+        EXPECT_EQ(result.m_bool, static_cast<EXP_BoolValue *>(value)->GetBool()) << text;
+        break;
+      }
+      case VALUE_STRING_TYPE: {
+        EXPECT_EQ(*result.m_string, static_cast<EXP_StringValue *>(value)->GetString()) << text;
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    EXPECT_EQ(result.GetNumber(), value->GetNumber()) << text;
+
+    value->Release();
+  }
+
+  void ExpectParity(const std::string &text)
+  {
+    EXP_Expression *expr = Parse(text);
+    ASSERT_NE(expr, nullptr) << text;
+
+    std::unique_ptr<EXP_BytecodeProgram> program = EXP_BytecodeProgram::Compile(expr);
+    ASSERT_NE(program, nullptr) << text;
+
+    ExpectSameValue(program.get(), expr, text);
+  }
+
+  /** Check that the program refuses to produce a value, the tree evaluation used
+   * instead must then report an error.
+   */
+  void ExpectError(const std::string &text)
+  {
+    EXP_Expression *expr = Parse(text);
+    ASSERT_NE(expr, nullptr) << text;
+
+    std::unique_ptr<EXP_BytecodeProgram> program = EXP_BytecodeProgram::Compile(expr);
+    if (program) {
+      EXP_BytecodeValue result;
+      EXPECT_FALSE(program->Execute(result)) << text;
+    }
+
+    EXP_Value *value = expr->Calculate();
+    EXPECT_TRUE(value->IsError()) << text;
+    value->Release();
+  }
+};
+
+}  // namespace
+
+TEST_F(ExpressionBytecodeTest, Arithmetic)
+{
+  ExpectParity("1 + 2 * 3");
+  ExpectParity("(1 + 2) * 3");
+  ExpectParity("7 / 2");
+  ExpectParity("7 % 3");
+  ExpectParity("-a + b");
+  ExpectParity("a - b * 2");
+  ExpectParity("a * f");
+  ExpectParity("f / 2");
+  ExpectParity("b / a");
+  ExpectParity("f % 2");
+  ExpectParity("1.5 + a");
+}
+
+TEST_F(ExpressionBytecodeTest, Comparison)
+{
+  ExpectParity("a == 3");
+  ExpectParity("a != b");
+  ExpectParity("a > b");
+  ExpectParity("a < f");
+  ExpectParity("a >= 3");
+  ExpectParity("b <= -5");
+  ExpectParity("f == 2.5");
+  ExpectParity("flag == true");
+  ExpectParity("s == \"foo\"");
+  ExpectParity("s != \"bar\"");
+}
+
+TEST_F(ExpressionBytecodeTest, Logic)
+{
+  ExpectParity("not flag");
+  ExpectParity("not a");
+  ExpectParity("flag and a > 2");
+  ExpectParity("a > 5 or flag");
+  ExpectParity("a > 5 or b > 0");
+  ExpectParity("true && false");
+  ExpectParity("false || flag");
+  ExpectParity("not (a == 3 and f < 3.0)");
+}
+
+TEST_F(ExpressionBytecodeTest, Condition)
+{
+  ExpectParity("if(flag, a, b)");
+  ExpectParity("if(not flag, a, b)");
+  ExpectParity("if(a > 5, 1, 2.5)");
+  ExpectParity("if(a == 3, if(b < 0, 10, 20), 30)");
+  ExpectParity("if(flag, a)");
+  ExpectParity("if(not flag, a)");
+}
+
+/// Only the selected branch of a condition is evaluated, the other one can't report an error.
+TEST_F(ExpressionBytecodeTest, ConditionShortCircuit)
+{
+  ExpectParity("if(flag, a, missing)");
+  ExpectParity("if(not flag, missing, b)");
+  ExpectParity("if(flag, a, 1 / zero)");
+  ExpectParity("if(a > 5, s + 1, f)");
+
+  ExpectError("if(flag, missing, a)");
+  ExpectError("if(not flag, a, 1 / zero)");
+  ExpectError("if(missing, a, b)");
+}
+
+/// Both operands of the logical operators are evaluated, an error in any of them is reported.
+TEST_F(ExpressionBytecodeTest, LogicNoShortCircuit)
+{
+  ExpectError("flag or missing");
+  ExpectError("missing or flag");
+  ExpectError("not flag and missing");
+  ExpectError("missing and not flag");
+  ExpectError("true or missing");
+  ExpectError("false and missing");
+}
+
+TEST_F(ExpressionBytecodeTest, Errors)
+{
+  ExpectError("missing");
+  ExpectError("missing + 1");
+  ExpectError("-missing");
+  ExpectError("a / zero");
+  ExpectError("f / zero");
+  ExpectError("s - a");
+  ExpectError("not s");
+}
+
+/// The result of string concatenation isn't representable, the tree must be used.
+TEST_F(ExpressionBytecodeTest, StringConcatenation)
+{
+  EXP_Expression *expr = Parse("s + \"bar\"");
+  std::unique_ptr<EXP_BytecodeProgram> program = EXP_BytecodeProgram::Compile(expr);
+  ASSERT_NE(program, nullptr);
+
+  EXP_BytecodeValue result;
+  EXPECT_FALSE(program->Execute(result));
+
+  EXP_Value *value = expr->Calculate();
+  EXPECT_EQ(value->GetText(), "foobar");
+  value->Release();
+}
+
+/// The properties are read at each execution, including the ones added or replaced later.
+TEST_F(ExpressionBytecodeTest, PropertyChange)
+{
+  const std::string text = "a * 2 + later";
+  EXP_Expression *expr = Parse(text);
+  std::unique_ptr<EXP_BytecodeProgram> program = EXP_BytecodeProgram::Compile(expr);
+  ASSERT_NE(program, nullptr);
+
+  EXP_BytecodeValue result;
+  EXPECT_FALSE(program->Execute(result));
+
+  SetProperty("later", new EXP_IntValue(1));
+  ExpectSameValue(program.get(), expr, text);
+
+  // Modified in place as done by the property actuator.
+  EXP_IntValue *ten = new EXP_IntValue(10);
+  m_context->GetProperty("a")->SetValue(ten);
+  ten->Release();
+  ExpectSameValue(program.get(), expr, text);
+
+  SetProperty("a", new EXP_FloatValue(0.25f));
+  ExpectSameValue(program.get(), expr, text);
+
+  m_context->RemoveProperty("later");
+  EXPECT_FALSE(program->Execute(result));
+}
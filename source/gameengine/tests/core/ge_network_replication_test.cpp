@@ -0,0 +1,244 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/tests/core/ge_network_replication_test.cpp
+ *  \ingroup ketsji
+ *
+ * Replication between two game instances connected on localhost, each one owning a transport
+ * and the replication of a scene as a blenderplayer would.
+ */
+
+#include "testing/testing.h"
+
+#include <chrono>
+#include <thread>
+
+#include "EXP_IntValue.h"
+#include "KX_GameObject.h"
+#include "KX_NetworkMessageManager.h"
+#include "KX_NetworkReplication.h"
+#include "KX_NodeRelationships.h"
+#include "SG_Node.h"
+
+namespace {
+
+/// First UDP port tried by the listening instance.
+const unsigned short BASE_PORT = 47800;
+/// Maximum number of frames to wait for the replication.
+const unsigned int MAX_FRAMES = 500;
+
+/// Game instance reduced to the objects of one scene, its transport and its replication.
+class Instance {
+ private:
+  SG_Callbacks m_callbacks;
+
+ public:
+  KX_NetworkMessageManager m_manager;
+  KX_NetworkReplication m_replication;
+  std::vector<KX_GameObject *> m_objects;
+
+  Instance() : m_replication("Scene")
+  {
+  }
+
+  ~Instance()
+  {
+    for (KX_GameObject *object : m_objects) {
+      m_replication.UnregisterObject(object);
+      SG_Node *node = object->GetSGNode();
+      object->SetSGNode(nullptr);
+      delete node;
+      object->Release();
+    }
+  }
+
+  KX_GameObject *AddObject(const std::string &name, unsigned int networkId)
+  {
+    KX_GameObject *object = new KX_GameObject();
+    object->SetName(name);
+    SG_Node *node = new SG_Node(object, nullptr, m_callbacks);
+    node->SetParentRelation(new KX_NormalParentRelation());
+    object->SetSGNode(node);
+    object->NodeUpdateGS(0.0);
+    EXPECT_TRUE(m_replication.SetNetworkId(object, networkId));
+    m_objects.push_back(object);
+    return object;
+  }
+
+  /// Network part of a frame as done by KX_KetsjiEngine::NextFrame.
+  void Frame()
+  {
+    m_manager.ReceivePackets();
+    m_replication.Update(&m_manager, nullptr);
+    m_manager.SendPackets();
+    m_manager.ClearMessages();
+  }
+};
+
+void SetHealth(KX_GameObject *object, int health)
+{
+  EXP_IntValue *value = new EXP_IntValue(health);
+  object->SetProperty("health", value);
+  value->Release();
+}
+
+int GetHealth(KX_GameObject *object)
+{
+  EXP_Value *value = object->GetProperty("health");
+  return value ? (int)value->GetNumber() : -1;
+}
+
+bool IsAt(KX_GameObject *object, const MT_Vector3 &position)
+{
+  return (object->NodeGetWorldPosition() - position).length() < 1.0e-4f;
+}
+
+/// Open the transports of both instances, the client connecting to the server.
+bool Connect(Instance &server, Instance &client)
+{
+  for (unsigned short port = BASE_PORT; port < BASE_PORT + 100; ++port) {
+    if (server.m_manager.GetTransport().Listen(port)) {
+      return client.m_manager.GetTransport().Connect("127.0.0.1", port);
+    }
+  }
+  return false;
+}
+
+/// Run frames of both instances until the condition is true.
+template<class Condition>
+bool RunFrames(Instance &server, Instance &client, Condition condition)
+{
+  for (unsigned int i = 0; i < MAX_FRAMES; ++i) {
+    client.Frame();
+    server.Frame();
+    if (condition()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+}  // namespace
+
+/// Replicas of the same name are replicated independently thanks to their network ids.
+TEST(ge_network_replication, TwoInstancesLocalhost)
+{
+  Instance server;
+  Instance client;
+  ASSERT_TRUE(Connect(server, client));
+
+  KX_GameObject *serverObjects[2] = {server.AddObject("Enemy", 1), server.AddObject("Enemy", 2)};
+  KX_GameObject *clientObjects[2] = {client.AddObject("Enemy", 1), client.AddObject("Enemy", 2)};
+
+  const MT_Vector3 positions[2] = {MT_Vector3(1.0f, 2.0f, 3.0f), MT_Vector3(-4.0f, 5.0f, 0.5f)};
+  for (unsigned short i = 0; i < 2; ++i) {
+    serverObjects[i]->NodeSetWorldPosition(positions[i]);
+    serverObjects[i]->NodeUpdateGS(0.0);
+    SetHealth(serverObjects[i], 10 * (i + 1));
+    EXPECT_TRUE(server.m_replication.AddObject(serverObjects[i], {"health"}, 0.0f));
+  }
+
+  EXPECT_TRUE(RunFrames(server, client, [&]() {
+    return IsAt(clientObjects[0], positions[0]) && IsAt(clientObjects[1], positions[1]) &&
+           GetHealth(clientObjects[0]) == 10 && GetHealth(clientObjects[1]) == 20;
+  }));
+
+  // A change of a single group of one replica is applied without altering the other one.
+  SetHealth(serverObjects[1], 5);
+  EXPECT_TRUE(RunFrames(server, client, [&]() { return GetHealth(clientObjects[1]) == 5; }));
+  EXPECT_EQ(GetHealth(clientObjects[0]), 10);
+  EXPECT_TRUE(IsAt(clientObjects[0], positions[0]));
+  EXPECT_TRUE(IsAt(clientObjects[1], positions[1]));
+
+  // Objects without network id can't be replicated.
+  KX_GameObject *object = new KX_GameObject();
+  EXPECT_FALSE(server.m_replication.AddObject(object, {}, 0.0f));
+  object->Release();
+
+  // Network ids are unique.
+  EXPECT_FALSE(client.m_replication.SetNetworkId(clientObjects[1], 1));
+}
+
+/// The replication identifier of a removed object is reused for another object.
+TEST(ge_network_replication, DespawnAndReusedId)
+{
+  Instance server;
+  Instance client;
+  ASSERT_TRUE(Connect(server, client));
+
+  KX_GameObject *serverObjects[2] = {server.AddObject("Enemy", 1), server.AddObject("Enemy", 2)};
+  KX_GameObject *clientObjects[2] = {client.AddObject("Enemy", 1), client.AddObject("Enemy", 2)};
+
+  const MT_Vector3 positions[3] = {
+      MT_Vector3(1.0f, 2.0f, 3.0f), MT_Vector3(-4.0f, 5.0f, 0.5f), MT_Vector3(7.0f, 0.0f, 0.0f)};
+  serverObjects[0]->NodeSetWorldPosition(positions[0]);
+  serverObjects[0]->NodeUpdateGS(0.0);
+  EXPECT_TRUE(server.m_replication.AddObject(serverObjects[0], {}, 0.0f));
+  EXPECT_TRUE(
+      RunFrames(server, client, [&]() { return IsAt(clientObjects[0], positions[0]); }));
+
+  /* The second object takes the identifier of the first one, the client must bind it to the
+   * second network id and no longer apply the states of the first object. */
+  server.m_replication.RemoveObject(serverObjects[0]);
+  serverObjects[0]->NodeSetWorldPosition(positions[2]);
+  serverObjects[0]->NodeUpdateGS(0.0);
+  serverObjects[1]->NodeSetWorldPosition(positions[1]);
+  serverObjects[1]->NodeUpdateGS(0.0);
+  EXPECT_TRUE(server.m_replication.AddObject(serverObjects[1], {}, 0.0f));
+  EXPECT_TRUE(
+      RunFrames(server, client, [&]() { return IsAt(clientObjects[1], positions[1]); }));
+  EXPECT_TRUE(IsAt(clientObjects[0], positions[0]));
+
+  // Later changes of the reused identifier only reach the second object.
+  serverObjects[1]->NodeSetWorldPosition(positions[2]);
+  serverObjects[1]->NodeUpdateGS(0.0);
+  EXPECT_TRUE(
+      RunFrames(server, client, [&]() { return IsAt(clientObjects[1], positions[2]); }));
+  EXPECT_TRUE(IsAt(clientObjects[0], positions[0]));
+}
+
+/// Only the messages of the network subjects are sent to the remote instances.
+TEST(ge_network_replication, NetworkMessageSubjects)
+{
+  Instance server;
+  Instance client;
+  ASSERT_TRUE(Connect(server, client));
+
+  client.m_manager.SetNetworkSubjects({"chat"});
+  client.m_manager.AddMessage({"Player", nullptr, "local", "not sent"});
+  client.m_manager.AddMessage({"Player", nullptr, "chat", "hello"});
+
+  std::vector<KX_NetworkMessageManager::Message> received;
+  EXPECT_TRUE(RunFrames(server, client, [&]() {
+    for (const std::string &subject : {"local", "chat"}) {
+      const std::vector<KX_NetworkMessageManager::Message> messages =
+          server.m_manager.GetMessages("Player", subject);
+      received.insert(received.end(), messages.begin(), messages.end());
+    }
+    return !received.empty();
+  }));
+
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].subject, "chat");
+  EXPECT_EQ(received[0].body, "hello");
+}
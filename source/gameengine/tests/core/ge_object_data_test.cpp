@@ -0,0 +1,202 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/tests/core/ge_object_data_test.cpp
+ *  \ingroup ketsji
+ *
+ * Bulk transfer of object transforms used by scene.gatherObjectData and
+ * scene.scatterObjectData.
+ */
+
+#include "testing/testing.h"
+
+#include "KX_GameObject.h"
+#include "KX_NodeRelationships.h"
+#include "KX_ObjectData.h"
+#include "SG_Node.h"
+
+namespace {
+
+const float EPSILON = 1.0e-5f;
+
+/// Number of transform updates of the nodes, as done for the physics synchronization.
+unsigned int numUpdates = 0;
+
+void CountUpdate(SG_Node *node, void *gameobj, void *scene)
+{
+  ++numUpdates;
+}
+
+/// Objects of a scene reduced to their scene graph nodes.
+class Objects {
+ private:
+  SG_Callbacks m_callbacks;
+
+ public:
+  std::vector<KX_GameObject *> m_objects;
+
+  Objects()
+  {
+    m_callbacks.m_updatefunc = CountUpdate;
+  }
+
+  ~Objects()
+  {
+    // Children are added after their parent, free them first.
+    for (std::vector<KX_GameObject *>::reverse_iterator it = m_objects.rbegin();
+         it != m_objects.rend();
+         ++it)
+    {
+      KX_GameObject *object = *it;
+      SG_Node *node = object->GetSGNode();
+      if (node->GetSGParent()) {
+        node->GetSGParent()->RemoveChild(node);
+      }
+      object->SetSGNode(nullptr);
+      delete node;
+      object->Release();
+    }
+  }
+
+  KX_GameObject *AddObject(const MT_Vector3 &position, KX_GameObject *parent = nullptr)
+  {
+    KX_GameObject *object = new KX_GameObject();
+    SG_Node *node = new SG_Node(object, nullptr, m_callbacks);
+    node->SetParentRelation(new KX_NormalParentRelation());
+    node->SetLocalPosition(position);
+    object->SetSGNode(node);
+    if (parent) {
+      parent->GetSGNode()->AddChild(node);
+    }
+    object->NodeUpdateGS(0.0);
+    m_objects.push_back(object);
+    return object;
+  }
+};
+
+std::vector<float> Gather(const std::vector<KX_GameObject *> &objects, const char *name)
+{
+  const KX_ObjectDataInfo *info = KX_FindObjectData(name);
+  std::vector<float> data(objects.size() * info->size);
+  KX_GatherObjectData(objects, info, data.data());
+  return data;
+}
+
+void Scatter(const std::vector<KX_GameObject *> &objects,
+             const char *name,
+             const std::vector<float> &data)
+{
+  KX_ScatterObjectData(objects, KX_FindObjectData(name), data.data());
+}
+
+void ExpectNear(const std::vector<float> &a, const std::vector<float> &b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (unsigned int i = 0; i < a.size(); ++i) {
+    EXPECT_NEAR(a[i], b[i], EPSILON) << "float " << i;
+  }
+}
+
+}  // namespace
+
+TEST(ge_object_data, FindObjectData)
+{
+  EXPECT_EQ(KX_FindObjectData("worldPosition")->size, 3);
+  EXPECT_EQ(KX_FindObjectData("localOrientation")->size, 9);
+  EXPECT_TRUE(KX_FindObjectData("worldLinearVelocity")->physics);
+  EXPECT_EQ(KX_FindObjectData("unknown"), nullptr);
+}
+
+TEST(ge_object_data, GatherEmptyList)
+{
+  EXPECT_TRUE(Gather({}, "worldPosition").empty());
+  Scatter({}, "worldPosition", {});
+}
+
+TEST(ge_object_data, PositionRoundTrip)
+{
+  Objects objects;
+  for (unsigned int i = 0; i < 4; ++i) {
+    objects.AddObject(MT_Vector3(i, 2.0f * i, -1.0f));
+  }
+
+  const std::vector<float> positions = Gather(objects.m_objects, "worldPosition");
+  ExpectNear(positions, {0, 0, -1, 1, 2, -1, 2, 4, -1, 3, 6, -1});
+
+  std::vector<float> moved = positions;
+  for (float &value : moved) {
+    value += 0.5f;
+  }
+  Scatter(objects.m_objects, "worldPosition", moved);
+  ExpectNear(Gather(objects.m_objects, "worldPosition"), moved);
+  ExpectNear(Gather(objects.m_objects, "localPosition"), moved);
+}
+
+TEST(ge_object_data, OrientationAndScaleRoundTrip)
+{
+  Objects objects;
+  KX_GameObject *object = objects.AddObject(MT_Vector3(0.0f, 0.0f, 0.0f));
+
+  // Rotation of 90 degrees around Z, row major.
+  const std::vector<float> rotation = {0, -1, 0, 1, 0, 0, 0, 0, 1};
+  Scatter(objects.m_objects, "worldOrientation", rotation);
+  ExpectNear(Gather(objects.m_objects, "worldOrientation"), rotation);
+  EXPECT_NEAR(object->NodeGetWorldOrientation()[0][1], -1.0f, EPSILON);
+
+  const std::vector<float> scale = {1, 2, 3};
+  Scatter(objects.m_objects, "localScale", scale);
+  ExpectNear(Gather(objects.m_objects, "worldScale"), scale);
+}
+
+TEST(ge_object_data, ChildWorldDataAfterParent)
+{
+  Objects objects;
+  KX_GameObject *parent = objects.AddObject(MT_Vector3(1.0f, 0.0f, 0.0f));
+  KX_GameObject *child = objects.AddObject(MT_Vector3(0.0f, 1.0f, 0.0f), parent);
+
+  ExpectNear(Gather({child}, "worldPosition"), {1, 1, 0});
+
+  // The parent moves in the same call, the child world position is relative to its new one.
+  const std::vector<float> positions = {10, 0, 0, 0, 5, 0};
+  Scatter(objects.m_objects, "worldPosition", positions);
+  ExpectNear(Gather(objects.m_objects, "worldPosition"), positions);
+  ExpectNear(Gather({child}, "localPosition"), {-10, 5, 0});
+}
+
+TEST(ge_object_data, ScatterUpdatesEachNodeOnce)
+{
+  Objects objects;
+  KX_GameObject *parent = objects.AddObject(MT_Vector3(0.0f, 0.0f, 0.0f));
+  for (unsigned int i = 0; i < 5; ++i) {
+    objects.AddObject(MT_Vector3(i, 0.0f, 0.0f), parent);
+  }
+
+  std::vector<float> positions = Gather(objects.m_objects, "localPosition");
+  for (float &value : positions) {
+    value += 1.0f;
+  }
+
+  numUpdates = 0;
+  Scatter(objects.m_objects, "localPosition", positions);
+  EXPECT_EQ(numUpdates, objects.m_objects.size());
+  ExpectNear(Gather(objects.m_objects, "localPosition"), positions);
+}
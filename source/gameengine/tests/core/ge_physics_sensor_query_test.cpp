@@ -0,0 +1,181 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/tests/core/ge_physics_sensor_query_test.cpp
+ *  \ingroup physbullet
+ *
+ * Near sensors resolved with broadphase queries must report the same objects as the near
+ * sensors simulated in the dynamics world.
+ */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+#include "CcdPhysicsController.h"
+#include "CcdPhysicsEnvironment.h"
+
+#include "btBulletDynamicsCommon.h"
+
+namespace {
+
+const float TIME_STEP = 1.0f / 60.0f;
+const int NUM_FRAMES = 180;
+const int NUM_OBJECTS = 12;
+
+/// Physics environment with a near sensor crossed by moving spheres.
+class SensorScene {
+ public:
+  CcdPhysicsEnvironment m_environment;
+  CcdPhysicsController *m_sensor;
+  std::vector<CcdPhysicsController *> m_objects;
+  /// Indices of the objects reported by the sensor for each frame.
+  std::vector<std::vector<int>> m_hits;
+  double m_time;
+
+  SensorScene(bool useQueries) : m_environment(PHY_SOLVER_SEQUENTIAL, false), m_time(0.0)
+  {
+    m_environment.SetGravity(0.0f, 0.0f, 0.0f);
+    m_environment.SetUseSensorQueries(useQueries);
+    m_environment.AddCollisionCallback(PHY_OBJECT_RESPONSE, ResponseCallback, this);
+
+    // Spheres on separate lanes, crossing the sensor at different times and speeds.
+    for (int i = 0; i < NUM_OBJECTS; ++i) {
+      DefaultMotionState *motionState = new DefaultMotionState();
+      motionState->m_worldTransform.setOrigin(
+          btVector3(-6.0f - (i % 4), (i - NUM_OBJECTS / 2) * 0.5f, (i % 3) * 0.5f));
+
+      CcdConstructionInfo ci;
+      ci.m_MotionState = motionState;
+      ci.m_collisionShape = new btSphereShape(0.2f);
+      ci.m_physicsEnv = &m_environment;
+      ci.m_mass = 1.0f;
+      ci.m_bDyna = true;
+      ci.m_bRigid = true;
+      ci.m_linearDamping = 0.0f;
+
+      CcdPhysicsController *ctrl = new CcdPhysicsController(ci);
+      m_environment.AddCcdPhysicsController(ctrl);
+      ctrl->GetRigidBody()->setLinearVelocity(btVector3(3.0f + (i % 5), 0.0f, 0.0f));
+      ctrl->GetRigidBody()->setActivationState(DISABLE_DEACTIVATION);
+      m_objects.push_back(ctrl);
+    }
+
+    m_sensor = static_cast<CcdPhysicsController *>(
+        m_environment.CreateSphereController(2.0f, MT_Vector3(0.0f, 0.0f, 0.0f)));
+    m_environment.RequestCollisionCallback(m_sensor);
+    m_environment.AddSensor(m_sensor);
+  }
+
+  ~SensorScene()
+  {
+    delete m_sensor;
+    for (CcdPhysicsController *ctrl : m_objects) {
+      delete ctrl;
+    }
+  }
+
+  static bool ResponseCallback(void *client_data,
+                               PHY_IPhysicsController *ctrl1,
+                               PHY_IPhysicsController *ctrl2,
+                               const PHY_ICollData * /*coll_data*/,
+                               bool /*first*/)
+  {
+    SensorScene *scene = static_cast<SensorScene *>(client_data);
+    PHY_IPhysicsController *objCtrl = (ctrl1 == scene->m_sensor) ? ctrl2 : ctrl1;
+    const int index = std::find(scene->m_objects.begin(), scene->m_objects.end(), objCtrl) -
+                      scene->m_objects.begin();
+    scene->m_hits.back().push_back(index);
+    return false;
+  }
+
+  void Step()
+  {
+    m_hits.emplace_back();
+    m_time += TIME_STEP;
+    m_environment.ProceedDeltaTime(m_time, TIME_STEP, TIME_STEP);
+  }
+};
+
+}  // namespace
+
+TEST(ge_physics_sensor_query, SameHitsAsWorldSensor)
+{
+  SensorScene world(false);
+  SensorScene queries(true);
+
+  // Only the sensors of the query scene are kept out of the dynamics world.
+  EXPECT_NE(world.m_sensor->GetCollisionObject()->getBroadphaseHandle(), nullptr);
+  EXPECT_EQ(queries.m_sensor->GetCollisionObject()->getBroadphaseHandle(), nullptr);
+
+  int numHits = 0;
+  for (int i = 0; i < NUM_FRAMES; ++i) {
+    world.Step();
+    queries.Step();
+
+    // The world sensor reports the objects in the order of the contact manifolds.
+    std::vector<int> &worldHits = world.m_hits.back();
+    std::sort(worldHits.begin(), worldHits.end());
+    EXPECT_EQ(queries.m_hits.back(), worldHits) << "frame " << i;
+    numHits += worldHits.size();
+  }
+
+  // The spheres went through the sensor.
+  EXPECT_GT(numHits, 0);
+}
+
+TEST(ge_physics_sensor_query, RestorePhysicsKeepsQuery)
+{
+  SensorScene queries(true);
+
+  queries.m_sensor->SuspendPhysics(false);
+  queries.m_sensor->RestorePhysics();
+  EXPECT_EQ(queries.m_sensor->GetCollisionObject()->getBroadphaseHandle(), nullptr);
+
+  // The sensor is still reported after being restored.
+  int numHits = 0;
+  for (int i = 0; i < NUM_FRAMES; ++i) {
+    queries.Step();
+    numHits += queries.m_hits.back().size();
+  }
+  EXPECT_GT(numHits, 0);
+}
+
+TEST(ge_physics_sensor_query, CollisionSensorObjectStaysInWorld)
+{
+  CcdPhysicsEnvironment environment(PHY_SOLVER_SEQUENTIAL, false);
+  environment.SetUseSensorQueries(true);
+
+  // Object of the "Sensor" physics type, used by a Collision sensor.
+  CcdConstructionInfo ci;
+  ci.m_MotionState = new DefaultMotionState();
+  ci.m_collisionShape = new btSphereShape(1.0f);
+  ci.m_physicsEnv = &environment;
+  ci.m_bSensor = true;
+  ci.m_collisionFilterGroup = CcdConstructionInfo::SensorFilter;
+  CcdPhysicsController *ctrl = new CcdPhysicsController(ci);
+
+  environment.AddSensor(ctrl);
+  EXPECT_NE(ctrl->GetCollisionObject()->getBroadphaseHandle(), nullptr);
+
+  delete ctrl;
+}
@@ -0,0 +1,143 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/tests/core/ge_python_threads_test.cpp
+ *  \ingroup ketsji
+ *
+ * Python threads started by a game must run while the engine waits with the GIL released by
+ * KX_PythonThreadsAllowed, as in the frame pacing or the buffer swap.
+ */
+
+#include "testing/testing.h"
+
+#include <chrono>
+#include <thread>
+
+#include "CM_Clock.h"
+#include "KX_FramePacer.h"
+#include "KX_PythonInit.h"
+
+namespace {
+
+const int NUM_FRAMES = 10;
+/// Duration of an engine phase without Python, as a frame wait.
+const std::chrono::milliseconds PHASE_DURATION(20);
+
+/// Background thread of a game script, counting its iterations until it is stopped.
+const char *THREAD_SCRIPT =
+    "import _thread\n"
+    "counter = 0\n"
+    "running = True\n"
+    "stopped = _thread.allocate_lock()\n"
+    "stopped.acquire()\n"
+    "def worker():\n"
+    "    global counter\n"
+    "    while running:\n"
+    "        counter += 1\n"
+    "    stopped.release()\n"
+    "_thread.start_new_thread(worker, ())\n";
+
+}  // namespace
+
+class ge_python_threads : public testing::Test {
+ protected:
+  PyObject *m_globals;
+
+  void SetUp() override
+  {
+    m_globals = nullptr;
+
+    PyConfig config;
+    PyConfig_InitIsolatedConfig(&config);
+    config.pathconfig_warnings = 0;
+    const PyStatus status = Py_InitializeFromConfig(&config);
+    PyConfig_Clear(&config);
+    if (PyStatus_Exception(status)) {
+      GTEST_SKIP() << "Python could not be initialized: "
+                   << (status.err_msg ? status.err_msg : "");
+    }
+
+    m_globals = PyDict_New();
+    PyDict_SetItemString(m_globals, "__builtins__", PyEval_GetBuiltins());
+    PyObject *result = PyRun_String(THREAD_SCRIPT, Py_file_input, m_globals, m_globals);
+    ASSERT_NE(result, nullptr);
+    Py_DECREF(result);
+  }
+
+  void TearDown() override
+  {
+    if (!m_globals) {
+      return;
+    }
+
+    // Stop the thread and wait for it, acquiring the lock releases the GIL.
+    PyDict_SetItemString(m_globals, "running", Py_False);
+    PyObject *result = PyRun_String("stopped.acquire()\n", Py_file_input, m_globals, m_globals);
+    EXPECT_NE(result, nullptr);
+    Py_XDECREF(result);
+
+    Py_DECREF(m_globals);
+    Py_FinalizeEx();
+  }
+
+  long GetCounter() const
+  {
+    return PyLong_AsLong(PyDict_GetItemString(m_globals, "counter"));
+  }
+};
+
+TEST_F(ge_python_threads, BackgroundThreadRunsDuringEnginePhases)
+{
+  for (int i = 0; i < NUM_FRAMES; ++i) {
+    // A phase keeping the GIL, as the logic, blocks the thread.
+    const long lockedCounter = GetCounter();
+    std::this_thread::sleep_for(PHASE_DURATION);
+    EXPECT_EQ(GetCounter(), lockedCounter) << "frame " << i;
+
+    // A phase releasing the GIL lets the thread run.
+    const long releasedCounter = GetCounter();
+    {
+      KX_PythonThreadsAllowed allowThreads;
+      std::this_thread::sleep_for(PHASE_DURATION);
+    }
+    EXPECT_GT(GetCounter(), releasedCounter) << "frame " << i;
+  }
+}
+
+TEST_F(ge_python_threads, BackgroundThreadRunsDuringFrameWait)
+{
+  CM_Clock clock;
+  KX_FramePacer pacer;
+  pacer.SetEnabled(true);
+  pacer.Calibrate(clock);
+
+  const double frameTime = std::chrono::duration<double>(PHASE_DURATION).count();
+  for (int i = 0; i < NUM_FRAMES; ++i) {
+    // The engine waits the next frame as with a fixed framerate.
+    const long counter = GetCounter();
+    pacer.Wait(clock, clock.GetTimeSecond() + frameTime);
+    EXPECT_GT(GetCounter(), counter) << "frame " << i;
+
+    // The engine holds the GIL again after the wait.
+    EXPECT_TRUE(PyGILState_Check()) << "frame " << i;
+  }
+}
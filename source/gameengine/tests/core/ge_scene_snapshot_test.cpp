@@ -0,0 +1,210 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/tests/core/ge_scene_snapshot_test.cpp
+ *  \ingroup ketsji
+ *
+ * Save and restore of the objects state with KX_SceneSnapshot, and the compressed snapshot
+ * files written by KX_SnapshotWriter.
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_fileops.h"
+
+#include "EXP_BoolValue.h"
+#include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_StringValue.h"
+#include "KX_GameObject.h"
+#include "KX_NodeRelationships.h"
+#include "KX_SceneSnapshot.h"
+#include "SG_Node.h"
+
+namespace {
+
+const float EPSILON = 1.0e-5f;
+/// Number of objects of the scene used to measure the compression.
+const unsigned int NUM_OBJECTS = 200;
+
+/// Objects of a scene reduced to their scene graph nodes and game properties.
+class Objects {
+ private:
+  SG_Callbacks m_callbacks;
+
+ public:
+  std::vector<KX_GameObject *> m_objects;
+
+  ~Objects()
+  {
+    for (KX_GameObject *object : m_objects) {
+      SG_Node *node = object->GetSGNode();
+      object->SetSGNode(nullptr);
+      delete node;
+      object->Release();
+    }
+  }
+
+  KX_GameObject *AddObject(const std::string &name)
+  {
+    KX_GameObject *object = new KX_GameObject();
+    object->SetName(name);
+    SG_Node *node = new SG_Node(object, nullptr, m_callbacks);
+    node->SetParentRelation(new KX_NormalParentRelation());
+    object->SetSGNode(node);
+    object->NodeUpdateGS(0.0);
+    m_objects.push_back(object);
+    return object;
+  }
+};
+
+void SetProperty(KX_GameObject *object, const std::string &name, EXP_Value *value)
+{
+  object->SetProperty(name, value);
+  value->Release();
+}
+
+/// Set a state to the object depending on the index.
+void SetState(KX_GameObject *object, int index)
+{
+  object->NodeSetWorldPosition(MT_Vector3(index, -index, 2.0f * index));
+  object->NodeSetGlobalOrientation(MT_Matrix3x3(MT_Vector3(0.0f, 0.0f, 0.1f * index)));
+  object->NodeSetWorldScale(MT_Vector3(1.0f, 1.0f + index, 2.0f));
+  object->NodeUpdateGS(0.0);
+  object->SetState(1 << (index % 30));
+  object->SetVisible(index % 2 == 0, false);
+  SetProperty(object, "health", new EXP_IntValue(100 - index));
+  SetProperty(object, "speed", new EXP_FloatValue(0.5f * index));
+  SetProperty(object, "alive", new EXP_BoolValue(index % 3 != 0));
+  SetProperty(object, "team", new EXP_StringValue(index % 2 ? "red" : "blue", "team"));
+}
+
+void ExpectState(KX_GameObject *object, int index)
+{
+  EXPECT_LT((object->NodeGetWorldPosition() - MT_Vector3(index, -index, 2.0f * index)).length(),
+            EPSILON);
+  const MT_Matrix3x3 orientation(MT_Vector3(0.0f, 0.0f, 0.1f * index));
+  for (unsigned short i = 0; i < 3; ++i) {
+    EXPECT_LT((object->NodeGetWorldOrientation()[i] - orientation[i]).length(), EPSILON);
+  }
+  EXPECT_LT((object->NodeGetWorldScaling() - MT_Vector3(1.0f, 1.0f + index, 2.0f)).length(),
+            EPSILON);
+  EXPECT_EQ(object->GetState(), 1u << (index % 30));
+  EXPECT_EQ(object->GetVisible(), index % 2 == 0);
+  EXPECT_EQ(object->GetProperty("health")->GetNumber(), 100 - index);
+  EXPECT_FLOAT_EQ(object->GetProperty("speed")->GetNumber(), 0.5f * index);
+  EXPECT_EQ(object->GetProperty("alive")->GetNumber() != 0.0, index % 3 != 0);
+  EXPECT_EQ(object->GetProperty("team")->GetText(), index % 2 ? "red" : "blue");
+}
+
+}  // namespace
+
+TEST(ge_scene_snapshot, SaveRestoreRoundTrip)
+{
+  Objects objects;
+  for (unsigned int i = 0; i < 3; ++i) {
+    SetState(objects.AddObject((i < 2) ? "Enemy" : "Player"), i);
+  }
+
+  const std::string snapshot = KX_SceneSnapshot::SaveObjects(objects.m_objects);
+
+  // Change all the saved state.
+  for (unsigned int i = 0; i < objects.m_objects.size(); ++i) {
+    SetState(objects.m_objects[i], i + 10);
+  }
+
+  EXPECT_TRUE(
+      KX_SceneSnapshot::RestoreObjects(objects.m_objects, snapshot.data(), snapshot.size()));
+  for (unsigned int i = 0; i < objects.m_objects.size(); ++i) {
+    ExpectState(objects.m_objects[i], i);
+  }
+}
+
+TEST(ge_scene_snapshot, RestoreMatchesObjectsByName)
+{
+  Objects objects;
+  SetState(objects.AddObject("Enemy"), 1);
+  SetState(objects.AddObject("Player"), 2);
+  const std::string snapshot = KX_SceneSnapshot::SaveObjects(objects.m_objects);
+
+  // The objects are restored by name, even in another order.
+  Objects other;
+  KX_GameObject *player = other.AddObject("Player");
+  KX_GameObject *enemy = other.AddObject("Enemy");
+  KX_GameObject *unknown = other.AddObject("Unknown");
+  SetState(unknown, 5);
+  EXPECT_TRUE(KX_SceneSnapshot::RestoreObjects(other.m_objects, snapshot.data(), snapshot.size()));
+  ExpectState(enemy, 1);
+  ExpectState(player, 2);
+  ExpectState(unknown, 5);
+}
+
+TEST(ge_scene_snapshot, RestoreRefusesInvalidData)
+{
+  Objects objects;
+  KX_GameObject *object = objects.AddObject("Player");
+  SetState(object, 1);
+  std::string snapshot = KX_SceneSnapshot::SaveObjects(objects.m_objects);
+  SetState(object, 2);
+
+  // Truncated snapshot.
+  EXPECT_FALSE(
+      KX_SceneSnapshot::RestoreObjects(objects.m_objects, snapshot.data(), snapshot.size() - 1));
+  // Other version.
+  snapshot[4] = KX_SceneSnapshot::VERSION + 1;
+  EXPECT_FALSE(
+      KX_SceneSnapshot::RestoreObjects(objects.m_objects, snapshot.data(), snapshot.size()));
+  // Not a snapshot.
+  EXPECT_FALSE(KX_SceneSnapshot::RestoreObjects(objects.m_objects, "BGS", 3));
+
+  // The object is left unchanged.
+  ExpectState(object, 2);
+}
+
+TEST(ge_scene_snapshot, CompressedFileRoundTrip)
+{
+  Objects objects;
+  for (unsigned int i = 0; i < NUM_OBJECTS; ++i) {
+    SetState(objects.AddObject("Enemy"), i % 10);
+  }
+  const std::string snapshot = KX_SceneSnapshot::SaveObjects(objects.m_objects);
+
+  const std::string rawPath = testing::TempDir() + "ge_scene_snapshot_raw.bgss";
+  const std::string compressedPath = testing::TempDir() + "ge_scene_snapshot_compressed.bgss";
+  {
+    KX_SnapshotWriter writer;
+    writer.Write(rawPath, std::string(snapshot), false);
+    writer.Write(compressedPath, std::string(snapshot), true);
+    writer.Wait();
+  }
+
+  EXPECT_EQ(BLI_file_size(rawPath.c_str()), snapshot.size());
+  // The state of objects of the same name compresses well.
+  EXPECT_LT(BLI_file_size(compressedPath.c_str()), snapshot.size() / 4);
+
+  for (const std::string &path : {rawPath, compressedPath}) {
+    std::string data;
+    EXPECT_TRUE(KX_SceneSnapshot::ReadFile(path, data)) << path;
+    EXPECT_EQ(data, snapshot) << path;
+    BLI_delete(path.c_str(), false, false);
+  }
+}
@@ -0,0 +1,594 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file gameengine/tests/performance/ge_core_performance_test.cpp
+ *  \ingroup ketsji
+ *
+ * Micro benchmarks of the game engine hot paths on synthetic scenes, run headless.
+ *
+ * Usage:
+ *   ge_core_performance_test --ge_sizes=1000,10000,100000 --ge_format=json --ge_output=out.json
+ */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "BLI_threads.h"
+#include "BLI_timeit.hh"
+
+#include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_ListValue.h"
+#include "EXP_StringValue.h"
+#include "KX_GameObject.h"
+#include "KX_NetworkMessageManager.h"
+#include "KX_NodeRelationships.h"
+#include "SCA_ANDController.h"
+#include "SCA_AlwaysSensor.h"
+#include "SCA_BasicEventManager.h"
+#include "SCA_LogicManager.h"
+#include "SCA_PropertyActuator.h"
+#include "SG_Node.h"
+
+#ifdef WITH_BULLET
+#  include "CcdPhysicsController.h"
+#  include "CcdPhysicsEnvironment.h"
+
+#  include "btBulletDynamicsCommon.h"
+#endif
+
+#ifdef WITH_AUDASPACE
+#  include <AUD_Device.h>
+#  include <AUD_Handle.h>
+#  include <AUD_Sound.h>
+#endif
+
+DEFINE_string(ge_sizes, "1000,10000,100000", "Comma separated numbers of objects to benchmark.");
+DEFINE_int32(ge_iterations, 10, "Number of measured iterations of each benchmark.");
+DEFINE_string(ge_format, "csv", "Format of the results: csv or json.");
+DEFINE_string(ge_output, "", "File to write the results to, standard output when empty.");
+
+namespace {
+
+using blender::timeit::Clock;
+using blender::timeit::Nanoseconds;
+using blender::timeit::TimePoint;
+
+/// Number of nodes in each hierarchy of the synthetic scenes: root, child, grandchild...
+const unsigned int HIERARCHY_DEPTH = 4;
+/// Number of game properties of each replicated object.
+const unsigned int NUM_PROPERTIES = 8;
+
+struct Result {
+  std::string benchmark;
+  unsigned int objects;
+  unsigned int iterations;
+  /// Mean time of an iteration.
+  double milliseconds;
+  /// Mean time per object, or per lookup for the lookup benchmarks.
+  double nanosecondsPerItem;
+};
+
+std::vector<Result> results;
+
+class Timer {
+ private:
+  Nanoseconds m_total;
+  TimePoint m_start;
+
+ public:
+  Timer() : m_total(0)
+  {
+  }
+
+  void Start()
+  {
+    m_start = Clock::now();
+  }
+
+  void Stop()
+  {
+    m_total += Clock::now() - m_start;
+  }
+
+  void AddResult(const std::string &benchmark,
+                 unsigned int objects,
+                 unsigned int iterations,
+                 unsigned int itemsPerIteration) const
+  {
+    const double nanoseconds = m_total.count();
+    results.push_back({benchmark,
+                       objects,
+                       iterations,
+                       nanoseconds / iterations / 1.0e6,
+                       nanoseconds / ((double)iterations * itemsPerIteration)});
+  }
+};
+
+std::vector<unsigned int> GetSizes()
+{
+  std::vector<unsigned int> sizes;
+  std::stringstream stream(FLAGS_ge_sizes);
+  std::string size;
+  while (std::getline(stream, size, ',')) {
+    if (!size.empty()) {
+      sizes.push_back(std::stoul(size));
+    }
+  }
+  return sizes;
+}
+
+unsigned int GetIterations()
+{
+  return std::max(FLAGS_ge_iterations, 1);
+}
+
+void WriteResults(std::ostream &stream)
+{
+  if (FLAGS_ge_format == "json") {
+    stream << "[\n";
+    for (unsigned int i = 0, size = results.size(); i < size; ++i) {
+      const Result &result = results[i];
+      stream << "  {\"benchmark\": \"" << result.benchmark << "\", \"objects\": " << result.objects
+             << ", \"iterations\": " << result.iterations
+             << ", \"milliseconds\": " << result.milliseconds
+             << ", \"nanoseconds_per_item\": " << result.nanosecondsPerItem << "}"
+             << ((i + 1 < size) ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+  else {
+    stream << "benchmark,objects,iterations,milliseconds,nanoseconds_per_item\n";
+    for (const Result &result : results) {
+      stream << result.benchmark << "," << result.objects << "," << result.iterations << ","
+             << result.milliseconds << "," << result.nanosecondsPerItem << "\n";
+    }
+  }
+}
+
+/// Write all the results once the benchmarks are run.
+class ResultsEnvironment : public testing::Environment {
+ public:
+  void TearDown() override
+  {
+    if (FLAGS_ge_output.empty()) {
+      WriteResults(std::cout);
+      return;
+    }
+
+    std::ofstream file(FLAGS_ge_output);
+    if (!file) {
+      std::cerr << "Could not open " << FLAGS_ge_output << std::endl;
+      return;
+    }
+    WriteResults(file);
+  }
+};
+
+testing::Environment *const resultsEnvironment = testing::AddGlobalTestEnvironment(
+    new ResultsEnvironment());
+
+void *ReplicationFunc(SG_Node *node, void *clientobj, void * /*clientinfo*/)
+{
+  EXP_Value *replica = static_cast<EXP_Value *>(clientobj)->GetReplica();
+  node->SetSGClientObject(replica);
+  return replica;
+}
+
+void *DestructionFunc(SG_Node *node, void *clientobj, void * /*clientinfo*/)
+{
+  if (clientobj) {
+    static_cast<EXP_Value *>(clientobj)->Release();
+  }
+  delete node;
+  return nullptr;
+}
+
+/** Create hierarchies of HIERARCHY_DEPTH nodes using the game engine parent relation.
+ * \param clientobj Called for each node to create its client object, can return nullptr.
+ */
+template<class ClientFunc>
+std::vector<SG_Node *> CreateHierarchies(unsigned int numObjects,
+                                         SG_Callbacks &callbacks,
+                                         ClientFunc clientFunc)
+{
+  std::vector<SG_Node *> roots;
+  for (unsigned int i = 0; i < numObjects; i += HIERARCHY_DEPTH) {
+    SG_Node *parent = nullptr;
+    for (unsigned int j = i; j < std::min(i + HIERARCHY_DEPTH, numObjects); ++j) {
+      SG_Node *node = new SG_Node(clientFunc(j), nullptr, callbacks);
+      node->SetParentRelation(new KX_NormalParentRelation());
+      node->SetLocalPosition(MT_Vector3(1.0f, 0.0f, 0.0f));
+      node->SetLocalOrientation(MT_Matrix3x3(MT_Vector3(0.0f, 0.0f, 0.1f * j)));
+      if (parent) {
+        parent->AddChild(node);
+      }
+      else {
+        roots.push_back(node);
+      }
+      parent = node;
+    }
+  }
+
+  return roots;
+}
+
+void DestructHierarchies(const std::vector<SG_Node *> &roots)
+{
+  for (SG_Node *root : roots) {
+    root->Destruct();
+  }
+}
+
+}  // namespace
+
+/// Update of the world transforms of modified hierarchies, as done each frame by the scene.
+TEST(ge_core_performance, SG_Node_UpdateWorldData)
+{
+  const unsigned int iterations = GetIterations();
+  for (const unsigned int size : GetSizes()) {
+    SG_Callbacks callbacks;
+    std::vector<SG_Node *> roots = CreateHierarchies(
+        size, callbacks, [](unsigned int /*index*/) -> void * { return nullptr; });
+
+    Timer timer;
+    for (unsigned int i = 0; i < iterations; ++i) {
+      const MT_Vector3 position(0.0f, 0.0f, (float)i);
+
+      timer.Start();
+      for (SG_Node *root : roots) {
+        root->SetLocalPosition(position);
+        root->UpdateWorldData(0.0);
+      }
+      timer.Stop();
+    }
+    timer.AddResult("SG_Node::UpdateWorldData", size, iterations, size);
+
+    DestructHierarchies(roots);
+  }
+}
+
+/** Replication of scene graph hierarchies whose client objects hold game properties. This is only
+ * the SG_Node::GetSGReplica part of KX_Scene::AddReplicaObject, the rest of it can't be
+ * benchmarked without a converted Blender scene.
+ */
+TEST(ge_core_performance, GetSGReplica)
+{
+  const unsigned int iterations = GetIterations();
+  for (const unsigned int size : GetSizes()) {
+    SG_Callbacks callbacks(ReplicationFunc, DestructionFunc, nullptr, nullptr, nullptr);
+    std::vector<SG_Node *> roots = CreateHierarchies(
+        size, callbacks, [](unsigned int index) -> void * {
+          EXP_IntValue *object = new EXP_IntValue(index, "object" + std::to_string(index));
+          for (unsigned int i = 0; i < NUM_PROPERTIES; ++i) {
+            const std::string name = "prop" + std::to_string(i);
+            EXP_Value *prop;
+            switch (i % 3) {
+              case 0:
+                prop = new EXP_IntValue(i);
+                break;
+              case 1:
+                prop = new EXP_FloatValue(i);
+                break;
+              default:
+                prop = new EXP_StringValue(name, name);
+                break;
+            }
+            object->SetProperty(name, prop);
+            prop->Release();
+          }
+          return object;
+        });
+
+    Timer timer;
+    std::vector<SG_Node *> replicas(roots.size());
+    for (unsigned int i = 0; i < iterations; ++i) {
+      timer.Start();
+      for (unsigned int j = 0, numroots = roots.size(); j < numroots; ++j) {
+        replicas[j] = roots[j]->GetSGReplica();
+      }
+      timer.Stop();
+
+      DestructHierarchies(replicas);
+    }
+    timer.AddResult("SG_Node::GetSGReplica", size, iterations, size);
+
+    DestructHierarchies(roots);
+  }
+}
+
+/// Trigger of controllers by sensors and update of the activated actuators.
+TEST(ge_core_performance, SCA_LogicManager)
+{
+  const unsigned int iterations = GetIterations();
+  for (const unsigned int size : GetSizes()) {
+    SCA_LogicManager *logicmgr = new SCA_LogicManager();
+    SCA_BasicEventManager *eventmgr = new SCA_BasicEventManager(logicmgr);
+    logicmgr->RegisterEventManager(eventmgr);
+
+    std::vector<KX_GameObject *> objects(size);
+    for (unsigned int i = 0; i < size; ++i) {
+      KX_GameObject *object = new KX_GameObject();
+      EXP_IntValue *count = new EXP_IntValue(0);
+      object->SetProperty("count", count);
+      count->Release();
+
+      SCA_AlwaysSensor *sensor = new SCA_AlwaysSensor(eventmgr, object);
+      sensor->SetPulseMode(true, false, 0);
+      sensor->SetLogicManager(logicmgr);
+      object->AddSensor(sensor);
+
+      SCA_ANDController *controller = new SCA_ANDController(object);
+      controller->SetState(1);
+      controller->SetLogicManager(logicmgr);
+      object->AddController(controller);
+
+      SCA_PropertyActuator *actuator = new SCA_PropertyActuator(
+          object, nullptr, "count", "1", SCA_PropertyActuator::KX_ACT_PROP_ADD);
+      actuator->SetLogicManager(logicmgr);
+      object->AddActuator(actuator);
+
+      logicmgr->RegisterToSensor(controller, sensor);
+      logicmgr->RegisterToActuator(controller, actuator);
+
+      sensor->Release();
+      controller->Release();
+      actuator->Release();
+
+      object->SetInitState(1);
+      object->ResetState();
+      objects[i] = object;
+    }
+
+    Timer timer;
+    for (unsigned int i = 0; i < iterations; ++i) {
+      const double time = i / 60.0;
+
+      timer.Start();
+      logicmgr->BeginFrame(time, time);
+      logicmgr->UpdateFrame(time);
+      logicmgr->EndFrame();
+      timer.Stop();
+    }
+    timer.AddResult("SCA_LogicManager", size, iterations, size);
+
+    for (KX_GameObject *object : objects) {
+      for (SCA_ISensor *sensor : object->GetSensors()) {
+        logicmgr->RemoveSensor(sensor);
+      }
+      for (SCA_IController *controller : object->GetControllers()) {
+        logicmgr->RemoveController(controller);
+      }
+      for (SCA_IActuator *actuator : object->GetActuators()) {
+        logicmgr->RemoveActuator(actuator);
+      }
+      object->Release();
+    }
+    delete logicmgr;
+  }
+}
+
+/// Lookup of objects by name, as done by the scene object list and the logic manager.
+TEST(ge_core_performance, EXP_ListValue_FindValue)
+{
+  const unsigned int iterations = GetIterations();
+  for (const unsigned int size : GetSizes()) {
+    EXP_ListValue<EXP_IntValue> *list = new EXP_ListValue<EXP_IntValue>();
+    list->Resize(size);
+    for (unsigned int i = 0; i < size; ++i) {
+      list->SetValue(i, new EXP_IntValue(i, "object" + std::to_string(i)));
+    }
+
+    // Names spread over the list, the last one is missing to measure a full search.
+    const unsigned int numLookups = std::min(size, 1000u);
+    std::vector<std::string> names(numLookups);
+    for (unsigned int i = 0; i < numLookups; ++i) {
+      names[i] = "object" + std::to_string((i + 1) * size / numLookups);
+    }
+
+    Timer timer;
+    unsigned int found = 0;
+    for (unsigned int i = 0; i < iterations; ++i) {
+      timer.Start();
+      for (const std::string &name : names) {
+        found += (list->FindValue(name) != nullptr);
+      }
+      timer.Stop();
+    }
+    timer.AddResult("EXP_ListValue::FindValue", size, iterations, numLookups);
+    EXPECT_EQ(found, (numLookups - 1) * iterations);
+
+    list->ReleaseAndRemoveAll();
+    list->Release();
+  }
+}
+
+/// Messages sent by every object and read the next frame by every object.
+TEST(ge_core_performance, KX_NetworkMessageManager)
+{
+  const unsigned int iterations = GetIterations();
+  const unsigned int numReceivers = 100;
+  const unsigned int numSubjects = 10;
+
+  for (const unsigned int size : GetSizes()) {
+    KX_NetworkMessageManager manager;
+
+    std::vector<std::string> receivers(numReceivers);
+    for (unsigned int i = 0; i < numReceivers; ++i) {
+      receivers[i] = "object" + std::to_string(i);
+    }
+    std::vector<std::string> subjects(numSubjects);
+    for (unsigned int i = 0; i < numSubjects; ++i) {
+      subjects[i] = "subject" + std::to_string(i);
+    }
+
+    Timer timer;
+    unsigned int received = 0;
+    for (unsigned int i = 0; i < iterations; ++i) {
+      timer.Start();
+      for (unsigned int j = 0; j < size; ++j) {
+        manager.AddMessage({receivers[j % numReceivers], nullptr, subjects[j % numSubjects], ""});
+      }
+      // Frame change, the messages sent are now readable.
+      manager.ClearMessages();
+      for (unsigned int j = 0; j < size; ++j) {
+        received += manager.GetMessages(receivers[j % numReceivers], subjects[j % numSubjects])
+                        .size();
+      }
+      timer.Stop();
+      manager.ClearMessages();
+    }
+    timer.AddResult("KX_NetworkMessageManager", size, iterations, size);
+    EXPECT_GT(received, 0u);
+  }
+}
+
+#ifdef WITH_AUDASPACE
+/** Mix of many 3D sounds by a software device, a quarter of them out of hearing distance.
+ * The number of voices mixed per millisecond is 1e6 / nanoseconds_per_item.
+ */
+TEST(ge_core_performance, AUD_SoftwareDevice_Mix)
+{
+  const unsigned int iterations = GetIterations();
+  const int samples = 1024;
+
+  AUD_DeviceSpecs specs;
+  specs.channels = AUD_CHANNELS_STEREO;
+  specs.format = AUD_FORMAT_FLOAT32;
+  specs.rate = AUD_RATE_48000;
+
+  AUD_Sound *sound = AUD_Sound_sine(440.0f, AUD_RATE_44100);
+  std::vector<float> buffer(samples * specs.channels);
+
+  for (const unsigned int size : GetSizes()) {
+    // Mix on a single thread reading every sound, then with the game engine settings.
+    for (const bool parallel : {false, true}) {
+      AUD_Device *device = AUD_Device_open("read", specs, samples, "");
+      AUD_Device_setDistanceModel(device, AUD_DISTANCE_MODEL_LINEAR_CLAMPED);
+      AUD_Device_setMixingThreads(device, parallel ? BLI_system_thread_count() : 1);
+      AUD_Device_setVirtualizationVolume(device, parallel ? 0.0f : -1.0f);
+
+      for (unsigned int i = 0; i < size; ++i) {
+        const float location[3] = {(i % 4 == 0) ? 100.0f : (float)(i % 40), 1.0f, 0.0f};
+        AUD_Handle *handle = AUD_Device_play(device, sound, 0);
+        AUD_Handle_setRelative(handle, 0);
+        AUD_Handle_setDistanceMaximum(handle, 50.0f);
+        AUD_Handle_setLocation(handle, location);
+        AUD_Handle_free(handle);
+      }
+
+      Timer timer;
+      for (unsigned int i = 0; i < iterations; ++i) {
+        timer.Start();
+        AUD_Device_read(device, (unsigned char *)buffer.data(), samples);
+        timer.Stop();
+      }
+      timer.AddResult(parallel ? "AUD_SoftwareDevice::mix parallel" : "AUD_SoftwareDevice::mix",
+                      size,
+                      iterations,
+                      size);
+
+      AUD_Device_free(device);
+    }
+  }
+
+  AUD_Sound_free(sound);
+}
+#endif  // WITH_AUDASPACE
+
+#ifdef WITH_BULLET
+/** Restore of a physics snapshot followed by a step, as done by a rollback network game which
+ * resimulates 8 frames each frame with 2000 bodies. The bodies are in piles of 10 touching the
+ * ground so that each of them has contacts.
+ */
+TEST(ge_core_performance, CcdPhysicsEnvironment_RestoreSnapshot)
+{
+  const unsigned int iterations = GetIterations();
+  const unsigned int numResimulations = 8;
+  const float timeStep = 1.0f / 60.0f;
+  // The physics step is too slow to use the benchmark sizes.
+  const unsigned int size = 2000;
+
+  CcdPhysicsEnvironment environment(PHY_SOLVER_SEQUENTIAL, false);
+  const unsigned int rowSize = std::max(1u, (unsigned int)std::sqrt(size / 10.0f));
+
+  std::vector<CcdPhysicsController *> controllers;
+  for (unsigned int i = 0; i <= size; ++i) {
+    DefaultMotionState *motionState = new DefaultMotionState();
+    // The shapes are deleted by the controllers.
+    CcdConstructionInfo ci;
+    if (i == size) {
+      motionState->m_worldTransform.setOrigin(btVector3(0.0f, 0.0f, -1.0f));
+      ci.m_collisionShape = new btBoxShape(btVector3(1000.0f, 1000.0f, 1.0f));
+      ci.m_collisionFilterGroup = CcdConstructionInfo::StaticFilter;
+    }
+    else {
+      const unsigned int pile = i / 10;
+      motionState->m_worldTransform.setOrigin(btVector3(
+          (pile % rowSize) * 3.0f, (pile / rowSize) * 3.0f, 0.5f + (i % 10) * 1.05f));
+      ci.m_collisionShape = new btBoxShape(btVector3(0.5f, 0.5f, 0.5f));
+      ci.m_mass = 1.0f;
+      ci.m_bDyna = true;
+      ci.m_bRigid = true;
+      ci.m_collisionFilterGroup = CcdConstructionInfo::DynamicFilter;
+    }
+    ci.m_MotionState = motionState;
+    ci.m_physicsEnv = &environment;
+
+    CcdPhysicsController *ctrl = new CcdPhysicsController(ci);
+    environment.AddCcdPhysicsController(ctrl);
+    controllers.push_back(ctrl);
+  }
+
+  double time = 0.0;
+  // Let the piles settle to have contacts.
+  for (unsigned int i = 0; i < 60; ++i) {
+    time += timeStep;
+    environment.ProceedDeltaTime(time, timeStep, timeStep);
+  }
+
+  Timer timer;
+  std::vector<unsigned char> snapshot;
+  for (unsigned int i = 0; i < iterations; ++i) {
+    EXPECT_TRUE(environment.SaveSnapshot(snapshot));
+    for (unsigned int j = 0; j < numResimulations; ++j) {
+      timer.Start();
+      EXPECT_TRUE(environment.RestoreSnapshot(snapshot.data(), snapshot.size()));
+      timer.Stop();
+      environment.ProceedDeltaTime(time + timeStep, timeStep, timeStep);
+    }
+    time += timeStep;
+  }
+  timer.AddResult(
+      "CcdPhysicsEnvironment::RestoreSnapshot", size, iterations * numResimulations, size);
+
+  for (CcdPhysicsController *ctrl : controllers) {
+    delete ctrl;
+  }
+}
+#endif  // WITH_BULLET